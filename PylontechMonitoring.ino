@@ -1,8 +1,10 @@
 // =========================
 // PylontechMonitoring (ESP32-S)
-// Clean architecture with 2 tasks:
-//   - Task 1 (Core 0): Real‑time pipeline (UART + Parser)
-//   - Task 2 (Core 1): Non‑critical pipeline (Scheduler + MQTT + Webserver + WiFi)
+// Clean architecture with 4 tasks:
+//   - Task 1 (Core 1): Real‑time pipeline (UART receive + validate)
+//   - Task 3 (Core 1): Parser stage (frameQueue → Parser → Snapshots)
+//   - Task 2 (Core 0): Non‑critical pipeline (Scheduler + MQTT + WiFi)
+//   - Task 4 (Core 0): Webserver (own task, slow answers are deferred)
 // =========================
 
 // ---- System Includes ----
@@ -22,11 +24,10 @@
 #include "py_systemmanager.h"
 #include "py_uart.h"
 #include "py_scheduler.h"
-#include "py_parser_pwr.h"
-#include "py_parser_bat.h"
-#include "py_parser_stat.h"
+#include "py_pipeline.h"
 #include "py_log.h"
 #include "py_mqtt.h"
+#include "py_mqtt_offline.h"
 //#include "py_display.h"
 
 // =========================
@@ -39,8 +40,7 @@
 QueueHandle_t mqttQueue;
 QueueHandle_t rtWakeQueue;
 
-// frameQueue kommt aus config.cpp (extern in config.h deklariert)
-extern QueueHandle_t frameQueue;
+// frameQueue kommt aus py_pipeline.cpp (UART → Parser)
 
 // Global objectsScheduler
 PyUart py_uart;
@@ -48,8 +48,8 @@ extern PyScheduler py_scheduler;
 extern PyMqtt py_mqtt;
 
 // =========================
- //  Task 1: Real‑Time Pipeline (Core 0)
- //  UART → Parser → Queue
+ //  Task 1: Real‑Time Pipeline (Core 1)
+ //  UART → frameQueue
  // =========================
 void realtimeTask(void* parameter) {
 
@@ -75,7 +75,8 @@ void realtimeTask(void* parameter) {
         }
 
         // 4) Pop next command
-        String cmd = py_scheduler.popNextCommand();
+        bool interactive = false;
+        String cmd = py_scheduler.popNextCommand(&interactive);
         if (cmd.length() == 0) {
             vTaskDelay(1);
             continue;
@@ -84,17 +85,16 @@ void realtimeTask(void* parameter) {
         Log(LOG_INFO, "Task1: executing command: " + cmd);
 
         // 5) Execute UART command (blocking allowed)
-        bool ok = py_uart.sendCommand(cmd.c_str());
+        bool ok = py_uart.sendCommand(cmd.c_str(), interactive);
 
-        if (!ok || !py_uart.hasFrame()) {
+        if (!ok) {
             Log(LOG_WARN, "Task1: UART failed for command: " + cmd);
             py_scheduler.lastCommandFinished = millis();
             vTaskDelay(1);
             continue;
         }
 
-        // 6) Get raw frame (Parser läuft in PyUart)
-        String raw = py_uart.getFrame();
+        // 6) Frame stays in frameStore (Parser-Task bekommt ihn über frameQueue, Web-Konsole liest dort)
 
         // 7) Mark command finished
         py_scheduler.lastCommandFinished =millis();
@@ -105,21 +105,41 @@ void realtimeTask(void* parameter) {
 }
 
 // =========================
-//  Task 2: Non‑Critical Pipeline (Core 1)
-//  Scheduler + MQTT + Webserver + WiFi
+//  Task 3: Parser Stage (Core 1)
+//  frameQueue → Parser → Snapshots
+// =========================
+void parserTask(void* parameter) {
+    FrameDesc desc;
+
+    for (;;) {
+        if (xQueueReceive(frameQueue, &desc, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        processFrame(desc);
+
+        // descriptor owned one slot reference
+        frameStore.release(desc.slot);
+    }
+}
+
+// =========================
+//  Task 2: Non‑Critical Pipeline (Core 0)
+//  Scheduler + MQTT + WiFi
 // =========================
 void noncriticalTask(void* parameter) {
     MqttMessage msg;
 
     unsigned long lastSched = 0;
     unsigned long lastMqtt  = 0;
-    unsigned long lastWeb   = 0;
     unsigned long lastSys   = 0;
     unsigned long lastRam   = 0;
 
     for (;;) {
         unsigned long now = millis();
 
+        // 0) Config changes posted by the web handlers (see ConfigChange)
+        ConfigChange_run();
+
         // 1) Scheduler
         if (now - lastSched >= 20) {
             lastSched = now;
@@ -137,19 +157,16 @@ void noncriticalTask(void* parameter) {
             py_mqtt.loop();
         }
 
-        // 4) Webserver
-        if (now - lastWeb >= 20) {
-            lastWeb = now;
-            WebServerModule_handle();
-        }
-
-        // 5) WiFi + System
+        // 4) WiFi + System
         if (now - lastSys >= 20) {
             lastSys = now;
             WiFiManagerModule::loop();
             SystemManager::loop();
         }
 
+        // 5) Log records → Serial (formatted here, not by the writers)
+        LogPump();
+
         // 6) RAM Debug
         if (config.logDebug) {
             if (now - lastRam >= 5000) {
@@ -175,6 +192,18 @@ void noncriticalTask(void* parameter) {
 }
 
 
+// =========================
+//  Task 4: Webserver (Core 0)
+//  handleClient + deferred answers
+//  (blocks in select(), no extra delay)
+// =========================
+void webTask(void* parameter) {
+    for (;;) {
+        WebServerModule_handle();
+    }
+}
+
+
 // =========================
 //  Setup
 // =========================
@@ -197,6 +226,13 @@ void setup() {
         Log(LOG_ERROR, "MQTT Queue could not be created!");
     }
 
+    // Parser queue (UART → Parser)
+    frameQueue = xQueueCreate(FRAME_QUEUE_LEN, sizeof(FrameDesc));
+
+    if (frameQueue == NULL) {
+        Log(LOG_ERROR, "Frame Queue could not be created!");
+    }
+
     // UART + Scheduler
     py_uart.begin(16, 17);      // RX=16, TX=17
     py_scheduler.begin(&py_uart);  
@@ -222,6 +258,9 @@ void setup() {
         Log(LOG_INFO, "SPIFFS mounted");
     }
 
+    // MQTT store-and-forward ring (needs SPIFFS)
+    mqttOffline.begin();
+
     // Webserver
     WebServerModule_begin();
 
@@ -247,7 +286,18 @@ void setup() {
         1           // Core 1
     );
 
-    // Start Task 2 (Non‑Critical + OTA + Webserver) auf Core 0
+    // Start Task 3 (Parser) on Core 1 - runs while Task 1 waits for UART
+    xTaskCreatePinnedToCore(
+        parserTask,
+        "Parser Task",
+        6144,
+        NULL,
+        1,          // below the UART task
+        NULL,
+        1           // Core 1
+    );
+
+    // Start Task 2 (Non‑Critical + OTA) auf Core 0
     xTaskCreatePinnedToCore(
         noncriticalTask,
         "NonCritical Task",
@@ -258,6 +308,17 @@ void setup() {
         0           // Core 0
     );
 
+    // Start Task 4 (Webserver) auf Core 0 - slow handlers no longer stall MQTT
+    xTaskCreatePinnedToCore(
+        webTask,
+        "Web Task",
+        8192,
+        NULL,
+        1,          // same as Task 2, time sliced
+        NULL,
+        0           // Core 0
+    );
+
     Log(LOG_INFO, "Setup complete");
 }
 
@@ -1,293 +1,219 @@
-#pragma once
-#include <Arduino.h>
-#include <Preferences.h>
-#include <map>
-#include <vector>
-
-// ---------------------------------------------------------
-// Timezone entry structure (Region → City → IANA → POSIX)
-// ---------------------------------------------------------
-struct TimezoneEntry {
-    const char* region;
-    const char* city;
-    const char* tzName;
-    const char* posix;
-};
-
-
-String getTimezoneJson();
-String findPosixForTimezone(const String& tzName);
-extern const TimezoneEntry TIMEZONES[];
-extern const size_t TIMEZONE_COUNT;
-
-// ---------------------------------------------------------
-// FieldConfig
-// ---------------------------------------------------------
-
-struct FieldConfig {
-    String label;      // UI label
-    String display;    // NEW: MQTT display name (CamelCase)
-    String factor;
-    String unit;
-    bool mqtt;
-    bool send;
-};
-
-// ---------------------------------------------------------
-// Battery configuration
-// ---------------------------------------------------------
-struct BatteryConfig {
-    unsigned long intervalPwr  = 60000;
-    unsigned long intervalBat  = 300000;
-    unsigned long intervalStat = 1800000;
-
-    bool enableBat  = false;
-    bool enableStat = false;
-
-    bool useFahrenheit = false;
-
-    uint8_t maxModules = 16;
-
-    std::map<String, FieldConfig> fieldsPwr;
-    std::map<String, FieldConfig> fieldsBat;
-    std::map<String, FieldConfig> fieldsStat;
-};
-
-// ---------------------------------------------------------
-// MQTT configuration
-// ---------------------------------------------------------
-struct MqttConfig {
-    bool enabled = false;
-
-    String server = "";
-    uint16_t port = 1883;
-    String user = "";
-    String pass = "";
-
-    String prefix     = "Pylontech";
-    String topicStack = "Stack";
-    String topicPwr   = "pwr";
-    String topicBat   = "bat";
-    String topicStat  = "stat";
-    String cellPrefix = "Cell";   // NEW: configurable cell prefix
-
-    String mode = "active";
-};
-
-// ---------------------------------------------------------
-// Battery data structures (PWR / BAT / STAT)
-// ---------------------------------------------------------
-struct BatteryModule {
-    bool present = false;
-    int index = 0;
-    int voltage_mV = 0;
-    int current_mA = 0;
-    int temperature = 0;
-    int soc = 0;
-    std::map<String, String> fields;
-};
-
-struct BatteryStack {
-    int batteryCount = 0;
-    int avgVoltage_mV = 0;
-    int totalCurrent_mA = 0;
-    int temperature = 0;
-    int soc = 0;
-
-    void reset() {
-        batteryCount = 0;
-        avgVoltage_mV = 0;
-        totalCurrent_mA = 0;
-        temperature = 0;
-        soc = 0;
-    }
-};
-
-struct BatField {
-    String name;
-    String raw;
-    // int moduleIndex;  // optional
-};
-
-struct BatData {
-    int moduleIndex;               // NEW: module number (1..N)
-    int cellIndex = -1;
-    std::vector<BatField> fields;
-};
-
-struct StatField {
-    String name;
-    String raw;
-};
-
-struct StatData {
-    int moduleIndex = -1;
-    std::vector<StatField> fields;
-};
-
-// ---------------------------------------------------------
-// ParsedData + Double Buffer
-// ---------------------------------------------------------
-struct ParsedData {
-    BatteryStack stack;
-    std::vector<BatteryModule> modules;
-    std::vector<BatData> batCells;
-    StatData stat;
-};
-
-//extern ParsedData bufferA;      //alt
-//extern ParsedData bufferB;      //alt
-//extern volatile bool useA;      //alt
-
-struct PwrBuffer {
-    BatteryStack stack;
-    std::vector<BatteryModule> modules;
-};
-
-struct BatBuffer {
-    std::vector<BatData> cells;
-};
-
-struct StatBuffer {
-    StatData stat;
-};
-
-// Doppelbuffer für PWR
-extern PwrBuffer pwrA;
-extern PwrBuffer pwrB;
-extern volatile bool pwrUseA;
-
-// Doppelbuffer für BAT
-extern BatBuffer batA;
-extern BatBuffer batB;
-extern volatile bool batUseA;
-
-// Doppelbuffer für STAT
-extern StatBuffer statA;
-extern StatBuffer statB;
-extern volatile bool statUseA;
-
-
-enum ParseResult {
-    PARSE_OK,
-    PARSE_FAIL,
-    PARSE_IGNORED
-};
-
-#define MAX_MODULES 16
-
-enum FrameType {
-    FRAME_PWR,
-    FRAME_BAT,
-    FRAME_STAT
-};
-
-struct ParsedFrame {
-    FrameType type;
-    uint8_t index;
-
-    BatteryStack stack;
-    BatteryModule modules[MAX_MODULES];
-    BatData bat;
-    StatData stat;
-};
-
-
-// ---------------------------------------------------------
-// Parser / MQTT Flags
-// ---------------------------------------------------------
-extern bool parserHasData;
-extern bool newParserData;
-
-extern bool batParserHasData;
-extern int  batParserModuleIndex;
-
-extern bool statParserHasData;
-extern int  statParserModuleIndex;
-
-extern bool discoveryPwrNeeded;
-extern bool discoveryBatNeeded;
-extern bool discoveryStatNeeded;
-
-// ---------------------------------------------------------
-// AppConfig
-// ---------------------------------------------------------
-class AppConfig {
-public:
-    String deviceName = "PylontechMonitor";
-    String hostname   = "";
-    String wifiSSID   = "";
-    String wifiPass   = "";
-    String apSSID     = "";
-    String apPass     = "";
-    bool setupDone    = false;
-
-    bool useStaticIP = false;
-    String ipAddr     = "";
-    String subnetMask = "";
-    String gateway    = "";
-    String dns        = "";
-
-    String ntpServer = "pool.ntp.org";
-    bool manual_mode = false;
-    bool manual_dst = false;
-    bool use_gateway_ntp = true;
-    bool manual_ntp = false;
-    String manual_date = "";
-    String manual_time = "";
-
-    String timezone = "Europe/Berlin";
-    bool daylightSaving = true;
-    uint32_t ntpResyncInterval = 86400;
-
-    MqttConfig mqtt;
-    BatteryConfig battery;
-
-    String firmwareVersion = "1.0.0";
-    String currentTime     = "";
-    String lastPwrUpdate   = "";
-    uint16_t detectedModules = 0;
-
-    String lastMqttContact = "";
-
-    void load();
-    void save();
-
-    void loadSystemConfig();
-    void saveSystemConfig();
-
-    void loadPwrConfig();
-    void savePwrConfig();
-    void loadPwrFields();
-    void savePwrFields();
-
-    void loadBatConfig();
-    void saveBatConfig();
-    void loadBatFields();
-    void saveBatFields();
-
-    void loadStatConfig();
-    void saveStatConfig();
-    void loadStatFields();
-    void saveStatFields();
-
-    void clearNVS();
-    void factoryDefaults();
-    void factoryReset();
-
-    String uptimeString();
-    String getCurrentTimeString();
-    bool isSystemTimeValid();
-
-    bool logInfo  = true;
-    bool logWarn  = true;
-    bool logError = true;
-    bool logDebug = false;
-
-private:
-    String generateHostname();
-    void saveJsonChunked(const char* ns, const char* prefix, const String& json);
-    String loadJsonChunked(const char* ns, const char* prefix);
-};
-
-extern AppConfig config;
\ No newline at end of file
+#pragma once
+#include <Arduino.h>
+#include <Preferences.h>
+#include <functional>
+#include <map>
+#include <vector>
+#include "py_snapshot.h"
+#include "py_data.h"
+#include "py_timezones.h"
+
+
+// ---------------------------------------------------------
+// FieldConfig
+// ---------------------------------------------------------
+
+struct FieldConfig {
+    String label;      // UI label
+    String display;    // NEW: MQTT display name (CamelCase)
+    String factor;
+    String unit;
+    bool mqtt;
+    bool send;
+
+    // Change detection (MQTT): publish only if the value moved by more
+    // than deadband (output units, after factor) or maxSilence seconds
+    // passed. maxSilence = 0 → publish every cycle (old behaviour).
+    float    deadband   = 0;
+    uint32_t maxSilence = 0;
+};
+
+// ---------------------------------------------------------
+// Battery configuration
+// ---------------------------------------------------------
+struct BatteryConfig {
+    unsigned long intervalPwr  = 60000;
+    unsigned long intervalBat  = 300000;
+    unsigned long intervalStat = 1800000;
+
+    bool enableBat  = false;
+    bool enableStat = false;
+
+    bool useFahrenheit = false;
+
+    uint8_t maxModules = 16;
+
+    std::map<String, FieldConfig> fieldsPwr;
+    std::map<String, FieldConfig> fieldsBat;
+    std::map<String, FieldConfig> fieldsStat;
+
+    // bumped by load()/save()/factoryDefaults() → MQTT publish plan recompiles
+    uint32_t fieldsRevision = 0;
+};
+
+// ---------------------------------------------------------
+// MQTT configuration
+// ---------------------------------------------------------
+struct MqttConfig {
+    bool enabled = false;
+
+    String server = "";
+    uint16_t port = 1883;
+    String user = "";
+    String pass = "";
+
+    String prefix     = "Pylontech";
+    String topicStack = "Stack";
+    String topicPwr   = "pwr";
+    String topicBat   = "bat";
+    String topicStat  = "stat";
+    String cellPrefix = "Cell";   // NEW: configurable cell prefix
+    String batMode    = "cells";  // BAT payload: "cells" | "bulk" | "both"
+    String discovery  = "entity"; // HA discovery: "entity" | "device"
+
+    String mode = "active";
+};
+
+// ---------------------------------------------------------
+// Published parser results (seqlock snapshots, see py_snapshot.h)
+// ---------------------------------------------------------
+// Data structures live in py_data.h. Written only by the parser task
+// after a successful parse, read by MQTT, web APIs and scheduler via
+// read()/peek(). generation() changes with every new result.
+// BAT / STAT come one module at a time → rings of the last results,
+// consumers walk them with a cursor (py_snapshot.h).
+#define MODULE_SNAPSHOT_RING  6     // ≈ 11 KB BAT + 14 KB STAT
+
+extern Snapshot<PwrBuffer>                           pwrSnapshot;
+extern SnapshotRing<BatBuffer, MODULE_SNAPSHOT_RING>  batSnapshot;
+extern SnapshotRing<StatBuffer, MODULE_SNAPSHOT_RING> statSnapshot;
+
+// ---------------------------------------------------------
+// Discovery Flags (Web-UI → MQTT)
+// ---------------------------------------------------------
+extern bool discoveryPwrNeeded;
+extern bool discoveryBatNeeded;
+extern bool discoveryStatNeeded;
+
+// ---------------------------------------------------------
+// AppConfig
+// ---------------------------------------------------------
+class AppConfig {
+public:
+    String deviceName = "PylontechMonitor";
+    String hostname   = "";
+    String wifiSSID   = "";
+    String wifiPass   = "";
+    String apSSID     = "";
+    String apPass     = "";
+    bool setupDone    = false;
+
+    bool useStaticIP = false;
+    String ipAddr     = "";
+    String subnetMask = "";
+    String gateway    = "";
+    String dns        = "";
+
+    String ntpServer = "pool.ntp.org";
+    bool manual_mode = false;
+    bool manual_dst = false;
+    bool use_gateway_ntp = true;
+    bool manual_ntp = false;
+    String manual_date = "";
+    String manual_time = "";
+
+    String timezone = "Europe/Berlin";
+    bool daylightSaving = true;
+    uint32_t ntpResyncInterval = 86400;
+
+    MqttConfig mqtt;
+    BatteryConfig battery;
+
+    String firmwareVersion = "1.0.0";
+    String currentTime     = "";
+    // last PWR result as of the last save() (NVS, shown until the first
+    // frame after boot) - live values come from pwrSnapshot
+    String lastPwrUpdate   = "";
+    uint16_t detectedModules = 0;
+
+    String lastMqttContact = "";
+
+    // bumped by load()/save()/factoryDefaults() → ETag of the data APIs
+    uint32_t revision = 0;
+
+    void load();
+    void save();
+
+    void loadSystemConfig();
+    void saveSystemConfig();
+
+    void loadPwrConfig();
+    void savePwrConfig();
+    void loadPwrFields();
+    void savePwrFields();
+
+    void loadBatConfig();
+    void saveBatConfig();
+    void loadBatFields();
+    void saveBatFields();
+
+    void loadStatConfig();
+    void saveStatConfig();
+    void loadStatFields();
+    void saveStatFields();
+
+    void clearNVS();
+    void factoryDefaults();
+    void factoryReset();
+
+    String uptimeString();
+    String getCurrentTimeString();
+    static String formatTime(uint32_t epoch);
+    bool isSystemTimeValid();
+
+    bool logInfo  = true;
+    bool logWarn  = true;
+    bool logError = true;
+    bool logDebug = false;
+
+private:
+    String generateHostname();
+    void saveJsonChunked(const char* ns, const char* prefix, const String& json);
+    String loadJsonChunked(const char* ns, const char* prefix);
+};
+
+extern AppConfig config;
+
+// ---------------------------------------------------------
+// Config lock (noncritical task <-> web task)
+// ---------------------------------------------------------
+// config belongs to the noncritical task: MQTT, WiFi and scheduler
+// read it there without a lock. Where that task writes a String / map
+// other tasks read, it takes the lock for the assignment.
+// Other tasks copy what they need under the lock and stream the copy;
+// they never write config but post a ConfigChange (below). Single
+// words (bool, intervals, revision) are read without the lock.
+// Held only for copies and assignments - never across socket I/O,
+// NVS or a module loop.
+// Recursive, scope based:   { ConfigLock lock; ... }
+struct ConfigLock {
+    ConfigLock();
+    ~ConfigLock();
+    ConfigLock(const ConfigLock&) = delete;
+    ConfigLock& operator=(const ConfigLock&) = delete;
+};
+
+// ---------------------------------------------------------
+// Config changes (web task → noncritical task)
+// ---------------------------------------------------------
+// post() queues a change and returns its number (0 = queue full).
+// The noncritical task runs it between its module loops without the
+// lock held: the change takes ConfigLock around its assignments,
+// then saves and restarts modules (py_mqtt.begin(), WiFi) itself.
+#define CONFIG_CHANGES_MAX  4
+
+typedef std::function<void()> ConfigChange;
+
+uint32_t ConfigChange_post(ConfigChange fn);
+bool     ConfigChange_applied(uint32_t n);
+void     ConfigChange_run();           // noncritical task
@@ -1,19 +1,98 @@
-function loadDashboard() {
-    fetch("/api/dashboard")
-        .then(r => r.json())
-        .then(d => {
-            wifi_mode.textContent = d.wifi.mode;
-            wifi_ssid.textContent = d.wifi.ssid;
-            wifi_ip.textContent = d.wifi.ip;
-            wifi_rssi.textContent = d.wifi.rssi;
-            mqtt_status.textContent = d.mqtt.connected ? "Connected" : "Disconnected";
-            mqtt_server.textContent = d.mqtt.server + ":" + d.mqtt.port;
-            mqtt_last.textContent = d.mqtt.last_contact;
-            bat_modules.textContent = d.battery.modules;
-            bat_last.textContent = d.battery.last_update;
-            sys_time.textContent = d.system.time;
-            sys_uptime.textContent = d.system.uptime;
-            sys_fw.textContent = d.system.version;
-        });
-}
-loadDashboard();
\ No newline at end of file
+function loadDashboard() {
+    fetch("/api/dashboard")
+        .then(r => r.json())
+        .then(d => {
+            wifi_mode.textContent = d.wifi.mode;
+            wifi_ssid.textContent = d.wifi.ssid;
+            wifi_ip.textContent = d.wifi.ip;
+            wifi_rssi.textContent = d.wifi.rssi;
+            mqtt_status.textContent = d.mqtt.connected ? "Connected" : "Disconnected";
+            mqtt_server.textContent = d.mqtt.server + ":" + d.mqtt.port;
+            mqtt_last.textContent = d.mqtt.last_contact;
+            bat_modules.textContent = d.battery.modules;
+            bat_last.textContent = d.battery.last_update;
+            sys_time.textContent = d.system.time;
+            sys_uptime.textContent = d.system.uptime;
+            sys_fw.textContent = d.system.version;
+        });
+}
+loadDashboard();
+
+// ---------------------------------------------------------
+// History chart: stack, 15 min min/avg/max, last 24 h
+// ---------------------------------------------------------
+let historyData = null;
+
+function loadHistory() {
+    fetch("/api/history?series=stack&res=15m&range=86400")
+        .then(r => r.ok ? r.json() : null)
+        .then(d => {
+            historyData = d;
+            drawHistory();
+        });
+}
+
+function drawHistory() {
+    const canvas = hist_canvas;
+    const ctx = canvas.getContext("2d");
+    ctx.clearRect(0, 0, canvas.width, canvas.height);
+
+    if (!historyData || historyData.points.length === 0) {
+        hist_info.textContent = "no data yet";
+        return;
+    }
+
+    const metric = hist_metric.value;
+    const cols = historyData.columns;
+    const iMin = cols.indexOf(metric + "_min");
+    const iAvg = cols.indexOf(metric + "_avg");
+    const iMax = cols.indexOf(metric + "_max");
+    const pts = historyData.points;
+
+    const t0 = historyData.uptime - 86400;
+    const pad = 30;
+    const w = canvas.width - 2 * pad;
+    const h = canvas.height - 2 * pad;
+
+    let lo = Math.min(...pts.map(p => p[iMin]));
+    let hi = Math.max(...pts.map(p => p[iMax]));
+    if (hi === lo) { hi += 1; lo -= 1; }
+
+    const x = t => pad + (t - t0) / 86400 * w;
+    const y = v => pad + h - (v - lo) / (hi - lo) * h;
+
+    // min / max band
+    ctx.fillStyle = "rgba(0, 120, 215, 0.15)";
+    ctx.beginPath();
+    pts.forEach((p, i) => i ? ctx.lineTo(x(p[0]), y(p[iMax])) : ctx.moveTo(x(p[0]), y(p[iMax])));
+    for (let i = pts.length - 1; i >= 0; i--) ctx.lineTo(x(pts[i][0]), y(pts[i][iMin]));
+    ctx.fill();
+
+    // average
+    ctx.strokeStyle = "rgb(0, 120, 215)";
+    ctx.lineWidth = 2;
+    ctx.beginPath();
+    pts.forEach((p, i) => i ? ctx.lineTo(x(p[0]), y(p[iAvg])) : ctx.moveTo(x(p[0]), y(p[iAvg])));
+    ctx.stroke();
+
+    // scale
+    ctx.fillStyle = "#333";
+    ctx.font = "12px sans-serif";
+    ctx.fillText(hi, 2, pad);
+    ctx.fillText(lo, 2, pad + h);
+    ctx.fillText("-24 h", pad, canvas.height - 8);
+    ctx.fillText("now", canvas.width - pad - 20, canvas.height - 8);
+
+    hist_info.textContent = pts.length + " points";
+}
+
+hist_metric.addEventListener("change", drawHistory);
+loadHistory();
+
+// Live: Modulanzahl + Zeitpunkt des letzten PWR-Frames (/api/stream,
+// Gerätezeit wie /api/dashboard; ohne gestellte Uhr bleibt der alte Wert)
+window.onLive = (type, s) => {
+    if (type !== "pwr") return;
+    bat_modules.textContent = s.modules;
+    if (s.updated) bat_last.textContent = s.updated;
+};
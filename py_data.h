@@ -0,0 +1,155 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ---------------------------------------------------------
+// Parser data model (PWR / BAT / STAT)
+// ---------------------------------------------------------
+// Plain fixed-size structs without Arduino or FreeRTOS types, so the
+// parsers (py_parser_*.cpp) only need this header, py_frame.h and
+// Log(). Published through the seqlock snapshots in config.h.
+// ---------------------------------------------------------
+
+#define MAX_MODULES 16
+
+#define PWR_MAX_COLS   24
+#define PWR_NAME_LEN   12
+#define PWR_TEXT_LEN   192   // all column values of one "pwr" line
+
+// "pwr" header line (shared by all modules of a frame)
+struct PwrHeader {
+    uint16_t revision = 0;     // bumped whenever the column names change
+    uint8_t  count = 0;
+    char     names[PWR_MAX_COLS][PWR_NAME_LEN];
+
+    int find(const char* name) const {
+        for (uint8_t i = 0; i < count; i++)
+            if (strcmp(names[i], name) == 0) return i;
+        return -1;
+    }
+};
+
+struct BatteryModule {
+    bool present = false;
+    int index = 0;
+    int voltage_mV = 0;
+    int current_mA = 0;
+    int temperature = 0;
+    int soc = 0;
+
+    // raw column values, NUL separated in text[], by header column
+    uint8_t fieldCount = 0;
+    uint8_t fieldOff[PWR_MAX_COLS];
+    char    text[PWR_TEXT_LEN];
+
+    const char* field(int col) const {
+        return (col >= 0 && col < fieldCount) ? text + fieldOff[col] : "";
+    }
+};
+
+struct BatteryStack {
+    int batteryCount = 0;
+    int avgVoltage_mV = 0;
+    int totalCurrent_mA = 0;
+    int temperature = 0;
+    int soc = 0;
+
+    void reset() {
+        batteryCount = 0;
+        avgVoltage_mV = 0;
+        totalCurrent_mA = 0;
+        temperature = 0;
+        soc = 0;
+    }
+};
+
+// ---------------------------------------------------------
+// BAT cell data (typed, fixed layout)
+// ---------------------------------------------------------
+// One shared column schema (taken from the "bat" header line) and
+// per module a struct-of-arrays block of integers [column][cell].
+// Numeric columns keep their suffix ("%", " mAH") and decimals in the
+// schema, text columns (Base State, BAL, ...) are stored as index into
+// a small interned enum dictionary. Raw text can be rebuilt exactly.
+#define BAT_MAX_COLS     16
+#define BAT_MAX_CELLS    16
+#define BAT_NAME_LEN     16
+#define BAT_SUFFIX_LEN   8
+#define BAT_ENUM_MAX     32
+#define BAT_ENUM_LEN     12
+
+#define BAT_VALUE_NONE   INT32_MIN   // cell has no (parsable) value
+
+enum BatColumnKind : uint8_t {
+    BAT_COL_NUM,
+    BAT_COL_ENUM
+};
+
+struct BatColumn {
+    char    name[BAT_NAME_LEN];
+    char    suffix[BAT_SUFFIX_LEN];
+    uint8_t kind;
+    uint8_t decimals;              // NUM: value = raw * 10^decimals
+};
+
+struct BatSchema {
+    uint16_t  revision = 0;        // bumped whenever header, column types or enums change
+    uint8_t   colCount = 0;
+    BatColumn cols[BAT_MAX_COLS];
+
+    uint8_t   enumCount = 0;
+    char      enums[BAT_ENUM_MAX][BAT_ENUM_LEN];
+};
+
+struct BatData {
+    int     moduleIndex = 0;       // module number (1..N)
+    uint8_t cellCount = 0;
+    int32_t values[BAT_MAX_COLS][BAT_MAX_CELLS];
+};
+
+#define STAT_MAX_FIELDS  48
+#define STAT_NAME_LEN    24
+#define STAT_VALUE_LEN   24
+
+struct StatField {
+    char name[STAT_NAME_LEN];
+    char raw[STAT_VALUE_LEN];
+};
+
+struct StatData {
+    int moduleIndex = -1;
+    uint8_t fieldCount = 0;
+    StatField fields[STAT_MAX_FIELDS];
+};
+
+// ---------------------------------------------------------
+// Parser results (one complete frame each)
+// ---------------------------------------------------------
+struct PwrBuffer {
+    BatteryStack  stack;
+    PwrHeader     header;
+    uint8_t       moduleCount = 0;
+    BatteryModule modules[MAX_MODULES];
+    uint32_t      updatedAt = 0;     // device time (epoch s) of the frame, 0 = clock not set
+};
+
+struct BatBuffer {
+    BatSchema schema;      // columns of the frame the cells belong to
+    BatData   cells;
+};
+
+struct StatBuffer {
+    StatData stat;
+};
+
+enum ParseResult {
+    PARSE_OK,
+    PARSE_FAIL,
+    PARSE_IGNORED
+};
+
+enum FrameType {
+    FRAME_PWR,
+    FRAME_BAT,
+    FRAME_STAT
+};
@@ -0,0 +1,133 @@
+#include "py_format.h"
+
+#define FIXED_MAX_SCALE  17       // 5 × 10^17 still fits into int64
+
+static const int64_t POW10_64[19] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+    100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+    1000000000000LL, 10000000000000LL, 100000000000000LL,
+    1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+    1000000000000000000LL
+};
+
+// a × b without int64 overflow
+static bool mulOk(int64_t a, int64_t b, int64_t& r) {
+    if (a == 0 || b == 0) { r = 0; return true; }
+    int64_t ua = a < 0 ? -a : a;
+    int64_t ub = b < 0 ? -b : b;
+    if (ua > INT64_MAX / ub) return false;
+    r = a * b;
+    return true;
+}
+
+// ---------------------------------------------------------
+bool fixedParseFactor(const char* s, int32_t& mul, uint8_t& exp) {
+    int64_t m = 0;
+    uint8_t e = 0;
+    bool neg = false, dot = false, digits = false;
+
+    if (*s == '-' || *s == '+') neg = (*s++ == '-');
+
+    for (; *s; s++) {
+        if (*s == '.' && !dot) { dot = true; continue; }
+        if (*s < '0' || *s > '9') return false;
+        m = m * 10 + (*s - '0');
+        if (dot) e++;
+        digits = true;
+        if (m > INT32_MAX || e > 9) return false;
+    }
+    if (!digits) return false;
+
+    while (e > 0 && m % 10 == 0) { m /= 10; e--; }   // "0.10" → 1 / 10^1
+
+    mul = neg ? -(int32_t)m : (int32_t)m;
+    exp = e;
+    return true;
+}
+
+// ---------------------------------------------------------
+bool fixedParseText(const char* s, int64_t& raw, uint8_t& rawScale) {
+    int64_t v = 0;
+    uint8_t scale = 0, digits = 0;
+    bool neg = false, dot = false;
+
+    while (*s == ' ' || *s == '\t') s++;
+    if (*s == '-' || *s == '+') neg = (*s++ == '-');
+
+    for (; *s; s++) {
+        if (*s == '.' && !dot) { dot = true; continue; }
+        if (*s < '0' || *s > '9') break;
+        if (digits == 0 && *s == '0' && !dot) continue;   // leading zeros
+        if (++digits > 18) return false;
+        v = v * 10 + (*s - '0');
+        if (dot) scale++;
+    }
+
+    // "1e3" → float path
+    if ((*s == 'e' || *s == 'E') && s[1] >= '0' && s[1] <= '9') return false;
+
+    raw = neg ? -v : v;
+    rawScale = scale;
+    return true;
+}
+
+// ---------------------------------------------------------
+size_t fixedFormat(char* out, size_t cap, int64_t raw, uint8_t rawScale,
+                   const FixedFormat& f)
+{
+    if (!f.exact || cap == 0 || f.decimals > 9) return 0;
+
+    // value = num / (den × 10^scale)
+    int64_t num;
+    int64_t den = 1;
+    uint8_t scale = rawScale + f.exp;
+
+    if (scale > FIXED_MAX_SCALE) return 0;
+    if (!mulOk(raw, f.mul, num)) return 0;
+
+    if (f.fahrenheit) {
+        // °F = °C × 9/5 + 32 = (num × 9 + 160 × 10^scale) / (5 × 10^scale)
+        int64_t offset;
+        if (!mulOk(num, 9, num)) return 0;
+        if (!mulOk(160, POW10_64[scale], offset)) return 0;
+        if ((offset > 0 && num > INT64_MAX - offset)) return 0;
+        num += offset;
+        den = 5;
+    }
+
+    // q = round(value × 10^decimals), half away from zero
+    bool neg = num < 0;
+    int64_t a = neg ? -num : num;
+    int64_t q;
+
+    if (f.decimals >= scale) {
+        if (!mulOk(a, POW10_64[f.decimals - scale], a)) return 0;
+        q = (a + den / 2) / den;
+    } else {
+        int64_t div = den * POW10_64[scale - f.decimals];
+        q = a / div;
+        if (a % div >= (div + 1) / 2) q++;
+    }
+
+    // digits, right to left
+    char tmp[24];
+    size_t n = 0;
+    uint8_t d = 0;
+
+    do {
+        if (d == f.decimals && f.decimals > 0) tmp[n++] = '.';
+        tmp[n++] = (char)('0' + q % 10);
+        q /= 10;
+        d++;
+    } while (q > 0 || d <= f.decimals);
+
+    bool anyNonZero = false;
+    for (size_t i = 0; i < n; i++)
+        if (tmp[i] > '0' && tmp[i] <= '9') anyNonZero = true;
+    if (neg && anyNonZero) tmp[n++] = '-';     // no "-0.0"
+
+    if (n + 1 > cap) return 0;
+    for (size_t i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+    out[n] = '\0';
+    return n;
+}
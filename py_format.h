@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------
+// Fixed-point value formatting
+// ---------------------------------------------------------
+// Console readings are integers (mV, mA, m°C) or short decimal
+// texts. With a decimal factor ("0.001", "0.1", "10") the scaled
+// value is exact in integer arithmetic, so no float, no
+// String(float, n) and no artefacts like 3.2989999.
+//
+//   value = raw / 10^rawScale × mul / 10^exp     (°F: × 9/5 + 32)
+//
+// rounded half away from zero to `decimals` digits. Plain C, no
+// Arduino types (builds off-device like the parsers).
+// ---------------------------------------------------------
+
+struct FixedFormat {
+    int32_t mul;         // factor = mul / 10^exp
+    uint8_t exp;
+    uint8_t decimals;    // output decimals
+    bool    fahrenheit;  // value is °C → print °F
+    bool    exact;       // factor is a plain decimal (else: float path)
+};
+
+// "0.001" → 1 / 10^3. false for text/date/exponent factors.
+bool fixedParseFactor(const char* s, int32_t& mul, uint8_t& exp);
+
+// Numeric prefix of a text, atof() semantics ("3299", "-12.5", "75%").
+// false if the text needs float (exponent, more than 18 digits).
+bool fixedParseText(const char* s, int64_t& raw, uint8_t& rawScale);
+
+// Writes the NUL-terminated value, returns its length.
+// 0 on overflow or if out is too small → caller falls back to float.
+size_t fixedFormat(char* out, size_t cap, int64_t raw, uint8_t rawScale,
+                   const FixedFormat& f);
@@ -0,0 +1,158 @@
+#include "py_frame.h"
+#include <string.h>
+
+static inline bool isWS(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// ---------------------------------------------------------
+// View helpers
+// ---------------------------------------------------------
+FrameView viewTrim(FrameView v) {
+    while (v.len > 0 && isWS(v.data[0])) { v.data++; v.len--; }
+    while (v.len > 0 && isWS(v.data[v.len - 1])) v.len--;
+    return v;
+}
+
+bool viewEquals(FrameView v, const char* s) {
+    size_t n = strlen(s);
+    return v.len == n && memcmp(v.data, s, n) == 0;
+}
+
+bool viewStartsWith(FrameView v, const char* s) {
+    size_t n = strlen(s);
+    return v.len >= n && memcmp(v.data, s, n) == 0;
+}
+
+int viewFind(FrameView v, const char* needle, size_t from) {
+    size_t n = strlen(needle);
+    if (n == 0 || v.len < n) return -1;
+
+    for (size_t i = from; i + n <= v.len; i++) {
+        if (v.data[i] == needle[0] && memcmp(v.data + i, needle, n) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+int viewFindChar(FrameView v, char c, size_t from) {
+    for (size_t i = from; i < v.len; i++)
+        if (v.data[i] == c) return (int)i;
+    return -1;
+}
+
+int viewFindLastChar(FrameView v, char c) {
+    for (size_t i = v.len; i > 0; i--)
+        if (v.data[i - 1] == c) return (int)(i - 1);
+    return -1;
+}
+
+FrameView viewSub(FrameView v, size_t from, size_t to) {
+    if (to > v.len) to = v.len;
+    if (from > to) from = to;
+    return FrameView(v.data + from, to - from);
+}
+
+long viewToInt(FrameView v) {
+    size_t i = 0;
+    while (i < v.len && isWS(v.data[i])) i++;
+
+    bool neg = false;
+    if (i < v.len && (v.data[i] == '-' || v.data[i] == '+')) {
+        neg = (v.data[i] == '-');
+        i++;
+    }
+
+    long r = 0;
+    while (i < v.len && v.data[i] >= '0' && v.data[i] <= '9') {
+        r = r * 10 + (v.data[i] - '0');
+        i++;
+    }
+    return neg ? -r : r;
+}
+
+size_t viewCopy(FrameView v, char* dst, size_t cap) {
+    if (cap == 0) return 0;
+    size_t n = v.len < cap - 1 ? v.len : cap - 1;
+    memcpy(dst, v.data, n);
+    dst[n] = '\0';
+    return n;
+}
+
+// ---------------------------------------------------------
+// Frame tokenizer
+// ---------------------------------------------------------
+bool frameBody(FrameView raw, FrameView& body) {
+    int start = viewFindChar(raw, '@');
+    int end   = viewFind(raw, "$$");
+
+    if (start < 0 || end < 0 || end <= start)
+        return false;
+
+    body = viewSub(raw, start + 1, end);
+    return true;
+}
+
+bool frameNextLine(FrameView& rest, FrameView& line) {
+    while (rest.len > 0) {
+        size_t i = 0;
+        while (i < rest.len && rest.data[i] != '\n' && rest.data[i] != '\r') i++;
+
+        FrameView l = viewTrim(FrameView(rest.data, i));
+
+        // skip the line end (\r, \n or \r\n)
+        if (i < rest.len && rest.data[i] == '\r') i++;
+        if (i < rest.len && rest.data[i] == '\n') i++;
+        rest.data += i;
+        rest.len  -= i;
+
+        if (l.len > 0) {
+            line = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t frameSplitWS(FrameView line, FrameView* out, size_t max) {
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < line.len && n < max) {
+        while (i < line.len && isWS(line.data[i])) i++;
+        if (i >= line.len) break;
+
+        size_t start = i;
+        while (i < line.len && !isWS(line.data[i])) i++;
+
+        out[n++] = FrameView(line.data + start, i - start);
+    }
+    return n;
+}
+
+size_t frameSplitColumns(FrameView line, FrameView* out, size_t max) {
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < line.len && n < max) {
+        while (i < line.len && line.data[i] == ' ') i++;
+        if (i >= line.len) break;
+
+        size_t start = i;
+        int spaceCount = 0;
+
+        while (i < line.len) {
+            if (line.data[i] == ' ') {
+                spaceCount++;
+                if (spaceCount >= 2) break;
+            } else {
+                spaceCount = 0;
+            }
+            i++;
+        }
+
+        FrameView col = viewTrim(FrameView(line.data + start, i - start));
+        if (col.len > 0) out[n++] = col;
+    }
+    return n;
+}
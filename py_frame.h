@@ -0,0 +1,53 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------
+// Zero-copy frame views
+// ---------------------------------------------------------
+// The UART writes every console response exactly once into a slot
+// of the frame store (py_frame_store.h). Parsers and the web console
+// only get read-only (const char*, len) views into that slot - no
+// String copies, no std::vector<String> line/column splitting.
+//
+// Plain C++ without Arduino / FreeRTOS types: the parsers need only
+// this file (host build in test/).
+// ---------------------------------------------------------
+
+#define FRAME_MAX_COLS   32    // max. tokens per line a parser looks at
+
+struct FrameView {
+    const char* data = nullptr;
+    size_t len = 0;
+
+    FrameView() {}
+    FrameView(const char* d, size_t l) : data(d), len(l) {}
+
+    bool empty() const { return len == 0; }
+    char operator[](size_t i) const { return data[i]; }
+};
+
+// ---------------------------------------------------------
+// View helpers (no allocation)
+// ---------------------------------------------------------
+FrameView viewTrim(FrameView v);
+bool viewEquals(FrameView v, const char* s);
+bool viewStartsWith(FrameView v, const char* s);
+int  viewFind(FrameView v, const char* needle, size_t from = 0);
+int  viewFindChar(FrameView v, char c, size_t from = 0);
+int  viewFindLastChar(FrameView v, char c);
+FrameView viewSub(FrameView v, size_t from, size_t to);
+long viewToInt(FrameView v);                                   // atol() semantics
+size_t viewCopy(FrameView v, char* dst, size_t cap);           // NUL-terminated
+
+// "@ ... $$" section of a console response
+bool frameBody(FrameView raw, FrameView& body);
+
+// next non-empty, trimmed line (\r, \n and \r\n are all line ends)
+bool frameNextLine(FrameView& rest, FrameView& line);
+
+// tokens separated by any whitespace
+size_t frameSplitWS(FrameView line, FrameView* out, size_t max);
+
+// columns separated by 2+ spaces (single spaces stay inside a column)
+size_t frameSplitColumns(FrameView line, FrameView* out, size_t max);
@@ -0,0 +1,89 @@
+#include "py_frame_store.h"
+#include <freertos/FreeRTOS.h>
+
+FrameStore frameStore;
+
+// RX callback (UART event task), realtime task and web handlers all touch
+// the reference counts → short critical sections, no blocking
+static portMUX_TYPE g_frameMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ---------------------------------------------------------
+// FrameStore
+// ---------------------------------------------------------
+int FrameStore::acquire() {
+    int slot = -1;
+
+    portENTER_CRITICAL(&g_frameMux);
+    for (int i = 0; i < FRAME_SLOTS; i++) {
+        if (refs[i] == 0) {
+            refs[i] = 1;
+            lens[i] = 0;
+            slots[i][0] = '\0';
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&g_frameMux);
+
+    return slot;
+}
+
+void FrameStore::retain(int slot) {
+    if (slot < 0 || slot >= FRAME_SLOTS) return;
+    portENTER_CRITICAL(&g_frameMux);
+    refs[slot]++;
+    portEXIT_CRITICAL(&g_frameMux);
+}
+
+void FrameStore::release(int slot) {
+    if (slot < 0 || slot >= FRAME_SLOTS) return;
+    portENTER_CRITICAL(&g_frameMux);
+    if (refs[slot] > 0) refs[slot]--;
+    portEXIT_CRITICAL(&g_frameMux);
+}
+
+void FrameStore::setLength(int slot, size_t len) {
+    if (slot < 0 || slot >= FRAME_SLOTS) return;
+    if (len >= FRAME_SLOT_SIZE) len = FRAME_SLOT_SIZE - 1;
+    lens[slot] = len;
+    slots[slot][len] = '\0';
+}
+
+FrameView FrameStore::view(int slot) const {
+    if (slot < 0 || slot >= FRAME_SLOTS) return FrameView();
+    return FrameView(slots[slot], lens[slot]);
+}
+
+void FrameStore::publishLast(int slot) {
+    int old;
+
+    portENTER_CRITICAL(&g_frameMux);
+    old = last;
+    last = slot;
+    lastSeq++;
+    if (slot >= 0) refs[slot]++;
+    if (old >= 0 && refs[old] > 0) refs[old]--;
+    portEXIT_CRITICAL(&g_frameMux);
+}
+
+int FrameStore::acquireLast(uint32_t* seq) {
+    int slot;
+
+    portENTER_CRITICAL(&g_frameMux);
+    slot = last;
+    if (slot >= 0) refs[slot]++;
+    if (seq) *seq = lastSeq;
+    portEXIT_CRITICAL(&g_frameMux);
+
+    return slot;
+}
+
+uint32_t FrameStore::lastSequence() const {
+    uint32_t seq;
+
+    portENTER_CRITICAL(&g_frameMux);
+    seq = lastSeq;
+    portEXIT_CRITICAL(&g_frameMux);
+
+    return seq;
+}
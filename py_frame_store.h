@@ -0,0 +1,48 @@
+#pragma once
+#include "py_frame.h"
+
+// ---------------------------------------------------------
+// Frame store (fixed arena of reference counted slots)
+// ---------------------------------------------------------
+// Slots are reference counted: the RX path owns one reference while
+// receiving, the "last raw frame" (console) holds one, and every
+// reader that wants to keep a view across calls retains its own.
+//
+// Worst case, all in different slots at the same time:
+//   RX (1) + parser task (1) + frameQueue (FRAME_QUEUE_LEN = 2)
+//   + last frame (1) + web console still reading an older last (1)
+// ---------------------------------------------------------
+
+#define FRAME_SLOTS      6
+#define FRAME_SLOT_SIZE  7000
+
+class FrameStore {
+public:
+    // Free slot for the RX path (refs = 1), -1 if all slots are in use
+    int acquire();
+
+    void retain(int slot);
+    void release(int slot);
+
+    char*  data(int slot) { return slots[slot]; }
+    size_t capacity() const { return FRAME_SLOT_SIZE; }
+
+    void setLength(int slot, size_t len);
+    FrameView view(int slot) const;
+
+    // Last response to a console command (web console). Every publish
+    // gets a new sequence number, so a reader can wait for a frame
+    // newer than the one it saw when the command was queued.
+    void     publishLast(int slot);
+    int      acquireLast(uint32_t* seq = nullptr);   // retained, -1 if none → release() when done
+    uint32_t lastSequence() const;                   // 0 = nothing published yet
+
+private:
+    char     slots[FRAME_SLOTS][FRAME_SLOT_SIZE];
+    uint16_t lens[FRAME_SLOTS] = {0};
+    uint8_t  refs[FRAME_SLOTS] = {0};
+    int      last = -1;
+    uint32_t lastSeq = 0;
+};
+
+extern FrameStore frameStore;
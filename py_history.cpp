@@ -0,0 +1,218 @@
+#include "py_history.h"
+#include "py_log.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+PyHistory history;
+
+// Parser task writes, web handlers read → short critical sections
+// (a few points are copied per lock, never while sending)
+static portMUX_TYPE g_histMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const uint16_t TIER_POINTS[HIST_TIERS] = {
+    HIST_RAW_POINTS, HIST_1M_POINTS, HIST_15M_POINTS, HIST_1H_POINTS
+};
+static const uint32_t TIER_STEP[HIST_TIERS] = { 0, 60, 900, 3600 };
+static const char*    TIER_NAME[HIST_TIERS] = { "raw", "1m", "15m", "1h" };
+
+// ---------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------
+uint32_t PyHistory::now() {
+    return (uint32_t)(esp_timer_get_time() / 1000000ULL);
+}
+
+uint32_t PyHistory::step(uint8_t tier) {
+    return tier < HIST_TIERS ? TIER_STEP[tier] : 0;
+}
+
+const char* PyHistory::tierName(uint8_t tier) {
+    return tier < HIST_TIERS ? TIER_NAME[tier] : "";
+}
+
+int PyHistory::tierByName(const String& name) {
+    for (uint8_t i = 0; i < HIST_TIERS; i++)
+        if (name == TIER_NAME[i]) return i;
+    return -1;
+}
+
+// raw / scale, rounded half away from zero, clamped to int16
+static int16_t histScale(long raw, long scale) {
+    long v = raw >= 0 ? (raw + scale / 2) / scale : -((-raw + scale / 2) / scale);
+    if (v > INT16_MAX) v = INT16_MAX;
+    if (v < INT16_MIN) v = INT16_MIN;
+    return (int16_t)v;
+}
+
+// ---------------------------------------------------------
+// Allocation (PSRAM first, internal heap with reserve)
+// ---------------------------------------------------------
+PyHistory::Series* PyHistory::allocSeries() {
+    size_t points = 0;
+    for (uint8_t i = 0; i < HIST_TIERS; i++) points += TIER_POINTS[i];
+
+    size_t bytes = sizeof(Series) + points * sizeof(HistPoint);
+
+    void* mem = nullptr;
+    if (psramFound())
+        mem = ps_malloc(bytes);
+    if (!mem && ESP.getFreeHeap() > bytes + HIST_HEAP_RESERVE)
+        mem = malloc(bytes);
+    if (!mem) return nullptr;
+
+    memset(mem, 0, bytes);
+
+    Series* s = (Series*)mem;
+    HistPoint* p = (HistPoint*)(s + 1);
+
+    for (uint8_t i = 0; i < HIST_TIERS; i++) {
+        s->tiers[i].pts = p;
+        s->tiers[i].cap = TIER_POINTS[i];
+        p += TIER_POINTS[i];
+    }
+    return s;
+}
+
+bool PyHistory::hasSeries(int idx) const {
+    return idx >= 0 && idx < HIST_SERIES && series[idx] != nullptr;
+}
+
+// ---------------------------------------------------------
+// Rollup (lock held)
+// ---------------------------------------------------------
+void PyHistory::addSample(Series& s, uint32_t t, const int16_t* v) {
+    // raw tier: the sample itself
+    Ring& raw = s.tiers[HIST_RAW];
+    HistPoint& rp = raw.pts[raw.total % raw.cap];
+    rp.t = t;
+    for (uint8_t m = 0; m < HIST_METRICS; m++)
+        rp.min[m] = rp.avg[m] = rp.max[m] = v[m];
+    raw.total++;
+
+    // aggregate tiers: close the bucket when the sample is past it
+    for (uint8_t i = HIST_1M; i < HIST_TIERS; i++) {
+        Acc& a = s.acc[i];
+        uint32_t bucket = t / TIER_STEP[i];
+
+        if (a.count > 0 && bucket != a.bucket) {
+            Ring& r = s.tiers[i];
+            HistPoint& p = r.pts[r.total % r.cap];
+            p.t = a.bucket * TIER_STEP[i];
+            for (uint8_t m = 0; m < HIST_METRICS; m++) {
+                p.min[m] = a.min[m];
+                p.max[m] = a.max[m];
+                p.avg[m] = (int16_t)(a.sum[m] / a.count);
+            }
+            r.total++;
+            a.count = 0;
+        }
+
+        if (a.count == 0) {
+            a.bucket = bucket;
+            for (uint8_t m = 0; m < HIST_METRICS; m++) {
+                a.sum[m] = 0;
+                a.min[m] = a.max[m] = v[m];
+            }
+        }
+
+        a.count++;
+        for (uint8_t m = 0; m < HIST_METRICS; m++) {
+            a.sum[m] += v[m];
+            if (v[m] < a.min[m]) a.min[m] = v[m];
+            if (v[m] > a.max[m]) a.max[m] = v[m];
+        }
+    }
+}
+
+void PyHistory::addPwr(const PwrBuffer& pwr) {
+    uint32_t t = now();
+
+    int16_t values[HIST_SERIES][HIST_METRICS];
+    bool    have[HIST_SERIES] = {false};
+
+    values[0][HIST_VOLT] = histScale(pwr.stack.avgVoltage_mV, HIST_SCALE_VOLT);
+    values[0][HIST_CURR] = histScale(pwr.stack.totalCurrent_mA, HIST_SCALE_CURR);
+    values[0][HIST_TEMP] = histScale(pwr.stack.temperature, HIST_SCALE_TEMP);
+    values[0][HIST_SOC]  = pwr.stack.soc;
+    have[0] = true;
+
+    for (uint8_t i = 0; i < pwr.moduleCount; i++) {
+        const BatteryModule& mod = pwr.modules[i];
+        if (!mod.present || mod.index < 1 || mod.index >= HIST_SERIES) continue;
+
+        values[mod.index][HIST_VOLT] = histScale(mod.voltage_mV, HIST_SCALE_VOLT);
+        values[mod.index][HIST_CURR] = histScale(mod.current_mA, HIST_SCALE_CURR);
+        values[mod.index][HIST_TEMP] = histScale(mod.temperature, HIST_SCALE_TEMP);
+        values[mod.index][HIST_SOC]  = mod.soc;
+        have[mod.index] = true;
+    }
+
+    // new series are allocated outside the critical section
+    for (int i = 0; i < HIST_SERIES; i++) {
+        if (!have[i] || series[i] || allocFailed[i]) continue;
+
+        Series* s = allocSeries();
+        if (!s) {
+            allocFailed[i] = true;
+            LOGW(LOGM_SYS, "History: no memory for series %d", i);
+            continue;
+        }
+
+        portENTER_CRITICAL(&g_histMux);
+        series[i] = s;
+        portEXIT_CRITICAL(&g_histMux);
+    }
+
+    portENTER_CRITICAL(&g_histMux);
+    for (int i = 0; i < HIST_SERIES; i++) {
+        if (have[i] && series[i]) addSample(*series[i], t, values[i]);
+    }
+    portEXIT_CRITICAL(&g_histMux);
+}
+
+// ---------------------------------------------------------
+// Readers (web handlers)
+// ---------------------------------------------------------
+size_t PyHistory::read(int idx, uint8_t tier, uint32_t since, uint32_t& cursor,
+                       HistPoint* out, size_t max) const {
+    if (!hasSeries(idx) || tier >= HIST_TIERS) return 0;
+
+    size_t n = 0;
+
+    portENTER_CRITICAL(&g_histMux);
+    const Ring& r = series[idx]->tiers[tier];
+
+    uint32_t oldest = r.total > r.cap ? r.total - r.cap : 0;
+    if (cursor < oldest) cursor = oldest;
+
+    while (cursor < r.total && n < max) {
+        const HistPoint& p = r.pts[cursor % r.cap];
+        cursor++;
+        if (p.t < since) continue;
+        out[n++] = p;
+    }
+    portEXIT_CRITICAL(&g_histMux);
+
+    return n;
+}
+
+bool PyHistory::openBucket(int idx, uint8_t tier, HistPoint& out) const {
+    if (!hasSeries(idx) || tier == HIST_RAW || tier >= HIST_TIERS) return false;
+
+    bool ok = false;
+
+    portENTER_CRITICAL(&g_histMux);
+    const Acc& a = series[idx]->acc[tier];
+    if (a.count > 0) {
+        out.t = a.bucket * TIER_STEP[tier];
+        for (uint8_t m = 0; m < HIST_METRICS; m++) {
+            out.min[m] = a.min[m];
+            out.max[m] = a.max[m];
+            out.avg[m] = (int16_t)(a.sum[m] / a.count);
+        }
+        ok = true;
+    }
+    portEXIT_CRITICAL(&g_histMux);
+
+    return ok;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <Arduino.h>
+#include "py_data.h"
+
+// ---------------------------------------------------------
+// History (multi-resolution time series in RAM)
+// ---------------------------------------------------------
+// Fed by the parser task on every PWR frame: series 0 is the stack,
+// series N is module N. Each point holds four metrics (voltage,
+// current, temperature, SOC) as scaled int16 (see HIST_SCALE_*).
+//
+// Tiers (fixed rings, the oldest point is overwritten):
+//   raw   one point per PWR frame     HIST_RAW_POINTS
+//   1m    min / avg / max per minute  HIST_1M_POINTS   (2 h)
+//   15m   ... per 15 minutes          HIST_15M_POINTS  (24 h)
+//   1h    ... per hour                HIST_1H_POINTS   (7 days)
+// Every tier accumulates the raw samples of its open bucket (count,
+// sum, min, max): O(1) per sample and tier, averages are exact.
+//
+// Time base: seconds since boot (monotonic, also without NTP). The
+// API reports uptime and epoch, so a client can map to wall time.
+//
+// Memory: a series is allocated on its first sample, from PSRAM when
+// present. Internal heap is only used while HIST_HEAP_RESERVE bytes
+// stay free - modules beyond that simply have no history.
+// ---------------------------------------------------------
+
+#define HIST_SERIES        (MAX_MODULES + 1)    // stack + modules
+#define HIST_METRICS       4
+
+#define HIST_RAW_POINTS    120
+#define HIST_1M_POINTS     120
+#define HIST_15M_POINTS    96
+#define HIST_1H_POINTS     168
+
+#define HIST_HEAP_RESERVE  (80 * 1024)
+
+// stored unit = raw unit / scale
+#define HIST_SCALE_VOLT    10       // mV  → 10 mV
+#define HIST_SCALE_CURR    100      // mA  → 100 mA
+#define HIST_SCALE_TEMP    100      // m°C → 0.1 °C
+
+enum HistMetric : uint8_t {
+    HIST_VOLT,
+    HIST_CURR,
+    HIST_TEMP,
+    HIST_SOC
+};
+
+enum HistTier : uint8_t {
+    HIST_RAW,
+    HIST_1M,
+    HIST_15M,
+    HIST_1H,
+    HIST_TIERS
+};
+
+struct HistPoint {
+    uint32_t t;                     // seconds since boot (bucket start)
+    int16_t  min[HIST_METRICS];
+    int16_t  avg[HIST_METRICS];     // raw tier: the sample itself
+    int16_t  max[HIST_METRICS];
+};
+
+class PyHistory {
+public:
+    // Parser task: one sample for the stack and every module
+    void addPwr(const PwrBuffer& pwr);
+
+    bool hasSeries(int series) const;
+
+    // Copies up to max points of a tier starting at cursor (absolute
+    // point number, 0 = oldest ever). Points older than since are
+    // skipped, overwritten points too. Returns the number copied.
+    size_t read(int series, uint8_t tier, uint32_t since, uint32_t& cursor,
+                HistPoint* out, size_t max) const;
+
+    // Open (not yet finished) bucket of an aggregate tier
+    bool openBucket(int series, uint8_t tier, HistPoint& out) const;
+
+    static uint32_t now();                      // seconds since boot
+    static uint32_t step(uint8_t tier);         // bucket length, 0 = raw
+    static const char* tierName(uint8_t tier);  // "raw", "1m", ...
+    static int tierByName(const String& name);  // -1 if unknown
+
+private:
+    struct Acc {
+        uint32_t bucket;
+        uint16_t count;
+        int32_t  sum[HIST_METRICS];
+        int16_t  min[HIST_METRICS];
+        int16_t  max[HIST_METRICS];
+    };
+
+    struct Ring {
+        HistPoint* pts;
+        uint16_t   cap;
+        uint32_t   total;           // points ever pushed
+    };
+
+    struct Series {
+        Ring tiers[HIST_TIERS];
+        Acc  acc[HIST_TIERS];
+    };
+
+    Series* allocSeries();
+    void    addSample(Series& s, uint32_t t, const int16_t* v);
+
+    Series* series[HIST_SERIES] = {nullptr};
+    bool    allocFailed[HIST_SERIES] = {false};
+};
+
+extern PyHistory history;
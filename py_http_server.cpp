@@ -0,0 +1,1125 @@
+#include "py_http_server.h"
+#include "py_log.h"
+#include <lwip/sockets.h>
+
+// ---------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------
+static const char* statusText(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 408: return "Request Timeout";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default:  return "Error";
+    }
+}
+
+static HTTPMethod parseMethod(const char* s, size_t n) {
+    struct { const char* name; HTTPMethod m; } static const methods[] = {
+        { "GET", HTTP_GET }, { "HEAD", HTTP_HEAD }, { "POST", HTTP_POST },
+        { "PUT", HTTP_PUT }, { "PATCH", HTTP_PATCH }, { "DELETE", HTTP_DELETE },
+        { "OPTIONS", HTTP_OPTIONS }
+    };
+    for (const auto& e : methods)
+        if (strlen(e.name) == n && memcmp(e.name, s, n) == 0) return e.m;
+    return HTTP_ANY;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// %xx and '+' (query / form encoding)
+static String urlDecode(const char* s, size_t n) {
+    String out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        char c = s[i];
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%' && i + 2 < n && hexDigit(s[i + 1]) >= 0 && hexDigit(s[i + 2]) >= 0) {
+            c = (char)(hexDigit(s[i + 1]) * 16 + hexDigit(s[i + 2]));
+            i += 2;
+        }
+        out += c;
+    }
+    return out;
+}
+
+static const char* findSeq(const char* s, size_t n, const char* seq, size_t m) {
+    if (m == 0 || n < m) return nullptr;
+    for (size_t i = 0; i + m <= n; i++)
+        if (s[i] == seq[0] && memcmp(s + i, seq, m) == 0) return s + i;
+    return nullptr;
+}
+
+static bool startsWithNoCase(const char* s, size_t n, const char* prefix) {
+    size_t m = strlen(prefix);
+    return n >= m && strncasecmp(s, prefix, m) == 0;
+}
+
+// value of key="..." (or key=token) inside a header line
+static String headerParam(const String& line, const char* key) {
+    String k = String(key) + "=";
+    int p = line.indexOf(k);
+    if (p < 0) return String();
+    p += k.length();
+    if (line[p] == '"') {
+        int e = line.indexOf('"', p + 1);
+        return e < 0 ? String() : line.substring(p + 1, e);
+    }
+    int e = line.indexOf(';', p);
+    String v = e < 0 ? line.substring(p) : line.substring(p, e);
+    v.trim();
+    return v;
+}
+
+static void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// ---------------------------------------------------------
+// Setup
+// ---------------------------------------------------------
+HttpServer::HttpServer(uint16_t port) : listenPort(port) {}
+
+HttpServer::~HttpServer() {
+    close();
+}
+
+void HttpServer::begin() {
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        LOGE(LOGM_WEB, "HTTP: socket() failed (%d)", errno);
+        return;
+    }
+
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(listenPort);
+
+    if (::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+        ::listen(listenFd, HTTP_BACKLOG) < 0) {
+        LOGE(LOGM_WEB, "HTTP: bind/listen on port %u failed (%d)", listenPort, errno);
+        ::close(listenFd);
+        listenFd = -1;
+        return;
+    }
+    setNonBlocking(listenFd);
+
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr*)&addr, &len);
+    listenPort = ntohs(addr.sin_port);
+
+    LOGI(LOGM_WEB, "HTTP: listening on port %u, %d connections", listenPort, HTTP_MAX_CONN);
+}
+
+void HttpServer::close() {
+    for (uint8_t i = 0; i < HTTP_MAX_CONN; i++)
+        if (conns[i].state != CONN_FREE) closeConn(conns[i]);
+
+    if (listenFd >= 0) ::close(listenFd);
+    listenFd = -1;
+}
+
+void HttpServer::on(const String& uri, HTTPMethod method, THandlerFunction fn) {
+    on(uri, method, fn, nullptr);
+}
+
+void HttpServer::on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction uploadFn) {
+    if (routeCount >= HTTP_MAX_ROUTES) {
+        LOGE(LOGM_WEB, "HTTP: route table full, %s not registered", uri);
+        return;
+    }
+    Route& r = routes[routeCount++];
+    r.uri      = uri;
+    r.method   = method;
+    r.fn       = fn;
+    r.uploadFn = uploadFn;
+}
+
+void HttpServer::collectHeaders(const char* keys[], size_t count) {
+    headerKeyCount = 0;
+    for (size_t i = 0; i < count && i < HTTP_MAX_HEADERS; i++)
+        headerKeys[headerKeyCount++] = keys[i];
+}
+
+uint8_t HttpServer::connections() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < HTTP_MAX_CONN; i++)
+        if (conns[i].state != CONN_FREE) n++;
+    return n;
+}
+
+// ---------------------------------------------------------
+// Event loop
+// ---------------------------------------------------------
+void HttpServer::handleClient(uint32_t waitMs) {
+    if (listenFd < 0) return;
+
+    // pipelined requests that waited for the previous response,
+    // one per connection and round
+    bool queued = false;
+    for (uint8_t i = 0; i < HTTP_MAX_CONN; i++) {
+        Conn& c = conns[i];
+        if (!c.pipelined) continue;
+        c.pipelined = false;
+        if (c.state == CONN_READ) process(c);
+        queued |= c.pipelined;
+    }
+
+    fd_set rd, wr;
+    FD_ZERO(&rd);
+    FD_ZERO(&wr);
+    int maxFd = -1;
+
+    // new clients only when a slot is free (or an idle one can go)
+    bool room = connections() < HTTP_MAX_CONN;
+    if (!room) {
+        for (uint8_t i = 0; i < HTTP_MAX_CONN && !room; i++)
+            room = conns[i].state == CONN_READ && conns[i].inLen == 0 && conns[i].served > 0;
+    }
+    if (room) {
+        FD_SET(listenFd, &rd);
+        maxFd = listenFd;
+    }
+
+    for (uint8_t i = 0; i < HTTP_MAX_CONN; i++) {
+        Conn& c = conns[i];
+        if (c.state == CONN_FREE) continue;
+
+        if (c.state == CONN_WRITE) {
+            FD_SET(c.fd, &wr);
+        } else if (c.inLen < HTTP_HEAD_MAX) {
+            // DEFERRED too: a closed browser shows up as readable
+            FD_SET(c.fd, &rd);
+        }
+        if (c.fd > maxFd) maxFd = c.fd;
+    }
+
+    if (queued) waitMs = 0;
+
+    timeval tv;
+    tv.tv_sec  = waitMs / 1000;
+    tv.tv_usec = (waitMs % 1000) * 1000;
+
+    int n = select(maxFd + 1, &rd, &wr, nullptr, &tv);
+    if (n > 0) {
+        if (room && FD_ISSET(listenFd, &rd)) acceptClients();
+
+        for (uint8_t i = 0; i < HTTP_MAX_CONN; i++) {
+            Conn& c = conns[i];
+            if (c.state == CONN_FREE || c.fd < 0) continue;
+
+            // connections accepted in this round are not in the sets
+            if (c.state == CONN_WRITE && FD_ISSET(c.fd, &wr)) writeConn(c);
+            else if (c.state != CONN_WRITE && FD_ISSET(c.fd, &rd)) readConn(c);
+        }
+    }
+
+    checkTimeouts();
+}
+
+void HttpServer::acceptClients() {
+    for (;;) {
+        Conn* slot = nullptr;
+        bool idle = false;
+        for (uint8_t i = 0; i < HTTP_MAX_CONN && !slot; i++) {
+            const Conn& c = conns[i];
+            if (c.state == CONN_FREE) slot = &conns[i];
+            idle |= c.state == CONN_READ && c.inLen == 0 && c.served > 0;
+        }
+        if (!slot && !idle) return;                     // rest waits in the backlog
+
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;                             // EAGAIN: nothing pending
+
+        if (!slot) {
+            evictIdle();
+            for (uint8_t i = 0; i < HTTP_MAX_CONN && !slot; i++)
+                if (conns[i].state == CONN_FREE) slot = &conns[i];
+        }
+
+        setNonBlocking(fd);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Conn& c = *slot;
+        c.in = (char*)malloc(HTTP_HEAD_MAX);
+        if (!c.in) {
+            LOGW(LOGM_WEB, "HTTP: no memory for a connection");
+            ::close(fd);
+            return;
+        }
+
+        c.fd        = fd;
+        c.state     = CONN_READ;
+        c.serial    = nextSerial++;
+        c.since     = millis();
+        c.served    = 0;
+        c.inLen     = 0;
+        c.outLen    = 0;
+        c.outSent   = 0;
+        c.keepAlive = false;
+        c.failed    = false;
+        c.pipelined = false;
+
+        st.accepted++;
+        uint8_t open = connections();
+        if (open > st.connMax) st.connMax = open;
+    }
+}
+
+// longest idle keep-alive connection makes room for a new client
+void HttpServer::evictIdle() {
+    Conn* oldest = nullptr;
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < HTTP_MAX_CONN; i++) {
+        Conn& c = conns[i];
+        if (c.state != CONN_READ || c.inLen > 0 || c.served == 0) continue;
+        if (!oldest || now - c.since > now - oldest->since) oldest = &c;
+    }
+    if (!oldest) return;
+
+    closeConn(*oldest);
+    st.evicted++;
+}
+
+void HttpServer::readConn(Conn& c) {
+    int n = ::recv(c.fd, c.in + c.inLen, HTTP_HEAD_MAX - c.inLen, 0);
+    if (n == 0) {
+        closeConn(c);                                   // browser closed
+        return;
+    }
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) closeConn(c);
+        return;
+    }
+
+    c.inLen += n;
+    if (c.state == CONN_DEFERRED) return;               // pipelined, later
+
+    c.since = millis();
+    process(c);
+}
+
+void HttpServer::writeConn(Conn& c) {
+    for (;;) {
+        if (c.outSent < c.outLen) {
+            int n = ::send(c.fd, c.out + c.outSent, c.outLen - c.outSent, 0);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) closeConn(c);
+                return;
+            }
+            c.outSent += n;
+            c.since = millis();
+            if (c.outSent < c.outLen) return;           // window full
+        }
+        c.outLen = c.outSent = 0;
+
+        if (!c.source || c.sourceLeft == 0) break;
+
+        // next piece of the file
+        if (!grow(c, HTTP_OUT_KEEP)) {
+            closeConn(c);
+            return;
+        }
+        size_t want = c.outCap < c.sourceLeft ? c.outCap : c.sourceLeft;
+        size_t got = c.source->read(c.out, want);
+        if (got == 0) {
+            // file shorter than announced: the length is wrong, close
+            LOGW(LOGM_WEB, "HTTP: file ended %u bytes early", (unsigned)c.sourceLeft);
+            closeConn(c);
+            return;
+        }
+        c.outLen = got;
+        c.sourceLeft -= got;
+    }
+
+    responseDone(c);
+}
+
+void HttpServer::closeConn(Conn& c) {
+    if (upConn == &c) {
+        if (upPhase == UP_FILE) uploadEvent(UPLOAD_FILE_ABORTED);
+        upConn = nullptr;
+        upPhase = UP_IDLE;
+    }
+
+    if (c.fd >= 0) ::close(c.fd);
+    delete c.source;
+    free(c.in);
+    free(c.out);
+
+    Request& r = reqs[&c - conns];
+    r.body = String();
+
+    c.fd = -1;
+    c.state = CONN_FREE;
+    c.source = nullptr;
+    c.sourceLeft = 0;
+    c.in = nullptr;
+    c.out = nullptr;
+    c.outCap = c.outLen = c.outSent = 0;
+}
+
+void HttpServer::checkTimeouts() {
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < HTTP_MAX_CONN; i++) {
+        Conn& c = conns[i];
+        uint32_t age = now - c.since;
+
+        switch (c.state) {
+            case CONN_READ:
+                if (c.inLen == 0 && c.served > 0) {
+                    if (age >= HTTP_KEEPALIVE_MS) closeConn(c);
+                    break;
+                }
+                // fall through: request started (or never sent)
+            case CONN_BODY:
+            case CONN_UPLOAD:
+                if (age >= HTTP_REQUEST_TIMEOUT_MS) {
+                    st.timeouts++;
+                    closeConn(c);
+                }
+                break;
+
+            case CONN_WRITE:
+                if (age >= HTTP_SEND_TIMEOUT_MS) {
+                    LOGD(LOGM_WEB, "HTTP: response stalled, %u bytes left",
+                         (unsigned)(c.outLen - c.outSent + c.sourceLeft));
+                    st.timeouts++;
+                    closeConn(c);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// Requests
+// ---------------------------------------------------------
+void HttpServer::consume(Conn& c, size_t n) {
+    if (n >= c.inLen) {
+        c.inLen = 0;
+        return;
+    }
+    memmove(c.in, c.in + n, c.inLen - n);
+    c.inLen -= n;
+}
+
+// Runs until the input is used up or the connection waits for its
+// response (pipelined requests stay in the buffer)
+void HttpServer::process(Conn& c) {
+    Request& r = reqs[&c - conns];
+
+    for (;;) {
+        if (c.state == CONN_READ) {
+            const char* end = findSeq(c.in, c.inLen, "\r\n\r\n", 4);
+            if (!end) {
+                if (c.inLen >= HTTP_HEAD_MAX) fail(c, 431, "Request header too large");
+                return;
+            }
+
+            size_t headLen = end - c.in + 4;
+            if (!parseHead(c, headLen)) return;
+            consume(c, headLen);
+
+            if (c.bodyLeft == 0) {
+                dispatch(c);
+                return;
+            }
+
+            const Route* rt = c.route >= 0 ? &routes[c.route] : nullptr;
+            if (rt && rt->uploadFn && r.contentType.startsWith("multipart/form-data")) {
+                if (!startUpload(c)) return;
+                c.state = CONN_UPLOAD;
+            } else if (c.bodyLeft > HTTP_BODY_MAX) {
+                fail(c, 413, "Body too large");
+                return;
+            } else {
+                r.body.reserve(c.bodyLeft);
+                c.state = CONN_BODY;
+            }
+        }
+
+        if (c.state == CONN_BODY) {
+            size_t n = c.inLen < c.bodyLeft ? c.inLen : c.bodyLeft;
+            r.body.concat(c.in, n);
+            consume(c, n);
+            c.bodyLeft -= n;
+            if (c.bodyLeft > 0) return;
+
+            if (r.contentType.startsWith("application/x-www-form-urlencoded"))
+                parseArgs(r, r.body.c_str(), r.body.length());
+            addArg(r, "plain", r.body);
+            dispatch(c);
+            return;
+        }
+
+        if (c.state == CONN_UPLOAD) {
+            size_t avail = c.inLen < c.bodyLeft ? c.inLen : c.bodyLeft;
+            bool last = avail == c.bodyLeft;
+            size_t used = feedUpload(c, c.in, avail, last);
+            consume(c, used);
+            c.bodyLeft -= used;
+            if (c.bodyLeft > 0) return;
+
+            if (upPhase != UP_DONE) {
+                if (upPhase == UP_FILE) uploadEvent(UPLOAD_FILE_ABORTED);
+                LOGW(LOGM_WEB, "HTTP: upload %s incomplete", up.filename);
+            }
+            upConn = nullptr;
+            upPhase = UP_IDLE;
+            dispatch(c);
+            return;
+        }
+
+        return;                                         // HANDLER / DEFERRED / WRITE
+    }
+}
+
+bool HttpServer::parseHead(Conn& c, size_t headLen) {
+    Request& r = reqs[&c - conns];
+    r.argCount = 0;
+    r.contentType = String();
+    r.body = String();
+    for (uint8_t i = 0; i < HTTP_MAX_HEADERS; i++) r.headerValue[i] = String();
+
+    // request line: METHOD SP target SP HTTP/1.x
+    const char* line = c.in;
+    const char* eol = findSeq(line, headLen, "\r\n", 2);
+    const char* sp1 = (const char*)memchr(line, ' ', eol - line);
+    const char* sp2 = sp1 ? (const char*)memchr(sp1 + 1, ' ', eol - sp1 - 1) : nullptr;
+    if (!sp1 || !sp2) {
+        fail(c, 400, "Bad request");
+        return false;
+    }
+
+    r.method = parseMethod(line, sp1 - line);
+    if (r.method == HTTP_ANY) {
+        fail(c, 501, "Method not implemented");
+        return false;
+    }
+
+    c.http10    = startsWithNoCase(sp2 + 1, eol - sp2 - 1, "HTTP/1.0");
+    c.keepAlive = !c.http10;
+
+    const char* target = sp1 + 1;
+    size_t targetLen = sp2 - target;
+    const char* q = (const char*)memchr(target, '?', targetLen);
+    size_t pathLen = q ? (size_t)(q - target) : targetLen;
+    r.uri = urlDecode(target, pathLen);
+    if (q) parseArgs(r, q + 1, targetLen - pathLen - 1);
+
+    // headers
+    size_t contentLength = 0;
+    const char* p = eol + 2;
+    const char* headEnd = c.in + headLen - 2;
+    while (p < headEnd) {
+        const char* e = findSeq(p, headEnd - p + 2, "\r\n", 2);
+        const char* colon = (const char*)memchr(p, ':', e - p);
+        if (colon) {
+            size_t nameLen = colon - p;
+            const char* v = colon + 1;
+            while (v < e && (*v == ' ' || *v == '\t')) v++;
+            size_t vLen = e - v;
+
+            if (nameLen == 14 && strncasecmp(p, "Content-Length", 14) == 0) {
+                contentLength = strtoul(v, nullptr, 10);
+            } else if (nameLen == 12 && strncasecmp(p, "Content-Type", 12) == 0) {
+                r.contentType = String(v, vLen);
+            } else if (nameLen == 10 && strncasecmp(p, "Connection", 10) == 0) {
+                if (startsWithNoCase(v, vLen, "close"))      c.keepAlive = false;
+                if (startsWithNoCase(v, vLen, "keep-alive")) c.keepAlive = true;
+            } else if (nameLen == 17 && strncasecmp(p, "Transfer-Encoding", 17) == 0) {
+                fail(c, 501, "Chunked request body not supported");
+                return false;
+            }
+
+            for (uint8_t i = 0; i < headerKeyCount; i++) {
+                if (headerKeys[i].length() == nameLen &&
+                    strncasecmp(p, headerKeys[i].c_str(), nameLen) == 0)
+                    r.headerValue[i] = String(v, vLen);
+            }
+        }
+        p = e + 2;
+    }
+
+    c.route = -1;
+    for (uint8_t i = 0; i < routeCount; i++) {
+        const Route& rt = routes[i];
+        if ((rt.method == HTTP_ANY || rt.method == r.method) && rt.uri == r.uri) {
+            c.route = i;
+            break;
+        }
+    }
+
+    c.bodyLeft = contentLength;
+    st.requests++;
+    if (c.served > 0) st.keepAlive++;
+    return true;
+}
+
+void HttpServer::parseArgs(Request& r, const char* s, size_t len) {
+    const char* end = s + len;
+    while (s < end) {
+        const char* amp = (const char*)memchr(s, '&', end - s);
+        const char* e = amp ? amp : end;
+        const char* eq = (const char*)memchr(s, '=', e - s);
+
+        if (e > s) {
+            if (eq) addArg(r, urlDecode(s, eq - s), urlDecode(eq + 1, e - eq - 1));
+            else    addArg(r, urlDecode(s, e - s), String());
+        }
+        s = e + 1;
+    }
+}
+
+void HttpServer::addArg(Request& r, const String& name, const String& value) {
+    if (r.argCount >= HTTP_MAX_ARGS) return;
+    r.argName[r.argCount]  = name;
+    r.argValue[r.argCount] = value;
+    r.argCount++;
+}
+
+String HttpServer::arg(const String& name) const {
+    for (uint8_t i = 0; i < req->argCount; i++)
+        if (req->argName[i] == name) return req->argValue[i];
+    return String();
+}
+
+bool HttpServer::hasArg(const String& name) const {
+    for (uint8_t i = 0; i < req->argCount; i++)
+        if (req->argName[i] == name) return true;
+    return false;
+}
+
+String HttpServer::header(const String& name) const {
+    for (uint8_t i = 0; i < headerKeyCount; i++)
+        if (headerKeys[i].equalsIgnoreCase(name)) return req->headerValue[i];
+    return String();
+}
+
+void HttpServer::dispatch(Conn& c) {
+    Request& r = reqs[&c - conns];
+
+    c.state = CONN_HANDLER;
+    cur  = &c;
+    req  = &r;
+    resp = Response();
+
+    uint32_t t0 = micros();
+    if (c.route >= 0)   routes[c.route].fn();
+    else if (notFound)  notFound();
+    else                send(404, "text/plain", "Not found");
+    uint32_t us = micros() - t0;
+    if (us > st.handlerMaxUs) st.handlerMaxUs = us;
+
+    cur = nullptr;
+    req = &noRequest;
+    r.body = String();
+
+    if (c.state != CONN_HANDLER) return;                // deferred / detached
+
+    if (c.failed) {
+        closeConn(c);
+        return;
+    }
+    if (!resp.started) {
+        LOGW(LOGM_WEB, "HTTP: %s sent no response", r.uri);
+        closeConn(c);
+        return;
+    }
+    if (resp.chunked && !resp.ended) {
+        static const char LAST[] = "0\r\n\r\n";
+        cur = &c;
+        put(LAST, sizeof(LAST) - 1);
+        cur = nullptr;
+    }
+
+    c.state = CONN_WRITE;
+    writeConn(c);
+}
+
+void HttpServer::responseDone(Conn& c) {
+    delete c.source;
+    c.source = nullptr;
+    c.served++;
+
+    if (!c.keepAlive) {
+        closeConn(c);
+        return;
+    }
+
+    // large buffers go back to the heap between requests
+    if (c.outCap > HTTP_OUT_KEEP) {
+        free(c.out);
+        c.out = nullptr;
+        c.outCap = 0;
+    }
+
+    // a pipelined request is taken up by the next round (no recursion)
+    c.state = CONN_READ;
+    c.since = millis();
+    c.pipelined = c.inLen > 0;
+}
+
+// Error answer from the core itself (no handler), connection closes
+void HttpServer::fail(Conn& c, int code, const char* text) {
+    LOGD(LOGM_WEB, "HTTP: %d %s", code, text);
+    st.badRequests++;
+
+    c.keepAlive = false;
+    c.inLen = 0;
+    c.state = CONN_HANDLER;
+
+    cur  = &c;
+    resp = Response();
+    send(code, "text/plain", text);
+    cur  = nullptr;
+
+    c.state = CONN_WRITE;
+    writeConn(c);
+}
+
+// ---------------------------------------------------------
+// multipart/form-data upload (one at a time)
+// ---------------------------------------------------------
+// The body is parsed as it arrives; file data goes to the route's
+// upload handler in HTTP_UPLOAD_BUFLEN pieces (START, WRITE.., END),
+// plain fields become args. Data close to the end of the buffer is
+// held back until it is clear that it is not the delimiter.
+bool HttpServer::startUpload(Conn& c) {
+    Request& r = reqs[&c - conns];
+
+    if (upConn) {
+        fail(c, 503, "Upload in progress");
+        return false;
+    }
+
+    String boundary = headerParam(r.contentType, "boundary");
+    if (boundary.length() == 0 || boundary.length() > 70) {
+        fail(c, 400, "Bad multipart boundary");
+        return false;
+    }
+
+    upConn  = &c;
+    upPhase = UP_PREAMBLE;
+    upDelim = "\r\n--" + boundary;
+    upField = String();
+    up.totalSize = 0;
+    up.currentSize = 0;
+    return true;
+}
+
+size_t HttpServer::feedUpload(Conn& c, const char* data, size_t len, bool last) {
+    Request& r = reqs[&c - conns];
+    const char* delim = upDelim.c_str();
+    size_t dlen = upDelim.length();
+    size_t used = 0;
+
+    for (;;) {
+        const char* p = data + used;
+        size_t n = len - used;
+
+        switch (upPhase) {
+            case UP_PREAMBLE: {
+                // the first delimiter has no leading CRLF
+                const char* d = findSeq(p, n, delim + 2, dlen - 2);
+                if (!d) {
+                    if (n > dlen) used += n - dlen;
+                    return last ? len : used;
+                }
+                used += d - p + dlen - 2;
+                upPhase = UP_DELIM;
+                break;
+            }
+
+            case UP_DELIM:
+                if (n < 2) return last ? len : used;
+                if (p[0] == '-' && p[1] == '-') {
+                    upPhase = UP_DONE;
+                    break;
+                }
+                used += (p[0] == '\r' && p[1] == '\n') ? 2 : 0;
+                upPhase = UP_PART_HEAD;
+                break;
+
+            case UP_PART_HEAD: {
+                const char* e = findSeq(p, n, "\r\n\r\n", 4);
+                if (!e) {
+                    if (n >= HTTP_HEAD_MAX || last) {
+                        upPhase = UP_DONE;              // broken, rest is skipped
+                        break;
+                    }
+                    return used;
+                }
+
+                String head(p, e - p + 2);
+                used += e - p + 4;
+
+                String disposition, type;
+                int pos = 0;
+                while (pos < (int)head.length()) {
+                    int eol = head.indexOf("\r\n", pos);
+                    if (eol < 0) break;
+                    String line = head.substring(pos, eol);
+                    if (startsWithNoCase(line.c_str(), line.length(), "Content-Disposition:"))
+                        disposition = line;
+                    else if (startsWithNoCase(line.c_str(), line.length(), "Content-Type:"))
+                        type = line.substring(13);
+                    pos = eol + 2;
+                }
+                type.trim();
+
+                up.name = headerParam(disposition, "name");
+                if (disposition.indexOf("filename=") >= 0) {
+                    up.filename    = headerParam(disposition, "filename");
+                    up.type        = type;
+                    up.totalSize   = 0;
+                    up.currentSize = 0;
+                    uploadEvent(UPLOAD_FILE_START);
+                    upPhase = UP_FILE;
+                } else {
+                    upField = String();
+                    upPhase = UP_FIELD;
+                }
+                break;
+            }
+
+            case UP_FILE:
+            case UP_FIELD: {
+                const char* d = findSeq(p, n, delim, dlen);
+                size_t take = d ? (size_t)(d - p) : (n > dlen ? n - dlen : 0);
+                if (!d && last) take = n;
+
+                if (upPhase == UP_FILE) uploadData(p, take);
+                else if (upField.length() + take <= HTTP_BODY_MAX) upField.concat(p, take);
+                used += take;
+
+                if (!d) return used;
+
+                used += dlen;
+                if (upPhase == UP_FILE) {
+                    if (up.currentSize > 0) uploadEvent(UPLOAD_FILE_WRITE);
+                    uploadEvent(UPLOAD_FILE_END);
+                } else {
+                    addArg(r, up.name, upField);
+                }
+                upPhase = UP_DELIM;
+                break;
+            }
+
+            case UP_DONE:
+            default:
+                return len;                             // epilogue
+        }
+    }
+}
+
+void HttpServer::uploadData(const char* data, size_t len) {
+    while (len > 0) {
+        size_t room = HTTP_UPLOAD_BUFLEN - up.currentSize;
+        size_t n = len < room ? len : room;
+        memcpy(up.buf + up.currentSize, data, n);
+        up.currentSize += n;
+        data += n;
+        len  -= n;
+        if (up.currentSize == HTTP_UPLOAD_BUFLEN) uploadEvent(UPLOAD_FILE_WRITE);
+    }
+}
+
+void HttpServer::uploadEvent(HTTPUploadStatus status) {
+    Conn& c = *upConn;
+    const Route& rt = routes[c.route];
+
+    up.status = status;
+    if (status == UPLOAD_FILE_WRITE) up.totalSize += up.currentSize;
+
+    Request* saved = req;
+    req = &reqs[&c - conns];
+    if (rt.uploadFn) rt.uploadFn();
+    req = saved;
+
+    if (status == UPLOAD_FILE_WRITE) up.currentSize = 0;
+}
+
+// ---------------------------------------------------------
+// Responses
+// ---------------------------------------------------------
+void HttpServer::sendHeader(const String& name, const String& value, bool first) {
+    String line = name + ": " + value + "\r\n";
+    if (first) resp.headers = line + resp.headers;
+    else       resp.headers += line;
+}
+
+void HttpServer::send(int code, const char* type, const String& content) {
+    if (!cur) return;
+    beginResponse(code, type, content.length());
+    if (content.length() > 0) sendContent(content.c_str(), content.length());
+}
+
+void HttpServer::send(int code, const char* type, const char* content) {
+    if (!cur) return;
+    size_t len = content ? strlen(content) : 0;
+    beginResponse(code, type, len);
+    if (len > 0) sendContent(content, len);
+}
+
+void HttpServer::send(int code, const String& type, const String& content) {
+    send(code, type.c_str(), content);
+}
+
+void HttpServer::beginResponse(int code, const char* type, size_t len) {
+    Conn& c = *cur;
+    if (resp.started) return;
+    resp.started = true;
+
+    size_t length = resp.contentLength == CONTENT_LENGTH_NOT_SET ? len : resp.contentLength;
+
+    // CONTENT_LENGTH_UNKNOWN: chunked, or until close for HTTP/1.0
+    if (length == CONTENT_LENGTH_UNKNOWN) {
+        if (c.http10) c.keepAlive = false;
+        else          resp.chunked = true;
+    }
+
+    char head[128];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+    put(head, n);
+
+    if (type && *type) {
+        n = snprintf(head, sizeof(head), "Content-Type: %s\r\n", type);
+        put(head, n);
+    }
+    if (resp.chunked) {
+        static const char TE[] = "Transfer-Encoding: chunked\r\n";
+        put(TE, sizeof(TE) - 1);
+    } else if (length != CONTENT_LENGTH_UNKNOWN) {
+        n = snprintf(head, sizeof(head), "Content-Length: %u\r\n", (unsigned)length);
+        put(head, n);
+    }
+
+    n = snprintf(head, sizeof(head), "Connection: %s\r\n",
+                 c.keepAlive ? "keep-alive" : "close");
+    put(head, n);
+    put(resp.headers.c_str(), resp.headers.length());
+    put("\r\n", 2);
+    resp.headers = String();
+}
+
+void HttpServer::sendContent(const char* data, size_t len) {
+    if (!cur || !resp.started || resp.ended) return;
+    if (req->method == HTTP_HEAD) return;
+
+    if (!resp.chunked) {
+        put(data, len);
+        return;
+    }
+
+    char size[12];
+    int n = snprintf(size, sizeof(size), "%X\r\n", (unsigned)len);
+    put(size, n);
+    put(data, len);
+    put("\r\n", 2);
+    if (len == 0) resp.ended = true;                    // "0\r\n\r\n"
+}
+
+size_t HttpServer::streamSource(HttpSource* src, size_t size, const String& type, bool gz) {
+    if (!cur || resp.started) {
+        delete src;
+        return 0;
+    }
+
+    if (gz) sendHeader("Content-Encoding", "gzip");
+    resp.contentLength = size;
+    beginResponse(200, type.c_str(), size);
+
+    if (req->method == HTTP_HEAD || cur->failed) {
+        delete src;
+        return 0;
+    }
+
+    // read by writeConn() when the header is out
+    cur->source = src;
+    cur->sourceLeft = size;
+    return size;
+}
+
+void HttpServer::put(const void* data, size_t len) {
+    Conn& c = *cur;
+    const uint8_t* p = (const uint8_t*)data;
+
+    while (len > 0 && !c.failed) {
+        if (c.outLen == c.outCap && !grow(c, c.outLen + len)) {
+            if (c.outLen == 0) {                        // no memory at all
+                c.failed = true;
+                return;
+            }
+            // HTTP_OUT_MAX reached: push out what is there (blocking)
+            if (!resp.blocked) {
+                resp.blocked = true;
+                st.blockedSends++;
+            }
+            if (!drain(c)) {
+                c.failed = true;
+                return;
+            }
+            continue;
+        }
+
+        size_t room = c.outCap - c.outLen;
+        size_t n = len < room ? len : room;
+        memcpy(c.out + c.outLen, p, n);
+        c.outLen += n;
+        p   += n;
+        len -= n;
+    }
+}
+
+bool HttpServer::grow(Conn& c, size_t need) {
+    if (need <= c.outCap) return true;
+    if (c.outCap >= HTTP_OUT_MAX) return false;
+
+    size_t cap = c.outCap ? c.outCap : 512;
+    while (cap < need && cap < HTTP_OUT_MAX) cap *= 2;
+    if (cap > HTTP_OUT_MAX) cap = HTTP_OUT_MAX;
+
+    uint8_t* p = (uint8_t*)realloc(c.out, cap);
+    if (!p) return false;                               // drained instead
+    c.out = p;
+    c.outCap = cap;
+    return true;
+}
+
+// Blocking send of the whole buffer (inside a handler only)
+bool HttpServer::drain(Conn& c) {
+    uint32_t start = millis();
+
+    while (c.outSent < c.outLen) {
+        int n = ::send(c.fd, c.out + c.outSent, c.outLen - c.outSent, 0);
+        if (n > 0) {
+            c.outSent += n;
+            start = millis();
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return false;
+
+        uint32_t waited = millis() - start;
+        if (waited >= HTTP_SEND_TIMEOUT_MS) return false;
+
+        fd_set wr;
+        FD_ZERO(&wr);
+        FD_SET(c.fd, &wr);
+        uint32_t left = HTTP_SEND_TIMEOUT_MS - waited;
+        timeval tv;
+        tv.tv_sec  = left / 1000;
+        tv.tv_usec = (left % 1000) * 1000;
+        select(c.fd + 1, nullptr, &wr, nullptr, &tv);
+    }
+
+    c.outLen = c.outSent = 0;
+    return true;
+}
+
+// ---------------------------------------------------------
+// Deferred answers / hand-over
+// ---------------------------------------------------------
+HttpTicket HttpServer::ticket(const Conn& c) const {
+    return (c.serial << 8) | (uint32_t)(&c - conns);
+}
+
+HttpServer::Conn* HttpServer::find(HttpTicket t) const {
+    uint32_t idx = t & 0xFF;
+    if (t == 0 || idx >= HTTP_MAX_CONN) return nullptr;
+
+    Conn* c = const_cast<Conn*>(&conns[idx]);
+    if (c->state == CONN_FREE || (c->serial << 8) != (t & ~0xFFu)) return nullptr;
+    return c;
+}
+
+HttpTicket HttpServer::defer() {
+    if (!cur || resp.started) return 0;
+
+    cur->state = CONN_DEFERRED;
+    st.deferred++;
+    return ticket(*cur);
+}
+
+bool HttpServer::reply(HttpTicket t, int code, const char* type, const char* data, size_t len) {
+    Conn* c = find(t);
+    if (!c || c->state != CONN_DEFERRED) return false;
+
+    // the parked request becomes the current one for the answer
+    Conn*    savedCur  = cur;
+    Request* savedReq  = req;
+    Response savedResp = resp;
+
+    cur  = c;
+    req  = &reqs[c - conns];
+    resp = Response();
+    c->state = CONN_HANDLER;
+
+    setContentLength(len);
+    beginResponse(code, type, len);
+    if (len > 0) sendContent(data, len);
+
+    cur  = savedCur;
+    req  = savedReq;
+    resp = savedResp;
+
+    if (c->failed) {
+        closeConn(*c);
+        return true;
+    }
+
+    c->since = millis();
+    c->state = CONN_WRITE;
+    writeConn(*c);
+    return true;
+}
+
+bool HttpServer::pending(HttpTicket t) const {
+    Conn* c = find(t);
+    return c && c->state == CONN_DEFERRED;
+}
+
+void HttpServer::abandon(HttpTicket t) {
+    Conn* c = find(t);
+    if (c && c->state == CONN_DEFERRED) closeConn(*c);
+}
+
+int HttpServer::detach() {
+    if (!cur || resp.started) return -1;
+
+    Conn& c = *cur;
+    int fd = c.fd;
+    c.fd = -1;                                          // not closed by closeConn
+    closeConn(c);
+    st.detached++;
+    return fd;
+}
@@ -0,0 +1,331 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+// ---------------------------------------------------------
+// Connection-multiplexed HTTP/1.1 server (web task)
+// ---------------------------------------------------------
+// Replaces the Arduino WebServer, which serves one client at a time
+// and blocks in every read and write of it. Here all connections live
+// in one select() loop over non-blocking lwIP sockets:
+//
+//   READ      request line + headers into a per-connection buffer,
+//             the body as far as it has arrived (uploads streamed)
+//   dispatch  the route handler runs once the request is complete
+//   WRITE     the response leaves from the connection's output
+//             buffer whenever the socket takes it; streamFile()
+//             refills it from the file chunk by chunk
+//   DEFERRED  parked until the handler's poll answers (reply())
+//
+// A slow browser, a large file or a handler waiting for the UART no
+// longer holds up the other connections. Handlers keep the WebServer
+// API subset this project uses (on, arg, hasArg, header, send,
+// sendHeader, sendContent, streamFile, upload, ...). The response is
+// built in memory; only a response larger than HTTP_OUT_MAX is pushed
+// out blocking while its handler runs (bounded by HTTP_SEND_TIMEOUT_MS).
+//
+// Keep-alive and pipelining are supported. An idle keep-alive
+// connection is closed after HTTP_KEEPALIVE_MS, or at once when a new
+// client needs its slot.
+//
+//   defer()   park the current request, answer later with reply()
+//   detach()  hand the socket over (Server-Sent Events)
+//
+// The core only needs BSD sockets: the host build (test/) runs it on
+// Linux, see test_http_server.cpp and bench_http.cpp.
+// ---------------------------------------------------------
+
+// lwIP socket budget (CONFIG_LWIP_MAX_SOCKETS 16): listen + HTTP +
+// /api/stream (STREAM_MAX_CLIENTS) + MQTT
+#ifndef HTTP_MAX_CONN
+#define HTTP_MAX_CONN           8
+#endif
+#define HTTP_MAX_ROUTES         64
+#define HTTP_MAX_ARGS           8
+#define HTTP_MAX_HEADERS        4       // collectHeaders()
+#define HTTP_BACKLOG            8
+
+#define HTTP_HEAD_MAX           2048    // request line + headers (input buffer)
+#define HTTP_BODY_MAX           8192    // request body (uploads are streamed)
+#define HTTP_OUT_MAX            8192    // response buffered per connection
+#define HTTP_OUT_KEEP           1536    // buffer kept between requests
+#define HTTP_UPLOAD_BUFLEN      1436
+
+#define HTTP_REQUEST_TIMEOUT_MS 5000    // incomplete request
+#define HTTP_KEEPALIVE_MS       5000    // idle keep-alive connection
+#define HTTP_SEND_TIMEOUT_MS    5000    // response without progress
+
+#define CONTENT_LENGTH_UNKNOWN  ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET  ((size_t)-2)
+
+enum HTTPMethod : uint8_t {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+enum HTTPUploadStatus : uint8_t {
+    UPLOAD_FILE_START,
+    UPLOAD_FILE_WRITE,
+    UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED
+};
+
+struct HTTPUpload {
+    HTTPUploadStatus status;
+    String  filename;
+    String  name;
+    String  type;
+    size_t  totalSize;
+    size_t  currentSize;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+// Body of a streamFile() response, owned by the connection until sent
+class HttpSource {
+public:
+    virtual ~HttpSource() {}
+    virtual size_t read(uint8_t* buf, size_t len) = 0;
+};
+
+// fs::File (or anything with read / close) - the copy keeps the file open
+template <typename F>
+class HttpFileSource : public HttpSource {
+public:
+    explicit HttpFileSource(F& f) : file(f) {}
+    ~HttpFileSource() override { file.close(); }
+    size_t read(uint8_t* buf, size_t len) override { return file.read(buf, len); }
+
+private:
+    F file;
+};
+
+// Deferred request: connection slot + serial (slot reuse is detected)
+typedef uint32_t HttpTicket;
+
+struct HttpServerStats {
+    uint32_t accepted = 0;
+    uint32_t requests = 0;
+    uint32_t keepAlive = 0;      // requests on a reused connection
+    uint32_t deferred = 0;
+    uint32_t detached = 0;
+    uint32_t evicted = 0;        // idle connections closed for a new client
+    uint32_t timeouts = 0;
+    uint32_t badRequests = 0;    // 400 / 413 / 431 / 501 / 503 from the core
+    uint32_t blockedSends = 0;   // responses > HTTP_OUT_MAX sent blocking
+    uint32_t handlerMaxUs = 0;   // slowest handler
+    uint8_t  connMax = 0;        // peak of open connections
+};
+
+class HttpServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit HttpServer(uint16_t port = 80);
+    ~HttpServer();
+
+    void begin();
+    void close();
+    uint16_t port() const { return listenPort; }     // bound port (0 → ephemeral)
+
+    // One round: wait up to waitMs for socket events, accept, read,
+    // run handlers, write
+    void handleClient(uint32_t waitMs = 0);
+
+    // ---------------------------------------------------------
+    // Routes
+    // ---------------------------------------------------------
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn);
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction uploadFn);
+    void onNotFound(THandlerFunction fn) { notFound = fn; }
+    void collectHeaders(const char* keys[], size_t count);
+
+    // ---------------------------------------------------------
+    // Current request (inside a handler)
+    // ---------------------------------------------------------
+    HTTPMethod    method() const { return req->method; }
+    const String& uri() const    { return req->uri; }
+    String arg(const String& name) const;
+    bool   hasArg(const String& name) const;
+    int    args() const { return req->argCount; }
+    String header(const String& name) const;
+    HTTPUpload& upload() { return up; }
+
+    // ---------------------------------------------------------
+    // Response (inside a handler)
+    // ---------------------------------------------------------
+    void setContentLength(size_t len) { resp.contentLength = len; }
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void send(int code, const char* type = nullptr, const String& content = String());
+    void send(int code, const char* type, const char* content);
+    void send(int code, const String& type, const String& content);
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* data, size_t len);
+    void sendContent_P(const char* data) { sendContent(data, strlen(data)); }
+    void sendContent_P(const char* data, size_t len) { sendContent(data, len); }
+
+    // The file is read while the response goes out and closed afterwards;
+    // *.gz gets Content-Encoding: gzip
+    template <typename F>
+    size_t streamFile(F& file, const String& type) {
+        String name = file.name();
+        bool gz = name.endsWith(".gz") &&
+                  type != "application/x-gzip" && type != "application/octet-stream";
+        return streamSource(new HttpFileSource<F>(file), file.size(), type, gz);
+    }
+
+    // ---------------------------------------------------------
+    // Deferred answers / hand-over
+    // ---------------------------------------------------------
+    HttpTicket defer();                          // 0: not inside a handler
+    bool reply(HttpTicket t, int code, const char* type, const char* data, size_t len);
+    bool pending(HttpTicket t) const;            // parked, browser still there
+    void abandon(HttpTicket t);                  // close without answer
+    int  detach();                               // socket of the current request, -1: none
+
+    const HttpServerStats& stats() const { return st; }
+    uint8_t connections() const;
+
+private:
+    enum ConnState : uint8_t {
+        CONN_FREE,
+        CONN_READ,          // request line + headers
+        CONN_BODY,          // body into req.body
+        CONN_UPLOAD,        // multipart body → upload handler
+        CONN_HANDLER,       // handler running
+        CONN_DEFERRED,
+        CONN_WRITE
+    };
+
+    struct Conn {
+        int         fd = -1;
+        ConnState   state = CONN_FREE;
+        uint32_t    serial = 0;
+        uint32_t    since = 0;          // last progress (millis)
+        uint16_t    served = 0;         // responses on this connection
+        bool        keepAlive = false;
+        bool        http10 = false;
+        bool        failed = false;     // write error inside a handler
+        bool        pipelined = false;  // next request already buffered
+
+        char*       in = nullptr;       // HTTP_HEAD_MAX
+        size_t      inLen = 0;
+
+        uint8_t*    out = nullptr;
+        size_t      outCap = 0;
+        size_t      outLen = 0;
+        size_t      outSent = 0;
+
+        HttpSource* source = nullptr;
+        size_t      sourceLeft = 0;
+
+        int         route = -1;
+        size_t      bodyLeft = 0;
+    };
+
+    struct Route {
+        String           uri;
+        HTTPMethod       method;
+        THandlerFunction fn;
+        THandlerFunction uploadFn;
+    };
+
+    // Parsed request, one per connection (bodies arrive interleaved)
+    struct Request {
+        HTTPMethod method = HTTP_ANY;
+        String     uri;
+        String     contentType;
+        String     body;
+        uint8_t    argCount = 0;
+        String     argName[HTTP_MAX_ARGS];
+        String     argValue[HTTP_MAX_ARGS];
+        String     headerValue[HTTP_MAX_HEADERS];
+    };
+
+    struct Response {
+        size_t contentLength = CONTENT_LENGTH_NOT_SET;
+        String headers;
+        bool   started = false;
+        bool   chunked = false;
+        bool   ended = false;
+        bool   blocked = false;
+    };
+
+    enum UploadPhase : uint8_t {
+        UP_IDLE,
+        UP_PREAMBLE,        // up to the first delimiter
+        UP_DELIM,           // "\r\n" (next part) or "--" (end)
+        UP_PART_HEAD,
+        UP_FILE,
+        UP_FIELD,
+        UP_DONE
+    };
+
+    // socket events
+    void acceptClients();
+    void evictIdle();
+    void readConn(Conn& c);
+    void writeConn(Conn& c);
+    void closeConn(Conn& c);
+    void checkTimeouts();
+
+    // request
+    void process(Conn& c);
+    bool parseHead(Conn& c, size_t headLen);
+    void parseArgs(Request& r, const char* s, size_t len);
+    void addArg(Request& r, const String& name, const String& value);
+    void consume(Conn& c, size_t n);
+    void dispatch(Conn& c);
+    void responseDone(Conn& c);
+    void fail(Conn& c, int code, const char* text);
+
+    // multipart upload
+    bool startUpload(Conn& c);
+    size_t feedUpload(Conn& c, const char* data, size_t len, bool last);
+    void uploadData(const char* data, size_t len);
+    void uploadEvent(HTTPUploadStatus status);
+
+    // response
+    void beginResponse(int code, const char* type, size_t len);
+    void put(const void* data, size_t len);
+    bool grow(Conn& c, size_t need);
+    bool drain(Conn& c);
+    size_t streamSource(HttpSource* src, size_t size, const String& type, bool gz);
+
+    HttpTicket ticket(const Conn& c) const;
+    Conn* find(HttpTicket t) const;
+
+    uint16_t listenPort;
+    int      listenFd = -1;
+    uint32_t nextSerial = 1;
+
+    Conn     conns[HTTP_MAX_CONN];
+    Request  reqs[HTTP_MAX_CONN];
+
+    Route    routes[HTTP_MAX_ROUTES];
+    uint8_t  routeCount = 0;
+    THandlerFunction notFound;
+
+    String   headerKeys[HTTP_MAX_HEADERS];
+    uint8_t  headerKeyCount = 0;
+
+    // handler context
+    Conn*    cur = nullptr;
+    Request  noRequest;
+    Request* req = &noRequest;      // reqs[] of cur while a handler runs
+    Response resp;
+
+    // the one upload in progress
+    HTTPUpload  up;
+    Conn*       upConn = nullptr;
+    UploadPhase upPhase = UP_IDLE;
+    String      upDelim;            // "\r\n--" + boundary
+    String      upField;
+
+    HttpServerStats st;
+};
@@ -1,136 +1,334 @@
-
-#include "py_log.h"
-#include <Arduino.h>
-#include <Preferences.h>
-#include "esp_log.h"
-#include "config.h"
-
-extern AppConfig config;
-
-//static const int MAX_PLOG = 200;
-
-// ---------------------------------------------------------
-// Timestamp: YYYY.MM.DD hh:mm:ss,ms
-// ---------------------------------------------------------
-String getTimestampWithMs() {
-    time_t now;
-    time(&now);
-
-    struct tm timeinfo;
-    localtime_r(&now, &timeinfo);
-
-    unsigned long ms = millis() % 1000;
-
-    char buf[40];
-    snprintf(
-        buf, sizeof(buf),
-        "%04d.%02d.%02d %02d:%02d:%02d,%03lu",
-        timeinfo.tm_year + 1900,
-        timeinfo.tm_mon + 1,
-        timeinfo.tm_mday,
-        timeinfo.tm_hour,
-        timeinfo.tm_min,
-        timeinfo.tm_sec,
-        ms
-    );
-
-    return String(buf);
-}
-
-// ---------------------------------------------------------
-// Web-Log Buffer
-// ---------------------------------------------------------
-static String webLog;
-
-void WebLog(const String& msg) {
-    webLog += msg + "\n";
-
-    if (webLog.length() > 8000) {
-        webLog.remove(0, 2000);
-    }
-}
-
-String WebLogGet() {
-    return webLog;
-}
-
-void WebLogClear() {
-    webLog = "";
-}
-
-// ---------------------------------------------------------
-// Main-Logfunction
-// ---------------------------------------------------------
-void Log(LogLevel lvl, const String& msg) {
-
-    // --- Log-Level-Filter ---
-    if ((lvl == LOG_INFO  && !config.logInfo)  ||
-        (lvl == LOG_WARN  && !config.logWarn)  ||
-        (lvl == LOG_ERROR && !config.logError) ||
-        (lvl == LOG_DEBUG && !config.logDebug)) {
-        return;
-    }
-
-    // --- Zeitstempel ---
-    String ts = getTimestampWithMs() + " ";
-
-    // --- Prefix ---
-    String prefix;
-    switch (lvl) {
-        case LOG_INFO:  prefix = "[INFO] ";  break;
-        case LOG_WARN:  prefix = "[WARN] ";  break;
-        case LOG_ERROR: prefix = "[ERROR] "; break;
-        case LOG_DEBUG: prefix = "[DEBUG] "; break;
-    }
-
-    String line = ts + prefix + msg;
-
-    // --- ESP_LOG ---
-    switch (lvl) {
-        case LOG_INFO:  ESP_LOGI("Pylontech", "%s", line.c_str()); break;
-        case LOG_WARN:  ESP_LOGW("Pylontech", "%s", line.c_str()); break;
-        case LOG_ERROR: ESP_LOGE("Pylontech", "%s", line.c_str()); break;
-        case LOG_DEBUG: ESP_LOGD("Pylontech", "%s", line.c_str()); break;
-    }
-
-    // --- Web-Log ---
-    WebLog(line);
-
-    // --- Serial ---
-    Serial.println(line);
-    // Optional persistent log
-    //PersistentLog(line);
-}
-
-static Preferences plogPrefs;
-
-//void PersistentLog(const String& msg) {
-//    if (!persistentLoggingEnabled) return;
-//
-//    plogPrefs.begin("plog", false);
-//
-//    int count = plogPrefs.getInt("count", 0);
-//    String key = "e" + String(count % MAX_PLOG);
-
-//    plogPrefs.putString(key.c_str(), msg);
-//    plogPrefs.putInt("count", count + 1);
-//
-//    plogPrefs.end();
-//}
-
-//String PersistentLogDump() {
-//    plogPrefs.begin("plog", true);
-
-//    int count = plogPrefs.getInt("count", 0);
-//    int start = max(0, count - MAX_PLOG);
-
-//    String out = "";
-
-//    for (int i = start; i < count; i++) {
-//        String key = "e" + String(i % MAX_PLOG);
-//        out += plogPrefs.getString(key.c_str(), "") + "\n";
-//    }
-
-//    plogPrefs.end();
-//    return out;
-//}
+#include "py_log.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include "config.h"
+
+extern AppConfig config;
+
+//static const int MAX_PLOG = 200;
+
+// ---------------------------------------------------------
+// Record ring (multi producer, lock free)
+// ---------------------------------------------------------
+// head counts records ever reserved; record i lives in ring[i % SIZE].
+// A writer reserves i with fetch_add, claims the slot by a CAS of seq
+// to LOG_SEQ(i) | LOG_BUSY, fills it and publishes it by storing
+// LOG_SEQ(i). Readers accept a slot only if seq matches before and
+// after the copy.
+// Two writers can only meet in one slot when the ring is lapped while
+// one of them is preempted (LOG_RING_SIZE newer records). The claim
+// keeps them apart: whoever finds the slot busy or already holding a
+// newer record drops its own record (logDropped) instead of writing
+// over the other one.
+// ---------------------------------------------------------
+#define LOG_BUSY        0x80000000u
+#define LOG_SEQ(i)      (((i) + 1) & ~LOG_BUSY)
+struct LogRecord {
+    std::atomic<uint32_t> seq;  // LOG_SEQ(i) when complete, | LOG_BUSY while written
+    uint32_t    ms;             // millis()
+    uint32_t    epoch;          // time(), 0 = not set
+    uint8_t     level;
+    uint8_t     module;
+    uint8_t     argLen;
+    uint8_t     reserved;
+    const char* fmt;
+    uint8_t     args[LOG_ARG_BYTES];
+};
+
+struct LogCopy {
+    uint32_t    ms;
+    uint32_t    epoch;
+    uint8_t     level;
+    uint8_t     module;
+    uint8_t     argLen;
+    const char* fmt;
+    uint8_t     args[LOG_ARG_BYTES];
+};
+
+static LogRecord logRing[LOG_RING_SIZE];
+static std::atomic<uint32_t> logHead{0};
+static std::atomic<uint32_t> logDropped{0};
+
+static uint32_t serialTail = 0;     // LogPump (noncritical task)
+static uint32_t webStart = 0;       // WebLogClear()
+
+static const char* const LEVEL_PREFIX[] = { "[INFO] ", "[WARN] ", "[ERROR] ", "[DEBUG] " };
+static const char* const MODULE_NAME[]  = { "", "UART", "PARSER", "MQTT", "SCHED", "WEB", "WIFI" };
+
+// ---------------------------------------------------------
+// Writer
+// ---------------------------------------------------------
+bool LogEnabled(LogLevel lvl) {
+    switch (lvl) {
+        case LOG_INFO:  return config.logInfo;
+        case LOG_WARN:  return config.logWarn;
+        case LOG_ERROR: return config.logError;
+        case LOG_DEBUG: return config.logDebug;
+    }
+    return false;
+}
+
+void LogWrite(LogLevel lvl, LogModule mod, const char* fmt, const LogArgs& args) {
+    uint32_t i = logHead.fetch_add(1, std::memory_order_relaxed);
+    LogRecord& r = logRing[i % LOG_RING_SIZE];
+    uint32_t want = LOG_SEQ(i);
+
+    // claim: only a free slot holding an older record
+    uint32_t cur = r.seq.load(std::memory_order_relaxed);
+    do {
+        uint32_t age = (want - cur) & ~LOG_BUSY;   // records between both, mod 2^31
+        if ((cur & LOG_BUSY) || age == 0 || age > 0x40000000u) {
+            logDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!r.seq.compare_exchange_weak(cur, want | LOG_BUSY,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    time_t now;
+    time(&now);
+
+    r.ms     = millis();
+    r.epoch  = config.isSystemTimeValid() ? (uint32_t)now : 0;
+    r.level  = lvl;
+    r.module = mod;
+    r.argLen = args.len;
+    r.fmt    = fmt;
+    memcpy(r.args, args.buf, args.len);
+
+    r.seq.store(want, std::memory_order_release);
+}
+
+uint32_t LogDropped() {
+    return logDropped.load(std::memory_order_relaxed);
+}
+
+void LogArgs::add(const String& s) {
+    putStr(s.c_str());
+}
+
+void Log(LogLevel lvl, const String& msg) {
+    if (!LogEnabled(lvl)) return;
+    LogArgs a;
+    a.putStr(msg.c_str());
+    LogWrite(lvl, LOGM_SYS, "%s", a);
+}
+
+// ---------------------------------------------------------
+// Reader side
+// ---------------------------------------------------------
+// false: slot not written yet, still being written or overwritten
+static bool logRead(uint32_t i, LogCopy& c) {
+    const LogRecord& r = logRing[i % LOG_RING_SIZE];
+
+    if (r.seq.load(std::memory_order_acquire) != LOG_SEQ(i)) return false;
+
+    c.ms     = r.ms;
+    c.epoch  = r.epoch;
+    c.level  = r.level;
+    c.module = r.module;
+    c.argLen = r.argLen;
+    c.fmt    = r.fmt;
+    memcpy(c.args, r.args, r.argLen <= LOG_ARG_BYTES ? r.argLen : LOG_ARG_BYTES);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return r.seq.load(std::memory_order_relaxed) == LOG_SEQ(i);
+}
+
+// One conversion with the stored argument (type from the tag byte)
+static int logFormatArg(char* out, size_t cap, const char* spec, size_t specLen,
+                        char conv, const uint8_t* args, uint8_t& pos, uint8_t len) {
+    if (pos >= len) return snprintf(out, cap, "?");
+
+    char tag = (char)args[pos++];
+
+    // spec without length modifiers ("%-08.3" + conversion)
+    char f[24];
+    size_t n = 0;
+    for (size_t k = 0; k < specLen && n < sizeof(f) - 4; k++) {
+        char ch = spec[k];
+        if (ch == 'h' || ch == 'l' || ch == 'z' || ch == 'j' || ch == 't' || ch == 'L') continue;
+        f[n++] = ch;
+    }
+
+    if (tag == 's') {
+        const char* s = (const char*)args + pos;
+        pos += strlen(s) + 1;
+        f[n++] = 's';
+        f[n] = '\0';
+        return snprintf(out, cap, f, s);
+    }
+
+    double  d = 0;
+    int64_t q = 0;
+
+    switch (tag) {
+        case 'i': { int32_t v;  memcpy(&v, args + pos, 4); pos += 4; q = v; d = v; break; }
+        case 'u': { uint32_t v; memcpy(&v, args + pos, 4); pos += 4; q = v; d = v; break; }
+        case 'q': { int64_t v;  memcpy(&v, args + pos, 8); pos += 8; q = v; d = (double)v; break; }
+        case 'Q': { uint64_t v; memcpy(&v, args + pos, 8); pos += 8; q = (int64_t)v; d = (double)v; break; }
+        case 'f': { memcpy(&d, args + pos, 8); pos += 8; q = (int64_t)d; break; }
+        case 'p': { void* p; memcpy(&p, args + pos, sizeof(p)); pos += sizeof(p);
+                    return snprintf(out, cap, "%p", p); }
+        default:  pos = len; return snprintf(out, cap, "?");
+    }
+
+    if (strchr("fFeEgGaA", conv)) {
+        f[n++] = conv;
+        f[n] = '\0';
+        return snprintf(out, cap, f, d);
+    }
+    if (conv == 'c') {
+        f[n++] = 'c';
+        f[n] = '\0';
+        return snprintf(out, cap, f, (int)q);
+    }
+    if (conv == 's') {
+        // number passed for %s → decimal text
+        return snprintf(out, cap, "%lld", (long long)q);
+    }
+
+    f[n++] = 'l';
+    f[n++] = 'l';
+    f[n++] = conv;
+    f[n] = '\0';
+    return snprintf(out, cap, f, (long long)q);
+}
+
+// "YYYY.MM.DD hh:mm:ss,ms [LEVEL] [MODULE] message"
+static size_t logFormat(const LogCopy& c, char* out, size_t cap) {
+    size_t len = 0;
+
+    if (c.epoch != 0) {
+        time_t t = c.epoch;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        len = snprintf(out, cap, "%04d.%02d.%02d %02d:%02d:%02d,%03lu ",
+                       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                       tm.tm_hour, tm.tm_min, tm.tm_sec,
+                       (unsigned long)(c.ms % 1000));
+    } else {
+        // no NTP time yet → uptime
+        len = snprintf(out, cap, "+%lu.%03lu ",
+                       (unsigned long)(c.ms / 1000), (unsigned long)(c.ms % 1000));
+    }
+
+    if (len < cap && c.level <= LOG_DEBUG)
+        len += snprintf(out + len, cap - len, "%s", LEVEL_PREFIX[c.level]);
+    if (len < cap && c.module != LOGM_SYS && c.module <= LOGM_WIFI)
+        len += snprintf(out + len, cap - len, "[%s] ", MODULE_NAME[c.module]);
+
+    uint8_t pos = 0;
+    for (const char* p = c.fmt; *p && len + 1 < cap; p++) {
+        if (*p != '%') {
+            out[len++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p++;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        const char* spec = p;
+        const char* q = p + 1;
+        while (*q && !strchr("diouxXcsfFeEgGaAp", *q)) q++;
+        if (!*q) break;
+
+        len += logFormatArg(out + len, cap - len, spec, q - spec, *q, c.args, pos, c.argLen);
+        p = q;
+    }
+
+    if (len >= cap) len = cap - 1;
+    out[len] = '\0';
+    return len;
+}
+
+// ---------------------------------------------------------
+// Serial output (deferred)
+// ---------------------------------------------------------
+void LogPump() {
+    uint32_t head = logHead.load(std::memory_order_acquire);
+    char line[LOG_LINE_LEN];
+    LogCopy c;
+
+    if (head - serialTail > LOG_RING_SIZE) {
+        Serial.printf("[LOG] %lu lines lost\n", (unsigned long)(head - serialTail - LOG_RING_SIZE));
+        serialTail = head - LOG_RING_SIZE;
+    }
+
+    for (uint8_t n = 0; serialTail != head && n < 16; n++) {
+        if (!logRead(serialTail, c)) {
+            // still being written → next call; overwritten → skip
+            if (logHead.load(std::memory_order_relaxed) - serialTail <= LOG_RING_SIZE) break;
+            serialTail++;
+            continue;
+        }
+        logFormat(c, line, sizeof(line));
+        Serial.println(line);
+        serialTail++;
+    }
+}
+
+// ---------------------------------------------------------
+// Web-Log (last LOG_RING_SIZE records)
+// ---------------------------------------------------------
+String WebLogGet() {
+    uint32_t head = logHead.load(std::memory_order_acquire);
+    uint32_t start = head > LOG_RING_SIZE ? head - LOG_RING_SIZE : 0;
+    if (start < webStart) start = webStart;
+
+    String out;
+    out.reserve((head - start) * 80);
+
+    char line[LOG_LINE_LEN];
+    LogCopy c;
+
+    for (uint32_t i = start; i != head; i++) {
+        if (!logRead(i, c)) continue;
+        logFormat(c, line, sizeof(line));
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+void WebLogClear() {
+    webStart = logHead.load(std::memory_order_acquire);
+}
+
+static Preferences plogPrefs;
+
+//void PersistentLog(const String& msg) {
+//    if (!persistentLoggingEnabled) return;
+//
+//    plogPrefs.begin("plog", false);
+//
+//    int count = plogPrefs.getInt("count", 0);
+//    String key = "e" + String(count % MAX_PLOG);
+
+//    plogPrefs.putString(key.c_str(), msg);
+//    plogPrefs.putInt("count", count + 1);
+//
+//    plogPrefs.end();
+//}
+
+//String PersistentLogDump() {
+//    plogPrefs.begin("plog", true);
+
+//    int count = plogPrefs.getInt("count", 0);
+//    int start = max(0, count - MAX_PLOG);
+
+//    String out = "";
+
+//    for (int i = start; i < count; i++) {
+//        String key = "e" + String(i % MAX_PLOG);
+//        out += plogPrefs.getString(key.c_str(), "") + "\n";
+//    }
+
+//    plogPrefs.end();
+//    return out;
+//}
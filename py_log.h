@@ -1,21 +1,167 @@
-#pragma once
-#include <Arduino.h>
-//#include "web/wp_ui.h"
-
-enum LogLevel {
-    LOG_INFO,
-    LOG_WARN,
-    LOG_ERROR,
-    LOG_DEBUG
-};
-
-void Log(LogLevel lvl, const String& msg);
-
-void WebLog(const String& msg);
-String WebLogGet();
-//void WebLogClear();
-
-//void PersistentLog(const String& msg);
-//String PersistentLogDump();
-//extern bool persistentLoggingEnabled;
-
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class String;   // Arduino, only by reference (parsers build without it)
+//#include "web/wp_ui.h"
+
+// ---------------------------------------------------------
+// Logging (lock-free ring of binary records)
+// ---------------------------------------------------------
+// Writers (any task) only reserve a slot with one atomic add and copy
+// the format pointer + typed arguments into it - no String, no heap,
+// no localtime_r. Formatting happens in the readers:
+//   LogPump()     noncritical task → Serial
+//   WebLogGet()   /api/log
+//
+// The format string must be a literal (only its pointer is stored);
+// %s arguments are copied into the record. Supported conversions:
+// d i u x X o c s f F e E g G p %% with flags / width / precision
+// (no '*'). Arguments that do not fit LOG_ARG_BYTES are cut.
+// ---------------------------------------------------------
+
+enum LogLevel {
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_DEBUG
+};
+
+enum LogModule : uint8_t {
+    LOGM_SYS,
+    LOGM_UART,
+    LOGM_PARSER,
+    LOGM_MQTT,
+    LOGM_SCHED,
+    LOGM_WEB,
+    LOGM_WIFI
+};
+
+#define LOG_RING_SIZE   64      // records, power of two
+#define LOG_ARG_BYTES   104     // record = 128 bytes
+#define LOG_LINE_LEN    192     // formatted line (reader side)
+
+// Typed argument blob of one record: tag byte + raw value bytes
+struct LogArgs {
+    uint8_t buf[LOG_ARG_BYTES];
+    uint8_t len = 0;
+
+    void put(char tag, const void* p, size_t n) {
+        if (len + 1 + n > LOG_ARG_BYTES) return;
+        buf[len++] = (uint8_t)tag;
+        memcpy(buf + len, p, n);
+        len += n;
+    }
+
+    void putInt(int32_t v)    { put('i', &v, sizeof(v)); }
+    void putUInt(uint32_t v)  { put('u', &v, sizeof(v)); }
+    void putDouble(double v)  { put('f', &v, sizeof(v)); }
+
+    void putStr(const char* s) {
+        if (!s) s = "(null)";
+        if (len + 2 > LOG_ARG_BYTES) return;
+        size_t n = strlen(s);
+        size_t room = LOG_ARG_BYTES - len - 2;
+        if (n > room) n = room;                 // cut, stays NUL terminated
+        buf[len++] = 's';
+        memcpy(buf + len, s, n);
+        len += n;
+        buf[len++] = 0;
+    }
+
+    void add(bool v)                { putInt(v); }
+    void add(char v)                { putInt(v); }
+    void add(signed char v)         { putInt(v); }
+    void add(unsigned char v)       { putUInt(v); }
+    void add(short v)               { putInt(v); }
+    void add(unsigned short v)      { putUInt(v); }
+    void add(int v)                 { putInt(v); }
+    void add(unsigned v)            { putUInt(v); }
+    void add(long v)                { putInt((int32_t)v); }
+    void add(unsigned long v)       { putUInt((uint32_t)v); }
+    void add(long long v)           { put('q', &v, sizeof(v)); }
+    void add(unsigned long long v)  { put('Q', &v, sizeof(v)); }
+    void add(float v)               { putDouble(v); }
+    void add(double v)              { putDouble(v); }
+    void add(const char* s)         { putStr(s); }
+    void add(const String& s);      // py_log.cpp
+    void add(const void* p)         { put('p', &p, sizeof(p)); }
+
+    void addAll() {}
+
+    template <typename T, typename... Rest>
+    void addAll(const T& v, const Rest&... rest) {
+        add(v);
+        addAll(rest...);
+    }
+};
+
+// Runtime level filter (config.logInfo / logWarn / logError / logDebug)
+bool LogEnabled(LogLevel lvl);
+
+// Append one record (format literal + encoded arguments)
+void LogWrite(LogLevel lvl, LogModule mod, const char* fmt, const LogArgs& args);
+
+// Records dropped because their slot was still in use (ring lapped)
+uint32_t LogDropped();
+
+template <typename... Args>
+void LogF(LogLevel lvl, LogModule mod, const char* fmt, const Args&... args) {
+    if (!LogEnabled(lvl)) return;
+    LogArgs a;
+    a.addAll(args...);
+    LogWrite(lvl, mod, fmt, a);
+}
+
+// Prebuilt message (copied into the record, cut at LOG_ARG_BYTES)
+void Log(LogLevel lvl, const String& msg);
+
+// ---------------------------------------------------------
+// Front-end macros: LOGE / LOGW / LOGI / LOGD(module, fmt, args...)
+// ---------------------------------------------------------
+// LOG_COMPILE_LEVEL removes everything above it at compile time (the
+// call is still type-checked). The runtime level is checked before
+// the arguments are evaluated, so a disabled LOGD costs one config
+// read and no String / no formatting:
+//
+//   LOGD(LOGM_UART, "RX len=%u in %lu ms", recvLen, rxTotalMs);
+// ---------------------------------------------------------
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Record without a second level check (caller already checked)
+template <typename... Args>
+void LogEmit(LogLevel lvl, LogModule mod, const char* fmt, const Args&... args) {
+    LogArgs a;
+    a.addAll(args...);
+    LogWrite(lvl, mod, fmt, a);
+}
+
+#define LOG_AT(lvl, sev, mod, ...)                                  \
+    do {                                                            \
+        if ((sev) <= LOG_COMPILE_LEVEL && LogEnabled(lvl))          \
+            LogEmit(lvl, mod, __VA_ARGS__);                         \
+    } while (0)
+
+#define LOGE(mod, ...)  LOG_AT(LOG_ERROR, LOG_LEVEL_ERROR, mod, __VA_ARGS__)
+#define LOGW(mod, ...)  LOG_AT(LOG_WARN,  LOG_LEVEL_WARN,  mod, __VA_ARGS__)
+#define LOGI(mod, ...)  LOG_AT(LOG_INFO,  LOG_LEVEL_INFO,  mod, __VA_ARGS__)
+#define LOGD(mod, ...)  LOG_AT(LOG_DEBUG, LOG_LEVEL_DEBUG, mod, __VA_ARGS__)
+
+// Noncritical task: formatted records → Serial (bounded per call)
+void LogPump();
+
+String WebLogGet();
+void WebLogClear();
+
+//void PersistentLog(const String& msg);
+//String PersistentLogDump();
+//extern bool persistentLoggingEnabled;
@@ -1,1046 +1,2122 @@
-#pragma once
-
-#include "py_log.h"
-#include "config.h"
-#include "py_parser_pwr.h"
-#include "py_parser_bat.h"
-#include "py_parser_stat.h"
-#include "py_mqtt.h"
-#include <WiFi.h>
-#include <map>
-#include <set>
-
-/* ---------------------------------------------------------------------------
-   GLOBAL STATE
-   ---------------------------------------------------------------------------
-   This file implements the MQTT publishing and Home Assistant discovery
-   system for the Pylontech Monitor. It uses a double-buffered ParsedData
-   structure and a discovery state machine to ensure stable MQTT output.
---------------------------------------------------------------------------- */
-
-// Queue from main application (Task 1 → Task 2)
-extern QueueHandle_t mqttQueue;
-
-// Parser state flags
-bool parserHasData        = false;
-bool newParserData        = false;
-bool statParserHasData    = false;
-int  statParserModuleIndex = 0;
-bool batParserHasData     = false;
-int  batParserModuleIndex  = 0;
-
-// Discovery triggers
-bool discoveryPwrNeeded   = false;
-bool discoveryBatNeeded   = false;
-bool discoveryStatNeeded  = false;
-
-// Discovery tracking (modules already announced)
-std::set<int> discoveredPwr;
-std::set<int> discoveredBat;
-std::set<int> discoveredStat;
-
-// Discovery state machine
-enum DiscoveryPhase {
-    DISC_IDLE,
-    DISC_STACK,
-    DISC_PWR,
-    DISC_BAT,
-    DISC_STAT,
-    DISC_DONE
-};
-
-static DiscoveryPhase discoveryPhase = DISC_IDLE;
-
-// Discovery indices
-static size_t discPwrIndex   = 0;
-static size_t discBatModule  = 0;
-static size_t discBatCell    = 0;
-static size_t discBatField   = 0;
-static size_t discStatModule = 0;
-static size_t discStatField  = 0;
-
-// Reconnect timers
-static unsigned long lastReconnectAttempt = 0;
-static unsigned long wifiConnectedSince   = 0;
-
-// Double-buffer for parser data
-//ParsedData bufferA;
-//ParsedData bufferB;
-//volatile bool useA = true;
-
-// MQTT instance
-PyMqtt py_mqtt;
-
-int PyMqtt::precisionForUnit(const String& unit) {
-    if (unit == "V")  return 3;
-    if (unit == "A")  return 3;
-    if (unit == "°C") return 1;
-    if (unit == "Ah") return 2;
-    if (unit == "%")  return 0;
-    return 0;
-}
-
-bool PyMqtt::precisionDiffersFromDefault(const String& unit) {
-    // HA default is always 0 decimal places
-    int desired = precisionForUnit(unit);
-    return desired != 0;
-}
-
-/* ---------------------------------------------------------------------------
-   LOGGING HELPERS
-   ---------------------------------------------------------------------------
-   Unified logging wrapper to ensure consistent formatting and log levels.
---------------------------------------------------------------------------- */
-
-static void logInfo(const String& msg)  { Log(LOG_INFO,  msg); }
-static void logWarn(const String& msg)  { Log(LOG_WARN,  msg); }
-static void logError(const String& msg) { Log(LOG_ERROR, msg); }
-static void logDebug(const String& msg) { Log(LOG_DEBUG, msg); }
-
-/* ---------------------------------------------------------------------------
-   DISCOVERY RESET
-   ---------------------------------------------------------------------------
-   Resets the discovery state machine and clears module tracking.
---------------------------------------------------------------------------- */
-void PyMqtt::resetDiscovery(bool pwr, bool bat, bool stat) {
-
-    if (pwr) discoveredPwr.clear();
-    if (bat) discoveredBat.clear();
-    if (stat) discoveredStat.clear();
-
-    discoveryPhase = DISC_STACK;
-    discPwrIndex   = 0;
-    discBatModule  = 0;
-    discBatCell    = 0;
-    discBatField   = 0;
-    discStatModule = 0;
-    discStatField  = 0;
-
-    discoveryActive = true;
-
-    logInfo("MQTT: Discovery reset triggered");
-}
-
-/* ---------------------------------------------------------------------------
-   BEGIN
-   ---------------------------------------------------------------------------
-   Initializes MQTT client and marks discovery as required.
---------------------------------------------------------------------------- */
-void PyMqtt::begin() {
-    enabled = config.mqtt.enabled;
-
-    if (!enabled) {
-        logInfo("MQTT disabled in configuration");
-        return;
-    }
-
-    mqttClient.setServer(config.mqtt.server.c_str(), config.mqtt.port);
-    mqttClient.setBufferSize(2048);
-
-    // Discovery darf NICHT automatisch starten
-    discoveryPhase = DISC_IDLE;
-    discoveryActive = false;
-
-    logInfo("MQTT: BufferSize set to 2048 bytes");
-}
-
-
-/* ---------------------------------------------------------------------------
-   CONNECT
-   ---------------------------------------------------------------------------
-   Attempts to connect to the MQTT broker. Connection is delayed until WiFi
-   has been stable for at least 10 seconds to avoid rapid reconnect loops.
---------------------------------------------------------------------------- */
-bool PyMqtt::connect() {
-    if (!enabled) return false;
-    if (WiFi.status() != WL_CONNECTED) return false;
-
-    if (wifiConnectedSince == 0)
-        wifiConnectedSince = millis();
-
-    // Wait 10 seconds after WiFi connects
-    if (millis() - wifiConnectedSince < 10000)
-        return false;
-
-    String clientId = "PylontechMonitor-" + String((uint32_t)ESP.getEfuseMac());
-
-    bool ok = mqttClient.connect(
-        clientId.c_str(),
-        config.mqtt.user.c_str(),
-        config.mqtt.pass.c_str()
-    );
-
-    if (ok)
-        logInfo("MQTT connected as " + clientId);
-    else
-        logWarn("MQTT connection failed");
-
-    return ok;
-}
-
-/* ---------------------------------------------------------------------------
-   RAW PUBLISH (Task 1 → Task 2)
-   ---------------------------------------------------------------------------
-   Publishes raw messages from the queue. Used for low-level or custom topics.
---------------------------------------------------------------------------- */
-bool PyMqtt::publishRaw(const String& topic, const String& payload) {
-    if (!enabled || !mqttClient.connected()) return false;
-    return mqttClient.publish(topic.c_str(), payload.c_str());
-}
-
-/* ---------------------------------------------------------------------------
-   LOOP (Task 2)
-   ---------------------------------------------------------------------------
-   Main MQTT loop:
-   - Handles reconnects
-   - Processes queue messages
-   - Publishes PWR/BAT/STAT data
-   - Runs discovery state machine
---------------------------------------------------------------------------- */
-void PyMqtt::loop() {
-    if (!enabled) return;
-
-    // Double-buffer
-    PwrBuffer* pwr  = pwrUseA  ? &pwrA  : &pwrB;
-    BatBuffer* bat  = batUseA  ? &batA  : &batB;
-    StatBuffer* stat = statUseA ? &statA : &statB;
-
-    // WiFi check
-    if (WiFi.status() != WL_CONNECTED) {
-        wifiConnectedSince = 0;
-        return;
-    }
-
-    // MQTT reconnect
-    if (!mqttClient.connected()) {
-        if (millis() - lastReconnectAttempt > 3000) {
-            lastReconnectAttempt = millis();
-            connect();
-        }
-        return;
-    }
-
-    // ---------------------------------------------------------
-    // DISCOVERY TRIGGER (NEU: startet IMMER, wenn Flag gesetzt)
-    // ---------------------------------------------------------
-    if (discoveryPwrNeeded || discoveryBatNeeded || discoveryStatNeeded) {
-
-        logInfo("MQTT: Discovery start requested");
-
-        discoveryPhase = DISC_STACK;
-        discoveryActive = true;
-
-        discoveryPwrNeeded  = false;
-        discoveryBatNeeded  = false;
-        discoveryStatNeeded = false;
-    }
-
-    // ---------------------------------------------------------
-    // RAW QUEUE
-    // ---------------------------------------------------------
-    MqttMessage msg;
-    while (xQueueReceive(mqttQueue, &msg, 0) == pdTRUE) {
-        publishRaw(String(msg.topic), String(msg.payload));
-    }
-
-    // ---------------------------------------------------------
-    // PUBLISH PWR
-    // ---------------------------------------------------------
-    if (parserHasData) {
-        publishStack(pwr->stack);
-        for (const auto& mod : pwr->modules) {
-            if (!mod.present) continue;
-            publishBat(mod.index, mod);
-        }
-        parserHasData = false;
-    }
-
-    // ---------------------------------------------------------
-    // PUBLISH BAT CELLS
-    // ---------------------------------------------------------
-    if (batParserHasData) {
-        publishBatCells(batParserModuleIndex, bat->cells);
-        batParserHasData = false;
-    }
-
-    // ---------------------------------------------------------
-    // PUBLISH STAT
-    // ---------------------------------------------------------
-    if (statParserHasData) {
-        publishStat(statParserModuleIndex, stat->stat);
-        statParserHasData = false;
-    }
-
-    // ---------------------------------------------------------
-    // DISCOVERY STATE MACHINE
-    // ---------------------------------------------------------
-    handleDiscoveryStep(*pwr, *bat, *stat);
-
-    mqttClient.loop();
-}
-
-
-/* ---------------------------------------------------------------------------
-   DISCOVERY STATE MACHINE (FRAMEWORK ONLY)
-   ---------------------------------------------------------------------------
-   The detailed discovery functions (publishDiscoveryStack, publishDiscoveryPwr,
-   publishDiscoveryBatField, publishDiscoveryStatField) will be implemented in
-   PART 3.
---------------------------------------------------------------------------- */
-void PyMqtt::handleDiscoveryStep(
-    const PwrBuffer& pwr,
-    const BatBuffer& bat,
-    const StatBuffer& stat
-) {
-    if (!enabled || !mqttClient.connected()) return;
-
-    switch (discoveryPhase) {
-
-        case DISC_IDLE:
-        case DISC_DONE:
-            return;
-
-        case DISC_STACK:
-            publishDiscoveryStack();
-            discoveryPhase = DISC_PWR;
-            discPwrIndex = 0;
-            return;
-
-        case DISC_PWR:
-            if (discPwrIndex >= pwr.modules.size()) {
-                discoveryPhase = DISC_BAT;
-                discBatModule = 0;
-                return;
-            }
-            if (!pwr.modules[discPwrIndex].present) {
-                discPwrIndex++;
-                return;
-            }
-            publishDiscoveryPwrModule(pwr.modules[discPwrIndex].index);
-            discPwrIndex++;
-            return;
-
-        case DISC_BAT:
-            if (discBatModule >= pwr.modules.size()) {
-                discoveryPhase = DISC_STAT;
-                discStatModule = 0;
-                return;
-            }
-            if (!pwr.modules[discBatModule].present) {
-                discBatModule++;
-                return;
-            }
-            for (size_t i = 0; i < bat.cells.size(); i++) {
-                publishDiscoveryBatCell(pwr.modules[discBatModule].index, i);
-                vTaskDelay(5);
-            }
-            discBatModule++;
-            return;
-
-        case DISC_STAT:
-            if (discStatModule >= pwr.modules.size()) {
-                discoveryPhase = DISC_DONE;
-                return;
-            }
-            if (!pwr.modules[discStatModule].present) {
-                discStatModule++;
-                return;
-            }
-            publishDiscoveryStatModule(pwr.modules[discStatModule].index);
-            discStatModule++;
-            return;
-    }
-}
-
-/* ---------------------------------------------------------------------------
-   NAME NORMALIZATION
-   ---------------------------------------------------------------------------
-   Converts display names into safe MQTT/JSON identifiers:
-   - Removes spaces and special characters
-   - Converts to CamelCase
-   - Ensures Home Assistant compatibility
---------------------------------------------------------------------------- */
-String PyMqtt::normalizeName(const String& in) {
-    String out;
-    bool upperNext = true;
-
-    for (char c : in) {
-        if (c == ' ' || c == '_' || c == '-' || c == '.') {
-            upperNext = true;
-            continue;
-        }
-        if (!isalnum(c)) continue;
-
-        if (upperNext) {
-            out += (char)toupper(c);
-            upperNext = false;
-        } else {
-            out += (char)c;
-        }
-    }
-    return out;
-}
-
-/* ---------------------------------------------------------------------------
-   ID SANITIZER
-   ---------------------------------------------------------------------------
-   Builds Home Assistant safe identifiers:
-   - lowercase
-   - only [a-z0-9_]
-   - spaces and separators → underscore
---------------------------------------------------------------------------- */
-static String sanitizeId(const String& in) {
-    String out;
-    out.reserve(in.length());
-    for (char c : in) {
-        if (c >= 'A' && c <= 'Z') {
-            out += char(c + 32); // tolower
-        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
-            out += c;
-        } else if (c == '_' || c == '-' || c == ' ' || c == '/' || c == '.') {
-            out += '_';
-        } else {
-            // ignore other characters
-        }
-    }
-    return out;
-}
-
-/* ---------------------------------------------------------------------------
-   DECIMAL PRECISION BASED ON UNIT
---------------------------------------------------------------------------- */
-int PyMqtt::decimalsForUnit(const String& unit) {
-    if (unit == "V")  return 3;   // voltage
-    if (unit == "A")  return 3;   // current
-    if (unit == "°C") return 1;   // temperature
-    if (unit == "%")  return 0;   // percentage
-    if (unit == "Ah") return 3;   // capacity
-    return 0;                     // default
-}
-
-/* ---------------------------------------------------------------------------
-   DEVICE CLASS BASED ON UNIT
---------------------------------------------------------------------------- */
-String PyMqtt::deviceClassForUnit(const String& unit) {
-    if (unit == "V")  return "voltage";
-    if (unit == "A")  return "current";
-    if (unit == "°C") return "temperature";
-    if (unit == "%")  return "battery";
-    return "";
-}
-
-/* ---------------------------------------------------------------------------
-   COMPUTE VALUE (NUMERIC OR TEXT)
---------------------------------------------------------------------------- */
-String PyMqtt::computeValue(const String& raw, const FieldConfig& fc) {
-
-    // Time fields → always text
-    if (fc.factor == "date" || fc.unit == "timestamp")
-        return raw;
-
-    // Text fields → unchanged
-    if (fc.factor == "text")
-        return raw;
-
-    // Numeric conversion
-    float factor = fc.factor.toFloat();
-    float valueC = raw.toFloat() * factor;
-
-    // Time fields → convert "YYYY-MM-DD HH:MM:SS" → "YYYY-MM-DDTHH:MM:SS"
-    if (fc.factor == "date" || fc.unit == "timestamp") {
-        String iso = raw;
-        iso.replace(" ", "T");
-        return iso;
-    }
-
-
-    // Fahrenheit conversion if enabled
-    if (fc.unit == "°C" && config.battery.useFahrenheit) {
-        float valueF = valueC * 1.8f + 32.0f;
-        return String(valueF, decimalsForUnit("°F"));
-    }
-
-    return String(valueC, decimalsForUnit(fc.unit));
-}
-
-/* ---------------------------------------------------------------------------
-   BUILD MQTT TOPIC
---------------------------------------------------------------------------- */
-String PyMqtt::buildTopic(
-    const String& subtopic,
-    int moduleIndex,
-    const String& fieldName,
-    int cellIndex,
-    bool isCell
-) {
-    String prefix = config.mqtt.prefix;
-    String cellPrefix = config.mqtt.cellPrefix; // e.g. "Cell"
-
-    if (isCell) {
-        return prefix + "/" + subtopic + "/" +
-               String(moduleIndex) + "/" +
-               cellPrefix + String(cellIndex) + "_" + fieldName;
-    }
-
-    return prefix + "/" + subtopic + "/" +
-           String(moduleIndex) + "/" + fieldName;
-}
-
-/* ---------------------------------------------------------------------------
-   PUBLISH STACK JSON
---------------------------------------------------------------------------- */
-void PyMqtt::publishStack(const BatteryStack& stack) {
-    if (!enabled || !mqttClient.connected() || !parserHasData) return;
-
-    String topic = config.mqtt.prefix + "/" + config.mqtt.topicStack;
-
-    StaticJsonDocument<256> doc;
-    doc["StackVoltAvg"] = stack.avgVoltage_mV / 1000.0f;
-    doc["StackCurrSum"] = stack.totalCurrent_mA / 1000.0f;
-    doc["StackTempMax"] = stack.temperature / 1000.0f;
-    doc["BatteryCount"] = stack.batteryCount;
-
-    String payload;
-    serializeJson(doc, payload);
-
-    mqttClient.publish(topic.c_str(), payload.c_str());
-}
-
-/* ---------------------------------------------------------------------------
-   PUBLISH PWR MODULE JSON
---------------------------------------------------------------------------- */
-void PyMqtt::publishBat(int index, const BatteryModule& mod) {
-    if (!enabled || !mqttClient.connected() || !parserHasData || !mod.present)
-        return;
-
-    String subtopic = config.mqtt.topicPwr;
-    String topic = config.mqtt.prefix + "/" + subtopic + "/" + String(index);
-
-    StaticJsonDocument<512> doc;
-
-    for (auto &kv : config.battery.fieldsPwr) {
-        const String& fieldName = kv.first;
-        const FieldConfig& fc = kv.second;
-
-        if (!fc.mqtt) continue;
-
-        auto it = mod.fields.find(fieldName);
-        if (it == mod.fields.end()) continue;
-
-        String display = normalizeName(fc.display);
-        String value = computeValue(it->second, fc);
-
-        doc[display] = value.c_str();
-
-    }
-
-    config.lastMqttContact = config.getCurrentTimeString();
-
-    String payload;
-    serializeJson(doc, payload);
-
-    if (!mqttClient.publish(topic.c_str(), payload.c_str()))
-        logWarn("MQTT publish failed: " + topic);
-}
-
-/* ---------------------------------------------------------------------------
-   PUBLISH BAT CELLS JSON
---------------------------------------------------------------------------- */
-void PyMqtt::publishBatCells(int moduleIndex, const std::vector<BatData>& batCells) {
-    if (!enabled || !mqttClient.connected()) return;
-    if (batCells.empty()) return;
-
-    String subtopic = config.mqtt.topicBat;
-
-    for (const auto& cell : batCells) {
-
-        StaticJsonDocument<512> doc;
-
-        for (auto &f : cell.fields) {
-
-            // Feld existiert in der BAT-Konfiguration?
-            if (!config.battery.fieldsBat.count(f.name)) continue;
-            const FieldConfig &fc = config.battery.fieldsBat[f.name];
-            if (!fc.mqtt) continue;
-
-            // WICHTIG:
-            // Discovery benutzt fc.display als JSON-Key → Publisher muss das auch tun
-            String key   = fc.display;
-            String value = computeValue(f.raw, fc);
-
-            doc[key] = value;
-        }
-
-        String payload;
-        serializeJson(doc, payload);
-
-        String topic =
-            config.mqtt.prefix + "/" + subtopic + "/" +
-            String(moduleIndex) + "/" +
-            config.mqtt.cellPrefix + String(cell.cellIndex);
-
-        mqttClient.publish(topic.c_str(), payload.c_str());
-    }
-}
-
-/* ---------------------------------------------------------------------------
-   PUBLISH STAT JSON
---------------------------------------------------------------------------- */
-void PyMqtt::publishStat(int moduleIndex, const StatData& stat) {
-    if (!enabled || !mqttClient.connected()) return;
-    if (!config.battery.enableStat) return;
-    if (stat.fields.empty()) return;
-
-    String subtopic = config.mqtt.topicStat;
-    String topic = config.mqtt.prefix + "/" + subtopic + "/" + String(moduleIndex);
-
-    StaticJsonDocument<1024> doc;
-
-    for (auto &f : stat.fields) {
-
-        if (!config.battery.fieldsStat.count(f.name)) continue;
-        const FieldConfig &fc = config.battery.fieldsStat[f.name];
-        if (!fc.mqtt) continue;
-
-        String display = normalizeName(fc.display);
-        String value = computeValue(f.raw, fc);
-
-        doc[display] = value.c_str();
-
-    }
-
-    String payload;
-    serializeJson(doc, payload);
-
-    if (!mqttClient.publish(topic.c_str(), payload.c_str()))
-        logWarn("MQTT publish failed: " + topic);
-}
-/* ---------------------------------------------------------------------------
-   BUILD DISCOVERY IDENTIFIERS
-   ---------------------------------------------------------------------------
-   Creates:
-   - unique_id
-   - object_id
-   - friendly_name
-   - discovery topic
---------------------------------------------------------------------------- */
-void PyMqtt::buildDiscoveryIds(
-    String& uniqueId,
-    String& objectId,
-    String& friendlyName,
-    String& discoveryTopic,
-    const String& subtopic,
-    int moduleIndex,
-    const String& displayName,
-    int cellIndex,
-    bool isCell
-) {
-    String prefix     = config.mqtt.prefix;
-    String cellPrefix = config.mqtt.cellPrefix; // e.g. "Cell"
-
-    // Base name: BAT5_Cell13_Voltage
-    String base;
-    if (isCell)
-        base = subtopic + String(moduleIndex) + "_" +
-               cellPrefix + String(cellIndex) + "_" + displayName;
-    else
-        base = subtopic + String(moduleIndex) + "_" + displayName;
-
-    // unique_id: Pylontech_BAT5_Cell13_Voltage
-    uniqueId = prefix + "_" + base;
-
-    // object_id: BAT5_Cell13_Voltage
-    objectId = base;
-
-    // friendly_name: Pylontech BAT5 Cell13 Voltage
-    if (isCell)
-        friendlyName = prefix + " " + subtopic + String(moduleIndex) +
-                       " " + cellPrefix + String(cellIndex) + " " + displayName;
-    else
-        friendlyName = prefix + " " + subtopic + String(moduleIndex) +
-                       " " + displayName;
-
-    // Discovery topic:
-    // homeassistant/sensor/Pylontech_BAT5_Cell13_Voltage/config
-    discoveryTopic =
-        "homeassistant/sensor/" + uniqueId + "/config";
-}
-
-/* ---------------------------------------------------------------------------
-   ADD DISCOVERY METADATA (unit, device_class, precision)
---------------------------------------------------------------------------- */
-void PyMqtt::addDiscoveryMeta(
-    JsonDocument& doc,
-    const FieldConfig& fc
-) {
-    // Time fields → no metadata
-    if (fc.factor == "date" || fc.unit == "timestamp")
-        return;
-
-    // Numeric fields
-    int dec = decimalsForUnit(fc.unit);
-    String devClass = deviceClassForUnit(fc.unit);
-
-    if (devClass.length() > 0)
-        doc["device_class"] = devClass;
-
-    if (fc.unit.length() > 0)
-        doc["unit_of_measurement"] = fc.unit;
-
-    doc["state_class"] = "measurement";
-    doc["suggested_display_precision"] = dec;
-}
-
-/* ---------------------------------------------------------------------------
-   DISCOVERY: STACK
---------------------------------------------------------------------------- */
-void PyMqtt::publishDiscoveryStack() {
-    if (!enabled || !mqttClient.connected()) return;
-
-    String prefix = config.mqtt.prefix;
-    String sub    = config.mqtt.topicStack;
-    String stateTopic = prefix + "/" + sub;
-
-    // Cleaned prefix for IDs
-    String prefixId = sanitizeId(prefix);
-
-    StaticJsonDocument<256> docStack;
-    docStack["StackVoltAvg"] = lastParsedStack.avgVoltage_mV / 1000.0f;
-    docStack["StackCurrSum"] = lastParsedStack.totalCurrent_mA / 1000.0f;
-    docStack["StackTempMax"] = lastParsedStack.temperature / 1000.0f;
-    docStack["BatteryCount"] = lastParsedStack.batteryCount;
-
-    for (JsonPair kv : docStack.as<JsonObject>()) {
-
-        String key = kv.key().c_str();   // z.B. "StackVoltAvg"
-        String fullName = key;           // Anzeigename in HA
-
-        // Build unique_id and entity_id from cleaned prefix + key
-        String uniqueId = prefixId + "_stack_" + sanitizeId(key);
-
-        String entityId = uniqueId;      // HA macht später sensor.<entityId>
-        // entityId ist bereits lowercase/safe durch sanitizeId
-
-        String discTopic = "homeassistant/sensor/" + uniqueId + "/config";
-
-        StaticJsonDocument<512> doc;
-
-        // Sichtbarer Name in HA (unverändert)
-        doc["name"]   = fullName;
-        doc["uniq_id"] = uniqueId;
-        doc["obj_id"]  = entityId;
-
-        doc["state_topic"]    = stateTopic;
-        doc["value_template"] = "{{ value_json." + key + " }}";
-
-        // Unit detection
-        String unit = "";
-        if (key == "StackVoltAvg") unit = "V";
-        else if (key == "StackCurrSum") unit = "A";
-        else if (key == "StackTempMax") unit = "°C";
-        else if (key == "BatteryCount") unit = "";
-
-        // Suggested precision only if different from HA default (0)
-        if (precisionDiffersFromDefault(unit)) {
-            doc["suggested_display_precision"] = precisionForUnit(unit);
-        }
-
-        // Device class + unit
-        if (unit == "V") {
-            doc["device_class"] = "voltage";
-            doc["unit_of_measurement"] = "V";
-        }
-        else if (unit == "A") {
-            doc["device_class"] = "current";
-            doc["unit_of_measurement"] = "A";
-        }
-        else if (unit == "°C") {
-            doc["device_class"] = "temperature";
-            doc["unit_of_measurement"] = "°C";
-        }
-
-        doc["state_class"] = "measurement";
-
-        JsonObject dev = doc.createNestedObject("dev");
-        dev["ids"]  = prefixId;          // Geräte-ID auch bereinigt
-        dev["name"] = prefix + " Stack"; // sichtbarer Name unverändert
-
-        String payload;
-        serializeJson(doc, payload);
-
-        mqttClient.publish(discTopic.c_str(), payload.c_str(), true);
-
-        vTaskDelay(5);
-    }
-}
-
-/* ---------------------------------------------------------------------------
-   DISCOVERY: PWR MODULE
-   ---------------------------------------------------------------------------
-   - Visible names (doc["name"]) remain exactly as user entered them
-   - unique_id, obj_id, dev.ids are sanitized for HA compatibility
-   - JSON keys use normalizeName(fc.display) exactly like publishBat()
-   - Text + Date fields send NO metadata (HA would reject them otherwise)
---------------------------------------------------------------------------- */
-void PyMqtt::publishDiscoveryPwrModule(int moduleIndex) {
-    if (!enabled || !mqttClient.connected()) return;
-
-    String prefix      = config.mqtt.prefix;        // visible
-    String prefixId    = sanitizeId(prefix);        // HA-safe
-    String subtopic    = config.mqtt.topicPwr;      // visible
-    String subtopicId  = sanitizeId(subtopic);      // HA-safe
-    String stateTopic  = prefix + "/" + subtopic + "/" + String(moduleIndex);
-
-    for (auto &kv : config.battery.fieldsPwr) {
-
-        const String& fieldName = kv.first;
-        const FieldConfig& fc   = kv.second;
-
-        if (!fc.mqtt) continue;
-
-        // JSON key used by publisher
-        String displayKey = normalizeName(fc.display);
-
-        // Visible name in HA
-        String friendly = fc.display;
-
-        // Build unique_id (HA-safe)
-        String uniqueId =
-            prefixId + "_" +
-            subtopicId + "_" +
-            String(moduleIndex) + "_" +
-            sanitizeId(displayKey);
-
-        // Entity ID (HA will prepend sensor.)
-        String entityId = uniqueId;
-
-        // Discovery topic
-        String discTopic =
-            "homeassistant/sensor/" + uniqueId + "/config";
-
-        StaticJsonDocument<512> doc;
-
-        // Visible name in HA (unchanged)
-        doc["name"]    = friendly;
-        doc["uniq_id"] = uniqueId;
-        doc["obj_id"]  = entityId;
-
-        // State topic
-        doc["state_topic"] = stateTopic;
-
-        // Template must match publisher JSON key
-        doc["value_template"] =
-            "{{ value_json." + displayKey + " }}";
-
-        /* ---------------------------------------------------------
-           TEXT FIELDS → no metadata at all
-        --------------------------------------------------------- */
-        if (fc.factor == "text") {
-            // No device_class, no unit, no precision, no state_class
-        }
-
-        /* ---------------------------------------------------------
-           DATE/TIMESTAMP → treat as text
-           (Publisher already converts " " → "T")
-        --------------------------------------------------------- */
-        else if (fc.factor == "date" || fc.unit == "timestamp") {
-            // Also no metadata
-        }
-
-        /* ---------------------------------------------------------
-           NUMERIC FIELDS → normal metadata
-        --------------------------------------------------------- */
-        else {
-            addDiscoveryMeta(doc, fc);
-        }
-
-        // Device block
-        JsonObject dev = doc.createNestedObject("dev");
-        dev["ids"]  = prefixId + "_pwr_" + String(moduleIndex);
-        dev["name"] = prefix + " PWR " + String(moduleIndex);
-
-        // Publish retained
-        String payload;
-        serializeJson(doc, payload);
-        mqttClient.publish(discTopic.c_str(), payload.c_str(), true);
-
-        vTaskDelay(5);
-    }
-}
-/* ---------------------------------------------------------------------------
-   DISCOVERY: BAT CELL FIELD
---------------------------------------------------------------------------- */
-/* ---------------------------------------------------------------------------
-   DISCOVERY: BAT CELL FIELD
-   ---------------------------------------------------------------------------
-   - Visible names (doc["name"]) remain exactly as user entered them
-   - unique_id, obj_id, dev.ids are sanitized for HA compatibility
-   - JSON keys use fc.display exactly like publishBatCells()
---------------------------------------------------------------------------- */
-void PyMqtt::publishDiscoveryBatCell(int moduleIndex, int cellIndex) {
-    if (!enabled || !mqttClient.connected()) return;
-
-    String prefix      = config.mqtt.prefix;        // visible
-    String prefixId    = sanitizeId(prefix);        // HA-safe
-    String subtopic    = config.mqtt.topicBat;      // visible
-    String subtopicId  = sanitizeId(subtopic);      // HA-safe
-
-    String stateTopic =
-        prefix + "/" + subtopic + "/" +
-        String(moduleIndex) + "/" +
-        config.mqtt.cellPrefix + String(cellIndex);
-
-    for (auto &kv : config.battery.fieldsBat) {
-
-        const String& fieldName = kv.first;
-        const FieldConfig& fc   = kv.second;
-        if (!fc.mqtt) continue;
-
-        // JSON key used by publisher (BAT uses fc.display directly)
-        String key = fc.display;
-
-        // Visible name in HA
-        String friendly = "Cell " + String(cellIndex) + " " + fc.display;
-
-        // Build unique_id (HA-safe)
-        String uniqueId =
-            prefixId + "_" +
-            subtopicId + "_" +
-            String(moduleIndex) + "_cell" +
-            String(cellIndex) + "_" +
-            sanitizeId(key);
-
-        // Entity ID (HA will prepend sensor.)
-        String entityId = uniqueId;
-
-        // Discovery topic
-        String discTopic =
-            "homeassistant/sensor/" + uniqueId + "/config";
-
-        StaticJsonDocument<512> doc;
-
-        // Visible name in HA (unchanged)
-        doc["name"]    = friendly;
-        doc["uniq_id"] = uniqueId;
-        doc["obj_id"]  = entityId;
-
-        // State topic
-        doc["state_topic"] = stateTopic;
-
-        // Template must match publisher JSON key
-        doc["value_template"] =
-            "{{ value_json." + key + " }}";
-
-        // Unit + device_class + precision
-        bool isNumeric =
-            !(fc.factor == "text" ||
-              fc.factor == "date" ||
-              fc.unit   == "timestamp");
-
-        if (isNumeric) {
-            if (precisionDiffersFromDefault(fc.unit))
-                doc["suggested_display_precision"] = precisionForUnit(fc.unit);
-
-            if (fc.unit == "V")  doc["device_class"] = "voltage";
-            if (fc.unit == "A")  doc["device_class"] = "current";
-            if (fc.unit == "°C") doc["device_class"] = "temperature";
-            if (fc.unit == "%")  doc["device_class"] = "battery";
-            if (fc.unit == "Ah") doc["device_class"] = "energy";
-
-            if (fc.unit.length() > 0)
-                doc["unit_of_measurement"] = fc.unit;
-
-            doc["state_class"] = "measurement";
-        }
-
-        // Device block
-        JsonObject dev = doc.createNestedObject("dev");
-        dev["ids"]  = prefixId + "_bat_" + String(moduleIndex);
-        dev["name"] = prefix + " BAT " + String(moduleIndex);
-
-        // Publish retained
-        String payload;
-        serializeJson(doc, payload);
-        mqttClient.publish(discTopic.c_str(), payload.c_str(), true);
-
-        vTaskDelay(5);
-    }
-}
-/* ---------------------------------------------------------------------------
-   DISCOVERY: STAT FIELD
---------------------------------------------------------------------------- */
-/* ---------------------------------------------------------------------------
-   DISCOVERY: STAT MODULE
-   ---------------------------------------------------------------------------
-   - Visible names (doc["name"]) remain exactly as user entered them
-   - unique_id, obj_id, dev.ids are sanitized for HA compatibility
-   - JSON keys use normalizeName(fc.display) exactly like publishStat()
---------------------------------------------------------------------------- */
-void PyMqtt::publishDiscoveryStatModule(int moduleIndex) {
-    if (!enabled || !mqttClient.connected()) return;
-    if (!config.battery.enableStat) return;
-
-    String prefix      = config.mqtt.prefix;        // visible
-    String prefixId    = sanitizeId(prefix);        // HA-safe
-    String subtopic    = config.mqtt.topicStat;     // visible
-    String subtopicId  = sanitizeId(subtopic);      // HA-safe
-
-    String stateTopic =
-        prefix + "/" + subtopic + "/" + String(moduleIndex);
-
-    for (auto &kv : config.battery.fieldsStat) {
-
-        const String& fieldName = kv.first;
-        const FieldConfig& fc   = kv.second;
-        if (!fc.mqtt) continue;
-
-        // JSON key used by publisher
-        String displayKey = normalizeName(fc.display);
-
-        // Visible name in HA
-        String friendly = fc.display;
-
-        // Build unique_id (HA-safe)
-        String uniqueId =
-            prefixId + "_" +
-            subtopicId + "_" +
-            String(moduleIndex) + "_" +
-            sanitizeId(displayKey);
-
-        // Entity ID (HA will prepend sensor.)
-        String entityId = uniqueId;
-
-        // Discovery topic
-        String discTopic =
-            "homeassistant/sensor/" + uniqueId + "/config";
-
-        StaticJsonDocument<512> doc;
-
-        // Visible name in HA (unchanged)
-        doc["name"]    = friendly;
-        doc["uniq_id"] = uniqueId;
-        doc["obj_id"]  = entityId;
-
-        // State topic
-        doc["state_topic"] = stateTopic;
-
-        // Template must match publisher JSON key
-        doc["value_template"] =
-            "{{ value_json." + displayKey + " }}";
-
-        // Unit + device_class + precision
-        addDiscoveryMeta(doc, fc);
-
-        // Device block
-        JsonObject dev = doc.createNestedObject("dev");
-        dev["ids"]  = prefixId + "_stat_" + String(moduleIndex);
-        dev["name"] = prefix + " STAT " + String(moduleIndex);
-
-        // Publish retained
-        String payload;
-        serializeJson(doc, payload);
-        mqttClient.publish(discTopic.c_str(), payload.c_str(), true);
-
-        vTaskDelay(5);
-    }
+#pragma once
+
+#include "py_log.h"
+#include "config.h"
+#include "py_parser_pwr.h"
+#include "py_parser_bat.h"
+#include "py_parser_stat.h"
+#include "py_mqtt.h"
+#include "py_mqtt_offline.h"
+#include <WiFi.h>
+#include <time.h>
+#include <Preferences.h>
+#include <map>
+#include <set>
+
+/* ---------------------------------------------------------------------------
+   GLOBAL STATE
+   ---------------------------------------------------------------------------
+   This file implements the MQTT publishing and Home Assistant discovery
+   system for the Pylontech Monitor. Parser results are read from the seqlock
+   snapshots (only when their generation changed) and a discovery state
+   machine ensures stable MQTT output.
+--------------------------------------------------------------------------- */
+
+// Queue from main application (Task 1 → Task 2)
+extern QueueHandle_t mqttQueue;
+
+// Local copies of the parser snapshots (MQTT task only)
+static PwrBuffer  mqttPwr;
+static BatBuffer  mqttBat;
+static StatBuffer mqttStat;
+
+// PWR: generation of the copy / of the last completely published one.
+// BAT / STAT: position in the snapshot rings (results handled so far)
+static uint32_t pwrGen = 0, pwrPublished = 0, stackPublished = 0;
+static uint32_t batCursor = 0, statCursor = 0;
+
+// Cell count of every module's last BAT result (index = module number);
+// discovery announces each module with its own cell layout
+static uint8_t batCells[MAX_MODULES + 1];
+
+// Discovery triggers
+bool discoveryPwrNeeded   = false;
+bool discoveryBatNeeded   = false;
+bool discoveryStatNeeded  = false;
+
+// Discovery tracking (modules already announced)
+std::set<int> discoveredPwr;
+std::set<int> discoveredBat;
+std::set<int> discoveredStat;
+
+// Discovery state machine
+enum DiscoveryPhase {
+    DISC_IDLE,
+    DISC_STACK,
+    DISC_PWR,
+    DISC_BAT,
+    DISC_STAT,
+    DISC_DONE
+};
+
+static DiscoveryPhase discoveryPhase = DISC_IDLE;
+
+// Discovery indices
+static size_t discPwrIndex   = 0;
+static size_t discBatModule  = 0;
+static size_t discBatCell    = 0;
+static size_t discBatField   = 0;
+static size_t discStatModule = 0;
+static size_t discStatField  = 0;
+
+// HA birth ("homeassistant/status" = "online") → full resync
+static volatile bool haBirthPending = false;
+static bool discoveryForce  = false;
+static bool discoveryFailed = false;    // a group failed in this run
+
+// Reconnect timers
+static unsigned long lastReconnectAttempt = 0;
+static unsigned long wifiConnectedSince   = 0;
+
+// MQTT instance
+PyMqtt py_mqtt;
+
+int PyMqtt::precisionForUnit(const String& unit) {
+    if (unit == "V")  return 3;
+    if (unit == "A")  return 3;
+    if (unit == "°C") return 1;
+    if (unit == "Ah") return 2;
+    if (unit == "%")  return 0;
+    return 0;
+}
+
+bool PyMqtt::precisionDiffersFromDefault(const String& unit) {
+    // HA default is always 0 decimal places
+    int desired = precisionForUnit(unit);
+    return desired != 0;
+}
+
+/* ---------------------------------------------------------------------------
+   STREAMED PUBLISH (beginPublish / write / endPublish)
+   ---------------------------------------------------------------------------
+   The payload is rendered twice by the same function: first into a
+   counting Print (MQTT needs the length up front), then in 256 byte
+   chunks straight into the client socket. No JsonDocument, no String,
+   and the payload is not limited by the PubSubClient buffer size.
+--------------------------------------------------------------------------- */
+class CountingPrint : public Print {
+public:
+    size_t count = 0;
+    size_t write(uint8_t) override { count++; return 1; }
+    size_t write(const uint8_t*, size_t n) override { count += n; return n; }
+};
+
+class MqttChunkWriter : public Print {
+public:
+    explicit MqttChunkWriter(PubSubClient& c) : client(c) {}
+
+    size_t write(uint8_t b) override {
+        buf[len++] = b;
+        if (len == sizeof(buf)) push();
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t n) override {
+        for (size_t i = 0; i < n; i++) write(data[i]);
+        return n;
+    }
+
+    void push() {
+        if (len == 0) return;
+        sent += client.write(buf, len);
+        len = 0;
+    }
+
+    size_t sent = 0;
+
+private:
+    PubSubClient& client;
+    uint8_t buf[256];
+    size_t  len = 0;
+};
+
+// PUB_DEFERRED: outbox full (backpressure) → nothing was written, the
+// caller keeps the values unmarked and sends newer ones next cycle
+enum PubResult : uint8_t { PUB_OK, PUB_DEFERRED, PUB_FAILED };
+
+#define MQTT_MAX_PACKET  65535   // PubSubClient length fields are 16 bit
+
+// qos 1: PUB_OK once the packet is in the transport's in-flight window
+// (kept there until the PUBACK, sent again after a reconnect); a full
+// window defers like a full outbox. Packets larger than the window go
+// out with QoS 0.
+template <typename Render>
+static PubResult publishStreamed(PubSubClient& client, MqttTransport& transport,
+                                 const char* topic, Render render, bool retained = false,
+                                 uint8_t qos = 0) {
+    CountingPrint counter;
+    render(counter);
+
+    size_t packet = MqttTransport::publishSize(topic, counter.count);
+    if (packet > MQTT_MAX_PACKET) {
+        LOGW(LOGM_MQTT, "payload too large (%u bytes): %s", counter.count, topic);
+        return PUB_FAILED;
+    }
+
+    size_t packetQos1 = MqttTransport::publishSize(topic, counter.count, 1);
+    if (qos && packetQos1 <= MQTT_INFLIGHT_BYTES) {
+        if (!transport.inflightFits(packetQos1)) return PUB_DEFERRED;
+
+        bool ok = transport.beginQos1(topic, counter.count, retained);
+        if (ok) {
+            MqttChunkWriter out(client);
+            render(out);
+            out.push();
+            ok = transport.endQos1() && out.sent == counter.count;
+        }
+        return ok ? PUB_OK : PUB_FAILED;
+    }
+
+    // larger than the whole outbox (device discovery) → blocking write
+    bool big = packet > MQTT_OUTBOX_SIZE;
+    bool wasBlocking = transport.isBlocking();
+    if (big) transport.setBlocking(true);
+    else if (!transport.fits(packet)) return PUB_DEFERRED;
+
+    bool ok = client.beginPublish(topic, counter.count, retained);
+    if (ok) {
+        MqttChunkWriter out(client);
+        render(out);
+        out.push();
+        ok = client.endPublish() && out.sent == counter.count;
+    }
+
+    if (big) transport.setBlocking(wasBlocking);
+    return ok ? PUB_OK : PUB_FAILED;
+}
+
+// Single buffered publish (PubSubClient buffer) with backpressure
+static PubResult publishPacket(PubSubClient& client, MqttTransport& transport,
+                               const char* topic, const char* payload, bool retained) {
+    if (!transport.fits(MqttTransport::publishSize(topic, strlen(payload))))
+        return PUB_DEFERRED;
+    return client.publish(topic, payload, retained) ? PUB_OK : PUB_FAILED;
+}
+
+// JSON string with minimal escaping (console text never contains
+// control characters, but a quote would break the document)
+static void printJsonString(Print& out, const char* s) {
+    out.write('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') out.write('\\');
+        out.write((uint8_t)*s);
+    }
+    out.write('"');
+}
+
+/* ---------------------------------------------------------------------------
+   OFFLINE CAPTURE (store-and-forward, see py_mqtt_offline.h)
+   ---------------------------------------------------------------------------
+   While WiFi or the broker is down, loop() runs the value publishers with
+   offlineCapture set: their documents go to the flash ring instead of the
+   socket (subtopic below config.mqtt.prefix + epoch time). Stored values
+   count as published for the deadband / max-silence change detection,
+   and so do samples the store had to drop (see storeOffline()).
+   After the reconnect replayOffline() sends them to <prefix>/replay/...
+   with QoS 1: a record leaves the flash ring when it is in the
+   transport's in-flight window, which keeps it until the PUBACK (also
+   over a reconnect, not over a reboot).
+--------------------------------------------------------------------------- */
+#define OFFLINE_REPLAY_MS     250     // replay pace: burst every 250 ms
+#define OFFLINE_REPLAY_BURST  4       // records per burst
+
+static bool offlineCapture = false;
+static unsigned long lastReplay = 0;
+static char offlineDoc[OFFLINE_MAX_RECORD];
+
+// Bounded render target, len counts on after an overflow
+class BufferPrint : public Print {
+public:
+    BufferPrint(char* b, size_t c) : buf(b), cap(c) {}
+
+    size_t write(uint8_t b) override {
+        if (len < cap) buf[len] = (char)b;
+        len++;
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t n) override {
+        for (size_t i = 0; i < n; i++) write(data[i]);
+        return n;
+    }
+
+    size_t len = 0;
+
+private:
+    char*  buf;
+    size_t cap;
+};
+
+static const char* offlineSubtopic(const char* topic) {
+    const String& prefix = config.mqtt.prefix;
+    size_t n = prefix.length();
+    if (strncmp(topic, prefix.c_str(), n) == 0 && topic[n] == '/')
+        return topic + n + 1;
+    return topic;
+}
+
+// Always PUB_OK: the ring never refuses for lack of room (it drops its
+// oldest segment), and a sample it cannot take (no system time yet,
+// larger than OFFLINE_MAX_RECORD, write error) would not fit on a retry
+// either - it is dropped and counted in OfflineStats (noTime / dropped),
+// so the snapshot cursors move on.
+static PubResult storeOffline(const char* topic, const char* doc, size_t len) {
+    uint32_t ts = config.isSystemTimeValid() ? (uint32_t)time(nullptr) : 0;
+    mqttOffline.append(ts, offlineSubtopic(topic), doc, len);
+    return PUB_OK;
+}
+
+// Value documents: broker when connected, flash ring while capturing
+template <typename Render>
+static PubResult publishValues(PubSubClient& client, MqttTransport& transport,
+                               const char* topic, Render render) {
+    if (!offlineCapture)
+        return publishStreamed(client, transport, topic, render);
+
+    BufferPrint out(offlineDoc, sizeof(offlineDoc));
+    render(out);
+    return storeOffline(topic, offlineDoc, out.len);
+}
+
+static PubResult publishValuePacket(PubSubClient& client, MqttTransport& transport,
+                                    const char* topic, const char* payload) {
+    if (offlineCapture)
+        return storeOffline(topic, payload, strlen(payload));
+    return publishPacket(client, transport, topic, payload, false);
+}
+
+/* ---------------------------------------------------------------------------
+   CHANGE DETECTION (DEADBAND / MAX SILENCE)
+   ---------------------------------------------------------------------------
+   Last published value per (subtopic, module, cell, field) in a small open
+   addressing table. A topic is published when at least one of its fields
+   is due: value moved by more than FieldConfig::deadband, text changed, or
+   FieldConfig::maxSilence seconds passed (keep-alive). The whole document
+   is sent so Home Assistant templates always find every key.
+   Fields with maxSilence = 0 are always due (no entry is kept). If the
+   table is full, values are simply published every cycle.
+--------------------------------------------------------------------------- */
+#define PUB_CACHE_SIZE   1024
+#define PUB_CACHE_PROBE  16
+
+enum PubSubtopic : uint8_t { PUB_PWR, PUB_BAT, PUB_STAT };
+
+struct PubCacheEntry {
+    uint32_t key;       // 0 = empty
+    uint32_t lastMs;
+    uint32_t bits;      // float value or text hash
+};
+
+static PubCacheEntry pubCache[PUB_CACHE_SIZE];
+
+// One field value of the document about to be published
+struct PubSample {
+    uint32_t key;
+    uint32_t bits;        // float value or FNV-1a hash of the text
+    uint32_t silenceMs;   // 0 = always due
+    float    deadband;
+    bool     numeric;
+};
+
+static uint32_t pubKey(uint8_t sub, int module, int cell, int field) {
+    return ((uint32_t)(sub + 1) << 24) |
+           ((uint32_t)(module & 0xFF) << 16) |
+           ((uint32_t)(cell & 0xFF) << 8) |
+           (uint32_t)(field & 0xFF);
+}
+
+static PubCacheEntry* pubFind(uint32_t key, bool create) {
+    uint32_t h = (key * 2654435761u) % PUB_CACHE_SIZE;
+
+    for (int i = 0; i < PUB_CACHE_PROBE; i++) {
+        PubCacheEntry& e = pubCache[(h + i) % PUB_CACHE_SIZE];
+        if (e.key == key) return &e;
+        if (e.key == 0) {
+            if (!create) return nullptr;
+            e.key = key;
+            e.lastMs = 0;
+            e.bits = 0;
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+static void pubCacheClear() {
+    memset(pubCache, 0, sizeof(pubCache));
+}
+
+static void pubSample(PubSample& s, uint32_t key, const char* value, const PlanField& pf) {
+    s.key       = key;
+    s.silenceMs = pf.silenceMs;
+    s.deadband  = pf.deadband;
+    s.numeric   = (pf.kind == PLAN_NUM);
+
+    if (s.numeric) {
+        float v = atof(value);
+        memcpy(&s.bits, &v, sizeof(v));
+    } else {
+        uint32_t h = 2166136261u;              // FNV-1a
+        for (const char* p = value; *p; p++) {
+            h ^= (uint8_t)*p;
+            h *= 16777619u;
+        }
+        s.bits = h;
+    }
+}
+
+static bool pubDue(const PubSample& s, uint32_t now) {
+    if (s.silenceMs == 0) return true;
+
+    const PubCacheEntry* e = pubFind(s.key, false);
+    if (!e) return true;                        // never published (or table full)
+    if (now - e->lastMs >= s.silenceMs) return true;
+
+    if (!s.numeric) return s.bits != e->bits;
+
+    float v, last;
+    memcpy(&v, &s.bits, sizeof(v));
+    memcpy(&last, &e->bits, sizeof(last));
+    return fabsf(v - last) > s.deadband;
+}
+
+static void pubMark(const PubSample& s, uint32_t now) {
+    if (s.silenceMs == 0) return;
+
+    PubCacheEntry* e = pubFind(s.key, true);
+    if (!e) return;
+    e->lastMs = now;
+    e->bits   = s.bits;
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY HASHES (NVS)
+   ---------------------------------------------------------------------------
+   Every discovery group (stack, PWR module N, BAT module N, STAT module N)
+   has a FNV-1a hash over everything its retained config messages are built
+   from: prefix, topics, cell layout and the MQTT field config. The hash of
+   the last successful publish is kept in NVS (namespace "mqtt_disc"), so a
+   boot or a settings save only republishes groups whose schema changed.
+   A Home Assistant birth message forces a full resync (discoveryForce).
+
+   DISC_SCHEMA_VERSION is part of every hash: bump it whenever the payload
+   format of the discovery messages changes.
+--------------------------------------------------------------------------- */
+#define DISC_NVS_NS          "mqtt_disc"
+#define DISC_SCHEMA_VERSION  1
+
+enum DiscGroup : uint8_t { DG_STACK, DG_PWR, DG_BAT, DG_STAT, DG_COUNT };
+
+static const char* const DISC_GROUP_KEY[DG_COUNT] = { "stack", "pwr", "bat", "stat" };
+
+// RAM copy of the stored hashes, index = module (stack: 0)
+static uint32_t discHashes[DG_COUNT][MAX_MODULES + 1];
+static bool     discHashesLoaded = false;
+
+// config.mqtt.discovery of the last complete run ("entity" / "device")
+static String   discModeStored;
+
+static void discKey(char* key, size_t cap, uint8_t group, int module) {
+    if (group == DG_STACK) snprintf(key, cap, "%s", DISC_GROUP_KEY[group]);
+    else                   snprintf(key, cap, "%s%d", DISC_GROUP_KEY[group], module);
+}
+
+static void discLoadHashes() {
+    memset(discHashes, 0, sizeof(discHashes));
+
+    Preferences p;
+    if (p.begin(DISC_NVS_NS, true)) {
+        char key[16];
+        for (uint8_t g = 0; g < DG_COUNT; g++) {
+            for (int m = (g == DG_STACK ? 0 : 1); m <= (g == DG_STACK ? 0 : MAX_MODULES); m++) {
+                discKey(key, sizeof(key), g, m);
+                discHashes[g][m] = p.getUInt(key, 0);
+            }
+        }
+        discModeStored = p.getString("mode", "");
+        p.end();
+    }
+    discHashesLoaded = true;
+}
+
+static void discStoreHash(uint8_t group, int module, uint32_t hash) {
+    if (module < 0 || module > MAX_MODULES) return;
+    if (discHashes[group][module] == hash) return;
+
+    discHashes[group][module] = hash;
+
+    char key[16];
+    discKey(key, sizeof(key), group, module);
+
+    Preferences p;
+    p.begin(DISC_NVS_NS, false);
+    p.putUInt(key, hash);
+    p.end();
+}
+
+static void discStoreMode(const String& mode) {
+    if (discModeStored == mode) return;
+    discModeStored = mode;
+
+    Preferences p;
+    p.begin(DISC_NVS_NS, false);
+    p.putString("mode", mode);
+    p.end();
+}
+
+static uint32_t fnvAdd(uint32_t h, const char* s) {
+    for (; *s; s++) {
+        h ^= (uint8_t)*s;
+        h *= 16777619u;
+    }
+    h ^= 0xFF;                                 // separator
+    h *= 16777619u;
+    return h;
+}
+
+static uint32_t fnvAddInt(uint32_t h, int32_t v) {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%ld", (long)v);
+    return fnvAdd(h, buf);
+}
+
+static uint32_t fnvAddFields(uint32_t h, const std::map<String, FieldConfig>& fields) {
+    for (auto &kv : fields) {
+        const FieldConfig& fc = kv.second;
+        if (!fc.mqtt) continue;
+        h = fnvAdd(h, kv.first.c_str());
+        h = fnvAdd(h, fc.display.c_str());
+        h = fnvAdd(h, fc.factor.c_str());
+        h = fnvAdd(h, fc.unit.c_str());
+    }
+    return h;
+}
+
+// Hash of one discovery group (0 is never produced → "nothing stored")
+static uint32_t discoveryHash(uint8_t group, int module, uint8_t cells) {
+    uint32_t h = 2166136261u;
+    h = fnvAddInt(h, DISC_SCHEMA_VERSION);
+    h = fnvAddInt(h, group);
+    h = fnvAddInt(h, module);
+    h = fnvAdd(h, config.mqtt.prefix.c_str());
+    h = fnvAdd(h, config.mqtt.discovery.c_str());
+
+    switch (group) {
+        case DG_STACK:
+            h = fnvAdd(h, config.mqtt.topicStack.c_str());
+            break;
+        case DG_PWR:
+            h = fnvAdd(h, config.mqtt.topicPwr.c_str());
+            h = fnvAddFields(h, config.battery.fieldsPwr);
+            break;
+        case DG_BAT:
+            h = fnvAdd(h, config.mqtt.topicBat.c_str());
+            h = fnvAdd(h, config.mqtt.cellPrefix.c_str());
+            h = fnvAdd(h, config.mqtt.batMode.c_str());
+            h = fnvAddInt(h, cells);
+            h = fnvAddFields(h, config.battery.fieldsBat);
+            break;
+        case DG_STAT:
+            h = fnvAdd(h, config.mqtt.topicStat.c_str());
+            h = fnvAddInt(h, config.battery.enableStat);
+            h = fnvAddFields(h, config.battery.fieldsStat);
+            break;
+    }
+    return h ? h : 1;
+}
+
+// Groups that cannot be announced yet (no hash is stored for them)
+static bool discoveryReady(uint8_t group, uint8_t cells) {
+    if (group == DG_BAT)  return cells > 0;
+    if (group == DG_STAT) return config.battery.enableStat;
+    return true;
+}
+
+// Device block of a group (entity mode: "dev" of every sensor,
+// device mode: the device of the single config message)
+static void discoveryDevice(uint8_t group, int module, String& ids, String& name);
+
+// true → group has to be (re)published
+static bool discoveryDue(uint8_t group, int module, uint32_t hash) {
+    if (discoveryForce) return true;
+    if (module < 0 || module > MAX_MODULES) return true;
+    return discHashes[group][module] != hash;
+}
+
+/* ---------------------------------------------------------------------------
+   HA BIRTH MESSAGE
+   ---------------------------------------------------------------------------
+   Runs inside mqttClient.loop() (MQTT task) → only sets a flag.
+--------------------------------------------------------------------------- */
+static void mqttCallback(char* topic, byte* payload, unsigned int length) {
+    if (strcmp(topic, "homeassistant/status") != 0) return;
+
+    if (length == 6 && memcmp(payload, "online", 6) == 0)
+        haBirthPending = true;
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY RESET
+   ---------------------------------------------------------------------------
+   Resets the discovery state machine and clears module tracking.
+--------------------------------------------------------------------------- */
+void PyMqtt::resetDiscovery(bool pwr, bool bat, bool stat) {
+
+    if (pwr) discoveredPwr.clear();
+    if (bat) discoveredBat.clear();
+    if (stat) discoveredStat.clear();
+
+    discoveryPhase = DISC_STACK;
+    discPwrIndex   = 0;
+    discBatModule  = 0;
+    discBatCell    = 0;
+    discBatField   = 0;
+    discStatModule = 0;
+    discStatField  = 0;
+
+    discoveryActive = true;
+
+    // new entities need a state right after discovery
+    pubCacheClear();
+
+    LOGI(LOGM_MQTT, "Discovery reset triggered");
+}
+
+/* ---------------------------------------------------------------------------
+   BEGIN
+   ---------------------------------------------------------------------------
+   Initializes MQTT client and marks discovery as required.
+--------------------------------------------------------------------------- */
+void PyMqtt::begin() {
+    enabled = config.mqtt.enabled;
+
+    if (!enabled) {
+        LOGI(LOGM_MQTT, "disabled in configuration");
+        return;
+    }
+
+    mqttClient.setServer(config.mqtt.server.c_str(), config.mqtt.port);
+    mqttClient.setBufferSize(2048);
+    mqttClient.setCallback(mqttCallback);
+
+    if (!discHashesLoaded) discLoadHashes();
+
+    // Discovery darf NICHT automatisch starten
+    discoveryPhase = DISC_IDLE;
+    discoveryActive = false;
+
+    LOGI(LOGM_MQTT, "BufferSize set to 2048 bytes");
+}
+
+
+/* ---------------------------------------------------------------------------
+   CONNECT
+   ---------------------------------------------------------------------------
+   Attempts to connect to the MQTT broker. Connection is delayed until WiFi
+   has been stable for at least 10 seconds to avoid rapid reconnect loops.
+--------------------------------------------------------------------------- */
+bool PyMqtt::connect() {
+    if (!enabled) return false;
+    if (WiFi.status() != WL_CONNECTED) return false;
+
+    if (wifiConnectedSince == 0)
+        wifiConnectedSince = millis();
+
+    // Wait 10 seconds after WiFi connects
+    if (millis() - wifiConnectedSince < 10000)
+        return false;
+
+    String clientId = "PylontechMonitor-" + String((uint32_t)ESP.getEfuseMac());
+
+    bool ok = mqttClient.connect(
+        clientId.c_str(),
+        config.mqtt.user.c_str(),
+        config.mqtt.pass.c_str()
+    );
+
+    if (ok) {
+        // broker may have lost retained state → send everything once
+        pubCacheClear();
+        LOGI(LOGM_MQTT, "connected as %s", clientId);
+
+        // HA restart → birth message → full discovery resync
+        if (!mqttClient.subscribe("homeassistant/status"))
+            LOGW(LOGM_MQTT, "subscribe homeassistant/status failed");
+
+        // QoS 1 replay packets without PUBACK from the last session
+        transport.resendInflight();
+    } else {
+        LOGW(LOGM_MQTT, "connection failed");
+    }
+
+    return ok;
+}
+
+/* ---------------------------------------------------------------------------
+   RAW PUBLISH (Task 1 → Task 2)
+   ---------------------------------------------------------------------------
+   Publishes raw messages from the queue. Used for low-level or custom topics.
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishRaw(const String& topic, const String& payload) {
+    if (!enabled || !mqttClient.connected()) return false;
+    return publishPacket(mqttClient, transport, topic.c_str(), payload.c_str(), false) == PUB_OK;
+}
+
+/* ---------------------------------------------------------------------------
+   LOOP (Task 2)
+   ---------------------------------------------------------------------------
+   Main MQTT loop:
+   - Handles reconnects
+   - Processes queue messages
+   - Publishes PWR/BAT/STAT data (offline: into the flash ring)
+   - Replays samples stored while offline
+   - Runs discovery state machine
+--------------------------------------------------------------------------- */
+void PyMqtt::loop() {
+    if (!enabled) return;
+
+    // WiFi check
+    if (WiFi.status() != WL_CONNECTED) {
+        wifiConnectedSince = 0;
+        captureOffline();
+        return;
+    }
+
+    // MQTT reconnect
+    if (!mqttClient.connected()) {
+        if (millis() - lastReconnectAttempt > 3000) {
+            lastReconnectAttempt = millis();
+            connect();
+        }
+        if (!mqttClient.connected()) captureOffline();
+        return;
+    }
+
+    // ---------------------------------------------------------
+    // DISCOVERY TRIGGER (NEU: startet IMMER, wenn Flag gesetzt)
+    // ---------------------------------------------------------
+    if (haBirthPending) {
+        haBirthPending = false;
+        discoveryForce = true;
+        discoveryPwrNeeded = true;      // → start below
+        LOGI(LOGM_MQTT, "Home Assistant online → full discovery resync");
+    }
+
+    if (discoveryPwrNeeded || discoveryBatNeeded || discoveryStatNeeded) {
+
+        LOGI(LOGM_MQTT, "Discovery start requested");
+
+        discoveryPhase = DISC_STACK;
+        discoveryActive = true;
+        discoveryFailed = false;
+        pubCacheClear();
+
+        discoveryPwrNeeded  = false;
+        discoveryBatNeeded  = false;
+        discoveryStatNeeded = false;
+    }
+
+    // flush what the previous cycle left in the outbox
+    transport.pump();
+
+    // ---------------------------------------------------------
+    // RAW QUEUE
+    // ---------------------------------------------------------
+    MqttMessage msg;
+    while (xQueueReceive(mqttQueue, &msg, 0) == pdTRUE) {
+        publishRaw(String(msg.topic), String(msg.payload));
+    }
+
+    // ---------------------------------------------------------
+    // PWR / BAT / STAT + stored offline samples
+    // ---------------------------------------------------------
+    publishSnapshots();
+
+    if (discoveryPhase == DISC_IDLE || discoveryPhase == DISC_DONE)
+        replayOffline();
+
+    // ---------------------------------------------------------
+    // DISCOVERY STATE MACHINE
+    // ---------------------------------------------------------
+    handleDiscoveryStep(mqttPwr, mqttStat);
+
+    mqttClient.loop();
+}
+
+/* ---------------------------------------------------------------------------
+   PUBLISH SNAPSHOTS
+   ---------------------------------------------------------------------------
+   Copies the parser snapshots whose generation changed and publishes them
+   (to the broker, or to the offline store while offlineCapture is set).
+--------------------------------------------------------------------------- */
+void PyMqtt::publishSnapshots() {
+    // ---------------------------------------------------------
+    // PUBLISH PWR (nur kopieren, wenn sich die Generation geändert hat)
+    // A deferred / failed publish keeps pwrPublished → retried next
+    // cycle; values already sent are not due any more (change detection)
+    // ---------------------------------------------------------
+    if (pwrSnapshot.generation() != pwrGen) pwrGen = pwrSnapshot.read(mqttPwr);
+
+    if (pwrGen != pwrPublished) {
+        // the stack document has no change detection → send it once
+        bool done = true;
+        if (stackPublished != pwrGen) {
+            if (publishStack(mqttPwr.stack)) stackPublished = pwrGen;
+            else done = false;
+        }
+        for (uint8_t i = 0; i < mqttPwr.moduleCount; i++) {
+            const BatteryModule& mod = mqttPwr.modules[i];
+            if (!mod.present) continue;
+            done = publishBat(mod.index, mqttPwr.header, mod) && done;
+        }
+        if (done) pwrPublished = pwrGen;
+    }
+
+    // ---------------------------------------------------------
+    // PUBLISH BAT CELLS / STAT: every module result in order, the
+    // cursor only moves on after the result was published
+    // ---------------------------------------------------------
+    for (;;) {
+        SnapRead r = batSnapshot.readAt(batCursor, mqttBat);
+        if (r == SNAP_NONE) break;
+        if (r == SNAP_LAPPED) {
+            LOGW(LOGM_MQTT, "BAT results overwritten before publishing");
+            continue;
+        }
+        int m = mqttBat.cells.moduleIndex;
+        if (m >= 0 && m <= MAX_MODULES) batCells[m] = mqttBat.cells.cellCount;
+
+        if (!publishBatCells(m, mqttBat)) break;
+        batCursor++;
+    }
+
+    for (;;) {
+        SnapRead r = statSnapshot.readAt(statCursor, mqttStat);
+        if (r == SNAP_NONE) break;
+        if (r == SNAP_LAPPED) {
+            LOGW(LOGM_MQTT, "STAT results overwritten before publishing");
+            continue;
+        }
+        if (!publishStat(mqttStat.stat.moduleIndex, mqttStat.stat)) break;
+        statCursor++;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   OFFLINE CAPTURE / REPLAY
+--------------------------------------------------------------------------- */
+void PyMqtt::captureOffline() {
+    offlineCapture = true;
+    publishSnapshots();
+    offlineCapture = false;
+}
+
+// {"ts":<epoch>,...stored document...} → <prefix>/replay/<subtopic>
+void PyMqtt::replayOffline() {
+    if (!mqttOffline.pending()) return;
+    if (millis() - lastReplay < OFFLINE_REPLAY_MS) return;
+    lastReplay = millis();
+
+    char topic[160];
+    OfflineRecord rec;
+
+    for (uint8_t i = 0; i < OFFLINE_REPLAY_BURST && mqttOffline.peek(rec); i++) {
+        snprintf(topic, sizeof(topic), "%s/replay/%s",
+                 config.mqtt.prefix.c_str(), rec.topic);
+
+        PubResult r = publishStreamed(mqttClient, transport, topic, [&](Print& out) {
+            out.print("{\"ts\":");
+            out.print(rec.ts);
+
+            if (rec.payloadLen > 1 && rec.payload[0] == '{') {
+                if (rec.payload[1] != '}') out.write(',');
+                out.write((const uint8_t*)rec.payload + 1, rec.payloadLen - 1);
+            } else {
+                out.print(",\"value\":");
+                out.write((const uint8_t*)rec.payload, rec.payloadLen);
+                out.write('}');
+            }
+        }, false, 1);
+
+        // deferred / failed: the record stays first in the ring
+        if (r != PUB_OK) {
+            if (r == PUB_FAILED) LOGW(LOGM_MQTT, "replay failed: %s", topic);
+            break;
+        }
+        mqttOffline.pop();
+
+        if (!mqttOffline.pending())
+            LOGI(LOGM_MQTT, "offline samples replayed (%u since boot)",
+                 mqttOffline.stats().replayed);
+    }
+}
+
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY STATE MACHINE
+   ---------------------------------------------------------------------------
+   One group per step: stack → PWR modules → BAT modules → STAT modules.
+   A group is only published if its hash differs from the stored one (or a
+   resync is forced); the hash is stored after every message of the group
+   went out.
+--------------------------------------------------------------------------- */
+bool PyMqtt::discoveryGroup(uint8_t group, int module) {
+    uint8_t cells = (group == DG_BAT && module >= 0 && module <= MAX_MODULES) ? batCells[module] : 0;
+    if (!discoveryReady(group, cells)) return false;
+
+    uint32_t hash = discoveryHash(group, module, cells);
+    if (!discoveryDue(group, module, hash)) {
+        LOGD(LOGM_MQTT, "discovery %s %d unchanged", DISC_GROUP_KEY[group], module);
+        return false;
+    }
+
+    bool device = config.mqtt.discovery == "device";
+
+    // rare and must be complete → written blocking (drains the outbox)
+    transport.setBlocking(true);
+
+    // mode switched → remove the retained messages of the other mode
+    if (discModeStored.length() > 0 && discModeStored != config.mqtt.discovery &&
+        module >= 0 && module <= MAX_MODULES && discHashes[group][module] != 0) {
+        publishDiscoveryGroup(group, module, cells, !device, true);
+    }
+
+    bool ok = publishDiscoveryGroup(group, module, cells, device, false);
+    transport.setBlocking(false);
+
+    if (ok) {
+        discStoreHash(group, module, hash);
+    } else {
+        discoveryFailed = true;
+        LOGW(LOGM_MQTT, "discovery %s %d incomplete, retried next time",
+             DISC_GROUP_KEY[group], module);
+    }
+    return true;
+}
+
+void PyMqtt::handleDiscoveryStep(
+    const PwrBuffer& pwr,
+    const StatBuffer& stat
+) {
+    if (!enabled || !mqttClient.connected()) return;
+
+    switch (discoveryPhase) {
+
+        case DISC_IDLE:
+        case DISC_DONE:
+            return;
+
+        case DISC_STACK:
+            discoveryGroup(DG_STACK, 0);
+            discoveryPhase = DISC_PWR;
+            discPwrIndex = 0;
+            return;
+
+        case DISC_PWR:
+            if (discPwrIndex >= pwr.moduleCount) {
+                discoveryPhase = DISC_BAT;
+                discBatModule = 0;
+                return;
+            }
+            if (pwr.modules[discPwrIndex].present)
+                discoveryGroup(DG_PWR, pwr.modules[discPwrIndex].index);
+            discPwrIndex++;
+            return;
+
+        case DISC_BAT:
+            if (discBatModule >= pwr.moduleCount) {
+                discoveryPhase = DISC_STAT;
+                discStatModule = 0;
+                return;
+            }
+            if (pwr.modules[discBatModule].present)
+                discoveryGroup(DG_BAT, pwr.modules[discBatModule].index);
+            discBatModule++;
+            return;
+
+        case DISC_STAT:
+            if (discStatModule >= pwr.moduleCount) {
+                discoveryPhase  = DISC_DONE;
+                discoveryActive = false;
+                discoveryForce  = false;
+                if (!discoveryFailed) discStoreMode(config.mqtt.discovery);
+                LOGI(LOGM_MQTT, "Discovery done");
+                return;
+            }
+            if (pwr.modules[discStatModule].present)
+                discoveryGroup(DG_STAT, pwr.modules[discStatModule].index);
+            discStatModule++;
+            return;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   NAME NORMALIZATION
+   ---------------------------------------------------------------------------
+   Converts display names into safe MQTT/JSON identifiers:
+   - Removes spaces and special characters
+   - Converts to CamelCase
+   - Ensures Home Assistant compatibility
+--------------------------------------------------------------------------- */
+String PyMqtt::normalizeName(const String& in) {
+    String out;
+    bool upperNext = true;
+
+    for (char c : in) {
+        if (c == ' ' || c == '_' || c == '-' || c == '.') {
+            upperNext = true;
+            continue;
+        }
+        if (!isalnum(c)) continue;
+
+        if (upperNext) {
+            out += (char)toupper(c);
+            upperNext = false;
+        } else {
+            out += (char)c;
+        }
+    }
+    return out;
+}
+
+/* ---------------------------------------------------------------------------
+   ID SANITIZER
+   ---------------------------------------------------------------------------
+   Builds Home Assistant safe identifiers:
+   - lowercase
+   - only [a-z0-9_]
+   - spaces and separators → underscore
+--------------------------------------------------------------------------- */
+static String sanitizeId(const String& in) {
+    String out;
+    out.reserve(in.length());
+    for (char c : in) {
+        if (c >= 'A' && c <= 'Z') {
+            out += char(c + 32); // tolower
+        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            out += c;
+        } else if (c == '_' || c == '-' || c == ' ' || c == '/' || c == '.') {
+            out += '_';
+        } else {
+            // ignore other characters
+        }
+    }
+    return out;
+}
+
+/* ---------------------------------------------------------------------------
+   DECIMAL PRECISION BASED ON UNIT
+--------------------------------------------------------------------------- */
+int PyMqtt::decimalsForUnit(const String& unit) {
+    if (unit == "V")  return 3;   // voltage
+    if (unit == "A")  return 3;   // current
+    if (unit == "°C") return 1;   // temperature
+    if (unit == "%")  return 0;   // percentage
+    if (unit == "Ah") return 3;   // capacity
+    return 0;                     // default
+}
+
+/* ---------------------------------------------------------------------------
+   DEVICE CLASS BASED ON UNIT
+--------------------------------------------------------------------------- */
+String PyMqtt::deviceClassForUnit(const String& unit) {
+    if (unit == "V")  return "voltage";
+    if (unit == "A")  return "current";
+    if (unit == "°C") return "temperature";
+    if (unit == "%")  return "battery";
+    return "";
+}
+
+/* ---------------------------------------------------------------------------
+   PUBLISH PLAN
+   ---------------------------------------------------------------------------
+   The field config (std::map<String, FieldConfig>, factor as text) is
+   compiled once into a flat PlanField per frame column: JSON key, kind,
+   parsed factor, decimals, °F switch, deadband. The publishers below only
+   index into the plan - no map lookup, no String factor parsing and no
+   normalizeName() per value.
+
+   A plan is rebuilt when config.battery.fieldsRevision changes (load, save,
+   factory defaults) or the column layout of the frame changes:
+   - PWR:  PwrHeader::revision
+   - BAT:  BatSchema::revision
+   - STAT: hash of the field names
+--------------------------------------------------------------------------- */
+#define PLAN_VALUE_LEN  32
+#define PLAN_MAX_VALUES (STAT_MAX_FIELDS > PWR_MAX_COLS ? STAT_MAX_FIELDS : PWR_MAX_COLS)
+
+static PlanField planPwrFields[PWR_MAX_COLS];
+static PlanField planBatFields[BAT_MAX_COLS];
+static PlanField planStatFields[STAT_MAX_FIELDS];
+
+static PublishPlan planPwr(planPwrFields, PWR_MAX_COLS);
+static PublishPlan planBat(planBatFields, BAT_MAX_COLS);
+static PublishPlan planStat(planStatFields, STAT_MAX_FIELDS);
+
+// Formatted values of the document being published (PWR / STAT)
+static char    planText[PLAN_MAX_VALUES][PLAN_VALUE_LEN];
+static uint8_t planCols[PLAN_MAX_VALUES];
+
+static bool planStale(const PublishPlan& plan, uint32_t layout) {
+    return !plan.valid ||
+           plan.fieldsRevision != config.battery.fieldsRevision ||
+           plan.layout != layout;
+}
+
+static void planDone(PublishPlan& plan, uint8_t count, uint32_t layout) {
+    plan.count          = count;
+    plan.layout         = layout;
+    plan.fieldsRevision = config.battery.fieldsRevision;
+    plan.valid          = true;
+}
+
+void PyMqtt::compileField(PlanField& pf, const FieldConfig* fc, bool normalizeKey) {
+    memset(&pf, 0, sizeof(pf));
+    pf.kind = PLAN_SKIP;
+
+    if (!fc || !fc->mqtt) return;
+
+    const String& u = fc->unit;
+    if      (u == "V")         pf.unit = UNIT_V;
+    else if (u == "A")         pf.unit = UNIT_A;
+    else if (u == "°C")        pf.unit = UNIT_C;
+    else if (u == "%")         pf.unit = UNIT_PERCENT;
+    else if (u == "Ah")        pf.unit = UNIT_AH;
+    else if (u == "timestamp") pf.unit = UNIT_TIMESTAMP;
+    else                       pf.unit = UNIT_NONE;
+
+    pf.deadband  = fc->deadband;
+    pf.silenceMs = fc->maxSilence * 1000UL;
+
+    // WICHTIG: Discovery benutzt denselben Key (PWR/STAT normalisiert,
+    // BAT fc.display unverändert)
+    String key = normalizeKey ? normalizeName(fc->display) : fc->display;
+    strlcpy(pf.key, key.c_str(), sizeof(pf.key));
+
+    // Time / text fields → console text unchanged
+    if (fc->factor == "text" || fc->factor == "date" || pf.unit == UNIT_TIMESTAMP) {
+        pf.kind = PLAN_TEXT;
+        return;
+    }
+
+    pf.kind   = PLAN_NUM;
+    pf.factor = fc->factor.toFloat();
+    pf.fmt.exact = fixedParseFactor(fc->factor.c_str(), pf.fmt.mul, pf.fmt.exp);
+
+    // Fahrenheit conversion if enabled
+    pf.fmt.fahrenheit = (pf.unit == UNIT_C) && config.battery.useFahrenheit;
+    pf.fmt.decimals   = pf.fmt.fahrenheit ? decimalsForUnit("°F") : decimalsForUnit(u);
+}
+
+/* ---------------------------------------------------------------------------
+   FORMAT VALUE (NUMERIC OR TEXT)
+   ---------------------------------------------------------------------------
+   Numeric values go through the integer fixed-point formatter (py_format)
+   whenever the factor is a plain decimal; float is only the fallback for
+   exotic factors / texts ("1e-3", more than 18 digits).
+--------------------------------------------------------------------------- */
+const char* PyMqtt::formatValue(const PlanField& pf, const char* raw, char* out, size_t cap) {
+    if (pf.kind == PLAN_TEXT) {
+        strlcpy(out, raw, cap);
+        return out;
+    }
+
+    int64_t v;
+    uint8_t scale;
+    if (pf.fmt.exact && fixedParseText(raw, v, scale))
+        return formatFixedValue(pf, v, scale, out, cap);
+
+    return formatNumeric(pf, atof(raw), out, cap);
+}
+
+const char* PyMqtt::formatFixedValue(const PlanField& pf, int64_t raw, uint8_t rawScale,
+                                     char* out, size_t cap) {
+    if (fixedFormat(out, cap, raw, rawScale, pf.fmt) > 0)
+        return out;
+
+    // overflow → float
+    float v = (float)raw;
+    for (uint8_t i = 0; i < rawScale; i++) v /= 10.0f;
+    return formatNumeric(pf, v, out, cap);
+}
+
+/* ---------------------------------------------------------------------------
+   FORMAT VALUE (FLOAT FALLBACK)
+--------------------------------------------------------------------------- */
+const char* PyMqtt::formatNumeric(const PlanField& pf, float raw, char* out, size_t cap) {
+    float v = raw * pf.factor;
+    if (pf.fmt.fahrenheit) v = v * 1.8f + 32.0f;
+
+    snprintf(out, cap, "%.*f", pf.fmt.decimals, v);
+    return out;
+}
+
+/* ---------------------------------------------------------------------------
+   FORMAT VALUE FOR A FIELD CONFIG (web APIs)
+--------------------------------------------------------------------------- */
+const char* PyMqtt::formatFieldValue(const FieldConfig& fc, const char* raw, char* out, size_t cap) {
+    if (!raw || !*raw) {          // no frame yet
+        if (cap) out[0] = '\0';
+        return out;
+    }
+
+    PlanField pf;
+    compileField(pf, &fc, false);
+
+    // MQTT disabled → still show the converted value
+    if (pf.kind == PLAN_SKIP) {
+        FieldConfig tmp = fc;
+        tmp.mqtt = true;
+        compileField(pf, &tmp, false);
+    }
+    return formatValue(pf, raw, out, cap);
+}
+
+/* ---------------------------------------------------------------------------
+   BUILD MQTT TOPIC
+--------------------------------------------------------------------------- */
+String PyMqtt::buildTopic(
+    const String& subtopic,
+    int moduleIndex,
+    const String& fieldName,
+    int cellIndex,
+    bool isCell
+) {
+    String prefix = config.mqtt.prefix;
+    String cellPrefix = config.mqtt.cellPrefix; // e.g. "Cell"
+
+    if (isCell) {
+        return prefix + "/" + subtopic + "/" +
+               String(moduleIndex) + "/" +
+               cellPrefix + String(cellIndex) + "_" + fieldName;
+    }
+
+    return prefix + "/" + subtopic + "/" +
+           String(moduleIndex) + "/" + fieldName;
+}
+
+/* ---------------------------------------------------------------------------
+   PUBLISH STACK JSON
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishStack(const BatteryStack& stack) {
+    if (!enabled) return true;
+    if (!mqttClient.connected() && !offlineCapture) return false;
+
+    String topic = config.mqtt.prefix + "/" + config.mqtt.topicStack;
+
+    // mV / mA / m°C → 3 decimals, exact (no float)
+    static const FixedFormat milli = { 1, 3, 3, false, true };
+    char volt[24], curr[24], temp[24];
+
+    fixedFormat(volt, sizeof(volt), stack.avgVoltage_mV, 0, milli);
+    fixedFormat(curr, sizeof(curr), stack.totalCurrent_mA, 0, milli);
+    fixedFormat(temp, sizeof(temp), stack.temperature, 0, milli);
+
+    char payload[128];
+    snprintf(payload, sizeof(payload),
+             "{\"StackVoltAvg\":%s,\"StackCurrSum\":%s,\"StackTempMax\":%s,\"BatteryCount\":%d}",
+             volt, curr, temp, (int)stack.batteryCount);
+
+    return publishValuePacket(mqttClient, transport, topic.c_str(), payload) == PUB_OK;
+}
+
+// {"key":"value",...} of the collected PWR / STAT values (planCols/planText)
+static void printPlanValues(Print& out, const PublishPlan& plan, uint8_t n) {
+    out.write('{');
+    for (uint8_t i = 0; i < n; i++) {
+        if (i > 0) out.write(',');
+        printJsonString(out, plan.fields[planCols[i]].key);
+        out.write(':');
+        printJsonString(out, planText[i]);
+    }
+    out.write('}');
+}
+
+/* ---------------------------------------------------------------------------
+   PUBLISH PWR MODULE JSON
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishBat(int index, const PwrHeader& header, const BatteryModule& mod) {
+    if (!enabled || !mod.present) return true;
+    if (!mqttClient.connected() && !offlineCapture) return false;
+
+    if (planStale(planPwr, header.revision)) {
+        for (uint8_t c = 0; c < header.count; c++) {
+            auto it = config.battery.fieldsPwr.find(String(header.names[c]));
+            compileField(planPwrFields[c],
+                         it != config.battery.fieldsPwr.end() ? &it->second : nullptr,
+                         true);
+        }
+        planDone(planPwr, header.count, header.revision);
+        LOGD(LOGM_MQTT, "PWR publish plan rebuilt (%u columns)", header.count);
+    }
+
+    char topic[128];
+    snprintf(topic, sizeof(topic), "%s/%s/%d",
+             config.mqtt.prefix.c_str(), config.mqtt.topicPwr.c_str(), index);
+
+    uint32_t now = millis();
+    PubSample samples[PWR_MAX_COLS];
+    uint8_t n = 0;
+    bool due = false;
+
+    for (uint8_t col = 0; col < planPwr.count && col < mod.fieldCount; col++) {
+        const PlanField& pf = planPwrFields[col];
+        if (pf.kind == PLAN_SKIP) continue;
+
+        formatValue(pf, mod.field(col), planText[n], PLAN_VALUE_LEN);
+        pubSample(samples[n], pubKey(PUB_PWR, index, 0, col), planText[n], pf);
+        due |= pubDue(samples[n], now);
+        planCols[n++] = col;
+    }
+
+    if (!due) return true;
+
+    if (!offlineCapture) {
+        String contact = config.getCurrentTimeString();
+        ConfigLock lock;                    // shown by the dashboard
+        config.lastMqttContact = contact;
+    }
+
+    PubResult r = publishValues(mqttClient, transport, topic, [&](Print& out) {
+        printPlanValues(out, planPwr, n);
+    });
+
+    if (r != PUB_OK) {
+        if (r == PUB_FAILED) LOGW(LOGM_MQTT, "publish failed: %s", topic);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+        pubMark(samples[i], now);
+    return true;
+}
+
+/* ---------------------------------------------------------------------------
+   PUBLISH BAT CELLS JSON
+   ---------------------------------------------------------------------------
+   config.mqtt.batMode:
+   - "cells": one message per cell  <prefix>/<bat>/<module>/<CellPrefix><n>
+              (Home Assistant per-cell topics, default)
+   - "bulk":  one message per module <prefix>/<bat>/<module>
+              {"Cells":[{...cell 0...},{...cell 1...},...]}
+   - "both":  both of the above
+--------------------------------------------------------------------------- */
+
+#define BAT_CELL_TEXT_LEN  (BAT_ENUM_LEN + BAT_SUFFIX_LEN + 16)
+
+void PyMqtt::printBatCell(Print& out, const BatBuffer& bat, uint8_t cell) {
+    char text[BAT_CELL_TEXT_LEN];
+    bool first = true;
+
+    out.write('{');
+
+    for (uint8_t c = 0; c < planBat.count; c++) {
+
+        if (planBatFields[c].kind == PLAN_SKIP) continue;
+        if (bat.cells.values[c][cell] == BAT_VALUE_NONE) continue;
+
+        if (!first) out.write(',');
+        first = false;
+
+        printJsonString(out, planBatFields[c].key);
+        out.write(':');
+        printJsonString(out, formatBatCell(bat, c, cell, text, sizeof(text)));
+    }
+
+    out.write('}');
+}
+
+// Published text of one cell value
+const char* PyMqtt::formatBatCell(
+    const BatBuffer& bat,
+    uint8_t c,
+    uint8_t cell,
+    char* out,
+    size_t cap
+) {
+    const PlanField& pf = planBatFields[c];
+
+    // typed column: integer value + column decimals, no text round trip
+    if (pf.kind == PLAN_NUM && batIsNumeric(bat.schema, c) && pf.fmt.exact)
+        return formatFixedValue(pf, bat.cells.values[c][cell],
+                                bat.schema.cols[c].decimals, out, cap);
+    if (pf.kind == PLAN_NUM && batIsNumeric(bat.schema, c))
+        return formatNumeric(pf, batValueAsFloat(bat, c, cell), out, cap);
+
+    // text column (enum), or numeric config on a text column
+    char text[BAT_CELL_TEXT_LEN];
+    batFormatValue(bat, c, cell, text, sizeof(text));
+    return formatValue(pf, text, out, cap);
+}
+
+// Change detection for one cell: due if any field is due.
+// mark = true: remember all values of the cell as published.
+bool PyMqtt::batCellDue(
+    int moduleIndex,
+    const BatBuffer& bat,
+    uint8_t cell,
+    uint32_t now,
+    bool mark
+) {
+    char text[BAT_CELL_TEXT_LEN];
+
+    for (uint8_t c = 0; c < planBat.count; c++) {
+        if (planBatFields[c].kind == PLAN_SKIP) continue;
+        if (bat.cells.values[c][cell] == BAT_VALUE_NONE) continue;
+
+        PubSample smp;
+        pubSample(smp, pubKey(PUB_BAT, moduleIndex, cell, c),
+                  formatBatCell(bat, c, cell, text, sizeof(text)),
+                  planBatFields[c]);
+
+        if (mark) {
+            pubMark(smp, now);
+        } else if (pubDue(smp, now)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PyMqtt::publishBatCells(int moduleIndex, const BatBuffer& bat) {
+    if (!enabled || bat.cells.cellCount == 0) return true;
+    if (!mqttClient.connected() && !offlineCapture) return false;
+
+    const BatSchema& schema = bat.schema;
+
+    if (planStale(planBat, schema.revision)) {
+        for (uint8_t c = 0; c < schema.colCount; c++) {
+            auto it = config.battery.fieldsBat.find(String(schema.cols[c].name));
+            compileField(planBatFields[c],
+                         it != config.battery.fieldsBat.end() ? &it->second : nullptr,
+                         false);
+        }
+        planDone(planBat, schema.colCount, schema.revision);
+        LOGD(LOGM_MQTT, "BAT publish plan rebuilt (%u columns)", schema.colCount);
+    }
+
+    bool perCell = config.mqtt.batMode != "bulk";
+    bool bulk    = config.mqtt.batMode == "bulk" || config.mqtt.batMode == "both";
+
+    char topic[128];
+    int base = snprintf(topic, sizeof(topic), "%s/%s/%d",
+                        config.mqtt.prefix.c_str(),
+                        config.mqtt.topicBat.c_str(),
+                        moduleIndex);
+    if (base < 0 || base >= (int)sizeof(topic)) return true;
+
+    // change detection per cell (deadband / max silence)
+    uint32_t now = millis();
+    bool due[BAT_MAX_CELLS];
+    bool anyDue = false;
+
+    for (uint8_t cell = 0; cell < bat.cells.cellCount; cell++) {
+        due[cell] = batCellDue(moduleIndex, bat, cell, now, false);
+        anyDue |= due[cell];
+    }
+    if (!anyDue) return true;
+
+    bool done = true;
+
+    // one document per module (all cells, as soon as one is due)
+    if (bulk) {
+        PubResult r = publishValues(mqttClient, transport, topic, [&](Print& out) {
+            out.print("{\"Cells\":[");
+            for (uint8_t cell = 0; cell < bat.cells.cellCount; cell++) {
+                if (cell > 0) out.write(',');
+                printBatCell(out, bat, cell);
+            }
+            out.print("]}");
+        });
+
+        bool ok = (r == PUB_OK);
+        if (r == PUB_FAILED) LOGW(LOGM_MQTT, "publish failed: %s", topic);
+        done = ok;
+
+        // bulk-only: the document carried every cell
+        if (ok && !perCell) {
+            for (uint8_t cell = 0; cell < bat.cells.cellCount; cell++)
+                batCellDue(moduleIndex, bat, cell, now, true);
+        }
+    }
+
+    // one document per cell (topic suffix appended in place)
+    if (perCell) {
+        for (uint8_t cell = 0; cell < bat.cells.cellCount; cell++) {
+
+            if (!due[cell]) continue;
+
+            snprintf(topic + base, sizeof(topic) - base, "/%s%u",
+                     config.mqtt.cellPrefix.c_str(), cell);
+
+            PubResult r = publishValues(mqttClient, transport, topic, [&](Print& out) {
+                printBatCell(out, bat, cell);
+            });
+
+            // deferred: remaining cells stay due → newest values next cycle
+            if (r != PUB_OK) {
+                if (r == PUB_FAILED) LOGW(LOGM_MQTT, "publish failed: %s", topic);
+                return false;
+            }
+
+            batCellDue(moduleIndex, bat, cell, now, true);
+        }
+    }
+    return done;
+}
+
+/* ---------------------------------------------------------------------------
+   PUBLISH STAT JSON
+--------------------------------------------------------------------------- */
+
+// STAT has no header line → layout key is a hash of the field names
+static uint32_t statLayout(const StatData& stat) {
+    uint32_t h = 2166136261u;                  // FNV-1a
+    for (uint8_t i = 0; i < stat.fieldCount; i++) {
+        for (const char* p = stat.fields[i].name; *p; p++) {
+            h ^= (uint8_t)*p;
+            h *= 16777619u;
+        }
+        h ^= 0xFF;                             // name separator
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool PyMqtt::publishStat(int moduleIndex, const StatData& stat) {
+    if (!enabled || !config.battery.enableStat || stat.fieldCount == 0) return true;
+    if (!mqttClient.connected() && !offlineCapture) return false;
+
+    uint32_t layout = statLayout(stat);
+    if (planStale(planStat, layout)) {
+        for (uint8_t i = 0; i < stat.fieldCount; i++) {
+            auto it = config.battery.fieldsStat.find(String(stat.fields[i].name));
+            compileField(planStatFields[i],
+                         it != config.battery.fieldsStat.end() ? &it->second : nullptr,
+                         true);
+        }
+        planDone(planStat, stat.fieldCount, layout);
+        LOGD(LOGM_MQTT, "STAT publish plan rebuilt (%u fields)", stat.fieldCount);
+    }
+
+    char topic[128];
+    snprintf(topic, sizeof(topic), "%s/%s/%d",
+             config.mqtt.prefix.c_str(), config.mqtt.topicStat.c_str(), moduleIndex);
+
+    uint32_t now = millis();
+    PubSample samples[STAT_MAX_FIELDS];
+    uint8_t n = 0;
+    bool due = false;
+
+    for (uint8_t i = 0; i < planStat.count; i++) {
+        const PlanField& pf = planStatFields[i];
+        if (pf.kind == PLAN_SKIP) continue;
+
+        formatValue(pf, stat.fields[i].raw, planText[n], PLAN_VALUE_LEN);
+        pubSample(samples[n], pubKey(PUB_STAT, moduleIndex, 0, i), planText[n], pf);
+        due |= pubDue(samples[n], now);
+        planCols[n++] = i;
+    }
+
+    if (!due) return true;
+
+    PubResult r = publishValues(mqttClient, transport, topic, [&](Print& out) {
+        printPlanValues(out, planStat, n);
+    });
+
+    if (r != PUB_OK) {
+        if (r == PUB_FAILED) LOGW(LOGM_MQTT, "publish failed: %s", topic);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+        pubMark(samples[i], now);
+    return true;
+}
+/* ---------------------------------------------------------------------------
+   BUILD DISCOVERY IDENTIFIERS
+   ---------------------------------------------------------------------------
+   Creates:
+   - unique_id
+   - object_id
+   - friendly_name
+   - discovery topic
+--------------------------------------------------------------------------- */
+void PyMqtt::buildDiscoveryIds(
+    String& uniqueId,
+    String& objectId,
+    String& friendlyName,
+    String& discoveryTopic,
+    const String& subtopic,
+    int moduleIndex,
+    const String& displayName,
+    int cellIndex,
+    bool isCell
+) {
+    String prefix     = config.mqtt.prefix;
+    String cellPrefix = config.mqtt.cellPrefix; // e.g. "Cell"
+
+    // Base name: BAT5_Cell13_Voltage
+    String base;
+    if (isCell)
+        base = subtopic + String(moduleIndex) + "_" +
+               cellPrefix + String(cellIndex) + "_" + displayName;
+    else
+        base = subtopic + String(moduleIndex) + "_" + displayName;
+
+    // unique_id: Pylontech_BAT5_Cell13_Voltage
+    uniqueId = prefix + "_" + base;
+
+    // object_id: BAT5_Cell13_Voltage
+    objectId = base;
+
+    // friendly_name: Pylontech BAT5 Cell13 Voltage
+    if (isCell)
+        friendlyName = prefix + " " + subtopic + String(moduleIndex) +
+                       " " + cellPrefix + String(cellIndex) + " " + displayName;
+    else
+        friendlyName = prefix + " " + subtopic + String(moduleIndex) +
+                       " " + displayName;
+
+    // Discovery topic:
+    // homeassistant/sensor/Pylontech_BAT5_Cell13_Voltage/config
+    discoveryTopic =
+        "homeassistant/sensor/" + uniqueId + "/config";
+}
+
+/* ---------------------------------------------------------------------------
+   ADD DISCOVERY METADATA (unit, device_class, precision)
+--------------------------------------------------------------------------- */
+void PyMqtt::addDiscoveryMeta(
+    JsonDocument& doc,
+    const FieldConfig& fc
+) {
+    // Time fields → no metadata
+    if (fc.factor == "date" || fc.unit == "timestamp")
+        return;
+
+    // Numeric fields
+    int dec = decimalsForUnit(fc.unit);
+    String devClass = deviceClassForUnit(fc.unit);
+
+    if (devClass.length() > 0)
+        doc["device_class"] = devClass;
+
+    if (fc.unit.length() > 0)
+        doc["unit_of_measurement"] = fc.unit;
+
+    doc["state_class"] = "measurement";
+    doc["suggested_display_precision"] = dec;
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY SINKS (ENTITY / DEVICE MODE)
+   ---------------------------------------------------------------------------
+   The discovery publishers below only build one JSON document per sensor
+   (without device block) and hand it to a sink:
+   - EntitySink: one retained message per sensor
+                 homeassistant/sensor/<unique_id>/config, "dev" added
+   - DeviceSink: component of the single device message
+                 homeassistant/device/<dev ids>/config
+                 {"dev":{...},"o":{...},"cmps":{"<unique_id>":{...},...}}
+                 streamed (publishStreamed), so a BAT module with all cells
+                 is not limited by the PubSubClient buffer size; a group
+                 over MQTT_MAX_PACKET goes out through the EntitySink.
+--------------------------------------------------------------------------- */
+class DiscoverySink {
+public:
+    virtual ~DiscoverySink() {}
+    virtual bool component(const String& uniqueId, JsonDocument& doc) = 0;
+};
+
+class EntitySink : public DiscoverySink {
+public:
+    EntitySink(PubSubClient& c, const String& ids, const String& name, bool rm)
+        : client(c), devIds(ids), devName(name), remove(rm) {}
+
+    bool component(const String& uniqueId, JsonDocument& doc) override {
+        String topic = "homeassistant/sensor/" + uniqueId + "/config";
+        bool ok;
+
+        if (remove) {
+            ok = client.publish(topic.c_str(), "", true);
+        } else {
+            JsonObject dev = doc.createNestedObject("dev");
+            dev["ids"]  = devIds;
+            dev["name"] = devName;
+
+            String payload;
+            serializeJson(doc, payload);
+            ok = client.publish(topic.c_str(), payload.c_str(), true);
+        }
+
+        vTaskDelay(5);
+        return ok;
+    }
+
+private:
+    PubSubClient& client;
+    const String& devIds;
+    const String& devName;
+    bool remove;
+};
+
+class DeviceSink : public DiscoverySink {
+public:
+    explicit DeviceSink(Print& o) : out(o) {}
+
+    bool component(const String& uniqueId, JsonDocument& doc) override {
+        if (!first) out.write(',');
+        first = false;
+
+        doc["platform"] = "sensor";
+
+        printJsonString(out, uniqueId.c_str());
+        out.write(':');
+        serializeJson(doc, out);
+        return true;
+    }
+
+private:
+    Print& out;
+    bool first = true;
+};
+
+static void discoveryDevice(uint8_t group, int module, String& ids, String& name) {
+    String prefix   = config.mqtt.prefix;        // visible
+    String prefixId = sanitizeId(prefix);        // HA-safe
+
+    switch (group) {
+        case DG_STACK:
+            ids  = prefixId;
+            name = prefix + " Stack";
+            break;
+        case DG_PWR:
+            ids  = prefixId + "_pwr_" + String(module);
+            name = prefix + " PWR " + String(module);
+            break;
+        case DG_BAT:
+            ids  = prefixId + "_bat_" + String(module);
+            name = prefix + " BAT " + String(module);
+            break;
+        default:
+            ids  = prefixId + "_stat_" + String(module);
+            name = prefix + " STAT " + String(module);
+            break;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY: ONE GROUP
+   ---------------------------------------------------------------------------
+   remove = true: clears the retained message(s) of the group instead
+   (empty payload), used when the discovery mode is switched.
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishDiscoveryComponents(
+    uint8_t group,
+    int module,
+    uint8_t cells,
+    DiscoverySink& sink
+) {
+    switch (group) {
+        case DG_STACK: return publishDiscoveryStack(sink);
+        case DG_PWR:   return publishDiscoveryPwrModule(module, sink);
+        case DG_BAT:   return publishDiscoveryBatModule(module, cells, sink);
+        case DG_STAT:  return publishDiscoveryStatModule(module, sink);
+    }
+    return false;
+}
+
+bool PyMqtt::publishDiscoveryGroup(
+    uint8_t group,
+    int module,
+    uint8_t cells,
+    bool device,
+    bool remove
+) {
+    String ids, name;
+    discoveryDevice(group, module, ids, name);
+
+    if (!device) {
+        EntitySink sink(mqttClient, ids, name, remove);
+        return publishDiscoveryComponents(group, module, cells, sink);
+    }
+
+    String topic = "homeassistant/device/" + ids + "/config";
+
+    if (remove)
+        return mqttClient.publish(topic.c_str(), "", true);
+
+    bool built = true;
+    auto render = [&](Print& out) {
+        out.print("{\"dev\":{\"ids\":");
+        printJsonString(out, ids.c_str());
+        out.print(",\"name\":");
+        printJsonString(out, name.c_str());
+        out.print("},\"o\":{\"name\":\"PylontechMonitor\"},\"cmps\":{");
+
+        DeviceSink sink(out);
+        built &= publishDiscoveryComponents(group, module, cells, sink);
+
+        out.print("}}");
+    };
+
+    // Device message over the 16 bit MQTT length (many cells × many
+    // fields) → this group falls back to entity messages; the device
+    // topic is cleared so HA does not keep an old, smaller version.
+    CountingPrint counter;
+    render(counter);
+    if (MqttTransport::publishSize(topic.c_str(), counter.count) > MQTT_MAX_PACKET) {
+        static bool warned = false;
+        if (!warned) {
+            LOGW(LOGM_MQTT, "discovery: %s has %u bytes, too large for one device message → entity messages",
+                 ids.c_str(), counter.count);
+            warned = true;
+        }
+        if (!mqttClient.publish(topic.c_str(), "", true)) return false;
+
+        EntitySink sink(mqttClient, ids, name, false);
+        return publishDiscoveryComponents(group, module, cells, sink);
+    }
+
+    built = true;
+    PubResult r = publishStreamed(mqttClient, transport, topic.c_str(), render, true);
+
+    return r == PUB_OK && built;
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY: STACK
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishDiscoveryStack(DiscoverySink& sink) {
+    if (!enabled || !mqttClient.connected()) return false;
+
+    String prefix = config.mqtt.prefix;
+    String sub    = config.mqtt.topicStack;
+    String stateTopic = prefix + "/" + sub;
+
+    // Cleaned prefix for IDs
+    String prefixId = sanitizeId(prefix);
+
+    // keys of publishStack()
+    static const char* const keys[] = {
+        "StackVoltAvg", "StackCurrSum", "StackTempMax", "BatteryCount"
+    };
+    bool ok = true;
+
+    for (const char* k : keys) {
+
+        String key = k;                  // z.B. "StackVoltAvg"
+        String fullName = key;           // Anzeigename in HA
+
+        // Build unique_id and entity_id from cleaned prefix + key
+        String uniqueId = prefixId + "_stack_" + sanitizeId(key);
+
+        String entityId = uniqueId;      // HA macht später sensor.<entityId>
+        // entityId ist bereits lowercase/safe durch sanitizeId
+
+        StaticJsonDocument<512> doc;
+
+        // Sichtbarer Name in HA (unverändert)
+        doc["name"]   = fullName;
+        doc["uniq_id"] = uniqueId;
+        doc["obj_id"]  = entityId;
+
+        doc["state_topic"]    = stateTopic;
+        doc["value_template"] = "{{ value_json." + key + " }}";
+
+        // Unit detection
+        String unit = "";
+        if (key == "StackVoltAvg") unit = "V";
+        else if (key == "StackCurrSum") unit = "A";
+        else if (key == "StackTempMax") unit = "°C";
+        else if (key == "BatteryCount") unit = "";
+
+        // Suggested precision only if different from HA default (0)
+        if (precisionDiffersFromDefault(unit)) {
+            doc["suggested_display_precision"] = precisionForUnit(unit);
+        }
+
+        // Device class + unit
+        if (unit == "V") {
+            doc["device_class"] = "voltage";
+            doc["unit_of_measurement"] = "V";
+        }
+        else if (unit == "A") {
+            doc["device_class"] = "current";
+            doc["unit_of_measurement"] = "A";
+        }
+        else if (unit == "°C") {
+            doc["device_class"] = "temperature";
+            doc["unit_of_measurement"] = "°C";
+        }
+
+        doc["state_class"] = "measurement";
+
+        ok &= sink.component(uniqueId, doc);
+    }
+    return ok;
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY: PWR MODULE
+   ---------------------------------------------------------------------------
+   - Visible names (doc["name"]) remain exactly as user entered them
+   - unique_id, obj_id, dev.ids are sanitized for HA compatibility
+   - JSON keys use normalizeName(fc.display) exactly like publishBat()
+   - Text + Date fields send NO metadata (HA would reject them otherwise)
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishDiscoveryPwrModule(int moduleIndex, DiscoverySink& sink) {
+    if (!enabled || !mqttClient.connected()) return false;
+
+    String prefix      = config.mqtt.prefix;        // visible
+    String prefixId    = sanitizeId(prefix);        // HA-safe
+    String subtopic    = config.mqtt.topicPwr;      // visible
+    String subtopicId  = sanitizeId(subtopic);      // HA-safe
+    String stateTopic  = prefix + "/" + subtopic + "/" + String(moduleIndex);
+    bool ok = true;
+
+    for (auto &kv : config.battery.fieldsPwr) {
+
+        const String& fieldName = kv.first;
+        const FieldConfig& fc   = kv.second;
+
+        if (!fc.mqtt) continue;
+
+        // JSON key used by publisher
+        String displayKey = normalizeName(fc.display);
+
+        // Visible name in HA
+        String friendly = fc.display;
+
+        // Build unique_id (HA-safe)
+        String uniqueId =
+            prefixId + "_" +
+            subtopicId + "_" +
+            String(moduleIndex) + "_" +
+            sanitizeId(displayKey);
+
+        // Entity ID (HA will prepend sensor.)
+        String entityId = uniqueId;
+
+        StaticJsonDocument<512> doc;
+
+        // Visible name in HA (unchanged)
+        doc["name"]    = friendly;
+        doc["uniq_id"] = uniqueId;
+        doc["obj_id"]  = entityId;
+
+        // State topic
+        doc["state_topic"] = stateTopic;
+
+        // Template must match publisher JSON key
+        doc["value_template"] =
+            "{{ value_json." + displayKey + " }}";
+
+        /* ---------------------------------------------------------
+           TEXT FIELDS → no metadata at all
+        --------------------------------------------------------- */
+        if (fc.factor == "text") {
+            // No device_class, no unit, no precision, no state_class
+        }
+
+        /* ---------------------------------------------------------
+           DATE/TIMESTAMP → treat as text
+           (Publisher already converts " " → "T")
+        --------------------------------------------------------- */
+        else if (fc.factor == "date" || fc.unit == "timestamp") {
+            // Also no metadata
+        }
+
+        /* ---------------------------------------------------------
+           NUMERIC FIELDS → normal metadata
+        --------------------------------------------------------- */
+        else {
+            addDiscoveryMeta(doc, fc);
+        }
+
+        ok &= sink.component(uniqueId, doc);
+    }
+    return ok;
+}
+/* ---------------------------------------------------------------------------
+   DISCOVERY: BAT MODULE (all cells of the last BAT frame)
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishDiscoveryBatModule(int moduleIndex, uint8_t cells, DiscoverySink& sink) {
+    if (!enabled || !mqttClient.connected()) return false;
+    if (cells == 0) return false;   // no cell layout yet
+
+    bool ok = true;
+    for (uint8_t cell = 0; cell < cells; cell++)
+        ok &= publishDiscoveryBatCell(moduleIndex, cell, sink);
+    return ok;
+}
+
+/* ---------------------------------------------------------------------------
+   DISCOVERY: BAT CELL FIELD
+   ---------------------------------------------------------------------------
+   - Visible names (doc["name"]) remain exactly as user entered them
+   - unique_id, obj_id, dev.ids are sanitized for HA compatibility
+   - JSON keys use fc.display exactly like publishBatCells()
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishDiscoveryBatCell(int moduleIndex, int cellIndex, DiscoverySink& sink) {
+    if (!enabled || !mqttClient.connected()) return false;
+
+    String prefix      = config.mqtt.prefix;        // visible
+    String prefixId    = sanitizeId(prefix);        // HA-safe
+    String subtopic    = config.mqtt.topicBat;      // visible
+    String subtopicId  = sanitizeId(subtopic);      // HA-safe
+
+    // bulk-only mode: the cell lives in the module document
+    bool bulkOnly = config.mqtt.batMode == "bulk";
+
+    String stateTopic =
+        prefix + "/" + subtopic + "/" + String(moduleIndex);
+
+    if (!bulkOnly)
+        stateTopic += "/" + config.mqtt.cellPrefix + String(cellIndex);
+
+    String valuePath = bulkOnly
+        ? "value_json.Cells[" + String(cellIndex) + "]."
+        : String("value_json.");
+    bool ok = true;
+
+    for (auto &kv : config.battery.fieldsBat) {
+
+        const String& fieldName = kv.first;
+        const FieldConfig& fc   = kv.second;
+        if (!fc.mqtt) continue;
+
+        // JSON key used by publisher (BAT uses fc.display directly)
+        String key = fc.display;
+
+        // Visible name in HA
+        String friendly = "Cell " + String(cellIndex) + " " + fc.display;
+
+        // Build unique_id (HA-safe)
+        String uniqueId =
+            prefixId + "_" +
+            subtopicId + "_" +
+            String(moduleIndex) + "_cell" +
+            String(cellIndex) + "_" +
+            sanitizeId(key);
+
+        // Entity ID (HA will prepend sensor.)
+        String entityId = uniqueId;
+
+        StaticJsonDocument<512> doc;
+
+        // Visible name in HA (unchanged)
+        doc["name"]    = friendly;
+        doc["uniq_id"] = uniqueId;
+        doc["obj_id"]  = entityId;
+
+        // State topic
+        doc["state_topic"] = stateTopic;
+
+        // Template must match publisher JSON key
+        doc["value_template"] =
+            "{{ " + valuePath + key + " }}";
+
+        // Unit + device_class + precision
+        bool isNumeric =
+            !(fc.factor == "text" ||
+              fc.factor == "date" ||
+              fc.unit   == "timestamp");
+
+        if (isNumeric) {
+            if (precisionDiffersFromDefault(fc.unit))
+                doc["suggested_display_precision"] = precisionForUnit(fc.unit);
+
+            if (fc.unit == "V")  doc["device_class"] = "voltage";
+            if (fc.unit == "A")  doc["device_class"] = "current";
+            if (fc.unit == "°C") doc["device_class"] = "temperature";
+            if (fc.unit == "%")  doc["device_class"] = "battery";
+            if (fc.unit == "Ah") doc["device_class"] = "energy";
+
+            if (fc.unit.length() > 0)
+                doc["unit_of_measurement"] = fc.unit;
+
+            doc["state_class"] = "measurement";
+        }
+
+        ok &= sink.component(uniqueId, doc);
+    }
+    return ok;
+}
+/* ---------------------------------------------------------------------------
+   DISCOVERY: STAT FIELD
+--------------------------------------------------------------------------- */
+/* ---------------------------------------------------------------------------
+   DISCOVERY: STAT MODULE
+   ---------------------------------------------------------------------------
+   - Visible names (doc["name"]) remain exactly as user entered them
+   - unique_id, obj_id, dev.ids are sanitized for HA compatibility
+   - JSON keys use normalizeName(fc.display) exactly like publishStat()
+--------------------------------------------------------------------------- */
+bool PyMqtt::publishDiscoveryStatModule(int moduleIndex, DiscoverySink& sink) {
+    if (!enabled || !mqttClient.connected()) return false;
+    if (!config.battery.enableStat) return false;
+
+    String prefix      = config.mqtt.prefix;        // visible
+    String prefixId    = sanitizeId(prefix);        // HA-safe
+    String subtopic    = config.mqtt.topicStat;     // visible
+    String subtopicId  = sanitizeId(subtopic);      // HA-safe
+
+    String stateTopic =
+        prefix + "/" + subtopic + "/" + String(moduleIndex);
+    bool ok = true;
+
+    for (auto &kv : config.battery.fieldsStat) {
+
+        const String& fieldName = kv.first;
+        const FieldConfig& fc   = kv.second;
+        if (!fc.mqtt) continue;
+
+        // JSON key used by publisher
+        String displayKey = normalizeName(fc.display);
+
+        // Visible name in HA
+        String friendly = fc.display;
+
+        // Build unique_id (HA-safe)
+        String uniqueId =
+            prefixId + "_" +
+            subtopicId + "_" +
+            String(moduleIndex) + "_" +
+            sanitizeId(displayKey);
+
+        // Entity ID (HA will prepend sensor.)
+        String entityId = uniqueId;
+
+        StaticJsonDocument<512> doc;
+
+        // Visible name in HA (unchanged)
+        doc["name"]    = friendly;
+        doc["uniq_id"] = uniqueId;
+        doc["obj_id"]  = entityId;
+
+        // State topic
+        doc["state_topic"] = stateTopic;
+
+        // Template must match publisher JSON key
+        doc["value_template"] =
+            "{{ value_json." + displayKey + " }}";
+
+        // Unit + device_class + precision
+        addDiscoveryMeta(doc, fc);
+
+        ok &= sink.component(uniqueId, doc);
+    }
+    return ok;
 }
\ No newline at end of file
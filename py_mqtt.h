@@ -1,111 +1,196 @@
-#pragma once
-
-#include <Arduino.h>
-#include <PubSubClient.h>
-#include <WiFiClient.h>
-#include <ArduinoJson.h>
-#include "config.h"
-
-// Forward declarations
-struct BatteryModule;
-struct BatteryStack;
-struct BatField;
-struct BatData;
-struct StatField;
-struct StatData;
-struct ParsedData;
-
-struct MqttMessage {
-    char topic[128];
-    char payload[64];
-};
-
-class PyMqtt {
-public:
-    // Core lifecycle
-    void begin();
-    void loop();
-    void resetDiscovery(bool pwr, bool bat, bool stat);
-
-    // Raw publish (Task1 → Task2)
-    bool publishRaw(const String& topic, const String& payload);
-
-    // Publish parsed data
-    void publishStack(const BatteryStack& stack);
-    void publishBat(int index, const BatteryModule& mod);
-    void publishDiscoveryBatModule(int moduleIndex);
-    void publishDiscoveryBatCell(int moduleIndex, int cellIndex);
-    void publishBatCells(int moduleIndex, const std::vector<BatData>& batCells);
-    void publishStat(int moduleIndex, const StatData& stat);
-
-    bool isDiscoveryActive() const { return discoveryActive; }
-
-    bool isConnected() { return mqttClient.connected(); }
-    void publishDiscoveryStatModule(int moduleIndex);
-
-
-private:
-    WiFiClient   wifiClient;
-    PubSubClient mqttClient = PubSubClient(wifiClient);
-
-    bool enabled = false;
-    bool discoveryActive = false;
-
-    int precisionForUnit(const String& unit);
-    bool precisionDiffersFromDefault(const String& unit);
-
-    // MQTT connection
-    bool connect();
-
-    // Value conversion (numeric, text, date)
-    String computeValue(const String& raw, const FieldConfig& fc);
-
-    // Name normalization (CamelCase)
-    String normalizeName(const String& in);
-
-    // Decimal precision based on unit
-    int decimalsForUnit(const String& unit);
-
-    // Device class based on unit
-    String deviceClassForUnit(const String& unit);
-
-    // Build MQTT topic
-    String buildTopic(
-        const String& subtopic,
-        int moduleIndex,
-        const String& fieldName,
-        int cellIndex,
-        bool isCell
-    );
-
-    // Build unique_id, object_id, friendly_name, discovery topic
-    void buildDiscoveryIds(
-        String& uniqueId,
-        String& objectId,
-        String& friendlyName,
-        String& discoveryTopic,
-        const String& subtopic,
-        int moduleIndex,
-        const String& displayName,
-        int cellIndex,
-        bool isCell
-    );
-
-    // Add HA metadata (unit, device_class, precision)
-    void addDiscoveryMeta(JsonDocument& doc, const FieldConfig& fc);
-
-    // Discovery publishers
-    void publishDiscoveryStack();
-    void publishDiscoveryPwrModule(int moduleIndex);
-    void publishDiscoveryStatField(int moduleIndex, const StatField& f);
-
-    // Discovery state machine
-    void handleDiscoveryStep(
-        const PwrBuffer& pwr,
-        const BatBuffer& bat,
-        const StatBuffer& stat
-    );
-
-    // Logging helper
-    void logPublishFailure(const String& topic);
+#pragma once
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WiFiClient.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "py_format.h"
+#include "py_mqtt_transport.h"
+
+// Forward declarations
+struct BatteryModule;
+struct BatteryStack;
+struct BatData;
+struct StatField;
+struct StatData;
+struct ParsedData;
+class DiscoverySink;
+
+// ---------------------------------------------------------
+// Publish plan (compiled field config)
+// ---------------------------------------------------------
+// One record per frame column, built when the field config
+// (battery.fieldsRevision) or the column layout (header / schema
+// revision) changes. The publish loops only index into it.
+#define PLAN_KEY_LEN  48
+
+enum PlanKind : uint8_t {
+    PLAN_SKIP,       // not configured / MQTT disabled
+    PLAN_NUM,        // numeric: raw × factor (optionally °F)
+    PLAN_TEXT        // factor "text" / "date", unit "timestamp"
+};
+
+enum PlanUnit : uint8_t {
+    UNIT_NONE,
+    UNIT_V,
+    UNIT_A,
+    UNIT_C,
+    UNIT_PERCENT,
+    UNIT_AH,
+    UNIT_TIMESTAMP
+};
+
+struct PlanField {
+    uint8_t     kind;
+    uint8_t     unit;        // PlanUnit
+    FixedFormat fmt;         // factor, decimals (after °F switch), °F
+    float       factor;      // float path if !fmt.exact
+    float       deadband;
+    uint32_t    silenceMs;   // 0 = publish every cycle
+    char        key[PLAN_KEY_LEN];   // JSON key
+};
+
+struct PublishPlan {
+    bool       valid = false;
+    uint32_t   fieldsRevision = 0;
+    uint32_t   layout = 0;   // header / schema revision it was built for
+    uint8_t    count = 0;
+    uint8_t    capacity;
+    PlanField* fields;
+
+    PublishPlan(PlanField* f, uint8_t cap) : capacity(cap), fields(f) {}
+};
+
+struct MqttMessage {
+    char topic[128];
+    char payload[64];
+};
+
+class PyMqtt {
+public:
+    // Core lifecycle
+    void begin();
+    void loop();
+    void resetDiscovery(bool pwr, bool bat, bool stat);
+
+    // Raw publish (Task1 → Task2)
+    bool publishRaw(const String& topic, const String& payload);
+
+    // Publish parsed data
+    // Value publishers: true = done (sent, stored / dropped offline or
+    // nothing due), false = deferred / failed → the caller retries with
+    // this result
+    bool publishStack(const BatteryStack& stack);
+    bool publishBat(int index, const PwrHeader& header, const BatteryModule& mod);
+    bool publishDiscoveryBatModule(int moduleIndex, uint8_t cells, DiscoverySink& sink);
+    bool publishDiscoveryBatCell(int moduleIndex, int cellIndex, DiscoverySink& sink);
+    bool publishBatCells(int moduleIndex, const BatBuffer& bat);
+    bool publishStat(int moduleIndex, const StatData& stat);
+
+    // Value as published for this field config (web APIs)
+    const char* formatFieldValue(const FieldConfig& fc, const char* raw, char* out, size_t cap);
+
+    bool isDiscoveryActive() const { return discoveryActive; }
+
+    bool isConnected() { return mqttClient.connected(); }
+
+    // Outbox / backpressure statistics (/api/mqtt/stats)
+    const MqttTransportStats& transportStats() const { return transport.stats(); }
+    size_t outboxQueued() const { return transport.queued(); }
+    uint8_t inflight() const { return transport.inflight(); }
+    bool publishDiscoveryStatModule(int moduleIndex, DiscoverySink& sink);
+
+
+private:
+    MqttTransport transport;      // non-blocking socket + outbox
+    PubSubClient  mqttClient = PubSubClient(transport);
+
+    bool enabled = false;
+    bool discoveryActive = false;
+
+    int precisionForUnit(const String& unit);
+    bool precisionDiffersFromDefault(const String& unit);
+
+    // MQTT connection
+    bool connect();
+
+    // Snapshot publishing, offline capture (flash ring) and replay
+    void publishSnapshots();
+    void captureOffline();
+    void replayOffline();
+
+    // Publish plan
+    void compileField(PlanField& pf, const FieldConfig* fc, bool normalizeKey);
+
+    // Value conversion (numeric, text, date) → out, returns out
+    const char* formatValue(const PlanField& pf, const char* raw, char* out, size_t cap);
+    const char* formatNumeric(const PlanField& pf, float raw, char* out, size_t cap);
+    const char* formatFixedValue(const PlanField& pf, int64_t raw, uint8_t rawScale,
+                                 char* out, size_t cap);
+
+    // One BAT cell as JSON object (streamed, see publishStreamed)
+    void printBatCell(Print& out, const BatBuffer& bat, uint8_t cell);
+    const char* formatBatCell(const BatBuffer& bat, uint8_t c, uint8_t cell,
+                              char* out, size_t cap);
+
+    // Change detection (deadband / max silence) for one BAT cell
+    bool batCellDue(int moduleIndex, const BatBuffer& bat, uint8_t cell,
+                    uint32_t now, bool mark);
+
+    // Name normalization (CamelCase)
+    String normalizeName(const String& in);
+
+    // Decimal precision based on unit
+    int decimalsForUnit(const String& unit);
+
+    // Device class based on unit
+    String deviceClassForUnit(const String& unit);
+
+    // Build MQTT topic
+    String buildTopic(
+        const String& subtopic,
+        int moduleIndex,
+        const String& fieldName,
+        int cellIndex,
+        bool isCell
+    );
+
+    // Build unique_id, object_id, friendly_name, discovery topic
+    void buildDiscoveryIds(
+        String& uniqueId,
+        String& objectId,
+        String& friendlyName,
+        String& discoveryTopic,
+        const String& subtopic,
+        int moduleIndex,
+        const String& displayName,
+        int cellIndex,
+        bool isCell
+    );
+
+    // Add HA metadata (unit, device_class, precision)
+    void addDiscoveryMeta(JsonDocument& doc, const FieldConfig& fc);
+
+    // Discovery publishers: one JSON document per sensor → sink
+    // (true = every component was delivered)
+    bool publishDiscoveryStack(DiscoverySink& sink);
+    bool publishDiscoveryPwrModule(int moduleIndex, DiscoverySink& sink);
+    void publishDiscoveryStatField(int moduleIndex, const StatField& f);
+
+    // One discovery group in entity or device mode (or its removal)
+    bool publishDiscoveryComponents(uint8_t group, int module,
+                                    uint8_t cells, DiscoverySink& sink);
+    bool publishDiscoveryGroup(uint8_t group, int module, uint8_t cells,
+                               bool device, bool remove);
+
+    // Discovery state machine (one group per step, hash compared)
+    bool discoveryGroup(uint8_t group, int module);
+    void handleDiscoveryStep(
+        const PwrBuffer& pwr,
+        const StatBuffer& stat
+    );
+
+    // Logging helper
+    void logPublishFailure(const String& topic);
 };
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "py_mqtt_offline.h"
+#include "py_log.h"
+#include <SPIFFS.h>
+
+MqttOfflineStore mqttOffline;
+
+#define SEGMENT_MAGIC   0x464F5950u     // "PYOF"
+#define RECORD_MAGIC    0x5259u         // "YR"
+
+// ---------------------------------------------------------
+// CRC32 (IEEE, nibble table - records are small)
+// ---------------------------------------------------------
+static const uint32_t crcNibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crcAdd(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------
+// Segments
+// ---------------------------------------------------------
+void MqttOfflineStore::path(char* out, size_t cap, int slot) const {
+    snprintf(out, cap, "/mqoff%d.bin", slot);
+}
+
+int MqttOfflineStore::oldestSlot() const {
+    int slot = -1;
+    for (int i = 0; i < OFFLINE_SEGMENTS; i++) {
+        if (segSeq[i] == 0) continue;
+        if (slot < 0 || segSeq[i] < segSeq[slot]) slot = i;
+    }
+    return slot;
+}
+
+void MqttOfflineStore::begin() {
+    if (SPIFFS.totalBytes() == 0) {
+        LOGW(LOGM_MQTT, "offline store: SPIFFS not mounted, disabled");
+        return;
+    }
+
+    char p[16];
+    uint32_t newest = 0;
+
+    for (int i = 0; i < OFFLINE_SEGMENTS; i++) {
+        path(p, sizeof(p), i);
+        if (!SPIFFS.exists(p)) continue;
+
+        File f = SPIFFS.open(p, "r");
+        SegmentHeader h;
+        bool ok = f && f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+                  h.magic == SEGMENT_MAGIC && h.seq != 0;
+        size_t size = f ? f.size() : 0;
+        if (f) f.close();
+
+        if (!ok) {
+            SPIFFS.remove(p);
+            continue;
+        }
+
+        segSeq[i]  = h.seq;
+        segSize[i] = size;
+
+        if (h.seq >= nextSeq) nextSeq = h.seq + 1;
+        if (h.seq > newest) { newest = h.seq; writeSlot = i; }
+    }
+
+    // old segments are only read; the next sample starts a new one
+    // (a torn record at the end of the last segment stays harmless)
+    readSlot = oldestSlot();
+    readOffset = sizeof(SegmentHeader);
+    ready = true;
+
+    if (readSlot >= 0)
+        LOGI(LOGM_MQTT, "offline store: %u segments (%u bytes) to replay",
+             segmentsUsed(), pendingBytes());
+}
+
+bool MqttOfflineStore::openWrite(int slot) {
+    // ring full → the oldest segment makes room
+    if (segSeq[slot] != 0) {
+        dropSegment(slot);
+        st.lostSegments++;
+    }
+
+    char p[16];
+    path(p, sizeof(p), slot);
+
+    writeFile = SPIFFS.open(p, "w");
+    if (!writeFile) return false;
+
+    SegmentHeader h = { SEGMENT_MAGIC, nextSeq };
+    if (writeFile.write((const uint8_t*)&h, sizeof(h)) != sizeof(h)) {
+        writeFile.close();
+        SPIFFS.remove(p);
+        return false;
+    }
+
+    writeSlot = slot;
+    segSeq[slot] = nextSeq++;
+    segSize[slot] = sizeof(h);
+    dirty = true;
+
+    if (readSlot < 0) {
+        readSlot = slot;
+        readOffset = sizeof(h);
+    }
+    return true;
+}
+
+void MqttOfflineStore::closeWrite() {
+    if (!writeFile) return;
+    writeFile.close();
+    dirty = false;
+}
+
+void MqttOfflineStore::dropSegment(int slot) {
+    if (slot == writeSlot) closeWrite();
+    if (slot == readSlot && readFile) readFile.close();
+
+    char p[16];
+    path(p, sizeof(p), slot);
+    SPIFFS.remove(p);
+
+    segSeq[slot] = 0;
+    segSize[slot] = 0;
+
+    if (slot == readSlot) {
+        readSlot = oldestSlot();
+        readOffset = sizeof(SegmentHeader);
+    }
+}
+
+void MqttOfflineStore::flushIfDue(bool force) {
+    if (!dirty || !writeFile) return;
+    if (!force && millis() - lastFlush < OFFLINE_FLUSH_MS) return;
+
+    writeFile.flush();
+    dirty = false;
+    lastFlush = millis();
+}
+
+// ---------------------------------------------------------
+// Append
+// ---------------------------------------------------------
+bool MqttOfflineStore::append(uint32_t ts, const char* topic, const char* payload, size_t len) {
+    if (!ready) {
+        st.dropped++;
+        return false;
+    }
+
+    if (ts == 0) {
+        st.noTime++;
+        return false;
+    }
+
+    size_t topicLen = strlen(topic);
+    if (topicLen > 255 || topicLen + len > OFFLINE_MAX_RECORD) {
+        st.dropped++;
+        return false;
+    }
+
+    uint32_t need = sizeof(RecordHeader) + topicLen + len;
+
+    if (!writeFile || segSize[writeSlot] + need > OFFLINE_SEGMENT_SIZE) {
+        closeWrite();
+        int slot = writeSlot < 0 ? 0 : (writeSlot + 1) % OFFLINE_SEGMENTS;
+        if (!openWrite(slot)) {
+            LOGW(LOGM_MQTT, "offline store: cannot open segment %d", slot);
+            st.dropped++;
+            return false;
+        }
+    }
+
+    RecordHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic    = RECORD_MAGIC;
+    h.len      = topicLen + len;
+    h.ts       = ts;
+    h.topicLen = topicLen;
+
+    uint32_t crc = crcAdd(0xFFFFFFFFu, &h, offsetof(RecordHeader, crc));
+    crc = crcAdd(crc, topic, topicLen);
+    crc = crcAdd(crc, payload, len);
+    h.crc = ~crc;
+
+    size_t n = writeFile.write((const uint8_t*)&h, sizeof(h));
+    n += writeFile.write((const uint8_t*)topic, topicLen);
+    n += writeFile.write((const uint8_t*)payload, len);
+
+    segSize[writeSlot] += n;
+    dirty = true;
+
+    if (n != need) {
+        // flash full / write error: the torn record ends this segment
+        LOGW(LOGM_MQTT, "offline store: write failed");
+        closeWrite();
+        st.dropped++;
+        return false;
+    }
+
+    st.stored++;
+    flushIfDue(false);
+    return true;
+}
+
+// ---------------------------------------------------------
+// Replay
+// ---------------------------------------------------------
+bool MqttOfflineStore::peek(OfflineRecord& rec) {
+    char p[16];
+
+    while (readSlot >= 0) {
+        bool active = (readSlot == writeSlot && writeFile);
+        if (active) {
+            // the reader must see what the writer appended
+            flushIfDue(true);
+            if (readFile) readFile.close();
+        }
+
+        if (readOffset + sizeof(RecordHeader) > segSize[readSlot]) {
+            dropSegment(readSlot);              // consumed
+            continue;
+        }
+
+        if (!readFile) {
+            path(p, sizeof(p), readSlot);
+            readFile = SPIFFS.open(p, "r");
+            if (!readFile) {
+                dropSegment(readSlot);
+                continue;
+            }
+        }
+
+        RecordHeader h;
+        bool ok = readFile.seek(readOffset) &&
+                  readFile.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+                  h.magic == RECORD_MAGIC &&
+                  h.len <= OFFLINE_MAX_RECORD &&
+                  h.topicLen <= h.len &&
+                  readOffset + sizeof(h) + h.len <= segSize[readSlot];
+
+        size_t payloadLen = ok ? h.len - h.topicLen : 0;
+
+        if (ok) {
+            ok = readFile.read((uint8_t*)buf, h.topicLen) == h.topicLen &&
+                 readFile.read((uint8_t*)buf + h.topicLen + 1, payloadLen) == payloadLen;
+        }
+
+        if (ok) {
+            uint32_t crc = crcAdd(0xFFFFFFFFu, &h, offsetof(RecordHeader, crc));
+            crc = crcAdd(crc, buf, h.topicLen);
+            crc = crcAdd(crc, buf + h.topicLen + 1, payloadLen);
+            ok = (~crc == h.crc);
+        }
+
+        if (!ok) {
+            // no resync inside a segment: the rest of it is skipped
+            st.corrupt++;
+            LOGW(LOGM_MQTT, "offline store: corrupt record in segment %d at %u",
+                 readSlot, readOffset);
+            readOffset = segSize[readSlot];
+            continue;
+        }
+
+        buf[h.topicLen] = '\0';
+        buf[h.topicLen + 1 + payloadLen] = '\0';
+
+        rec.ts         = h.ts;
+        rec.topic      = buf;
+        rec.payload    = buf + h.topicLen + 1;
+        rec.payloadLen = payloadLen;
+
+        peekLen = sizeof(h) + h.len;
+        return true;
+    }
+    return false;
+}
+
+void MqttOfflineStore::pop() {
+    if (readSlot < 0 || peekLen == 0) return;
+
+    readOffset += peekLen;
+    peekLen = 0;
+    st.replayed++;
+
+    // segment done → delete it now, a reboot must not replay it again
+    if (readOffset + sizeof(RecordHeader) > segSize[readSlot])
+        dropSegment(readSlot);
+}
+
+size_t MqttOfflineStore::pendingBytes() const {
+    size_t bytes = 0;
+    for (int i = 0; i < OFFLINE_SEGMENTS; i++) {
+        if (segSeq[i] != 0 && segSize[i] > sizeof(SegmentHeader))
+            bytes += segSize[i] - sizeof(SegmentHeader);
+    }
+    if (readSlot >= 0 && readOffset > sizeof(SegmentHeader))
+        bytes -= readOffset - sizeof(SegmentHeader);
+    return bytes;
+}
+
+uint8_t MqttOfflineStore::segmentsUsed() const {
+    uint8_t n = 0;
+    for (int i = 0; i < OFFLINE_SEGMENTS; i++)
+        if (segSeq[i] != 0) n++;
+    return n;
+}
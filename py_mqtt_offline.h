@@ -0,0 +1,109 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+
+// ---------------------------------------------------------
+// MQTT offline store (store-and-forward on SPIFFS)
+// ---------------------------------------------------------
+// While WiFi or the broker is down, the MQTT task keeps rendering the
+// PWR / BAT / STAT documents and appends them here instead of dropping
+// them. After the reconnect they are replayed at a limited pace to
+// <prefix>/replay/<subtopic> with the original time as "ts" (epoch
+// seconds), so a recorder (Telegraf, Node-RED, ...) can fill the gap.
+//
+// Layout: OFFLINE_SEGMENTS files /mqoff<N>.bin of OFFLINE_SEGMENT_SIZE
+// bytes, written in circular order (every segment gets the same
+// number of erase cycles). Each segment starts with a SegmentHeader
+// (magic + sequence number), followed by binary records:
+//
+//   RecordHeader (16 bytes, CRC32 over header + data) | topic | payload
+//
+// When the ring is full, the oldest segment is dropped. A replayed
+// segment is deleted as a whole; a reboot during replay only repeats
+// the records of the current segment (same "ts" → easy to dedupe).
+// Torn or corrupt records end their segment (counted in stats).
+// ---------------------------------------------------------
+
+#define OFFLINE_SEGMENTS        16
+#define OFFLINE_SEGMENT_SIZE    16384   // bytes per segment file
+#define OFFLINE_MAX_RECORD      2048    // topic + payload
+#define OFFLINE_FLUSH_MS        5000    // max. unflushed time of the write file
+
+struct OfflineStats {
+    uint32_t stored = 0;         // records appended since boot
+    uint32_t replayed = 0;       // records replayed since boot
+    uint32_t dropped = 0;        // records not stored (too large, write error, no SPIFFS)
+    uint32_t lostSegments = 0;   // oldest segments overwritten (ring full)
+    uint32_t corrupt = 0;        // records with bad magic / CRC
+    uint32_t noTime = 0;         // samples skipped: system time not set (ts = 0)
+};
+
+struct OfflineRecord {
+    uint32_t    ts;              // epoch seconds of the sample
+    const char* topic;           // subtopic (below config.mqtt.prefix)
+    const char* payload;         // JSON document
+    size_t      payloadLen;
+};
+
+class MqttOfflineStore {
+public:
+    // After SPIFFS is mounted: scan existing segments (kept over reboot)
+    void begin();
+
+    // Append one sample (ts = 0: time unknown → skipped), false if not
+    // stored; every sample not stored is counted (noTime / dropped)
+    bool append(uint32_t ts, const char* topic, const char* payload, size_t len);
+
+    // Oldest record (valid until the next call), false if empty
+    bool peek(OfflineRecord& rec);
+    void pop();
+
+    bool   pending() const { return ready && readSlot >= 0; }
+    size_t pendingBytes() const;
+    uint8_t segmentsUsed() const;
+
+    const OfflineStats& stats() const { return st; }
+
+private:
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t seq;
+    };
+
+    struct RecordHeader {
+        uint16_t magic;
+        uint16_t len;            // topic + payload
+        uint32_t ts;
+        uint8_t  topicLen;
+        uint8_t  reserved[3];
+        uint32_t crc;            // CRC32 of the bytes above + data
+    };
+
+    void path(char* out, size_t cap, int slot) const;
+    int  oldestSlot() const;
+    bool openWrite(int slot);
+    void closeWrite();
+    void dropSegment(int slot);
+    void flushIfDue(bool force);
+
+    bool ready = false;
+
+    uint32_t segSeq[OFFLINE_SEGMENTS] = {0};    // 0 = unused
+    uint32_t segSize[OFFLINE_SEGMENTS] = {0};
+    uint32_t nextSeq = 1;
+
+    int      writeSlot = -1;                    // newest segment
+    File     writeFile;
+    uint32_t lastFlush = 0;
+    bool     dirty = false;
+
+    int      readSlot = -1;                     // oldest segment, -1 = empty
+    uint32_t readOffset = 0;
+    File     readFile;
+    uint32_t peekLen = 0;                       // bytes of the peeked record
+
+    char buf[OFFLINE_MAX_RECORD + 2];          // topic \0 payload \0
+    OfflineStats st;
+};
+
+extern MqttOfflineStore mqttOffline;
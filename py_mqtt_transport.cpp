@@ -0,0 +1,370 @@
+#include "py_mqtt_transport.h"
+#include "py_log.h"
+#include <lwip/sockets.h>
+#include <errno.h>
+
+// ---------------------------------------------------------
+// Connection
+// ---------------------------------------------------------
+// The QoS 1 window survives connect() / stop(): resendInflight()
+// sends it again once the broker accepted the new session.
+int MqttTransport::connect(IPAddress ip, uint16_t port) {
+    stop();
+    return sock.connect(ip, port);
+}
+
+int MqttTransport::connect(const char* host, uint16_t port) {
+    stop();
+    return sock.connect(host, port);
+}
+
+int MqttTransport::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+    stop();
+    return sock.connect(ip, port, timeout);
+}
+
+int MqttTransport::connect(const char* host, uint16_t port, int32_t timeout) {
+    stop();
+    return sock.connect(host, port, timeout);
+}
+
+void MqttTransport::stop() {
+    head = count = 0;
+    capturing = false;           // a cut QoS 1 packet is not kept
+    oldestSentAt = millis();     // PUBACK timeout restarts with the next session
+    resetRx();
+    sock.stop();
+}
+
+uint8_t MqttTransport::connected() {
+    return sock.connected();
+}
+
+void MqttTransport::fail(const char* why) {
+    st.errors++;
+    LOGW(LOGM_MQTT, "transport: %s → reconnect", why);
+    stop();
+}
+
+// ---------------------------------------------------------
+// Socket write without blocking
+// ---------------------------------------------------------
+int MqttTransport::sendNow(const uint8_t* buf, size_t len) {
+    int fd = sock.fd();
+    if (fd < 0) return -1;
+
+    int n = ::send(fd, buf, len, MSG_DONTWAIT);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            st.wouldBlock++;
+            return 0;
+        }
+        return -1;
+    }
+
+    st.sentBytes += n;
+    return n;
+}
+
+void MqttTransport::pump() {
+    if (inflightCount > 0 && millis() - oldestSentAt > MQTT_INFLIGHT_TIMEOUT_MS) {
+        fail("no PUBACK");
+        return;
+    }
+    if (count == 0) return;
+
+    uint32_t t0 = micros();
+
+    while (count > 0) {
+        // contiguous part up to the ring end
+        size_t len = count;
+        if (head + len > MQTT_OUTBOX_SIZE) len = MQTT_OUTBOX_SIZE - head;
+
+        int n = sendNow(ring + head, len);
+        if (n < 0) { fail("send failed"); break; }
+        if (n == 0) break;                       // TCP window full
+
+        head = (head + n) % MQTT_OUTBOX_SIZE;
+        count -= n;
+    }
+    if (count == 0) head = 0;
+
+    uint32_t dt = micros() - t0;
+    if (dt > st.pumpMaxUs) st.pumpMaxUs = dt;
+}
+
+bool MqttTransport::drain(uint32_t timeoutMs) {
+    uint32_t start = millis();
+    while (count > 0) {
+        pump();
+        if (count == 0) break;
+        if (!sock.connected() || millis() - start > timeoutMs) return false;
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+void MqttTransport::setBlocking(bool on) {
+    blocking = on;
+}
+
+// ---------------------------------------------------------
+// Writes (PubSubClient)
+// ---------------------------------------------------------
+size_t MqttTransport::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t MqttTransport::write(const uint8_t* buf, size_t size) {
+    if (size == 0) return 0;
+
+    // QoS 1 packet in progress → keep a copy for the resend
+    if (capturing) {
+        size_t pos = (keepHead + keepCount + captured) % MQTT_INFLIGHT_BYTES;
+        for (size_t i = 0; i < size && captured + i < captureLen; i++) {
+            keep[pos] = buf[i];
+            pos = (pos + 1) % MQTT_INFLIGHT_BYTES;
+        }
+        captured += size;
+    }
+
+    if (blocking) {
+        if (!drain(MQTT_BLOCK_TIMEOUT_MS)) {
+            fail("outbox drain timeout");
+            return 0;
+        }
+        size_t n = sock.write(buf, size);
+        st.sentBytes += n;
+        return n;
+    }
+
+    return queue(buf, size) ? size : 0;
+}
+
+bool MqttTransport::queue(const uint8_t* buf, size_t size) {
+    size_t done = 0;
+
+    // nothing queued → straight to the socket (keeps the byte order)
+    if (count == 0) {
+        int n = sendNow(buf, size);
+        if (n < 0) { fail("send failed"); return false; }
+        done = n;
+    }
+
+    // rest → outbox
+    size_t rest = size - done;
+    if (rest > MQTT_OUTBOX_SIZE - count) {
+        // the packet was not reserved with fits() → the stream is cut
+        fail("outbox overflow");
+        return false;
+    }
+
+    size_t tail = (head + count) % MQTT_OUTBOX_SIZE;
+    for (size_t i = 0; i < rest; i++) {
+        ring[tail] = buf[done + i];
+        tail = (tail + 1) % MQTT_OUTBOX_SIZE;
+    }
+    count += rest;
+    if (count > st.queuedMax) st.queuedMax = count;
+
+    return true;
+}
+
+void MqttTransport::flush() {
+    drain(MQTT_BLOCK_TIMEOUT_MS);
+}
+
+// ---------------------------------------------------------
+// Reads (pass through, queued output is pushed first; PUBACKs
+// for the QoS 1 window are picked out on the way)
+// ---------------------------------------------------------
+int MqttTransport::available() {
+    pump();
+    return sock.available();
+}
+
+int MqttTransport::read() {
+    int c = sock.read();
+    if (c >= 0) snoop((uint8_t)c);
+    return c;
+}
+
+int MqttTransport::read(uint8_t* buf, size_t size) {
+    int n = sock.read(buf, size);
+    for (int i = 0; i < n; i++) snoop(buf[i]);
+    return n;
+}
+
+void MqttTransport::resetRx() {
+    rxState = 0;
+}
+
+// fixed header → remaining length → body (first 2 bytes kept)
+void MqttTransport::snoop(uint8_t b) {
+    switch (rxState) {
+        case 0:
+            rxType = b;
+            rxRemain = 0;
+            rxShift = 0;
+            rxState = 1;
+            break;
+
+        case 1:
+            rxRemain |= (uint32_t)(b & 0x7F) << rxShift;
+            rxShift += 7;
+            if (b & 0x80) {
+                if (rxShift > 21) resetRx();     // not MQTT any more
+                break;
+            }
+            rxPos = 0;
+            rxState = rxRemain ? 2 : 0;
+            break;
+
+        default:
+            if (rxPos < sizeof(rxBody)) rxBody[rxPos] = b;
+            rxPos++;
+            if (--rxRemain == 0) {
+                if ((rxType & 0xF0) == 0x40 && rxPos == 2)       // PUBACK
+                    acked(((uint16_t)rxBody[0] << 8) | rxBody[1]);
+                rxState = 0;
+            }
+            break;
+    }
+}
+
+int MqttTransport::peek() {
+    return sock.peek();
+}
+
+// ---------------------------------------------------------
+// Backpressure
+// ---------------------------------------------------------
+bool MqttTransport::fits(size_t packetLen) {
+    if (blocking) return true;
+
+    pump();
+    if (packetLen <= MQTT_OUTBOX_SIZE - count) return true;
+
+    st.deferred++;
+    return false;
+}
+
+size_t MqttTransport::publishSize(const char* topic, size_t payloadLen, uint8_t qos) {
+    size_t remaining = 2 + strlen(topic) + payloadLen + (qos ? 2 : 0);
+
+    size_t lenBytes = 1;
+    for (size_t r = remaining; r >= 128; r >>= 7) lenBytes++;
+
+    return 1 + lenBytes + remaining;
+}
+
+// ---------------------------------------------------------
+// QoS 1 window
+// ---------------------------------------------------------
+bool MqttTransport::inflightFits(size_t packetLen) {
+    if (inflightCount < MQTT_INFLIGHT_MAX && packetLen <= MQTT_INFLIGHT_BYTES - keepCount)
+        return fits(packetLen);
+
+    st.inflightFull++;
+    return false;
+}
+
+bool MqttTransport::beginQos1(const char* topic, size_t payloadLen, bool retained) {
+    size_t topicLen = strlen(topic);
+    size_t packet = publishSize(topic, payloadLen, 1);
+
+    if (capturing || !connected()) return false;
+    if (inflightCount >= MQTT_INFLIGHT_MAX || packet > MQTT_INFLIGHT_BYTES - keepCount)
+        return false;
+
+    uint16_t id = nextId;
+    nextId = nextId == 0xFFFF ? 0x8000 : nextId + 1;
+
+    // PUBLISH, QoS 1 | remaining length | topic | packet id
+    uint8_t hdr[8];
+    size_t n = 0;
+    hdr[n++] = 0x32 | (retained ? 1 : 0);
+    size_t remaining = 2 + topicLen + 2 + payloadLen;
+    do {
+        uint8_t d = remaining & 0x7F;
+        remaining >>= 7;
+        hdr[n++] = d | (remaining ? 0x80 : 0);
+    } while (remaining);
+    hdr[n++] = topicLen >> 8;
+    hdr[n++] = topicLen & 0xFF;
+
+    capturing = true;
+    captured = 0;
+    captureLen = packet;
+
+    inflightList[(inflightFirst + inflightCount) % MQTT_INFLIGHT_MAX] = { id, (uint16_t)packet, false };
+
+    uint8_t idBytes[2] = { (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+    write(hdr, n);
+    write((const uint8_t*)topic, topicLen);
+    write(idBytes, 2);
+
+    return capturing;            // false: fail() cut the connection
+}
+
+bool MqttTransport::endQos1() {
+    if (!capturing) return false;
+    capturing = false;
+
+    if (captured != captureLen) {
+        fail("QoS 1 packet length");
+        return false;
+    }
+
+    keepCount += captured;
+    if (inflightCount++ == 0) oldestSentAt = millis();
+    st.qos1Sent++;
+    return true;
+}
+
+void MqttTransport::acked(uint16_t id) {
+    bool found = false;
+    for (uint8_t i = 0; i < inflightCount; i++) {
+        Inflight& f = inflightList[(inflightFirst + i) % MQTT_INFLIGHT_MAX];
+        if (f.id != id || f.acked) continue;
+        f.acked = true;
+        found = true;
+        st.qos1Acked++;
+        break;
+    }
+    if (!found) return;          // late PUBACK of a resent packet
+
+    // free the copies from the front (PUBACKs normally come in order)
+    while (inflightCount > 0 && inflightList[inflightFirst].acked) {
+        Inflight& f = inflightList[inflightFirst];
+        keepHead = (keepHead + f.len) % MQTT_INFLIGHT_BYTES;
+        keepCount -= f.len;
+        inflightFirst = (inflightFirst + 1) % MQTT_INFLIGHT_MAX;
+        inflightCount--;
+        oldestSentAt = millis();
+    }
+    if (keepCount == 0) keepHead = 0;
+}
+
+void MqttTransport::resendInflight() {
+    if (inflightCount == 0) return;
+
+    size_t pos = keepHead;
+    for (uint8_t i = 0; i < inflightCount; i++) {
+        Inflight& f = inflightList[(inflightFirst + i) % MQTT_INFLIGHT_MAX];
+
+        if (!f.acked) {
+            keep[pos] |= 0x08;                          // DUP
+
+            size_t first = f.len;
+            if (pos + first > MQTT_INFLIGHT_BYTES) first = MQTT_INFLIGHT_BYTES - pos;
+            if (!queue(keep + pos, first)) return;
+            if (first < f.len && !queue(keep, f.len - first)) return;
+            st.qos1Resent++;
+        }
+        pos = (pos + f.len) % MQTT_INFLIGHT_BYTES;
+    }
+
+    oldestSentAt = millis();
+    LOGI(LOGM_MQTT, "transport: %u QoS 1 packets sent again", inflightCount);
+}
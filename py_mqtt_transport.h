@@ -0,0 +1,140 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+#include <WiFiClient.h>
+
+// ---------------------------------------------------------
+// Non-blocking MQTT transport
+// ---------------------------------------------------------
+// Client between PubSubClient and the WiFiClient socket. Writes go
+// out with MSG_DONTWAIT; whatever the TCP window does not take is
+// kept in a bounded outbox ring and flushed by pump() from the MQTT
+// loop. A slow broker or weak WiFi therefore no longer blocks the
+// noncritical task (web server, WiFi manager) inside publish().
+//
+// Backpressure: a packet must fit completely (fits()) before the
+// publisher starts writing it - MQTT packets cannot be cut. Callers
+// that get false defer the message (values are republished with the
+// newest data in the next cycle, superseded values are dropped).
+//
+// setBlocking(true) is used for rare large messages (discovery):
+// the outbox is drained first and the socket is written blocking,
+// like the plain WiFiClient did.
+//
+// QoS 1 (offline replay): PubSubClient only publishes QoS 0, so the
+// transport writes the PUBLISH header itself (beginQos1 / endQos1)
+// and keeps a copy of every packet until its PUBACK arrives. PUBACKs
+// are picked out of the byte stream PubSubClient reads (it ignores
+// them). The window is bounded by MQTT_INFLIGHT_MAX packets and
+// MQTT_INFLIGHT_BYTES; when it is full, inflightFits() says no and
+// the caller defers like on a full outbox. After a reconnect the
+// unacknowledged packets are sent again with DUP set (resendInflight),
+// a broker that does not ack within MQTT_INFLIGHT_TIMEOUT_MS is
+// treated as a dead connection. Packet ids start at 0x8000, below
+// are PubSubClient's (SUBSCRIBE).
+// ---------------------------------------------------------
+
+#define MQTT_OUTBOX_SIZE        8192    // bytes
+#define MQTT_BLOCK_TIMEOUT_MS   5000    // setBlocking(): max. drain time
+
+#define MQTT_INFLIGHT_MAX       8       // unacknowledged QoS 1 packets
+#define MQTT_INFLIGHT_BYTES     4096    // copies kept for the resend
+#define MQTT_INFLIGHT_TIMEOUT_MS 30000  // oldest without PUBACK → reconnect
+
+struct MqttTransportStats {
+    uint32_t sentBytes = 0;
+    uint32_t queuedMax = 0;      // outbox high-water mark (bytes)
+    uint32_t deferred = 0;       // packets refused by fits()
+    uint32_t wouldBlock = 0;     // sends that hit a full TCP window
+    uint32_t errors = 0;         // socket errors / cut packets
+    uint32_t pumpMaxUs = 0;      // worst pump() duration
+
+    uint32_t qos1Sent = 0;       // QoS 1 packets written (without resends)
+    uint32_t qos1Acked = 0;      // PUBACKs matched
+    uint32_t qos1Resent = 0;     // packets sent again after a reconnect
+    uint32_t inflightFull = 0;   // QoS 1 packets refused by inflightFits()
+};
+
+class MqttTransport : public Client {
+public:
+    // Client interface (PubSubClient)
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeout);
+    int connect(const char* host, uint16_t port, int32_t timeout);
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    // Outbox
+    void   pump();                           // MQTT loop: push queued bytes
+    bool   fits(size_t packetLen);           // complete packet fits now?
+    size_t queued() const { return count; }
+    void   setBlocking(bool on);
+    bool   isBlocking() const { return blocking; }
+
+    // QoS 1 window
+    bool    inflightFits(size_t packetLen);   // window + outbox have room?
+    bool    beginQos1(const char* topic, size_t payloadLen, bool retained);
+    bool    endQos1();                        // payload went through write()
+    void    resendInflight();                 // after CONNACK
+    uint8_t inflight() const { return inflightCount; }
+
+    // MQTT packet size of a PUBLISH (header + topic [+ id] + payload)
+    static size_t publishSize(const char* topic, size_t payloadLen, uint8_t qos = 0);
+
+    const MqttTransportStats& stats() const { return st; }
+
+private:
+    struct Inflight {
+        uint16_t id;
+        uint16_t len;            // bytes in keep[]
+        bool     acked;
+    };
+
+    int  sendNow(const uint8_t* buf, size_t len);   // bytes taken, -1 = error
+    bool queue(const uint8_t* buf, size_t size);    // socket / outbox, in order
+    bool drain(uint32_t timeoutMs);
+    void fail(const char* why);
+    void resetRx();
+    void snoop(uint8_t b);                          // incoming bytes → PUBACK
+    void acked(uint16_t id);
+
+    WiFiClient sock;
+
+    uint8_t ring[MQTT_OUTBOX_SIZE];
+    size_t  head = 0;            // next byte to send
+    size_t  count = 0;           // bytes queued
+
+    bool blocking = false;
+
+    // QoS 1: copies of the unacknowledged packets, oldest first
+    uint8_t  keep[MQTT_INFLIGHT_BYTES];
+    size_t   keepHead = 0;
+    size_t   keepCount = 0;
+    Inflight inflightList[MQTT_INFLIGHT_MAX];
+    uint8_t  inflightFirst = 0;
+    uint8_t  inflightCount = 0;
+    uint16_t nextId = 0x8000;
+    uint32_t oldestSentAt = 0;
+    bool     capturing = false;  // between beginQos1() and endQos1()
+    size_t   captured = 0;
+    size_t   captureLen = 0;
+
+    // incoming packet framing (only PUBACK is of interest)
+    uint8_t  rxState = 0;
+    uint8_t  rxType = 0;
+    uint32_t rxRemain = 0;
+    uint8_t  rxShift = 0;
+    uint8_t  rxBody[2];
+    uint8_t  rxPos = 0;
+
+    MqttTransportStats st;
+};
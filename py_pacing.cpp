@@ -0,0 +1,158 @@
+#include "py_pacing.h"
+#include "py_log.h"
+
+PyPacing py_pacing;
+
+// EWMA with alpha = 1/4 (first sample is taken as is)
+static inline uint32_t ewma(uint32_t avg, uint32_t sample, uint32_t count) {
+    if (count <= 1) return sample;
+    return (avg * 3 + sample) / 4;
+}
+
+PaceType PyPacing::typeOf(const String& cmd) {
+    if (cmd.startsWith("pwr"))  return PACE_PWR;
+    if (cmd.startsWith("bat"))  return PACE_BAT;
+    if (cmd.startsWith("stat")) return PACE_STAT;
+    return PACE_OTHER;
+}
+
+const char* PyPacing::typeName(PaceType t) {
+    switch (t) {
+        case PACE_PWR:  return "pwr";
+        case PACE_BAT:  return "bat";
+        case PACE_STAT: return "stat";
+        default:        return "other";
+    }
+}
+
+// ---------------------------------------------------------
+// Sample window
+// ---------------------------------------------------------
+static inline uint16_t clamp16(uint32_t v) {
+    return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+void PaceWindow::add(uint32_t fb, uint32_t t) {
+    firstByte[next] = clamp16(fb);
+    total[next]     = clamp16(t);
+    next = (next + 1) % PACE_WINDOW;
+    if (count < PACE_WINDOW) count++;
+}
+
+// 90th percentile (nearest rank) of the filled part, insertion sort
+// on a copy - 16 values, a few hundred cycles per command
+uint32_t PaceWindow::p90(const uint16_t* v) const {
+    if (count == 0) return 0;
+
+    uint16_t s[PACE_WINDOW];
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t x = v[i];
+        int8_t j = i - 1;
+        while (j >= 0 && s[j] > x) { s[j + 1] = s[j]; j--; }
+        s[j + 1] = x;
+    }
+
+    uint8_t rank = (count * 9 + 9) / 10;      // ceil(0.9 × n)
+    return s[rank - 1];
+}
+
+// ---------------------------------------------------------
+void PyPacing::reset() {
+    // keep the statistics, only the timing starts conservative again:
+    // the console may behave differently after a wake-up
+    for (uint8_t t = 0; t < PACE_TYPES; t++) {
+        st[t].gap = PACE_GAP_START;
+        st[t].backoff = 0;
+        st[t].firstByteTimeout = PACE_FIRST_BYTE_MAX;
+        win[t].count = 0;
+        win[t].next = 0;
+    }
+    nextAllowed = millis() + PACE_GAP_START;
+}
+
+void PyPacing::waitGap() {
+    long wait = (long)(nextAllowed - millis());
+    if (wait <= 0) return;
+
+    totalGapMs += wait;
+    vTaskDelay(pdMS_TO_TICKS(wait));
+}
+
+// ---------------------------------------------------------
+// AIMD (fallback): the backoff after bad responses, on top of the
+// percentile gap. Doubles per bad response, shrinks 1/8 per good one.
+// ---------------------------------------------------------
+void PyPacing::aimdFallback(PaceStats& s, PaceResult r) {
+    if (r == PACE_OK) {
+        s.backoff -= s.backoff / 8;
+        if (s.backoff < 8) s.backoff = 0;
+    } else {
+        s.backoff = s.backoff ? min((uint32_t)PACE_GAP_MAX, s.backoff * 2) : s.gap;
+    }
+}
+
+void PyPacing::onResult(PaceType t, PaceResult r,
+                        uint32_t firstByteMs, uint32_t totalMs, size_t bytes)
+{
+    PaceStats& s = st[t];
+    PaceWindow& w = win[t];
+
+    s.count++;
+    totalCommands++;
+    totalRxMs += totalMs;
+
+    if (r == PACE_OK) {
+        s.ok++;
+
+        s.latencyAvg   = ewma(s.latencyAvg, totalMs, s.ok);
+        s.firstByteAvg = ewma(s.firstByteAvg, firstByteMs, s.ok);
+        s.bytesAvg     = ewma(s.bytesAvg, bytes, s.ok);
+
+        if (s.ok == 1 || totalMs < s.latencyMin) s.latencyMin = totalMs;
+        if (totalMs > s.latencyMax) s.latencyMax = totalMs;
+
+        // judged against the window before this sample joins it
+        if (w.count >= PACE_WINDOW_MIN && totalMs > s.latencyP90 + PACE_SLOW_MARGIN) {
+            s.slow++;
+            r = PACE_INVALID;                 // valid data, but back off
+            LOGD(LOGM_SCHED, "pacing: %s slow frame %u ms (p90 %u)", typeName(t), totalMs, s.latencyP90);
+        }
+
+        w.add(firstByteMs, totalMs);
+        s.firstByteP90 = w.p90(w.firstByte);
+        s.latencyP90   = w.p90(w.total);
+    }
+    else {
+        if (r == PACE_INVALID) s.invalid++;
+        else                   s.timeouts++;
+    }
+
+    if (w.count >= PACE_WINDOW_MIN) {
+        // percentile gap + AIMD backoff on top
+        s.gap = max(s.firstByteP90 + PACE_GAP_MARGIN, (uint32_t)PACE_GAP_MIN);
+        aimdFallback(s, r);
+        s.gap = min(s.gap + s.backoff, (uint32_t)PACE_GAP_MAX);
+
+        uint32_t fb = s.firstByteP90 * 2 + PACE_FIRST_BYTE_MARGIN;
+        s.firstByteTimeout = constrain(fb, (uint32_t)PACE_FIRST_BYTE_MIN, (uint32_t)PACE_FIRST_BYTE_MAX);
+    }
+    else {
+        // warm-up: AIMD only, first-byte limit from the average so far
+        s.backoff = 0;
+        if (r == PACE_OK) s.gap -= s.gap / 8;
+        else              s.gap *= 2;
+        s.gap = constrain(s.gap, (uint32_t)PACE_GAP_MIN, (uint32_t)PACE_GAP_MAX);
+
+        if (r == PACE_OK && s.ok > 0) {
+            uint32_t fb = s.firstByteAvg * 4 + PACE_FIRST_BYTE_MARGIN;
+            s.firstByteTimeout = constrain(fb, (uint32_t)PACE_FIRST_BYTE_MIN, (uint32_t)PACE_FIRST_BYTE_MAX);
+        }
+    }
+
+    if (r == PACE_TIMEOUT)
+        s.firstByteTimeout = PACE_FIRST_BYTE_MAX;
+    if (r != PACE_OK)
+        LOGD(LOGM_SCHED, "pacing: %s backoff → gap %u ms", typeName(t), s.gap);
+
+    nextAllowed = millis() + s.gap;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+
+// ---------------------------------------------------------
+// Adaptive UART pacing
+// ---------------------------------------------------------
+// Replaces the fixed 1 s vTaskDelay after every console command.
+// Per command type the controller keeps the last PACE_WINDOW valid
+// responses (send → first byte, send → frame end):
+//
+//   gap              = p90(first byte) + PACE_GAP_MARGIN
+//   first-byte limit = p90(first byte) × 2 + PACE_FIRST_BYTE_MARGIN
+//
+// The echo delay is the console's turnaround time, so the next command
+// waits about that long after the prompt. A frame that ends much later
+// than usual (> p90(frame end) + PACE_SLOW_MARGIN) counts as a sign of
+// a busy console like an invalid frame.
+//
+// AIMD is only the fallback: until PACE_WINDOW_MIN samples exist, and
+// as a backoff on top of the percentile gap after invalid frames /
+// timeouts / slow frames (doubles, then shrinks by 1/8 per good frame).
+// ---------------------------------------------------------
+enum PaceType : uint8_t {
+    PACE_PWR = 0,
+    PACE_BAT,
+    PACE_STAT,
+    PACE_OTHER,
+    PACE_TYPES
+};
+
+enum PaceResult : uint8_t {
+    PACE_OK = 0,
+    PACE_INVALID,
+    PACE_TIMEOUT
+};
+
+#define PACE_GAP_MIN          50      // ms, never closer than this
+#define PACE_GAP_START        300     // ms, after boot / wake-up
+#define PACE_GAP_MAX          3000    // ms, upper bound of the backoff
+#define PACE_GAP_MARGIN       20      // ms on top of p90(first byte)
+#define PACE_FIRST_BYTE_MIN   400     // ms
+#define PACE_FIRST_BYTE_MAX   1500    // ms (old fixed value)
+#define PACE_FIRST_BYTE_MARGIN 100    // ms
+#define PACE_SLOW_MARGIN      250     // ms over p90(frame end) → slow frame
+
+#define PACE_WINDOW           16      // samples per command type
+#define PACE_WINDOW_MIN       4       // below: AIMD only
+
+struct PaceStats {
+    uint32_t count = 0;
+    uint32_t ok = 0;
+    uint32_t invalid = 0;
+    uint32_t timeouts = 0;
+
+    uint32_t latencyAvg = 0;     // EWMA send → frame complete (ms)
+    uint32_t latencyMin = 0;
+    uint32_t latencyMax = 0;
+    uint32_t firstByteAvg = 0;   // EWMA send → first byte (ms)
+    uint32_t bytesAvg = 0;       // EWMA frame size
+
+    uint32_t firstByteP90 = 0;   // over the window (ms)
+    uint32_t latencyP90 = 0;
+    uint32_t slow = 0;           // frames over p90(frame end) + PACE_SLOW_MARGIN
+
+    uint32_t gap = PACE_GAP_START;
+    uint32_t backoff = 0;        // AIMD part on top of the percentile gap
+    uint32_t firstByteTimeout = PACE_FIRST_BYTE_MAX;
+};
+
+// Last PACE_WINDOW valid responses of one command type
+struct PaceWindow {
+    uint16_t firstByte[PACE_WINDOW];
+    uint16_t total[PACE_WINDOW];
+    uint8_t  next = 0;
+    uint8_t  count = 0;
+
+    void add(uint32_t fb, uint32_t t);
+    uint32_t p90(const uint16_t* v) const;
+};
+
+class PyPacing {
+public:
+    static PaceType typeOf(const String& cmd);
+    static const char* typeName(PaceType t);
+
+    void reset();
+
+    // Blocks (vTaskDelay) until the gap after the previous command is over
+    void waitGap();
+
+    uint32_t firstByteTimeout(PaceType t) const { return st[t].firstByteTimeout; }
+
+    // Called once per command after the response was judged
+    void onResult(PaceType t, PaceResult r,
+                  uint32_t firstByteMs, uint32_t totalMs, size_t bytes);
+
+    const PaceStats& stats(PaceType t) const { return st[t]; }
+
+    // Totals for throughput (time spent receiving vs. waiting)
+    uint32_t totalCommands = 0;
+    uint32_t totalRxMs = 0;
+    uint32_t totalGapMs = 0;
+
+private:
+    void aimdFallback(PaceStats& s, PaceResult r);
+
+    PaceStats  st[PACE_TYPES];
+    PaceWindow win[PACE_TYPES];
+    unsigned long nextAllowed = 0;
+};
+
+extern PyPacing py_pacing;
@@ -1,219 +1,347 @@
-#include "py_parser_bat.h"
-#include "py_log.h"
-#include "py_uart.h"
-
-extern PyUart py_uart;
-
-// Globale BAT-Daten (für Web-UI)
-std::vector<BatData> lastParsedBatCells;
-BatData lastParsedBat;
-
-// ---------------------------------------------------------
-// Helper: trim whitespace
-// ---------------------------------------------------------
-static String trimWS(const String& s) {
-    String r = s;
-    r.trim();
-    return r;
-}
-
-// ---------------------------------------------------------
-// Extract @ ... $$ frame
-// ---------------------------------------------------------
-static bool extractFrame(const String& raw, String& frame) {
-    int start = raw.indexOf('@');
-    int end   = raw.indexOf("$$");
-
-    if (start < 0 || end < 0 || end <= start)
-        return false;
-
-    frame = raw.substring(start + 1, end);
-    return true;
-}
-
-// ---------------------------------------------------------
-// Split columns by 2+ spaces
-// ---------------------------------------------------------
-static std::vector<String> splitColumns(const String& line) {
-    std::vector<String> out;
-    int len = line.length();
-    int start = 0;
-
-    while (start < len) {
-        while (start < len && line[start] == ' ') start++;
-        if (start >= len) break;
-
-        int end = start;
-        int spaceCount = 0;
-
-        while (end < len) {
-            char c = line[end];
-            if (c == ' ') {
-                spaceCount++;
-                if (spaceCount >= 2) break;
-            } else {
-                spaceCount = 0;
-            }
-            end++;
-        }
-
-        String col = line.substring(start, end);
-        col.trim();
-        if (col.length() > 0) out.push_back(col);
-
-        start = end;
-    }
-
-    return out;
-}
-
-// ---------------------------------------------------------
-// Main BAT parser
-// ---------------------------------------------------------
-ParseResult parseBatFrame(int /*moduleIndex*/,
-                          const String& raw,
-                          BatData& out)
-{
-    lastParsedBatCells.clear();
-    out.fields.clear();
-    out.cellIndex = -1;
-
-    // ---------------------------------------------------------
-    // 1) Check if this frame belongs to BAT
-    // ---------------------------------------------------------
-    String last = py_uart.getLastCommand();
-    String lastLower = last;
-    lastLower.trim();
-    lastLower.toLowerCase();
-
-    if (!lastLower.startsWith("bat")) {
-        Log(LOG_DEBUG, "BAT parser: ignoring frame (last command was '" + last + "')");
-        return PARSE_IGNORED;
-    }
-
-    // Extract module index from command (bat1, bat2, ...)
-    String num = lastLower.substring(3);
-    num.trim();
-    int moduleIdx = num.toInt();
-
-    if (moduleIdx < 1 || moduleIdx > 16) {
-        Log(LOG_WARN, "BAT parser: invalid module index '" + last + "'");
-        return PARSE_IGNORED;
-    }
-
-    out.moduleIndex = moduleIdx;
-
-    // ---------------------------------------------------------
-    // 2) Validate frame
-    // ---------------------------------------------------------
-    if (!py_uart.isFrameValid()) {
-        Log(LOG_WARN, "BAT parser: skipping invalid frame");
-        return PARSE_FAIL;
-    }
-
-    Log(LOG_INFO, "BAT parser: raw frame received for module " + String(moduleIdx));
-
-    // ---------------------------------------------------------
-    // 3) Extract @ ... $$ section
-    // ---------------------------------------------------------
-    String frame;
-    if (!extractFrame(raw, frame)) {
-        Log(LOG_WARN, "BAT parser: no valid @ ... $$ frame found");
-        return PARSE_FAIL;
-    }
-
-    frame.replace("\r\n", "\n");
-    frame.replace("\r", "\n");
-
-    // ---------------------------------------------------------
-    // 4) Split into lines
-    // ---------------------------------------------------------
-    std::vector<String> lines;
-    {
-        int pos = 0;
-        while (true) {
-            int nl = frame.indexOf('\n', pos);
-            if (nl < 0) {
-                String lastLine = trimWS(frame.substring(pos));
-                if (lastLine.length() > 0) lines.push_back(lastLine);
-                break;
-            }
-            String line = trimWS(frame.substring(pos, nl));
-            if (line.length() > 0) lines.push_back(line);
-            pos = nl + 1;
-        }
-    }
-
-    if (lines.size() < 2) {
-        Log(LOG_WARN, "BAT parser: too few lines");
-        return PARSE_FAIL;
-    }
-
-    // ---------------------------------------------------------
-    // 5) Header
-    // ---------------------------------------------------------
-    std::vector<String> header = splitColumns(lines[0]);
-    if (header.empty()) {
-        Log(LOG_WARN, "BAT parser: empty header");
-        return PARSE_FAIL;
-    }
-
-    // ---------------------------------------------------------
-    // 6) Parse cell rows
-    // ---------------------------------------------------------
-    for (int row = 1; row < (int)lines.size(); row++) {
-        String line = lines[row];
-
-        // Stop at non-numeric first token
-        String firstToken = line;
-        firstToken.trim();
-        int spacePos = firstToken.indexOf(' ');
-        if (spacePos > 0)
-            firstToken = firstToken.substring(0, spacePos);
-
-        if (firstToken.length() == 0)
-            continue;
-
-        if (!isDigit(firstToken[0])) {
-            break; // end of data
-        }
-
-        std::vector<String> cols = splitColumns(line);
-        if (cols.empty()) continue;
-
-        size_t count = min(header.size(), cols.size());
-
-        BatData cell;
-        cell.cellIndex = row - 1;
-        cell.moduleIndex = moduleIdx;
-
-        for (size_t c = 0; c < count; c++) {
-            BatField f;
-            f.name = header[c];
-            f.raw  = cols[c];
-            cell.fields.push_back(f);
-        }
-
-        lastParsedBatCells.push_back(cell);
-    }
-
-    // ---------------------------------------------------------
-    // 7) Store first cell for convenience
-    // ---------------------------------------------------------
-    if (!lastParsedBatCells.empty()) {
-        out = lastParsedBatCells[0];
-        lastParsedBat = out;
-    }
-
-    BatBuffer* target = batUseA ? &batB : &batA;
-
-    target->cells = lastParsedBatCells;
-
-    batUseA = !batUseA;
-
-
-    Log(LOG_INFO, "BAT parser: parsed " + String(lastParsedBatCells.size()) +
-                  " cells for module " + String(moduleIdx));
-
-    return PARSE_OK;
-}
+#include "py_parser_bat.h"
+#include "py_log.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+// Working schema of the parser; copied into every published BatBuffer
+static BatSchema batSchema;
+
+static bool g_enumFullLogged = false;
+
+static const int32_t POW10[] = { 1, 10, 100, 1000, 10000 };
+#define BAT_MAX_DECIMALS 4
+
+// ---------------------------------------------------------
+// Helper: compare a header token with a (possibly truncated) schema name
+// ---------------------------------------------------------
+static bool nameEquals(FrameView v, const char* name) {
+    size_t n = strlen(name);
+    if (v.len > BAT_NAME_LEN - 1) v.len = BAT_NAME_LEN - 1;
+    return v.len == n && memcmp(v.data, name, n) == 0;
+}
+
+// ---------------------------------------------------------
+// Helper: "[-]digits[.digits][suffix]" → scaled integer
+// ---------------------------------------------------------
+static bool parseNumber(FrameView v, int32_t& value, uint8_t& decimals, FrameView& suffix) {
+    size_t i = 0;
+    bool neg = false;
+
+    if (i < v.len && v.data[i] == '-') { neg = true; i++; }
+
+    size_t digits = 0;
+    int32_t r = 0;
+    while (i < v.len && isdigit((unsigned char)v.data[i])) {
+        r = r * 10 + (v.data[i] - '0');
+        i++; digits++;
+    }
+    if (digits == 0) return false;
+
+    uint8_t dec = 0;
+    if (i + 1 < v.len && v.data[i] == '.' && isdigit((unsigned char)v.data[i + 1])) {
+        i++;
+        while (i < v.len && isdigit((unsigned char)v.data[i])) {
+            if (dec < BAT_MAX_DECIMALS) {
+                r = r * 10 + (v.data[i] - '0');
+                dec++;
+            }
+            i++;
+        }
+    }
+
+    // only a short unit may follow ("%", " mAH"), no further digits
+    // (dates/times stay text)
+    suffix = viewSub(v, i, v.len);
+    if (suffix.len >= BAT_SUFFIX_LEN) return false;
+    for (size_t k = 0; k < suffix.len; k++)
+        if (isdigit((unsigned char)suffix.data[k])) return false;
+
+    value = neg ? -r : r;
+    decimals = dec;
+    return true;
+}
+
+// ---------------------------------------------------------
+// Helper: interned enum text → dictionary index
+// ---------------------------------------------------------
+static int32_t internEnum(FrameView v) {
+    if (v.len > BAT_ENUM_LEN - 1) v.len = BAT_ENUM_LEN - 1;
+
+    for (uint8_t i = 0; i < batSchema.enumCount; i++) {
+        const char* e = batSchema.enums[i];
+        if (strlen(e) == v.len && memcmp(e, v.data, v.len) == 0)
+            return i;
+    }
+
+    if (batSchema.enumCount >= BAT_ENUM_MAX) {
+        if (!g_enumFullLogged) {
+            LOGW(LOGM_PARSER, "BAT: enum dictionary full, value dropped");
+            g_enumFullLogged = true;
+        }
+        return BAT_VALUE_NONE;
+    }
+
+    viewCopy(v, batSchema.enums[batSchema.enumCount], BAT_ENUM_LEN);
+    return batSchema.enumCount++;
+}
+
+// ---------------------------------------------------------
+// Helper: header → schema (only rebuilt when the header changes)
+// ---------------------------------------------------------
+static void rememberSchema(const FrameView* header, size_t count) {
+    bool same = (count == batSchema.colCount);
+    for (size_t c = 0; same && c < count; c++)
+        same = nameEquals(header[c], batSchema.cols[c].name);
+
+    if (same) return;
+
+    batSchema.colCount = count;
+    for (size_t c = 0; c < count; c++) {
+        viewCopy(header[c], batSchema.cols[c].name, BAT_NAME_LEN);
+        batSchema.cols[c].suffix[0] = '\0';
+        batSchema.cols[c].kind = BAT_COL_ENUM;
+        batSchema.cols[c].decimals = 0;
+    }
+
+    batSchema.enumCount = 0;
+    batSchema.revision++;
+    g_enumFullLogged = false;
+
+    LOGI(LOGM_PARSER, "BAT: new column schema (%u columns)", count);
+}
+
+// ---------------------------------------------------------
+// Helper: next cell row (paging prompt skipped, ends at the first
+// line that does not start with a cell number)
+// ---------------------------------------------------------
+static bool nextCellRow(FrameView& rest, FrameView* cols, size_t& colCount, int& row) {
+    FrameView line;
+    while (frameNextLine(rest, line)) {
+        row++;
+
+        // console paging prompt (the RX path already answered it)
+        if (viewStartsWith(line, "Press [Enter]")) continue;
+
+        // Stop at non-numeric first token
+        if (!isdigit((unsigned char)line[0])) return false;
+
+        colCount = frameSplitColumns(line, cols, FRAME_MAX_COLS);
+        if (colCount > 0) return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------
+// Helper: column kinds from all rows of the frame
+// ---------------------------------------------------------
+// A column becomes numeric as soon as one row holds a number; text in
+// it ("-", "N/A") is a missing value, not an enum. Decimals only widen,
+// so no value is cut. Re-typed columns leave stale enum texts behind →
+// the dictionary is rebuilt for this frame.
+static void typeSchema(FrameView rest, size_t headerCount) {
+    FrameView cols[FRAME_MAX_COLS];
+    size_t colCount;
+    int row = 0;
+    bool changed = false, retyped = false;
+
+    for (int cell = 0; cell < BAT_MAX_CELLS && nextCellRow(rest, cols, colCount, row); cell++) {
+        size_t count = headerCount < colCount ? headerCount : colCount;
+
+        for (size_t c = 0; c < count; c++) {
+            BatColumn& col = batSchema.cols[c];
+            int32_t v;
+            uint8_t dec;
+            FrameView suffix;
+
+            if (!parseNumber(cols[c], v, dec, suffix)) continue;
+
+            if (col.kind == BAT_COL_ENUM) {
+                col.kind = BAT_COL_NUM;
+                col.decimals = dec;
+                viewCopy(suffix, col.suffix, BAT_SUFFIX_LEN);
+                changed = retyped = true;
+            }
+            else if (dec > col.decimals) {
+                col.decimals = dec;
+                changed = true;
+            }
+        }
+    }
+
+    if (retyped) {
+        batSchema.enumCount = 0;
+        g_enumFullLogged = false;
+    }
+    if (changed) batSchema.revision++;
+}
+
+static int32_t encodeValue(uint8_t c, FrameView text) {
+    const BatColumn& col = batSchema.cols[c];
+
+    if (col.kind == BAT_COL_ENUM)
+        return internEnum(text);
+
+    int32_t v;
+    uint8_t dec;
+    FrameView suffix;
+    if (!parseNumber(text, v, dec, suffix))
+        return BAT_VALUE_NONE;
+
+    // align to the column scale (rounded, half away from zero)
+    if (dec < col.decimals)
+        return v * POW10[col.decimals - dec];
+    if (dec > col.decimals) {
+        int32_t d = POW10[dec - col.decimals];
+        return (v + (v < 0 ? -d / 2 : d / 2)) / d;
+    }
+    return v;
+}
+
+// ---------------------------------------------------------
+// Main BAT parser
+// ---------------------------------------------------------
+ParseResult parseBatFrame(int moduleIndex,
+                          const FrameView& raw,
+                          BatBuffer& buf)
+{
+    BatData& out = buf.cells;
+    out.moduleIndex = 0;
+    out.cellCount = 0;
+
+    // ---------------------------------------------------------
+    // 1) Module index (from "bat N", frame already validated)
+    // ---------------------------------------------------------
+    int moduleIdx = moduleIndex;
+
+    if (moduleIdx < 1 || moduleIdx > MAX_MODULES) {
+        LOGW(LOGM_PARSER, "BAT: invalid module index %d", moduleIdx);
+        return PARSE_IGNORED;
+    }
+
+    out.moduleIndex = moduleIdx;
+
+    LOGI(LOGM_PARSER, "BAT: raw frame received for module %d", moduleIdx);
+
+    // ---------------------------------------------------------
+    // 2) Extract @ ... $$ section (view, no copy)
+    // ---------------------------------------------------------
+    FrameView frame;
+    if (!frameBody(raw, frame)) {
+        LOGW(LOGM_PARSER, "BAT: no valid @ ... $$ frame found");
+        return PARSE_FAIL;
+    }
+
+    // ---------------------------------------------------------
+    // 3) Header (\r, \n and \r\n are handled by frameNextLine)
+    // ---------------------------------------------------------
+    FrameView rest = frame;
+    FrameView line;
+
+    if (!frameNextLine(rest, line)) {
+        LOGW(LOGM_PARSER, "BAT: too few lines");
+        return PARSE_FAIL;
+    }
+
+    FrameView header[FRAME_MAX_COLS];
+    size_t headerCount = frameSplitColumns(line, header, FRAME_MAX_COLS);
+    if (headerCount == 0) {
+        LOGW(LOGM_PARSER, "BAT: empty header");
+        return PARSE_FAIL;
+    }
+    if (headerCount > BAT_MAX_COLS) {
+        LOGW(LOGM_PARSER, "BAT: %u columns, only %d are kept", headerCount, BAT_MAX_COLS);
+        headerCount = BAT_MAX_COLS;
+    }
+
+    rememberSchema(header, headerCount);
+    typeSchema(rest, headerCount);
+
+    // ---------------------------------------------------------
+    // 4) Parse cell rows into [column][cell]
+    // ---------------------------------------------------------
+    FrameView cols[FRAME_MAX_COLS];
+    size_t colCount;
+    int row = 0;
+
+    while (nextCellRow(rest, cols, colCount, row)) {
+        if (out.cellCount >= BAT_MAX_CELLS) {
+            LOGW(LOGM_PARSER, "BAT: more than %d cells, rest ignored", BAT_MAX_CELLS);
+            break;
+        }
+
+        size_t count = headerCount < colCount ? headerCount : colCount;
+
+        uint8_t cell = out.cellCount++;
+
+        for (size_t c = 0; c < headerCount; c++)
+            out.values[c][cell] = (c < count) ? encodeValue(c, cols[c]) : BAT_VALUE_NONE;
+    }
+
+    if (row == 0) {
+        LOGW(LOGM_PARSER, "BAT: too few lines");
+        return PARSE_FAIL;
+    }
+
+    // ---------------------------------------------------------
+    // 5) Schema travels with the cells (published together)
+    // ---------------------------------------------------------
+    buf.schema = batSchema;
+
+    LOGI(LOGM_PARSER, "BAT: parsed %u cells for module %d", out.cellCount, moduleIdx);
+
+    return PARSE_OK;
+}
+
+// ---------------------------------------------------------
+// Accessors
+// ---------------------------------------------------------
+int batFindColumn(const BatSchema& schema, const char* name) {
+    for (uint8_t c = 0; c < schema.colCount; c++)
+        if (strcmp(name, schema.cols[c].name) == 0) return c;
+    return -1;
+}
+
+bool batIsNumeric(const BatSchema& schema, uint8_t col) {
+    return col < schema.colCount && schema.cols[col].kind == BAT_COL_NUM;
+}
+
+float batValueAsFloat(const BatBuffer& b, uint8_t col, uint8_t cell) {
+    if (col >= b.schema.colCount || cell >= b.cells.cellCount) return 0.0f;
+
+    int32_t v = b.cells.values[col][cell];
+    if (v == BAT_VALUE_NONE || b.schema.cols[col].kind != BAT_COL_NUM) return 0.0f;
+
+    return (float)v / POW10[b.schema.cols[col].decimals];
+}
+
+size_t batFormatValue(const BatBuffer& b, uint8_t col, uint8_t cell,
+                      char* buf, size_t cap)
+{
+    if (cap == 0) return 0;
+    buf[0] = '\0';
+
+    if (col >= b.schema.colCount || cell >= b.cells.cellCount) return 0;
+
+    const BatColumn& c = b.schema.cols[col];
+    int32_t v = b.cells.values[col][cell];
+    if (v == BAT_VALUE_NONE) return 0;
+
+    int n;
+    if (c.kind == BAT_COL_ENUM) {
+        if (v < 0 || v >= b.schema.enumCount) return 0;
+        n = snprintf(buf, cap, "%s", b.schema.enums[v]);
+    }
+    else if (c.decimals == 0) {
+        n = snprintf(buf, cap, "%ld%s", (long)v, c.suffix);
+    }
+    else {
+        int32_t p = POW10[c.decimals];
+        long a = v < 0 ? -(long)v : (long)v;
+        n = snprintf(buf, cap, "%s%ld.%0*ld%s", v < 0 ? "-" : "",
+                     a / p, (int)c.decimals, a % p, c.suffix);
+    }
+
+    if (n < 0) return 0;
+    return (size_t)n < cap ? (size_t)n : cap - 1;
+}
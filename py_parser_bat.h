@@ -1,13 +1,22 @@
-#pragma once
-#include <Arduino.h>
-#include <vector>
-#include "config.h"
-
-// Globale BAT-Daten für Web-UI (optional)
-extern std::vector<BatData> lastParsedBatCells;
-extern BatData lastParsedBat;
-
-// BAT parser function
-ParseResult parseBatFrame(int moduleIndex,
-                          const String& raw,
-                          BatData& out);
+#pragma once
+#include "py_data.h"
+#include "py_frame.h"
+
+// BAT parser function (raw = view into the frameStore slot,
+// moduleIndex = N of "bat N", already validated frame)
+// Fills cells + the column schema they belong to; PyUart publishes
+// the result via batSnapshot.
+ParseResult parseBatFrame(int moduleIndex,
+                          const FrameView& raw,
+                          BatBuffer& out);
+
+// ---------------------------------------------------------
+// Accessors for the typed cell model
+// ---------------------------------------------------------
+int    batFindColumn(const BatSchema& schema, const char* name);     // -1 if unknown
+bool   batIsNumeric(const BatSchema& schema, uint8_t col);
+float  batValueAsFloat(const BatBuffer& b, uint8_t col, uint8_t cell);
+
+// Rebuilds the original console text ("3345", "75%", "Dischg", ...)
+size_t batFormatValue(const BatBuffer& b, uint8_t col, uint8_t cell,
+                      char* buf, size_t cap);
@@ -1,258 +1,211 @@
-#include "py_parser_pwr.h"
-#include "py_log.h"
-#include "config.h"
-#include "py_uart.h"
-
-#include <cctype>
-#include <algorithm>
-
-// UART instance
-extern PyUart py_uart;
-
-// Globale Parserdaten für Weboberfläche
-BatteryStack lastParsedStack;
-std::vector<BatteryModule> lastParsedModules;
-std::vector<String> lastParserHeader;
-std::vector<String> lastParserValues;
-
-// ---------------------------------------------------------
-// Helper: trim whitespace
-// ---------------------------------------------------------
-static String trimWS(const String& s) {
-    String r = s;
-    r.trim();
-    return r;
-}
-
-// ---------------------------------------------------------
-// Helper: split by whitespace
-// ---------------------------------------------------------
-static std::vector<String> splitWS(const String& line) {
-    std::vector<String> out;
-    int start = 0;
-
-    while (start < line.length()) {
-        while (start < line.length() && isspace((unsigned char)line[start])) start++;
-        if (start >= line.length()) break;
-
-        int end = start;
-        while (end < line.length() && !isspace((unsigned char)line[end])) end++;
-
-        out.push_back(line.substring(start, end));
-        start = end;
-    }
-    return out;
-}
-
-// ---------------------------------------------------------
-// Extract @ ... $$ frame
-// ---------------------------------------------------------
-static bool extractFrame(const String& raw, String& frame) {
-    int start = raw.indexOf('@');
-    int end   = raw.indexOf("$$");
-
-    if (start < 0 || end < 0 || end <= start)
-        return false;
-
-    frame = raw.substring(start + 1, end);
-    return true;
-}
-
-// ---------------------------------------------------------
-// Main PWR parser
-// ---------------------------------------------------------
-ParseResult parsePwrFrame(const String& raw,
-                          BatteryStack& stackOut,
-                          std::vector<BatteryModule>& modulesOut)
-{
-    // Sicherstellen, dass das wirklich ein PWR-Frame ist
-    if (py_uart.getLastCommand() != "pwr") {
-        Log(LOG_DEBUG, "PWR parser: ignoring frame (last command was '" + py_uart.getLastCommand() + "')");
-        return PARSE_IGNORED;
-    }
-
-    // Nur gültige Frames verarbeiten
-    if (!py_uart.isFrameValid()) {
-        Log(LOG_WARN, "PWR parser: skipping invalid frame");
-        return PARSE_FAIL;
-    }
-
-    modulesOut.clear();
-    stackOut.reset();
-
-    Log(LOG_INFO, "PWR parser: raw frame received, length=" + String(raw.length()));
-
-    // @ ... $$ extrahieren
-    String frame;
-    if (!extractFrame(raw, frame)) {
-        Log(LOG_WARN, "PWR parser: no valid @ ... $$ frame found");
-        return PARSE_FAIL;
-    }
-
-    // Zeilen aufsplitten
-    std::vector<String> lines;
-    {
-        int pos = 0;
-        while (true) {
-            int nl = frame.indexOf('\n', pos);
-            if (nl < 0) {
-                String last = trimWS(frame.substring(pos));
-                if (last.length() > 0) lines.push_back(last);
-                break;
-            }
-            String line = trimWS(frame.substring(pos, nl));
-            if (line.length() > 0) lines.push_back(line);
-            pos = nl + 1;
-        }
-    }
-
-    if (lines.size() < 2) {
-        Log(LOG_WARN, "PWR parser: too few lines");
-        return PARSE_FAIL;
-    }
-
-    // Header parsen
-    std::vector<String> header = splitWS(lines[0]);
-    if (header.size() < 3) {
-        Log(LOG_WARN, "PWR parser: header too small");
-        return PARSE_FAIL;
-    }
-
-    lastParserHeader = header;
-    lastParserValues.clear();
-
-    int baseIndex = -1;
-    int timeIndex = -1;
-
-    for (size_t h = 0; h < header.size(); h++) {
-        if (header[h] == "Base.St" || header[h] == "Base") {
-            baseIndex = h;
-        }
-        if (header[h] == "Time") {
-            timeIndex = h;
-        }
-    }
-
-    // Datenzeilen
-    for (size_t i = 1; i < lines.size(); i++) {
-
-        std::vector<String> cols = splitWS(lines[i]);
-        if (cols.empty()) continue;
-
-        // Datum + Zeit zusammenführen, falls getrennt
-        if (timeIndex >= 0 && cols.size() > (size_t)timeIndex + 1) {
-            String datePart = cols[timeIndex];
-            String timePart = cols[timeIndex + 1];
-
-            bool looksLikeDate = (datePart.indexOf('-') > 0 || datePart.indexOf('/') > 0);
-            bool looksLikeTime = (timePart.indexOf(':') > 0);
-
-            if (looksLikeDate && looksLikeTime) {
-                cols[timeIndex] = datePart + " " + timePart;
-                cols.erase(cols.begin() + timeIndex + 1);
-            }
-        }
-
-        if (cols.size() < header.size()) continue;
-
-        // Absent → Ende
-        if (baseIndex >= 0 && cols[baseIndex] == "Absent") {
-            Log(LOG_INFO, "PWR parser: Absent detected at line " + String(i));
-            break;
-        }
-
-        // Erste gültige Zeile für Web-UI merken
-        if (lastParserValues.empty()) {
-            lastParserValues = cols;
-        }
-
-        BatteryModule mod;
-        mod.present = true;
-
-        for (size_t c = 0; c < header.size(); c++) {
-            const String& col = header[c];
-            const String& value = cols[c];
-
-            mod.fields[col] = value;
-
-            if (col == "Power" || col == "Battery") {
-                mod.index = value.toInt();
-            }
-            else if (col == "Volt") {
-                mod.voltage_mV = value.toInt();
-            }
-            else if (col == "Curr") {
-                mod.current_mA = value.toInt();
-            }
-            else if (col == "Tempr") {
-                mod.temperature = value.toInt();
-            }
-            else if (col == "Coulomb" || col == "SOC") {
-                String v = value;
-                v.replace("%", "");
-                mod.soc = v.toInt();
-            }
-        }
-
-        // Plausibilitätscheck
-        bool plausible = true;
-
-        plausible &= (mod.index >= 1 && mod.index <= 32);
-        plausible &= (mod.voltage_mV > 10000 && mod.voltage_mV < 60000);
-        plausible &= (mod.temperature > 1000 && mod.temperature < 60000);
-        plausible &= (mod.soc >= 1 && mod.soc <= 100);
-
-        if (!plausible) {
-            Log(LOG_WARN, "PWR parser: skipping implausible module line " + String(i));
-            continue;
-        }
-
-        modulesOut.push_back(mod);
-    }
-
-    if (modulesOut.empty()) {
-        Log(LOG_WARN, "PWR parser: no modules parsed");
-        return PARSE_FAIL;
-    }
-
-    // Stack-Werte berechnen
-    int count = modulesOut.size();
-    stackOut.batteryCount = count;
-    config.detectedModules = count;
-
-    long sumVolt = 0;
-    long sumCurr = 0;
-    int minSoc = 999;
-    int maxTemp = -999;
-
-    for (auto& m : modulesOut) {
-        sumVolt += m.voltage_mV;
-        sumCurr += m.current_mA;
-
-        if (m.soc < minSoc) minSoc = m.soc;
-        if (m.temperature > maxTemp) maxTemp = m.temperature;
-    }
-
-    stackOut.avgVoltage_mV   = sumVolt / count;
-    stackOut.totalCurrent_mA = sumCurr;
-    stackOut.soc             = minSoc;
-    stackOut.temperature     = maxTemp;
-
-    config.lastPwrUpdate = config.getCurrentTimeString();
-
-    // Web-UI Daten aktualisieren
-    lastParsedStack   = stackOut;
-    lastParsedModules = modulesOut;
-
-    PwrBuffer* target = pwrUseA ? &pwrB : &pwrA;
-
-    target->stack   = stackOut;
-    target->modules = modulesOut;
-
-    pwrUseA = !pwrUseA;
-
-
-    Log(LOG_INFO, "PWR parser: parsed " + String(count) + " modules");
-
-    return PARSE_OK;
-}
+#include "py_parser_pwr.h"
+#include "py_log.h"
+
+// Last header line (revision changes only when the columns do)
+static PwrHeader g_header;
+
+// ---------------------------------------------------------
+// Helper: copy the column values of one line into the module
+// ---------------------------------------------------------
+static void storeFields(BatteryModule& mod, const FrameView* cols, size_t count) {
+    size_t pos = 0;
+    mod.fieldCount = 0;
+
+    for (size_t c = 0; c < count && c < PWR_MAX_COLS; c++) {
+        // pool full → remaining columns are empty
+        if (pos + cols[c].len + 1 > PWR_TEXT_LEN)
+            pos = PWR_TEXT_LEN - 1;
+
+        mod.fieldOff[c] = pos;
+        pos += viewCopy(cols[c], mod.text + pos, PWR_TEXT_LEN - pos);
+        if (pos < PWR_TEXT_LEN - 1) pos++;
+        mod.fieldCount++;
+    }
+}
+
+// ---------------------------------------------------------
+// Main PWR parser
+// ---------------------------------------------------------
+ParseResult parsePwrFrame(const FrameView& raw, PwrBuffer& out)
+{
+    out.moduleCount = 0;
+    out.header.count = 0;
+    out.stack.reset();
+
+    LOGI(LOGM_PARSER, "PWR: raw frame received, length=%u", raw.len);
+
+    // @ ... $$ extrahieren (View, keine Kopie)
+    FrameView frame;
+    if (!frameBody(raw, frame)) {
+        LOGW(LOGM_PARSER, "PWR: no valid @ ... $$ frame found");
+        return PARSE_FAIL;
+    }
+
+    // Header = erste nicht-leere Zeile
+    FrameView rest = frame;
+    FrameView line;
+
+    if (!frameNextLine(rest, line)) {
+        LOGW(LOGM_PARSER, "PWR: too few lines");
+        return PARSE_FAIL;
+    }
+
+    FrameView header[FRAME_MAX_COLS];
+    size_t headerCount = frameSplitWS(line, header, FRAME_MAX_COLS);
+    if (headerCount < 3) {
+        LOGW(LOGM_PARSER, "PWR: header too small");
+        return PARSE_FAIL;
+    }
+
+    if (headerCount > PWR_MAX_COLS) {
+        LOGW(LOGM_PARSER, "PWR: %u columns, only %d are kept", headerCount, PWR_MAX_COLS);
+        headerCount = PWR_MAX_COLS;
+    }
+
+    bool changed = (g_header.count != headerCount);
+    char name[PWR_NAME_LEN];
+
+    for (size_t h = 0; h < headerCount; h++) {
+        viewCopy(header[h], name, PWR_NAME_LEN);
+        if (strcmp(name, g_header.names[h]) != 0) {
+            memcpy(g_header.names[h], name, PWR_NAME_LEN);
+            changed = true;
+        }
+    }
+    g_header.count = headerCount;
+    if (changed) g_header.revision++;
+
+    out.header = g_header;
+
+    int baseIndex = -1;
+    int timeIndex = -1;
+
+    for (size_t h = 0; h < headerCount; h++) {
+        if (viewEquals(header[h], "Base.St") || viewEquals(header[h], "Base")) {
+            baseIndex = h;
+        }
+        if (viewEquals(header[h], "Time")) {
+            timeIndex = h;
+        }
+    }
+
+    // Datenzeilen
+    FrameView cols[FRAME_MAX_COLS + 1];
+    int lineNo = 0;
+
+    while (frameNextLine(rest, line)) {
+        lineNo++;
+
+        size_t colCount = frameSplitWS(line, cols, FRAME_MAX_COLS + 1);
+        if (colCount == 0) continue;
+
+        // Datum + Zeit zusammenführen, falls getrennt:
+        // beide Tokens liegen direkt hintereinander im Slot → View verlängern
+        if (timeIndex >= 0 && colCount > (size_t)timeIndex + 1) {
+            FrameView datePart = cols[timeIndex];
+            FrameView timePart = cols[timeIndex + 1];
+
+            bool looksLikeDate = (viewFindChar(datePart, '-') > 0 || viewFindChar(datePart, '/') > 0);
+            bool looksLikeTime = (viewFindChar(timePart, ':') > 0);
+
+            if (looksLikeDate && looksLikeTime) {
+                cols[timeIndex] = FrameView(datePart.data,
+                                            (timePart.data + timePart.len) - datePart.data);
+                for (size_t c = timeIndex + 1; c + 1 < colCount; c++)
+                    cols[c] = cols[c + 1];
+                colCount--;
+            }
+        }
+
+        if (colCount < headerCount) continue;
+
+        // Absent → Ende
+        if (baseIndex >= 0 && viewEquals(cols[baseIndex], "Absent")) {
+            LOGI(LOGM_PARSER, "PWR: Absent detected at line %d", lineNo);
+            break;
+        }
+
+        if (out.moduleCount >= MAX_MODULES) {
+            LOGW(LOGM_PARSER, "PWR: more than %d modules, rest ignored", MAX_MODULES);
+            break;
+        }
+
+        BatteryModule& mod = out.modules[out.moduleCount];
+        mod = BatteryModule();
+        mod.present = true;
+
+        storeFields(mod, cols, headerCount);
+
+        for (size_t c = 0; c < headerCount; c++) {
+            const FrameView& col   = header[c];
+            const FrameView& value = cols[c];
+
+            if (viewEquals(col, "Power") || viewEquals(col, "Battery")) {
+                mod.index = viewToInt(value);
+            }
+            else if (viewEquals(col, "Volt")) {
+                mod.voltage_mV = viewToInt(value);
+            }
+            else if (viewEquals(col, "Curr")) {
+                mod.current_mA = viewToInt(value);
+            }
+            else if (viewEquals(col, "Tempr")) {
+                mod.temperature = viewToInt(value);
+            }
+            else if (viewEquals(col, "Coulomb") || viewEquals(col, "SOC")) {
+                mod.soc = viewToInt(value);   // "97%" → 97
+            }
+        }
+
+        // Plausibilitätscheck
+        bool plausible = true;
+
+        plausible &= (mod.index >= 1 && mod.index <= 32);
+        plausible &= (mod.voltage_mV > 10000 && mod.voltage_mV < 60000);
+        plausible &= (mod.temperature > 1000 && mod.temperature < 60000);
+        plausible &= (mod.soc >= 1 && mod.soc <= 100);
+
+        if (!plausible) {
+            LOGW(LOGM_PARSER, "PWR: skipping implausible module line %d", lineNo);
+            continue;
+        }
+
+        out.moduleCount++;
+    }
+
+    if (lineNo == 0) {
+        LOGW(LOGM_PARSER, "PWR: too few lines");
+        return PARSE_FAIL;
+    }
+    if (out.moduleCount == 0) {
+        LOGW(LOGM_PARSER, "PWR: no modules parsed");
+        return PARSE_FAIL;
+    }
+
+    // Stack-Werte berechnen
+    int count = out.moduleCount;
+    out.stack.batteryCount = count;
+
+    long sumVolt = 0;
+    long sumCurr = 0;
+    int minSoc = 999;
+    int maxTemp = -999;
+
+    for (int i = 0; i < count; i++) {
+        const BatteryModule& m = out.modules[i];
+        sumVolt += m.voltage_mV;
+        sumCurr += m.current_mA;
+
+        if (m.soc < minSoc) minSoc = m.soc;
+        if (m.temperature > maxTemp) maxTemp = m.temperature;
+    }
+
+    out.stack.avgVoltage_mV   = sumVolt / count;
+    out.stack.totalCurrent_mA = sumCurr;
+    out.stack.soc             = minSoc;
+    out.stack.temperature     = maxTemp;
+
+    LOGI(LOGM_PARSER, "PWR: parsed %d modules", count);
+
+    return PARSE_OK;
+}
@@ -1,22 +1,17 @@
-#pragma once
-#include <Arduino.h>
-#include <vector>
-#include "config.h"
-
-// ---------------------------------------------------------
-// PWR Parser Header
-// ---------------------------------------------------------
-// Liefert nur BatteryStack + BatteryModule-Liste zurück.
-// Alle Strukturen kommen aus config.h.
-// ---------------------------------------------------------
-
-// Main PWR parser function
-ParseResult parsePwrFrame(const String& raw,
-                          BatteryStack& stackOut,
-                          std::vector<BatteryModule>& modulesOut);
-
-// Globale Parser-Ergebnisse für Web UI (optional)
-extern BatteryStack lastParsedStack;
-extern std::vector<BatteryModule> lastParsedModules;
-extern std::vector<String> lastParserHeader;
-extern std::vector<String> lastParserValues;
+#pragma once
+#include "py_data.h"
+#include "py_frame.h"
+
+// ---------------------------------------------------------
+// PWR Parser Header
+// ---------------------------------------------------------
+// Füllt einen PwrBuffer (Stack + Header + Module, feste Größe).
+// Veröffentlicht wird er von PyUart über pwrSnapshot.
+//
+// Die Parser hängen weder von py_uart noch von config ab: PyUart
+// prüft Kommando und Frame-Gültigkeit vorher, die Pipeline setzt
+// updatedAt nach PARSE_OK und veröffentlicht den Buffer.
+// ---------------------------------------------------------
+
+// Main PWR parser function (raw = view into the frameStore slot)
+ParseResult parsePwrFrame(const FrameView& raw, PwrBuffer& out);
@@ -1,12 +1,10 @@
-#pragma once
-#include <Arduino.h>
-#include <vector>
-#include "config.h"   // Provides StatField, StatData, ParseResult
-
-// Global STAT storage (for Web UI)
-extern StatData lastParsedStat;
-
-// STAT parser function
-ParseResult parseStatFrame(int moduleIndex,
-                           const String& raw,
-                           StatData& out);
+#pragma once
+#include "py_data.h"   // Provides StatField, StatData, ParseResult
+#include "py_frame.h"
+
+// STAT parser function (raw = view into the frameStore slot,
+// moduleIndex = N of "stat N", already validated frame)
+// Result is published by PyUart via statSnapshot.
+ParseResult parseStatFrame(int moduleIndex,
+                           const FrameView& raw,
+                           StatData& out);
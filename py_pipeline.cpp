@@ -0,0 +1,84 @@
+#include "py_pipeline.h"
+#include "py_log.h"
+#include "py_parser_pwr.h"
+#include "py_parser_bat.h"
+#include "py_parser_stat.h"
+#include "py_history.h"
+#include <time.h>
+
+#include "config.h"   // Snapshots
+
+QueueHandle_t frameQueue = nullptr;
+
+// Working buffers of the parser stage (only touched by the parser task,
+// kept off the task stack)
+static PwrBuffer  g_pwrOut;
+static BatBuffer  g_batOut;
+static StatBuffer g_statOut;
+
+// ---------------------------------------------------------
+bool frameDescFor(const String& cmd, FrameDesc& d) {
+    d.moduleIndex = 0;
+    d.slot = -1;
+    d.receivedAt = 0;
+
+    if (cmd == "pwr") {
+        d.type = FRAME_PWR;
+        return true;
+    }
+
+    int idx;
+    if (cmd.startsWith("bat")) {
+        d.type = FRAME_BAT;
+        idx = cmd.substring(3).toInt();
+    } else if (cmd.startsWith("stat")) {
+        d.type = FRAME_STAT;
+        idx = cmd.substring(4).toInt();
+    } else {
+        return false;
+    }
+
+    if (idx < 1 || idx > MAX_MODULES) return false;
+    d.moduleIndex = idx;
+    return true;
+}
+
+// ---------------------------------------------------------
+bool pushFrame(const FrameDesc& d, TickType_t wait) {
+    if (!frameQueue) return false;
+    return xQueueSend(frameQueue, &d, wait) == pdTRUE;
+}
+
+// ---------------------------------------------------------
+ParseResult processFrame(const FrameDesc& d) {
+    FrameView raw = frameStore.view(d.slot);
+    ParseResult r = PARSE_IGNORED;
+
+    switch (d.type) {
+        case FRAME_PWR:
+            r = parsePwrFrame(raw, g_pwrOut);
+            if (r == PARSE_OK) {
+                // module count + time travel with the snapshot, nothing
+                // shared is written here (config belongs to the noncritical task)
+                time_t now = time(nullptr);
+                g_pwrOut.updatedAt = config.isSystemTimeValid() ? (uint32_t)now : 0;
+                pwrSnapshot.publish(g_pwrOut);
+                history.addPwr(g_pwrOut);
+            }
+            break;
+
+        case FRAME_BAT:
+            r = parseBatFrame(d.moduleIndex, raw, g_batOut);
+            if (r == PARSE_OK) batSnapshot.publish(g_batOut);
+            break;
+
+        case FRAME_STAT:
+            r = parseStatFrame(d.moduleIndex, raw, g_statOut.stat);
+            if (r == PARSE_OK) statSnapshot.publish(g_statOut);
+            break;
+    }
+
+    LOGD(LOGM_PARSER, "frame type %d module %u result %d after %lu ms",
+         (int)d.type, d.moduleIndex, (int)r, millis() - d.receivedAt);
+    return r;
+}
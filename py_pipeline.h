@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "py_data.h"
+#include "py_frame_store.h"
+
+// ---------------------------------------------------------
+// Frame pipeline (UART stage → parser stage)
+// ---------------------------------------------------------
+// PyUart only receives and validates. Every valid pwr / bat N / stat N
+// response is handed to the parser task as a FrameDesc through
+// frameQueue, so frame N is parsed while frame N+1 is already on the
+// wire.
+//
+// The descriptor owns one frameStore reference to its slot: PyUart
+// does not release the slot after a successful push, the parser stage
+// releases it after processFrame().
+// ---------------------------------------------------------
+
+#define FRAME_QUEUE_LEN   2
+
+// RX + parser + queue + last frame + console reader (py_frame_store.h)
+static_assert(FRAME_SLOTS >= FRAME_QUEUE_LEN + 4, "FRAME_SLOTS too small for the pipeline");
+
+struct FrameDesc {
+    FrameType type;
+    uint8_t   moduleIndex;      // N of "bat N" / "stat N", 0 for pwr
+    int8_t    slot;             // frameStore slot (one reference owned)
+    uint32_t  receivedAt;       // millis() when the frame was complete
+};
+
+extern QueueHandle_t frameQueue;
+
+// Command → descriptor (false for console commands that are not parsed)
+bool frameDescFor(const String& cmd, FrameDesc& d);
+
+// UART stage: hand a slot over to the parser stage.
+// On false the caller still owns the reference.
+bool pushFrame(const FrameDesc& d, TickType_t wait);
+
+// Parser stage: parse the frame in place and publish the result
+// (pwrSnapshot / batSnapshot / statSnapshot, PWR also into history).
+// Does not release the slot.
+ParseResult processFrame(const FrameDesc& d);
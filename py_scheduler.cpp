@@ -1,127 +1,318 @@
-#include "py_scheduler.h"
-#include "py_log.h"
-#include "py_parser_pwr.h"   // lastParsedStack + lastParsedModules
-#include "config.h"
-
-PyScheduler py_scheduler;
-
-void PyScheduler::begin(PyUart* u) {
-    uart = u;
-    queue.clear();
-
-    bootTime = millis();
-
-    lastPwr  = millis();
-    lastBat  = millis();
-    lastStat = millis();
-
-    initialPwrDone  = false;
-    initialBatDone  = false;
-    initialStatDone = false;
-
-    Log(LOG_INFO, "Scheduler: started");
-}
-
-void PyScheduler::enqueue(const String& cmd) {
-    Log(LOG_DEBUG, "Scheduler: enqueue → " + cmd);
-    queue.push_back(cmd);
-}
-
-bool PyScheduler::hasQueuedCommand() const {
-    return !queue.empty();
-}
-
-String PyScheduler::popNextCommand() {
-    if (queue.empty()) return "";
-    String cmd = queue.front();
-    queue.erase(queue.begin());
-    Log(LOG_DEBUG, "Scheduler: pop → " + cmd);
-    return cmd;
-}
-
-void PyScheduler::loop() {
-    unsigned long now = millis();
-
-    // UART busy? Dann warten
-    if (uart->isBusy()) return;
-
-    unsigned long sinceBoot = now - bootTime;
-
-    // ---------------------------------------------------------
-    // INITIAL SEQUENCE (runs only once)
-    // ---------------------------------------------------------
-
-    // 1) PWR at T+15s
-    if (!initialPwrDone && sinceBoot >= 15000) {
-        enqueue("pwr");
-        Log(LOG_INFO, "Scheduler: INITIAL PWR");
-        initialPwrDone = true;
-        return;
-    }
-
-    // 2) BAT at T+25s
-    if (initialPwrDone && !initialBatDone && sinceBoot >= 25000) {
-        enqueue("bat 1");
-        Log(LOG_INFO, "Scheduler: INITIAL BAT");
-        initialBatDone = true;
-        return;
-    }
-
-    // 3) STAT at T+45s
-    if (initialBatDone && !initialStatDone && sinceBoot >= 45000) {
-        enqueue("stat 1");
-        Log(LOG_INFO, "Scheduler: INITIAL STAT");
-        initialStatDone = true;
-        return;
-    }
-    // 4) DISCOVERY at T+50s
-    if (initialStatDone && !initialDiscoveryDone && sinceBoot >= 50000) {
-
-        Log(LOG_INFO, "Scheduler: INITIAL DISCOVERY triggered");
-
-        discoveryPwrNeeded  = true;
-        discoveryBatNeeded  = true;
-        discoveryStatNeeded = true;
-
-        initialDiscoveryDone = true;
-        return;
-    }
-
-
-    // ---------------------------------------------------------
-    // NORMAL CYCLIC SCHEDULING (after initial sequence)
-    // ---------------------------------------------------------
-
-    if (!initialStatDone) return;
-
-    // PWR
-    if (now - lastPwr >= config.battery.intervalPwr) {
-        enqueue("pwr");
-        lastPwr = now;
-        Log(LOG_INFO, "Scheduler: PWR scheduled");
-    }
-
-    // BAT
-    if (now - lastBat >= config.battery.intervalBat) {
-        if (config.battery.enableBat) {
-            for (const auto& m : lastParsedModules) {
-                if (!m.present) continue;
-                enqueue("bat " + String(m.index));
-            }
-            Log(LOG_INFO, "Scheduler: BAT scheduled (present modules)");
-        }
-        lastBat = now;
-    }
-
-    // STAT
-    if (now - lastStat >= config.battery.intervalStat) {
-        if (config.battery.enableStat) {
-            for (const auto& m : lastParsedModules) {
-                if (!m.present) continue;
-                enqueue("stat " + String(m.index));
-            }
-            Log(LOG_INFO, "Scheduler: STAT scheduled (present modules)");
-        }
-        lastStat = now;
-    }
-}
+#include "py_scheduler.h"
+#include "py_log.h"
+#include "config.h"          // pwrSnapshot
+
+PyScheduler py_scheduler;
+
+// ---------------------------------------------------------
+// Present module indices of the last PWR result
+// (peek → only the indices are copied, not the whole snapshot)
+// ---------------------------------------------------------
+static int presentModules(int* out) {
+    int n = 0;
+    pwrSnapshot.peek([&](const PwrBuffer& p) {
+        n = 0;
+        for (uint8_t i = 0; i < p.moduleCount && i < MAX_MODULES; i++)
+            if (p.modules[i].present) out[n++] = p.modules[i].index;
+    });
+    return n;
+}
+
+// enqueue() runs in the non-critical task, popNextCommand() in the
+// realtime task → the queue is only touched inside this mux
+static portMUX_TYPE g_schedMux = portMUX_INITIALIZER_UNLOCKED;
+
+// "bat 3" / "bat3" → 3, 0 if the command has no module
+static int moduleOf(const char* cmd, const char* prefix) {
+    size_t n = strlen(prefix);
+    if (strncasecmp(cmd, prefix, n) != 0) return 0;
+    int idx = atoi(cmd + n);
+    return (idx >= 1 && idx <= MAX_MODULES) ? idx : 0;
+}
+
+// deadline a is earlier than b (millis() wrap-safe)
+static inline bool earlier(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+void PyScheduler::begin(PyUart* u) {
+    uart = u;
+
+    bootTime = millis();
+
+    // first cyclic BAT/STAT round one interval after boot (as before)
+    portENTER_CRITICAL(&g_schedMux);
+    for (auto& e : queue) e.used = false;
+    for (int i = 0; i <= MAX_MODULES; i++) {
+        batPolled[i]  = bootTime;
+        statPolled[i] = bootTime;
+    }
+    portEXIT_CRITICAL(&g_schedMux);
+
+    lastPwr  = millis();
+    lastModuleCheck = millis();
+
+    initialPwrDone  = false;
+    initialBatDone  = false;
+    initialStatDone = false;
+
+    LOGI(LOGM_SCHED, "started");
+}
+
+bool PyScheduler::schedule(const char* cmd, CmdPriority prio, uint32_t deadline) {
+    int  freeSlot = -1;
+    bool coalesced = false;
+
+    portENTER_CRITICAL(&g_schedMux);
+    for (int i = 0; i < SCHED_CAPACITY; i++) {
+        SchedEntry& e = queue[i];
+
+        if (!e.used) {
+            if (freeSlot < 0) freeSlot = i;
+            continue;
+        }
+
+        // identical command already pending → keep one, take the
+        // stricter priority and deadline
+        if (strcasecmp(e.cmd, cmd) == 0) {
+            if (prio < e.prio) e.prio = prio;
+            if (earlier(deadline, e.deadline)) e.deadline = deadline;
+            coalesced = true;
+            break;
+        }
+    }
+
+    if (!coalesced && freeSlot >= 0) {
+        SchedEntry& e = queue[freeSlot];
+        strlcpy(e.cmd, cmd, SCHED_CMD_LEN);
+        e.prio     = prio;
+        e.enqueued = millis();
+        e.deadline = deadline;
+        e.used     = true;
+    }
+    portEXIT_CRITICAL(&g_schedMux);
+
+    if (coalesced) {
+        // periodic re-checks coalesce every second → only log console commands
+        if (prio == PRIO_INTERACTIVE)
+            LOGD(LOGM_SCHED, "coalesced → %s", cmd);
+        return true;
+    }
+    if (freeSlot < 0) {
+        LOGW(LOGM_SCHED, "queue full, dropped → %s", cmd);
+        return false;
+    }
+
+    LOGD(LOGM_SCHED, "enqueue → %s", cmd);
+    return true;
+}
+
+bool PyScheduler::enqueue(const String& cmd) {
+    String c = cmd;
+    c.trim();
+    if (c.length() == 0) return false;
+
+    return schedule(c.c_str(), PRIO_INTERACTIVE, millis() + SCHED_INTERACTIVE_MS);
+}
+
+bool PyScheduler::hasQueuedCommand() const {
+    return queuedCount() > 0;
+}
+
+size_t PyScheduler::queuedCount() const {
+    size_t n = 0;
+    portENTER_CRITICAL(&g_schedMux);
+    for (const auto& e : queue)
+        if (e.used) n++;
+    portEXIT_CRITICAL(&g_schedMux);
+    return n;
+}
+
+String PyScheduler::popNextCommand(bool* interactive) {
+    char cmd[SCHED_CMD_LEN];
+    cmd[0] = '\0';
+    bool fromConsole = false;
+
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&g_schedMux);
+    int best = -1;
+    bool bestOverdue = false;
+
+    for (int i = 0; i < SCHED_CAPACITY; i++) {
+        const SchedEntry& e = queue[i];
+        if (!e.used) continue;
+
+        bool overdue = (e.prio != PRIO_INTERACTIVE) && earlier(e.deadline, now);
+
+        if (best < 0) { best = i; bestOverdue = overdue; continue; }
+
+        const SchedEntry& b = queue[best];
+
+        // 1) interactive always first
+        if ((e.prio == PRIO_INTERACTIVE) != (b.prio == PRIO_INTERACTIVE)) {
+            if (e.prio == PRIO_INTERACTIVE) { best = i; bestOverdue = overdue; }
+            continue;
+        }
+        // 2) overdue before not overdue
+        if (overdue != bestOverdue) {
+            if (overdue) { best = i; bestOverdue = overdue; }
+            continue;
+        }
+        // 3) higher class first (not among overdue ones)
+        if (!overdue && e.prio != b.prio) {
+            if (e.prio < b.prio) { best = i; bestOverdue = overdue; }
+            continue;
+        }
+        // 4) earliest deadline, then oldest entry
+        if (earlier(e.deadline, b.deadline) ||
+            (e.deadline == b.deadline && earlier(e.enqueued, b.enqueued))) {
+            best = i; bestOverdue = overdue;
+        }
+    }
+
+    if (best >= 0) {
+        strlcpy(cmd, queue[best].cmd, SCHED_CMD_LEN);
+        fromConsole = queue[best].prio == PRIO_INTERACTIVE;
+        queue[best].used = false;
+
+        int m;
+        if ((m = moduleOf(cmd, "bat"))  > 0) batPolled[m]  = now;
+        if ((m = moduleOf(cmd, "stat")) > 0) statPolled[m] = now;
+    }
+    portEXIT_CRITICAL(&g_schedMux);
+
+    if (interactive) *interactive = fromConsole;
+    if (best < 0) return "";
+
+    LOGD(LOGM_SCHED, "pop → %s", cmd);
+    return String(cmd);
+}
+
+// ---------------------------------------------------------
+// Drop commands that could not run long after their deadline
+// (UART down) instead of letting work pile up
+// ---------------------------------------------------------
+void PyScheduler::expireStale(uint32_t now) {
+    char dropped[SCHED_CMD_LEN];
+
+    for (;;) {
+        bool found = false;
+
+        portENTER_CRITICAL(&g_schedMux);
+        for (auto& e : queue) {
+            if (e.used && (int32_t)(now - e.deadline) > SCHED_EXPIRE_MS) {
+                strlcpy(dropped, e.cmd, SCHED_CMD_LEN);
+                e.used = false;
+                found = true;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&g_schedMux);
+
+        if (!found) return;
+        LOGW(LOGM_SCHED, "expired → %s", dropped);
+    }
+}
+
+// ---------------------------------------------------------
+// BAT / STAT per module: due when its own data is older than the
+// interval; deadline = due + interval/2 → oldest module runs first
+// ---------------------------------------------------------
+void PyScheduler::scheduleModules(uint32_t now) {
+    int idx[MAX_MODULES];
+    int n = presentModules(idx);
+
+    for (int i = 0; i < n; i++) {
+        int m = idx[i];
+        if (m < 1 || m > MAX_MODULES) continue;
+
+        char cmd[SCHED_CMD_LEN];
+
+        if (config.battery.enableBat) {
+            uint32_t due = batPolled[m] + config.battery.intervalBat;
+            if (!earlier(now, due)) {
+                snprintf(cmd, sizeof(cmd), "bat %d", m);
+                schedule(cmd, PRIO_BAT, due + config.battery.intervalBat / 2);
+            }
+        }
+
+        if (config.battery.enableStat) {
+            uint32_t due = statPolled[m] + config.battery.intervalStat;
+            if (!earlier(now, due)) {
+                snprintf(cmd, sizeof(cmd), "stat %d", m);
+                schedule(cmd, PRIO_STAT, due + config.battery.intervalStat / 2);
+            }
+        }
+    }
+}
+
+void PyScheduler::loop() {
+    unsigned long now = millis();
+
+    // UART busy? Dann warten
+    if (uart->isBusy()) return;
+
+    unsigned long sinceBoot = now - bootTime;
+
+    // ---------------------------------------------------------
+    // INITIAL SEQUENCE (runs only once)
+    // ---------------------------------------------------------
+
+    // 1) PWR at T+15s
+    if (!initialPwrDone && sinceBoot >= 15000) {
+        schedule("pwr", PRIO_PWR, now);
+        LOGI(LOGM_SCHED, "INITIAL PWR");
+        initialPwrDone = true;
+        return;
+    }
+
+    // 2) BAT at T+25s
+    if (initialPwrDone && !initialBatDone && sinceBoot >= 25000) {
+        if (schedule("bat 1", PRIO_BAT, now)) batPolled[1] = now;
+        LOGI(LOGM_SCHED, "INITIAL BAT");
+        initialBatDone = true;
+        return;
+    }
+
+    // 3) STAT at T+45s
+    if (initialBatDone && !initialStatDone && sinceBoot >= 45000) {
+        if (schedule("stat 1", PRIO_STAT, now)) statPolled[1] = now;
+        LOGI(LOGM_SCHED, "INITIAL STAT");
+        initialStatDone = true;
+        return;
+    }
+    // 4) DISCOVERY at T+50s
+    if (initialStatDone && !initialDiscoveryDone && sinceBoot >= 50000) {
+
+        LOGI(LOGM_SCHED, "INITIAL DISCOVERY triggered");
+
+        discoveryPwrNeeded  = true;
+        discoveryBatNeeded  = true;
+        discoveryStatNeeded = true;
+
+        initialDiscoveryDone = true;
+        return;
+    }
+
+
+    // ---------------------------------------------------------
+    // NORMAL CYCLIC SCHEDULING (after initial sequence)
+    // ---------------------------------------------------------
+
+    if (!initialStatDone) return;
+
+    // PWR (stack data: highest periodic class, stays fresh)
+    if (now - lastPwr >= config.battery.intervalPwr) {
+        schedule("pwr", PRIO_PWR, now + config.battery.intervalPwr / 2);
+        lastPwr = now;
+        LOGI(LOGM_SCHED, "PWR scheduled");
+    }
+
+    // BAT / STAT per module, oldest data first
+    if (now - lastModuleCheck >= SCHED_CHECK_MS) {
+        lastModuleCheck = now;
+        scheduleModules(now);
+        expireStale(now);
+    }
+}
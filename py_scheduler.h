@@ -1,39 +1,77 @@
-#pragma once
-#include <Arduino.h>
-#include <vector>
-
-#include "py_uart.h"
-#include "config.h"
-#include "py_parser_pwr.h"   // für lastParsedStack + lastParsedModules
-
-class PyScheduler {
-public:
-    void begin(PyUart* u);
-    void loop();
-
-    void enqueue(const String& cmd);
-
-    bool   hasQueuedCommand() const;
-    String popNextCommand();
-
-    unsigned long lastCommandFinished = 0;
-
-private:
-    PyUart* uart = nullptr;
-
-    unsigned long bootTime = 0;
-
-    unsigned long lastPwr  = 0;
-    unsigned long lastBat  = 0;
-    unsigned long lastStat = 0;
-
-    bool initialPwrDone  = false;
-    bool initialBatDone  = false;
-    bool initialStatDone = false;
-    bool initialDiscoveryDone = false;
-
-
-    std::vector<String> queue;
-};
-
-extern PyScheduler py_scheduler;
+#pragma once
+#include <Arduino.h>
+
+#include "py_uart.h"
+#include "config.h"
+
+// ---------------------------------------------------------
+// Command scheduler (fixed capacity, no heap)
+// ---------------------------------------------------------
+// Priority classes, highest first. Within a class the command with
+// the earliest deadline runs first (= oldest data first across
+// modules). A command whose deadline has passed is taken before
+// higher classes (except interactive) so BAT/STAT cannot starve.
+// Identical pending commands are coalesced into one entry.
+// ---------------------------------------------------------
+enum CmdPriority : uint8_t {
+    PRIO_INTERACTIVE = 0,   // web console /req, web commands
+    PRIO_PWR,
+    PRIO_BAT,
+    PRIO_STAT
+};
+
+#define SCHED_CAPACITY        40       // 16 bat + 16 stat + pwr + console headroom
+#define SCHED_CMD_LEN         24
+#define SCHED_INTERACTIVE_MS  2000     // deadline of console commands
+#define SCHED_EXPIRE_MS       120000   // pending this long past deadline → dropped
+#define SCHED_CHECK_MS        1000     // per-module due check
+
+struct SchedEntry {
+    bool     used = false;
+    uint8_t  prio = PRIO_INTERACTIVE;
+    uint32_t enqueued = 0;
+    uint32_t deadline = 0;
+    char     cmd[SCHED_CMD_LEN];
+};
+
+class PyScheduler {
+public:
+    void begin(PyUart* u);
+    void loop();
+
+    // Interactive command (console, web). false if the queue is full.
+    bool enqueue(const String& cmd);
+
+    bool   hasQueuedCommand() const;
+    String popNextCommand(bool* interactive = nullptr);   // interactive: console / web command
+
+    size_t queuedCount() const;
+
+    unsigned long lastCommandFinished = 0;
+
+private:
+    // false = queue full (a coalesced command counts as success)
+    bool schedule(const char* cmd, CmdPriority prio, uint32_t deadline);
+    void expireStale(uint32_t now);
+    void scheduleModules(uint32_t now);
+
+    PyUart* uart = nullptr;
+
+    unsigned long bootTime = 0;
+
+    unsigned long lastPwr  = 0;
+    unsigned long lastModuleCheck = 0;
+
+    // last time "bat N" / "stat N" was dispatched (index = module number)
+    uint32_t batPolled[MAX_MODULES + 1];
+    uint32_t statPolled[MAX_MODULES + 1];
+
+    bool initialPwrDone  = false;
+    bool initialBatDone  = false;
+    bool initialStatDone = false;
+    bool initialDiscoveryDone = false;
+
+    SchedEntry queue[SCHED_CAPACITY];
+};
+
+extern PyScheduler py_scheduler;
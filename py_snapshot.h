@@ -0,0 +1,168 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
+// ---------------------------------------------------------
+// Snapshot<T> – single writer / multi reader seqlock
+// ---------------------------------------------------------
+// Replaces the old A/B buffers that were flipped via a volatile bool
+// while the other core could still be walking the "old" buffer.
+//
+// Writer (realtime task, parser results):
+//   publish(value)  → sequence odd, copy, sequence even
+//
+// Readers (MQTT, web APIs, scheduler, ...):
+//   read(copy)      → copies into the caller's own buffer and retries
+//                     if the writer was active meanwhile (never tears)
+//   peek(fn)        → runs fn on the live data under the same retry
+//                     rule; fn must only copy out plain values
+//
+// generation() counts publications (0 = nothing published yet), so a
+// consumer can skip data it has already handled.
+// T must be trivially copyable (fixed arrays, no String/vector), the
+// reader side never allocates.
+// ---------------------------------------------------------
+
+template <typename T>
+class Snapshot {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Snapshot<T> needs a trivially copyable type");
+
+public:
+    void publish(const T& value) {
+        update([&](T& d) { memcpy((void*)&d, &value, sizeof(T)); });
+    }
+
+    // Writer: fill the data in place (no temporary copy of T)
+    template <typename F>
+    void update(F fn) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        fn(data);
+
+        std::atomic_thread_fence(std::memory_order_release);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // Returns the generation of the copy
+    uint32_t read(T& out) const {
+        return peek([&](const T& d) { memcpy((void*)&out, &d, sizeof(T)); });
+    }
+
+    template <typename F>
+    uint32_t peek(F fn) const {
+        for (int attempt = 0; ; attempt++) {
+            uint32_t s1 = seq.load(std::memory_order_acquire);
+
+            if ((s1 & 1) == 0) {
+                fn((const T&)data);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                uint32_t s2 = seq.load(std::memory_order_relaxed);
+                if (s1 == s2) return s1 >> 1;
+            }
+
+            // writer is copying (a few µs) – give it the CPU if it runs
+            // on this core with lower priority
+            if (attempt >= 3) vTaskDelay(1);
+        }
+    }
+
+    uint32_t generation() const {
+        return seq.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    std::atomic<uint32_t> seq{0};
+    T data;
+};
+
+// ---------------------------------------------------------
+// SnapshotRing<T, N> – the last N publications (per-module results)
+// ---------------------------------------------------------
+// "bat N" / "stat N" results arrive one module after the other. A
+// single Snapshot only holds the module parsed last, so a consumer
+// that looks less often than the parser publishes would skip modules.
+// Every publication k gets its own seqlock slot (k % N); a consumer
+// walks them in order with its own cursor (publications handled):
+//
+//   uint32_t cursor = 0;
+//   while (batSnapshot.readAt(cursor, copy) == SNAP_OK) {
+//       if (!handle(copy)) break;      // retry the same entry later
+//       cursor++;
+//   }
+//
+// readAt() returns SNAP_NONE when the cursor is up to date and
+// SNAP_LAPPED when its entry was overwritten meanwhile: the cursor is
+// moved to the oldest entry still kept, the skipped ones are lost.
+// latest() is the newest entry (REST handlers).
+// ---------------------------------------------------------
+
+enum SnapRead : uint8_t { SNAP_OK, SNAP_NONE, SNAP_LAPPED };
+
+template <typename T, uint8_t N>
+class SnapshotRing {
+    struct Entry {
+        uint32_t index;   // publication number k
+        T        value;
+    };
+
+public:
+    void publish(const T& value) {
+        uint32_t k = count.load(std::memory_order_relaxed);
+
+        slots[k % N].update([&](Entry& e) {
+            e.index = k;
+            memcpy((void*)&e.value, &value, sizeof(T));
+        });
+        count.store(k + 1, std::memory_order_release);
+    }
+
+    // Publications so far (0 = nothing published yet)
+    uint32_t generation() const {
+        return count.load(std::memory_order_acquire);
+    }
+
+    SnapRead readAt(uint32_t& cursor, T& out) const {
+        uint32_t n = generation();
+        if (cursor == n) return SNAP_NONE;
+
+        if (n - cursor > N) {
+            cursor = n > N ? n - N : 0;
+            return SNAP_LAPPED;
+        }
+
+        uint32_t index = 0;
+        slots[cursor % N].peek([&](const Entry& e) {
+            index = e.index;
+            memcpy((void*)&out, &e.value, sizeof(T));
+        });
+
+        if (index != cursor) {              // overwritten while we looked
+            n = generation();
+            cursor = n > N ? n - N : 0;
+            return SNAP_LAPPED;
+        }
+        return SNAP_OK;
+    }
+
+    // Newest entry, returns its generation (0 = none)
+    uint32_t latest(T& out) const {
+        for (;;) {
+            uint32_t n = generation();
+            if (n == 0) return 0;
+
+            uint32_t cursor = n - 1;
+            if (readAt(cursor, out) == SNAP_OK) return n;
+        }
+    }
+
+private:
+    std::atomic<uint32_t> count{0};
+    Snapshot<Entry> slots[N];
+};
@@ -1,24 +1,24 @@
-#pragma once
-#include <Arduino.h>
-
-namespace SystemManager {
-
-    // Callbacks für Events
-    extern std::function<void()> onAPTemporary;
-    extern std::function<void()> onWiFiReset;
-    extern std::function<void()> onFactoryReset;
-
-    void begin();
-    void loop();
-
-    // interne Funktionen
-    void handleButton();
-
-    // Events auslösen
-    void triggerAPTemporary();
-    void triggerWiFiReset();
-    void triggerFactoryReset();
-
-    // BootCounter
-    int getBootCounter();
+#pragma once
+#include <Arduino.h>
+
+namespace SystemManager {
+
+    // Callbacks für Events
+    extern std::function<void()> onAPTemporary;
+    extern std::function<void()> onWiFiReset;
+    extern std::function<void()> onFactoryReset;
+
+    void begin();
+    void loop();
+
+    // interne Funktionen
+    void handleButton();
+
+    // Events auslösen
+    void triggerAPTemporary();
+    void triggerWiFiReset();
+    void triggerFactoryReset();
+
+    // BootCounter
+    int getBootCounter();
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Generated by tools/gen_timezones.py from tools/timezone.json - do not edit
+#pragma once
+#include "py_timezones.h"
+
+constexpr TimezoneEntry TIMEZONES[] = {
+    { "Europe", "London", "Europe/London", "GMT0BST-1,M3.5.0/01:00:00,M10.5.0/02:00:00" },
+    { "Europe", "Berlin", "Europe/Berlin", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Paris", "Europe/Paris", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Rome", "Europe/Rome", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Madrid", "Europe/Madrid", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Vienna", "Europe/Vienna", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Athens", "Europe/Athens", "EET-2EEST-3,M3.5.0/03:00:00,M10.5.0/04:00:00" },
+    { "Europe", "Moscow", "Europe/Moscow", "MSK-3" },
+    { "Europe", "Lisbon", "Europe/Lisbon", "WET0WEST-1,M3.5.0/01:00:00,M10.5.0/02:00:00" },
+    { "Europe", "Dublin", "Europe/Dublin", "IST-1GMT0,M3.5.0/01:00:00,M10.5.0/02:00:00" },
+    { "Europe", "Oslo", "Europe/Oslo", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Stockholm", "Europe/Stockholm", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Helsinki", "Europe/Helsinki", "EET-2EEST-3,M3.5.0/03:00:00,M10.5.0/04:00:00" },
+    { "Europe", "Tallinn", "Europe/Tallinn", "EET-2EEST-3,M3.5.0/03:00:00,M10.5.0/04:00:00" },
+    { "Europe", "Riga", "Europe/Riga", "EET-2EEST-3,M3.5.0/03:00:00,M10.5.0/04:00:00" },
+    { "Europe", "Vilnius", "Europe/Vilnius", "EET-2EEST-3,M3.5.0/03:00:00,M10.5.0/04:00:00" },
+    { "Europe", "Budapest", "Europe/Budapest", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Prague", "Europe/Prague", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Warsaw", "Europe/Warsaw", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "Europe", "Zurich", "Europe/Zurich", "CET-1CEST-2,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "America", "New York", "America/New_York", "EST+5EDT+4,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Chicago", "America/Chicago", "CST+6CDT+5,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Denver", "America/Denver", "MST+7MDT+6,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Los Angeles", "America/Los_Angeles", "PST+8PDT+7,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Anchorage", "America/Anchorage", "AKST+9AKDT+8,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Phoenix", "America/Phoenix", "MST+7" },
+    { "America", "Toronto", "America/Toronto", "EST+5EDT+4,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Vancouver", "America/Vancouver", "PST+8PDT+7,M3.2.0/02:00:00,M11.1.0/02:00:00" },
+    { "America", "Mexico City", "America/Mexico_City", "CST+6CDT+5,M4.1.0/02:00:00,M10.5.0/02:00:00" },
+    { "America", "Sao Paulo", "America/Sao_Paulo", "BRT+3" },
+    { "America", "Buenos Aires", "America/Argentina/Buenos_Aires", "ART+3" },
+    { "America", "Santiago", "America/Santiago", "CLT+4CLST+3,M9.1.6/24:00:00,M4.1.6/24:00:00" },
+    { "America", "Bogota", "America/Bogota", "COT+5" },
+    { "America", "Lima", "America/Lima", "PET+5" },
+    { "America", "Caracas", "America/Caracas", "VET+4" },
+    { "Asia", "Dubai", "Asia/Dubai", "GST-4" },
+    { "Asia", "Karachi", "Asia/Karachi", "PKT-5" },
+    { "Asia", "Dhaka", "Asia/Dhaka", "BDT-6" },
+    { "Asia", "Bangkok", "Asia/Bangkok", "ICT-7" },
+    { "Asia", "Singapore", "Asia/Singapore", "SGT-8" },
+    { "Asia", "Shanghai", "Asia/Shanghai", "CST-8" },
+    { "Asia", "Hong Kong", "Asia/Hong_Kong", "HKT-8" },
+    { "Asia", "Tokyo", "Asia/Tokyo", "JST-9" },
+    { "Asia", "Seoul", "Asia/Seoul", "KST-9" },
+    { "Asia", "Jakarta", "Asia/Jakarta", "WIB-7" },
+    { "Asia", "Manila", "Asia/Manila", "PST-8" },
+    { "Asia", "Tehran", "Asia/Tehran", "IRST-3:30IRDT-4:30,M3.3.0/24:00:00,M9.3.0/24:00:00" },
+    { "Australia", "Sydney", "Australia/Sydney", "AEST-10AEDT-11,M10.1.0/02:00:00,M4.1.0/03:00:00" },
+    { "Australia", "Melbourne", "Australia/Melbourne", "AEST-10AEDT-11,M10.1.0/02:00:00,M4.1.0/03:00:00" },
+    { "Australia", "Perth", "Australia/Perth", "AWST-8" },
+    { "Pacific", "Honolulu", "Pacific/Honolulu", "HST+10" },
+    { "Pacific", "Auckland", "Pacific/Auckland", "NZST-12NZDT-13,M9.5.0/02:00:00,M4.1.0/03:00:00" },
+    { "Pacific", "Fiji", "Pacific/Fiji", "FJT-12FJST-13,M11.1.0/02:00:00,M1.2.0/03:00:00" },
+    { "Africa", "Johannesburg", "Africa/Johannesburg", "SAST-2" },
+    { "Africa", "Cairo", "Africa/Cairo", "EET-2" },
+    { "Africa", "Nairobi", "Africa/Nairobi", "EAT-3" },
+    { "Africa", "Casablanca", "Africa/Casablanca", "WET0WEST-1,M3.5.0/02:00:00,M10.5.0/03:00:00" },
+    { "GMT", "GMT-12", "Etc/GMT+12", "GMT+12" },
+    { "GMT", "GMT-11", "Etc/GMT+11", "GMT+11" },
+    { "GMT", "GMT-10", "Etc/GMT+10", "GMT+10" },
+    { "GMT", "GMT-9", "Etc/GMT+9", "GMT+9" },
+    { "GMT", "GMT-8", "Etc/GMT+8", "GMT+8" },
+    { "GMT", "GMT-7", "Etc/GMT+7", "GMT+7" },
+    { "GMT", "GMT-6", "Etc/GMT+6", "GMT+6" },
+    { "GMT", "GMT-5", "Etc/GMT+5", "GMT+5" },
+    { "GMT", "GMT-4", "Etc/GMT+4", "GMT+4" },
+    { "GMT", "GMT-3", "Etc/GMT+3", "GMT+3" },
+    { "GMT", "GMT-2", "Etc/GMT+2", "GMT+2" },
+    { "GMT", "GMT-1", "Etc/GMT+1", "GMT+1" },
+    { "GMT", "GMT+0", "Etc/GMT", "GMT0" },
+    { "GMT", "GMT+1", "Etc/GMT-1", "GMT-1" },
+    { "GMT", "GMT+2", "Etc/GMT-2", "GMT-2" },
+    { "GMT", "GMT+3", "Etc/GMT-3", "GMT-3" },
+    { "GMT", "GMT+4", "Etc/GMT-4", "GMT-4" },
+    { "GMT", "GMT+5", "Etc/GMT-5", "GMT-5" },
+    { "GMT", "GMT+6", "Etc/GMT-6", "GMT-6" },
+    { "GMT", "GMT+7", "Etc/GMT-7", "GMT-7" },
+    { "GMT", "GMT+8", "Etc/GMT-8", "GMT-8" },
+    { "GMT", "GMT+9", "Etc/GMT-9", "GMT-9" },
+    { "GMT", "GMT+10", "Etc/GMT-10", "GMT-10" },
+    { "GMT", "GMT+11", "Etc/GMT-11", "GMT-11" },
+    { "GMT", "GMT+12", "Etc/GMT-12", "GMT-12" },
+};
+
+constexpr TimezoneRegion TIMEZONE_REGIONS[] = {
+    { "Europe", 0, 20 },
+    { "America", 20, 15 },
+    { "Asia", 35, 12 },
+    { "Australia", 47, 3 },
+    { "Pacific", 50, 3 },
+    { "Africa", 53, 4 },
+    { "GMT", 57, 25 },
+};
+
+constexpr uint8_t TIMEZONE_BY_NAME[] = {
+    54, 56, 53, 55, 24, 30, 32, 34, 21, 22, 33, 23, 28, 20, 25, 31,
+    29, 26, 27, 38, 37, 35, 41, 44, 36, 45, 43, 40, 39, 46, 42, 48,
+    49, 47, 69, 68, 59, 58, 57, 67, 66, 65, 64, 63, 62, 61, 60, 70,
+    79, 80, 81, 71, 72, 73, 74, 75, 76, 77, 78, 6, 1, 16, 9, 12,
+    8, 0, 4, 7, 10, 2, 17, 14, 3, 11, 13, 5, 15, 18, 19, 51,
+    52, 50,
+};
+
+constexpr size_t TIMEZONE_COUNT        = 82;
+constexpr size_t TIMEZONE_REGION_COUNT = 7;
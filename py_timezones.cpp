@@ -0,0 +1,27 @@
+#include "py_timezones.h"
+#include "py_timezone_data.h"
+#include <string.h>
+
+// ----------------------------------------------------
+//  Lookup (index sorted by IANA name)
+// ----------------------------------------------------
+const TimezoneEntry* findTimezone(const char* tzName) {
+    size_t lo = 0;
+    size_t hi = TIMEZONE_COUNT;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const TimezoneEntry& e = TIMEZONES[TIMEZONE_BY_NAME[mid]];
+
+        int c = strcmp(tzName, e.tzName);
+        if (c == 0) return &e;
+        if (c < 0) hi = mid;
+        else       lo = mid + 1;
+    }
+    return nullptr;
+}
+
+const char* findPosixForTimezone(const char* tzName) {
+    const TimezoneEntry* e = findTimezone(tzName);
+    return e ? e->posix : "UTC0";   // fallback
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+
+// ---------------------------------------------------------
+// Timezones (Region → City → IANA → POSIX)
+// ---------------------------------------------------------
+// The tables are generated from tools/timezone.json by
+// tools/gen_timezones.py (py_timezone_data.h) and live in flash:
+// lookup needs neither heap nor SPIFFS.
+//
+//   TIMEZONES[]          grouped by region, UI order
+//   TIMEZONE_REGIONS[]   region → first entry, count
+// ---------------------------------------------------------
+
+struct TimezoneEntry {
+    const char* region;
+    const char* city;
+    const char* tzName;
+    const char* posix;
+};
+
+struct TimezoneRegion {
+    const char* name;
+    uint8_t first;
+    uint8_t count;
+};
+
+extern const TimezoneEntry  TIMEZONES[];
+extern const TimezoneRegion TIMEZONE_REGIONS[];
+extern const size_t TIMEZONE_COUNT;
+extern const size_t TIMEZONE_REGION_COUNT;
+
+// Binary search by IANA name, nullptr if unknown
+const TimezoneEntry* findTimezone(const char* tzName);
+
+// POSIX TZ string for setenv("TZ"), "UTC0" if unknown
+const char* findPosixForTimezone(const char* tzName);
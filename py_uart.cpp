@@ -1,297 +1,399 @@
-#include "py_uart.h"
-#include "py_log.h"
-#include "py_parser_pwr.h"
-#include "py_parser_bat.h"
-#include "py_parser_stat.h"
-
-#include "config.h"   // enthält PwrBuffer, BatBuffer, StatBuffer + Flags
-
-
-#define BAT_RX_PIN 16
-#define BAT_TX_PIN 17
-
-static char g_szRecvBuff[7000];
-static int g_invalidCount = 0;
-
-// ---------------------------------------------------------
-static bool isValidFrame(const String& f) {
-    if (f.indexOf("@") < 0) return false;
-    if (f.indexOf("$$") < 0) return false;
-    if (f.indexOf("pylon>") < 0) return false;
-    if (f.length() < 40) return false;
-
-    int lines = 0;
-    for (int i = 0; i < f.length(); i++)
-        if (f[i] == '\n') lines++;
-    if (lines < 3) return false;
-
-    if (f.indexOf("Press [Enter]") >= 0 &&
-        f.indexOf("Remote command:") < 0)
-        return false;
-
-    return true;
-}
-
-// ---------------------------------------------------------
-void PyUart::begin(int rx, int tx) {
-    rxPin = rx;
-    txPin = tx;
-
-    Serial2.begin(115200, SERIAL_8N1, rxPin, txPin);
-    delay(50);
-
-    Log(LOG_INFO, "UART: begin() RX=" + String(rxPin) + " TX=" + String(txPin));
-
-    commReady     = false;
-    busy          = false;
-    frameReady    = false;
-    frameValid    = false;
-    lastCommand   = "";
-    lastRawFrame  = "";
-    lastPwrFrame  = "";
-    lastBatFrame  = "";
-    lastStatFrame = "";
-    g_invalidCount = 0;
-
-    wakeUpConsole();
-}
-
-// ---------------------------------------------------------
-void PyUart::switchBaud(int newRate) {
-    Log(LOG_DEBUG, "UART: switchBaud(" + String(newRate) + ")");
-    Serial2.flush();
-    delay(20);
-    Serial2.end();
-    delay(20);
-    Serial2.begin(newRate, SERIAL_8N1, rxPin, txPin);
-    delay(20);
-}
-
-// ---------------------------------------------------------
-void PyUart::wakeUpConsole() {
-    Log(LOG_INFO, "UART: wakeUpConsole()");
-
-    commReady = false;
-
-    switchBaud(1200);
-    Serial2.write("~20014682C0048520FCC3\r");
-    delay(1000);
-
-    byte nl[] = {0x0E, 0x0A};
-    switchBaud(115200);
-
-    for (int i = 0; i < 10; i++) {
-        Serial2.write(nl, 2);
-        delay(1000);
-
-        if (Serial2.available()) {
-            while (Serial2.available()) Serial2.read();
-            break;
-        }
-    }
-
-    commReady = true;
-    g_invalidCount = 0;
-
-    Log(LOG_INFO, "UART: wakeUpConsole complete → commReady=true");
-}
-
-// ---------------------------------------------------------
-int PyUart::readFromSerial() {
-    memset(g_szRecvBuff, 0, sizeof(g_szRecvBuff));
-    int recvLen = 0;
-
-    // Wait for first byte
-    for (int i = 0; i < 150 && !Serial2.available(); ++i)
-        delay(10);
-
-    if (!Serial2.available()) {
-        Log(LOG_WARN, "UART: timeout waiting for response");
-        return 0;
-    }
-
-    while (Serial2.available()) {
-        char buf[256] = "";
-        int r = Serial2.readBytesUntil('>', buf, sizeof(buf) - 1);
-
-        if (r > 0) {
-            if (r + recvLen + 1 >= (int)sizeof(g_szRecvBuff)) {
-                Log(LOG_WARN, "UART: read overflow");
-                break;
-            }
-
-            strcat(g_szRecvBuff, buf);
-            recvLen += r;
-
-            if (strstr(g_szRecvBuff, "$$\r\n\rpylon")) {
-                strcat(g_szRecvBuff, ">");
-                break;
-            }
-
-            if (strstr(g_szRecvBuff, "Press [Enter] to be continued"))
-                Serial2.write("\r");
-
-            for (int j = 0; j < 20 && !Serial2.available(); ++j)
-                delay(10);
-        } else break;
-    }
-
-    Log(LOG_DEBUG, "UART RX len=" + String(recvLen));
-    return recvLen;
-}
-
-// ---------------------------------------------------------
-bool PyUart::sendCommandAndReadSerialResponse(const char* cmd) {
-    if (cmd && cmd[0]) {
-        Log(LOG_DEBUG, "UART TX: '" + String(cmd) + "'");
-        Serial2.write(cmd);
-    }
-
-    Serial2.write("\n");
-    Serial2.flush();
-
-    int len = readFromSerial();
-    return (len > 0);
-}
-
-// ---------------------------------------------------------
-bool PyUart::sendCommand(const char* cmd) {
-
-    if (!commReady) {
-        Log(LOG_WARN, "UART: commReady=false → wakeUpConsole()");
-        wakeUpConsole();
-        if (!commReady) {
-            Log(LOG_ERROR, "UART: wakeUpConsole failed");
-            return false;
-        }
-    }
-
-    while (Serial2.available()) Serial2.read();
-    delay(10);
-
-    lastCommand = String(cmd);
-
-    busy       = true;
-    frameReady = false;
-    frameValid = false;
-
-    if (!sendCommandAndReadSerialResponse(cmd)) {
-        busy = false;
-        g_invalidCount++;
-
-        Log(LOG_WARN, "UART: no response, invalidCount=" + String(g_invalidCount));
-
-        if (g_invalidCount > 3) {
-            commReady = false;
-            Log(LOG_ERROR, "UART: too many failures → commReady=false");
-        }
-
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        return false;
-    }
-
-    lastRawFrame = String(g_szRecvBuff);
-    frameReady   = true;
-    frameValid   = isValidFrame(lastRawFrame);
-
-    if (!frameValid) {
-        g_invalidCount++;
-        Log(LOG_WARN, "UART: invalid frame received");
-
-        if (g_invalidCount > 3) {
-            commReady = false;
-            Log(LOG_ERROR, "UART: too many invalid frames → commReady=false");
-        }
-
-        busy = false;
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        return false;
-    }
-
-    g_invalidCount = 0;
-
-    Log(LOG_INFO, "UART: valid frame received (" + String(lastRawFrame.length()) + " bytes)");
-
-    if (lastCommand == "pwr")      lastPwrFrame = lastRawFrame;
-    else if (lastCommand.startsWith("bat"))  lastBatFrame = lastRawFrame;
-    else if (lastCommand.startsWith("stat")) lastStatFrame = lastRawFrame;
-
-    // ---------------------------------------------------------
-    // PARSER DIRECT CALL (NEW ARCHITECTURE)
-    // ---------------------------------------------------------
-    if (frameValid) {
-
-        String raw = lastRawFrame;
-
-        // -----------------------------
-        // PWR PARSER
-        // -----------------------------
-        if (lastCommand == "pwr") {
-            BatteryStack stack;
-            std::vector<BatteryModule> mods;
-
-            ParseResult r = parsePwrFrame(raw, stack, mods);
-
-            if (r == PARSE_OK) {
-                PwrBuffer* target = pwrUseA ? &pwrB : &pwrA;
-                target->stack = stack;
-                target->modules = mods;
-                pwrUseA = !pwrUseA;
-                parserHasData = true;
-            }
-        }
-
-        // -----------------------------
-        // BAT PARSER
-        // -----------------------------
-        else if (lastCommand.startsWith("bat")) {
-            BatData out;
-            int moduleIndex = lastCommand.substring(3).toInt();
-
-            ParseResult r = parseBatFrame(moduleIndex, raw, out);
-
-            if (r == PARSE_OK) {
-                BatBuffer* target = batUseA ? &batB : &batA;
-                target->cells = lastParsedBatCells;
-                batUseA = !batUseA;
-                batParserHasData = true;
-                batParserModuleIndex = moduleIndex;
-            }
-        }
-
-        // -----------------------------
-        // STAT PARSER
-        // -----------------------------
-        else if (lastCommand.startsWith("stat")) {
-            StatData out;
-            int moduleIndex = lastCommand.substring(4).toInt();
-
-            ParseResult r = parseStatFrame(moduleIndex, raw, out);
-
-            if (r == PARSE_OK) {
-                StatBuffer* target = statUseA ? &statB : &statA;
-                target->stat = out;
-                statUseA = !statUseA;
-                statParserHasData = true;
-                statParserModuleIndex = moduleIndex;
-            }
-        }
-
-        // Frame wurde verarbeitet → nicht erneut parsen
-        frameReady = false;
-    }
-    
-
-    busy = false;
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-    return true;
-}
-
-// ---------------------------------------------------------
-void PyUart::loop() {}
-
-// ---------------------------------------------------------
-String PyUart::getFrame() {
-    frameReady = false;
-    return lastRawFrame;
-}
+#include "py_uart.h"
+#include "py_log.h"
+#include "py_pipeline.h"
+#include "py_pacing.h"
+
+#include "config.h"
+
+
+#define BAT_RX_PIN 16
+#define BAT_TX_PIN 17
+
+static int g_invalidCount = 0;
+
+// ---------------------------------------------------------
+// Event-driven RX engine
+// ---------------------------------------------------------
+// Serial2.onReceive() is called from the UART driver's event task
+// whenever the driver reports new data (FIFO threshold or RX idle).
+// The callback appends the bytes to the armed frameStore slot (written
+// exactly once, never copied afterwards), scans only the new
+// tail for "Press [Enter]" / "$$ ... pylon>" and wakes the realtime
+// task through g_rxDone once the frame is complete.
+// ---------------------------------------------------------
+static const char* const RX_MORE   = "Press [Enter] to be continued";
+static const char* const RX_END    = "$$";
+static const char* const RX_PROMPT = "pylon>";
+
+// first-byte timeout is adaptive per command type (py_pacing)
+static const unsigned long RX_IDLE_TIMEOUT       = 200;   // ms
+static const size_t        RX_DRIVER_BUFFER      = 1024;  // driver ring, drained by the callback
+
+static SemaphoreHandle_t g_rxDone = nullptr;
+static portMUX_TYPE g_rxMux = portMUX_INITIALIZER_UNLOCKED;
+
+static char* g_rxBuf = nullptr;   // frameStore slot
+static int   g_rxCap = 0;
+
+static volatile bool g_rxArmed = false;
+static volatile bool g_rxComplete = false;
+static volatile int  g_rxLen = 0;
+static volatile unsigned long g_rxLastByte = 0;
+static volatile unsigned long g_rxFirstByte = 0;
+
+static int g_rxMoreScan = 0;   // next offset to search for RX_MORE
+static int g_rxEndPos   = -1;  // offset of "$$", -1 = not seen yet
+
+// search needle in g_rxBuf starting at 'from' (buffer is NUL-terminated)
+static int rxFind(int from, const char* needle) {
+    if (from < 0) from = 0;
+    const char* p = strstr(g_rxBuf + from, needle);
+    return p ? (int)(p - g_rxBuf) : -1;
+}
+
+// Append one chunk; returns true if the console asks for <Enter>.
+// Must be called with g_rxMux held.
+static bool rxAppend(const char* data, int n) {
+    int oldLen = g_rxLen;
+    int len = oldLen;
+
+    for (int i = 0; i < n; i++) {
+        if (len + 1 >= g_rxCap) break;
+        if (data[i] == '\0') continue;
+        g_rxBuf[len++] = data[i];
+    }
+    g_rxBuf[len] = '\0';
+    g_rxLen = len;
+
+    bool wantEnter = false;
+    int more = rxFind(g_rxMoreScan, RX_MORE);
+    if (more >= 0) {
+        wantEnter = true;
+        g_rxMoreScan = more + strlen(RX_MORE);
+    } else {
+        g_rxMoreScan = max(g_rxMoreScan, len - (int)strlen(RX_MORE));
+    }
+
+    // only look at the tail that may contain a new match
+    if (g_rxEndPos < 0)
+        g_rxEndPos = rxFind(oldLen - (int)strlen(RX_END), RX_END);
+
+    if (g_rxEndPos >= 0) {
+        int from = max(g_rxEndPos, oldLen - (int)strlen(RX_PROMPT));
+        if (rxFind(from, RX_PROMPT) >= 0)
+            g_rxComplete = true;
+    }
+
+    return wantEnter;
+}
+
+static void onUartReceive() {
+    if (!g_rxArmed) return;   // not waiting for a response → leave data in driver
+
+    uint8_t chunk[128];
+
+    while (Serial2.available() > 0) {
+        size_t n = Serial2.read(chunk, sizeof(chunk));
+        if (n == 0) break;
+
+        bool wantEnter = false;
+        bool complete  = false;
+
+        portENTER_CRITICAL(&g_rxMux);
+        if (g_rxArmed) {
+            if (g_rxLen == 0) g_rxFirstByte = millis();
+            wantEnter = rxAppend((const char*)chunk, (int)n);
+            g_rxLastByte = millis();
+            complete = g_rxComplete;
+            if (complete) g_rxArmed = false;
+        }
+        portEXIT_CRITICAL(&g_rxMux);
+
+        if (wantEnter && !complete)
+            Serial2.write("\r");
+
+        if (complete) {
+            xSemaphoreGive(g_rxDone);
+            return;
+        }
+    }
+}
+
+static void rxArm(char* buf, int cap) {
+    portENTER_CRITICAL(&g_rxMux);
+    g_rxBuf      = buf;
+    g_rxCap      = cap;
+    g_rxBuf[0]   = '\0';
+    g_rxLen      = 0;
+    g_rxMoreScan = 0;
+    g_rxEndPos   = -1;
+    g_rxComplete = false;
+    g_rxLastByte = millis();
+    g_rxFirstByte = 0;
+    g_rxArmed    = true;
+    portEXIT_CRITICAL(&g_rxMux);
+
+    // drop a stale completion from an earlier timeout
+    xSemaphoreTake(g_rxDone, 0);
+}
+
+static void rxDisarm() {
+    portENTER_CRITICAL(&g_rxMux);
+    g_rxArmed = false;
+    portEXIT_CRITICAL(&g_rxMux);
+}
+
+static void rxAttach() {
+    if (!g_rxDone) g_rxDone = xSemaphoreCreateBinary();
+    Serial2.onReceive(onUartReceive);
+}
+
+// ---------------------------------------------------------
+static bool isValidFrame(FrameView f) {
+    if (viewFindChar(f, '@') < 0) return false;
+    if (viewFind(f, "$$") < 0) return false;
+    if (viewFind(f, "pylon>") < 0) return false;
+    if (f.len < 40) return false;
+
+    int lines = 0;
+    for (size_t i = 0; i < f.len; i++)
+        if (f[i] == '\n') lines++;
+    if (lines < 3) return false;
+
+    if (viewFind(f, "Press [Enter]") >= 0 &&
+        viewFind(f, "Remote command:") < 0)
+        return false;
+
+    return true;
+}
+
+// ---------------------------------------------------------
+void PyUart::begin(int rx, int tx) {
+    rxPin = rx;
+    txPin = tx;
+
+    Serial2.setRxBufferSize(RX_DRIVER_BUFFER);
+    Serial2.begin(115200, SERIAL_8N1, rxPin, txPin);
+    rxAttach();
+    delay(50);
+
+    LOGI(LOGM_UART, "begin() RX=%d TX=%d", rxPin, txPin);
+
+    commReady     = false;
+    busy          = false;
+    frameValid    = false;
+    lastCommand   = "";
+    g_invalidCount = 0;
+
+    wakeUpConsole();
+}
+
+// ---------------------------------------------------------
+void PyUart::switchBaud(int newRate) {
+    LOGD(LOGM_UART, "switchBaud(%d)", newRate);
+    Serial2.flush();
+    delay(20);
+    Serial2.end();
+    delay(20);
+    Serial2.begin(newRate, SERIAL_8N1, rxPin, txPin);
+    rxAttach();
+    delay(20);
+}
+
+// ---------------------------------------------------------
+void PyUart::wakeUpConsole() {
+    LOGI(LOGM_UART, "wakeUpConsole()");
+
+    commReady = false;
+
+    switchBaud(1200);
+    Serial2.write("~20014682C0048520FCC3\r");
+    delay(1000);
+
+    byte nl[] = {0x0E, 0x0A};
+    switchBaud(115200);
+
+    for (int i = 0; i < 10; i++) {
+        Serial2.write(nl, 2);
+        delay(1000);
+
+        if (Serial2.available()) {
+            while (Serial2.available()) Serial2.read();
+            break;
+        }
+    }
+
+    commReady = true;
+    g_invalidCount = 0;
+    py_pacing.reset();
+
+    LOGI(LOGM_UART, "wakeUpConsole complete → commReady=true");
+}
+
+// ---------------------------------------------------------
+// Waits for the RX engine instead of polling Serial2.
+// Returns the number of bytes received into rxSlot.
+// ---------------------------------------------------------
+int PyUart::readFromSerial() {
+    unsigned long start = millis();
+    unsigned long firstByteTimeout = py_pacing.firstByteTimeout(paceType);
+
+    for (;;) {
+        if (xSemaphoreTake(g_rxDone, pdMS_TO_TICKS(20)) == pdTRUE)
+            break;   // "$$ ... pylon>" seen
+
+        unsigned long now = millis();
+        int len;
+        unsigned long last;
+
+        portENTER_CRITICAL(&g_rxMux);
+        len  = g_rxLen;
+        last = g_rxLastByte;
+        portEXIT_CRITICAL(&g_rxMux);
+
+        if (len == 0 && now - start >= firstByteTimeout) {
+            rxDisarm();
+            LOGW(LOGM_UART, "timeout waiting for response");
+            return 0;
+        }
+
+        // Console stopped talking without a prompt → hand over what we have,
+        // isValidFrame() decides about it
+        if (len > 0 && now - last >= RX_IDLE_TIMEOUT) {
+            rxDisarm();
+            if (len + 1 >= g_rxCap)
+                LOGW(LOGM_UART, "read overflow");
+            break;
+        }
+    }
+
+    int recvLen = g_rxLen;
+    frameStore.setLength(rxSlot, recvLen);
+
+    rxTotalMs     = millis() - start;
+    // echo may already arrive while TX is flushed → clamp to 0
+    long fb = g_rxFirstByte ? (long)(g_rxFirstByte - start) : (long)rxTotalMs;
+    rxFirstByteMs = fb > 0 ? fb : 0;
+
+    LOGD(LOGM_UART, "RX len=%u in %lu ms (first byte %lu ms)",
+         recvLen, rxTotalMs, rxFirstByteMs);
+    return recvLen;
+}
+
+// ---------------------------------------------------------
+bool PyUart::sendCommandAndReadSerialResponse(const char* cmd) {
+    rxArm(frameStore.data(rxSlot), frameStore.capacity());
+
+    if (cmd && cmd[0]) {
+        LOGD(LOGM_UART, "TX: '%s'", cmd);
+        Serial2.write(cmd);
+    }
+
+    Serial2.write("\n");
+    Serial2.flush();
+
+    int len = readFromSerial();
+    return (len > 0);
+}
+
+// ---------------------------------------------------------
+bool PyUart::sendCommand(const char* cmd, bool console) {
+
+    if (!commReady) {
+        LOGW(LOGM_UART, "commReady=false → wakeUpConsole()");
+        wakeUpConsole();
+        if (!commReady) {
+            LOGE(LOGM_UART, "wakeUpConsole failed");
+            return false;
+        }
+    }
+
+    lastCommand = String(cmd);
+    paceType    = PyPacing::typeOf(lastCommand);
+
+    // adaptive gap instead of a fixed 1 s sleep after every command
+    py_pacing.waitGap();
+
+    while (Serial2.available()) Serial2.read();
+    delay(10);
+
+    rxSlot = frameStore.acquire();
+    if (rxSlot < 0) {
+        LOGW(LOGM_UART, "no free frame slot");
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        return false;
+    }
+
+    busy       = true;
+    frameValid = false;
+
+    if (!sendCommandAndReadSerialResponse(cmd)) {
+        frameStore.release(rxSlot);
+        rxSlot = -1;
+        busy = false;
+        g_invalidCount++;
+        py_pacing.onResult(paceType, PACE_TIMEOUT, rxFirstByteMs, rxTotalMs, 0);
+
+        LOGW(LOGM_UART, "no response, invalidCount=%d", g_invalidCount);
+
+        if (g_invalidCount > 3) {
+            commReady = false;
+            LOGE(LOGM_UART, "too many failures → commReady=false");
+        }
+
+        return false;
+    }
+
+    // Web console sees the response to its command, valid or not
+    FrameView raw = frameStore.view(rxSlot);
+    if (console) frameStore.publishLast(rxSlot);
+    frameValid = isValidFrame(raw);
+
+    if (!frameValid) {
+        frameStore.release(rxSlot);
+        rxSlot = -1;
+        g_invalidCount++;
+        py_pacing.onResult(paceType, PACE_INVALID, rxFirstByteMs, rxTotalMs, raw.len);
+        LOGW(LOGM_UART, "invalid frame received");
+
+        if (g_invalidCount > 3) {
+            commReady = false;
+            LOGE(LOGM_UART, "too many invalid frames → commReady=false");
+        }
+
+        busy = false;
+        return false;
+    }
+
+    g_invalidCount = 0;
+    py_pacing.onResult(paceType, PACE_OK, rxFirstByteMs, rxTotalMs, raw.len);
+
+    LOGI(LOGM_UART, "valid frame received (%u bytes)", raw.len);
+
+    // ---------------------------------------------------------
+    // HAND OVER TO THE PARSER STAGE (py_pipeline)
+    // The descriptor takes over our slot reference; parsing runs in
+    // the parser task while the next command is already being sent.
+    // ---------------------------------------------------------
+    FrameDesc desc;
+    if (frameDescFor(lastCommand, desc)) {
+        desc.slot = rxSlot;
+        desc.receivedAt = millis();
+
+        // back-pressure: wait for the parser instead of dropping
+        if (pushFrame(desc, pdMS_TO_TICKS(1000))) {
+            rxSlot = -1;
+        } else {
+            LOGW(LOGM_UART, "parser queue full, frame dropped");
+        }
+    }
+
+    frameStore.release(rxSlot);   // no-op if handed over (rxSlot = -1)
+    rxSlot = -1;
+
+    busy = false;
+    return true;
+}
+
+// ---------------------------------------------------------
+void PyUart::loop() {}
@@ -1,48 +1,43 @@
-#pragma once
-#include <Arduino.h>
-
-class PyUart {
-public:
-    void begin(int rx, int tx);
-    void loop();   // intentionally empty
-
-    // Blocking command → fills lastRawFrame
-    bool sendCommand(const char* cmd);
-
-    // Frame access for realtimeTask()
-    bool hasFrame() const { return frameReady; }
-    bool isFrameValid() const { return frameValid; }
-    String getFrame();   // returns lastRawFrame and clears frameReady
-
-    // Status
-    bool isReady() const { return commReady; }
-    bool isBusy() const { return busy; }
-    String getLastCommand() const { return lastCommand; }
-
-    // Last frames for web UI
-    String getLastPwrFrame() const { return lastPwrFrame; }
-    String getLastBatFrame() const { return lastBatFrame; }
-    String getLastStatFrame() const { return lastStatFrame; }
-    String getLastRawFrame() const { return lastRawFrame; }
-
-private:
-    void switchBaud(int newRate);
-    void wakeUpConsole();
-    int  readFromSerial();
-    bool sendCommandAndReadSerialResponse(const char* cmd);
-
-    bool commReady = false;
-    bool busy = false;
-    bool frameReady = false;
-    bool frameValid = false;
-
-    int rxPin = -1;
-    int txPin = -1;
-
-    String lastCommand;
-    String lastRawFrame;
-
-    String lastPwrFrame;
-    String lastBatFrame;
-    String lastStatFrame;
-};
+#pragma once
+#include <Arduino.h>
+#include "py_frame_store.h"
+#include "py_pacing.h"
+
+class PyUart {
+public:
+    void begin(int rx, int tx);
+    void loop();   // intentionally empty
+
+    // Blocking command → response lands in a frameStore slot.
+    // console: response of a console command → published as the
+    // last frame (frameStore.acquireLast(), valid or not)
+    bool sendCommand(const char* cmd, bool console = false);
+
+    bool isFrameValid() const { return frameValid; }
+
+    // Status
+    bool isReady() const { return commReady; }
+    bool isBusy() const { return busy; }
+    String getLastCommand() const { return lastCommand; }
+
+private:
+    void switchBaud(int newRate);
+    void wakeUpConsole();
+    int  readFromSerial();
+    bool sendCommandAndReadSerialResponse(const char* cmd);
+
+    bool commReady = false;
+    bool busy = false;
+    bool frameValid = false;
+
+    int rxPin = -1;
+    int txPin = -1;
+
+    int rxSlot = -1;   // frameStore slot of the response being received
+
+    PaceType paceType = PACE_OTHER;
+    uint32_t rxFirstByteMs = 0;   // send → first byte of the last response
+    uint32_t rxTotalMs = 0;       // send → end of the last response
+
+    String lastCommand;
+};
@@ -0,0 +1,101 @@
+// Value formatting benchmark: py_format (fixed point) against the
+// float paths it replaced (atof × factor + "%.*f", String(float, n))
+//
+//   ./bench_format            full run
+//   ./bench_format --quick    smoke run (ctest)
+//
+// "same" counts values where the float path prints the same text;
+// differences are float artefacts ("-0.00", x.xx5 rounding).
+#include "host_test.h"
+#include "py_format.h"
+#include <Arduino.h>
+
+struct Case {
+    const char* name;
+    const char* raw;         // console text
+    const char* factor;
+    uint8_t     decimals;
+    bool        fahrenheit;
+};
+
+static const Case CASES[] = {
+    { "volt mV -> V",    "50376",   "0.001", 3, false },
+    { "curr mA -> A",    "-1150",   "0.001", 2, false },
+    { "temp mC -> C",    "20400",   "0.001", 1, false },
+    { "temp mC -> F",    "20450",   "0.001", 1, true  },
+    { "soc text",        "76%",     "1",     0, false },
+    { "coulomb mAH",     "37104 mAH", "0.001", 2, false },
+    { "decimal text",    "50.375",  "1",     2, false },
+    { "small negative",  "-4",      "0.001", 2, false },
+};
+
+static const int NCASES = sizeof(CASES) / sizeof(CASES[0]);
+
+static FixedFormat FMT[NCASES];
+static float       FACTOR[NCASES];
+
+// the old publish path (PyMqtt::formatNumeric before py_format)
+static size_t floatFormat(const Case& c, float factor, char* out, size_t cap) {
+    float v = (float)atof(c.raw) * factor;
+    if (c.fahrenheit) v = v * 1.8f + 32.0f;
+    return snprintf(out, cap, "%.*f", c.decimals, v);
+}
+
+static size_t fixedPath(const Case& c, const FixedFormat& f, char* out, size_t cap) {
+    int64_t raw;
+    uint8_t scale;
+    if (!fixedParseText(c.raw, raw, scale)) return 0;
+    return fixedFormat(out, cap, raw, scale, f);
+}
+
+template <typename Fn>
+static void bench(const char* name, int iterations, Fn format) {
+    char out[32];
+    size_t sink = 0;
+
+    size_t allocs = hostAllocCount();
+    uint64_t t0 = hostNowNs();
+    for (int i = 0; i < iterations; i++)
+        for (int c = 0; c < NCASES; c++) sink += format(c, out, sizeof(out));
+    uint64_t t1 = hostNowNs();
+    allocs = hostAllocCount() - allocs;
+
+    double n = (double)iterations * NCASES;
+    printf("%-22s %8.1f ns/value  %5.2f allocs/value  (%zu)\n",
+           name, (t1 - t0) / n, allocs / n, sink % 10);
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    int n = quick ? 1000 : 200000;
+
+    int same = 0;
+    for (int c = 0; c < NCASES; c++) {
+        const Case& k = CASES[c];
+        FMT[c].decimals   = k.decimals;
+        FMT[c].fahrenheit = k.fahrenheit;
+        FMT[c].exact      = fixedParseFactor(k.factor, FMT[c].mul, FMT[c].exp);
+        FACTOR[c]         = (float)atof(k.factor);
+
+        char a[32], b[32];
+        fixedPath(k, FMT[c], a, sizeof(a));
+        floatFormat(k, FACTOR[c], b, sizeof(b));
+        same += strcmp(a, b) == 0;
+        printf("%-16s %-10s -> fixed %-10s float %s\n", k.name, k.raw, a, b);
+    }
+    printf("%d of %d identical\n\n", same, NCASES);
+
+    bench("fixedFormat", n, [](int c, char* out, size_t cap) {
+        return fixedPath(CASES[c], FMT[c], out, cap);
+    });
+    bench("float + snprintf", n, [](int c, char* out, size_t cap) {
+        return floatFormat(CASES[c], FACTOR[c], out, cap);
+    });
+    bench("String(float, n)", n, [](int c, char* out, size_t cap) {
+        float v = (float)atof(CASES[c].raw) * FACTOR[c];
+        if (CASES[c].fahrenheit) v = v * 1.8f + 32.0f;
+        String s(v, (unsigned int)CASES[c].decimals);
+        return (size_t)strlcpy(out, s.c_str(), cap);
+    });
+    return 0;
+}
@@ -0,0 +1,235 @@
+// HTTP server load generator: concurrent clients against the server
+// core (py_http_server.cpp) running in its own thread like the web task
+//
+//   ./bench_http            full run
+//   ./bench_http --quick    smoke run (ctest)
+//
+// Every client thread sends a request, waits for the answer (a ~1 KB
+// JsonStream document, like the REST pages) and sends the next one.
+// Reported: requests/s and the latency percentiles of these requests.
+//
+//   keep-alive N   N clients on persistent connections
+//   new conn N     a new connection per request
+//   mixed          4 keep-alive clients while a browser downloads a
+//                  1 MB file through a small window and two requests
+//                  at a time are deferred for 50 ms (UART / WiFi scan)
+//
+// The mixed row shows what the multiplexing is for: the file and the
+// parked requests do not show up in the others' tail latency.
+#include "host_test.h"
+#include "host_http.h"
+#include "py_http_server.h"
+#include "web/json_stream.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#define FILE_BYTES    (1024 * 1024)
+#define DEFER_MS      50
+
+static HttpServer server(0);
+static std::atomic<bool> stopLoop{false};
+
+// ---------------------------------------------------------
+// Server side
+// ---------------------------------------------------------
+struct FakeFile {
+    size_t len;
+    size_t pos = 0;
+
+    const char* name() const { return "/blob.bin"; }
+    size_t size() const { return len; }
+    size_t read(uint8_t* buf, size_t n) {
+        size_t k = std::min(n, len - pos);
+        memset(buf, 'f', k);
+        pos += k;
+        return k;
+    }
+    void close() {}
+};
+
+struct Parked {
+    HttpTicket ticket;
+    uint32_t   due;
+};
+
+static std::vector<Parked> parked;          // server thread only
+
+static void registerRoutes() {
+    server.on("/api/values", HTTP_GET, [] {
+        JsonStream js(server);
+        js.begin();
+        js.beginObject();
+        js.member("gen", (unsigned)server.stats().requests);
+        js.key("values").beginArray();
+        for (int i = 0; i < 80; i++) js.value("52.310");
+        js.endArray();
+        js.endObject();
+        js.end();
+    });
+
+    server.on("/file", HTTP_GET, [] {
+        FakeFile f = { FILE_BYTES };
+        server.streamFile(f, "application/octet-stream");
+    });
+
+    server.on("/defer", HTTP_GET, [] {
+        HttpTicket t = server.defer();
+        if (t) parked.push_back({ t, (uint32_t)(millis() + DEFER_MS) });
+    });
+}
+
+static void serverLoop() {
+    while (!stopLoop) {
+        server.handleClient(1);
+
+        uint32_t now = millis();
+        for (size_t i = 0; i < parked.size();) {
+            if ((int32_t)(now - parked[i].due) < 0) { i++; continue; }
+            server.reply(parked[i].ticket, 200, "text/plain", "late", 4);
+            parked.erase(parked.begin() + i);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// Clients
+// ---------------------------------------------------------
+struct Samples {
+    std::mutex mu;
+    std::vector<uint32_t> us;
+    uint32_t errors = 0;
+
+    void add(const std::vector<uint32_t>& v, uint32_t err) {
+        std::lock_guard<std::mutex> lock(mu);
+        us.insert(us.end(), v.begin(), v.end());
+        errors += err;
+    }
+};
+
+static void closeHard(HostHttpClient& c) {
+    // RST instead of TIME_WAIT: thousands of connections per second
+    linger l = { 1, 0 };
+    setsockopt(c.fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
+    c.close();
+}
+
+static void requester(uint64_t until, bool reconnect, Samples& out) {
+    std::vector<uint32_t> us;
+    uint32_t errors = 0;
+    HostHttpClient c;
+    std::string req = hostHttpGet("/api/values");
+
+    while (hostNowNs() < until) {
+        uint64_t t0 = hostNowNs();
+        if (!c.isOpen() && !c.open(server.port())) {
+            errors++;
+            continue;
+        }
+
+        HostHttpResponse r;
+        if (!c.request(req, r) || r.code != 200) {
+            errors++;
+            c.close();
+            continue;
+        }
+        us.push_back((uint32_t)((hostNowNs() - t0) / 1000));
+
+        if (reconnect) closeHard(c);
+    }
+    out.add(us, errors);
+}
+
+// reads the file in small portions with pauses (weak WiFi)
+static void slowDownload(uint64_t until, uint32_t& files) {
+    char buf[2048];
+    while (hostNowNs() < until) {
+        HostHttpClient c;
+        if (!c.open(server.port(), 4096) || !c.write(hostHttpGet("/file", true))) return;
+
+        size_t total = 0;
+        for (;;) {
+            ssize_t n = ::recv(c.fd, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            total += n;
+            usleep(200);
+        }
+        if (total > FILE_BYTES) files++;
+    }
+}
+
+static void deferredRequests(uint64_t until, uint32_t& answered) {
+    HostHttpClient c;
+    while (hostNowNs() < until) {
+        if (!c.isOpen() && !c.open(server.port())) return;
+        HostHttpResponse r;
+        if (c.request(hostHttpGet("/defer"), r, 1000) && r.body == "late") answered++;
+        else c.close();
+    }
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& v, double p) {
+    if (v.empty()) return 0;
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+static bool run(const char* label, int clients, bool reconnect, bool mixed, uint32_t ms) {
+    Samples s;
+    uint64_t t0 = hostNowNs();
+    uint64_t until = t0 + (uint64_t)ms * 1000000;
+
+    uint32_t files = 0, deferred[2] = { 0, 0 };
+    std::vector<std::thread> threads;
+    if (mixed) {
+        threads.emplace_back(slowDownload, until, std::ref(files));
+        threads.emplace_back(deferredRequests, until, std::ref(deferred[0]));
+        threads.emplace_back(deferredRequests, until, std::ref(deferred[1]));
+    }
+    for (int i = 0; i < clients; i++)
+        threads.emplace_back(requester, until, reconnect, std::ref(s));
+    for (auto& t : threads) t.join();
+
+    double sec = (hostNowNs() - t0) / 1e9;
+    std::sort(s.us.begin(), s.us.end());
+
+    bool ok = s.errors == 0 && !s.us.empty();
+    printf("%-14s %8.0f req/s  p50 %6u us  p99 %6u us  p99.9 %6u us  max %6u us",
+           label, s.us.size() / sec,
+           percentile(s.us, 0.50), percentile(s.us, 0.99), percentile(s.us, 0.999),
+           s.us.empty() ? 0 : s.us.back());
+    if (mixed) printf("  (%u files, %u deferred)", files, deferred[0] + deferred[1]);
+    printf("  %s\n", ok ? "ok" : "FAIL");
+    if (s.errors) printf("  %u errors\n", s.errors);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    uint32_t ms = quick ? 200 : 3000;
+
+    registerRoutes();
+    server.begin();
+    std::thread loop(serverLoop);
+
+    bool ok = true;
+    ok &= run("keep-alive 1", 1, false, false, ms);
+    ok &= run("keep-alive 4", 4, false, false, ms);
+    ok &= run("keep-alive 8", HTTP_MAX_CONN, false, false, ms);
+    ok &= run("new conn 4",   4, true,  false, ms);
+    ok &= run("mixed",        4, false, true,  ms);
+
+    stopLoop = true;
+    loop.join();
+
+    const HttpServerStats& st = server.stats();
+    printf("requests %u, reused %u, accepted %u, evicted %u, timeouts %u, "
+           "blocked sends %u, peak connections %u, slowest handler %u us\n",
+           st.requests, st.keepAlive, st.accepted, st.evicted, st.timeouts,
+           st.blockedSends, st.connMax, st.handlerMaxUs);
+    server.close();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+// Log benchmark: writer cost (LOGx in the calling task), disabled
+// levels, and the deferred formatting in the readers
+//
+//   ./bench_log            full run
+//   ./bench_log --quick    smoke run (ctest)
+#include "host_test.h"
+#include "py_log.h"
+#include "config.h"
+#include <Arduino.h>
+
+template <typename Fn>
+static void bench(const char* name, int iterations, Fn fn) {
+    size_t allocs = hostAllocCount();
+    uint64_t t0 = hostNowNs();
+    for (int i = 0; i < iterations; i++) fn(i);
+    uint64_t t1 = hostNowNs();
+    allocs = hostAllocCount() - allocs;
+
+    printf("%-28s %8.1f ns/call  %6.2f allocs/call\n",
+           name, (double)(t1 - t0) / iterations, (double)allocs / iterations);
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    int n = quick ? 2000 : 1000000;
+
+    config.logInfo  = true;
+    config.logDebug = false;
+
+    bench("LOGI 3 ints", n, [](int i) {
+        LOGI(LOGM_UART, "RX len=%u in %lu ms (first byte %lu ms)", (unsigned)i, 42ul, 7ul);
+    });
+    bench("LOGI string + float", n, [](int i) {
+        LOGI(LOGM_MQTT, "publish %s = %.3f", "pylon/stack/voltage", 50.376 + i);
+    });
+    bench("LOGD disabled", n, [](int i) {
+        LOGD(LOGM_UART, "RX len=%u", (unsigned)i);
+    });
+
+    String msg = "prebuilt message from a String";
+    bench("Log(String)", n, [&](int) { Log(LOG_INFO, msg); });
+
+    // reader: LOG_RING_SIZE records formatted per WebLogGet()
+    int r = quick ? 20 : 20000;
+    size_t allocs = hostAllocCount();
+    uint64_t t0 = hostNowNs();
+    size_t bytes = 0;
+    for (int i = 0; i < r; i++) bytes += WebLogGet().length();
+    uint64_t t1 = hostNowNs();
+    allocs = hostAllocCount() - allocs;
+
+    printf("%-28s %8.1f ns/record  %6.2f allocs/call  (%zu B per call)\n",
+           "WebLogGet (formatting)", (double)(t1 - t0) / ((double)r * LOG_RING_SIZE),
+           (double)allocs / r, bytes / r);
+    printf("dropped records: %u\n", LogDropped());
+    return 0;
+}
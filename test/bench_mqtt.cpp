@@ -0,0 +1,103 @@
+// MQTT transport benchmark: PubSubClient + MqttTransport against the
+// loopback broker (host_broker.h)
+//
+//   ./bench_mqtt            full run
+//   ./bench_mqtt --quick    smoke run (ctest)
+//
+// One "cycle" is what PyMqtt::loop() does per round: publish a burst
+// of value documents (each guarded by fits(), deferred ones are simply
+// dropped like superseded values), pump() the outbox, client.loop().
+// Reported: delivered messages/s, deferred share and the worst cycle
+// time - the figure that matters for the web server / WiFi manager in
+// the same task. "20 KB/s" throttles the broker's reads (weak WiFi),
+// "qos1" publishes through the in-flight window (offline replay).
+#include "host_test.h"
+#include "host_broker.h"
+#include "py_mqtt_transport.h"
+#include <PubSubClient.h>
+
+#define BURST        16          // documents per cycle (one BAT module: cells)
+#define DOC_BYTES    300
+
+static HostBroker    broker;
+static MqttTransport transport;
+static PubSubClient  client(transport);
+static char          doc[DOC_BYTES + 1];
+
+static bool cycle(bool qos1, uint32_t& published, uint32_t& deferred) {
+    for (int i = 0; i < BURST; i++) {
+        bool ok;
+        if (qos1) {
+            ok = transport.inflightFits(MqttTransport::publishSize("bench/r", DOC_BYTES, 1)) &&
+                 transport.beginQos1("bench/r", DOC_BYTES, false);
+            if (ok) {
+                client.write((const uint8_t*)doc, DOC_BYTES);
+                ok = transport.endQos1();
+            }
+        } else {
+            ok = transport.fits(MqttTransport::publishSize("bench/v", DOC_BYTES)) &&
+                 client.publish("bench/v", (const uint8_t*)doc, DOC_BYTES);
+        }
+        if (ok) published++;
+        else    deferred++;
+    }
+    transport.pump();
+    client.loop();
+    return client.connected();
+}
+
+static void run(const char* label, uint32_t readRate, bool qos1, uint32_t ms) {
+    broker.readRate = readRate;
+    broker.clear();
+
+    uint32_t published = 0, deferred = 0;
+    uint64_t worstNs = 0, cycles = 0;
+    uint64_t t0 = hostNowNs();
+    bool ok = true;
+
+    while (hostNowNs() - t0 < (uint64_t)ms * 1000000) {
+        uint64_t c0 = hostNowNs();
+        ok &= cycle(qos1, published, deferred);
+        uint64_t dt = hostNowNs() - c0;
+        if (dt > worstNs) worstNs = dt;
+        cycles++;
+    }
+
+    // let the broker take the rest, then count what arrived
+    uint64_t end = hostNowNs();
+    while ((transport.queued() > 0 || transport.inflight() > 0) && hostNowNs() - end < 5000000000ull) {
+        transport.pump();
+        client.loop();
+    }
+    double sec = (hostNowNs() - t0) / 1e9;
+    ok &= broker.waitMessages(published, 5000);
+
+    printf("%-10s %8.0f msg/s  %6.1f %% deferred  cycle avg %7.1f us  worst %7.1f us  %s\n",
+           label, broker.messageCount() / sec,
+           published + deferred ? deferred * 100.0 / (published + deferred) : 0.0,
+           (double)(end - t0) / cycles / 1000.0, worstNs / 1000.0,
+           ok && broker.messageCount() == published ? "ok" : "FAIL");
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    uint32_t ms = quick ? 100 : 2000;
+
+    memset(doc, 'x', DOC_BYTES);
+
+    client.setServer("127.0.0.1", broker.port());
+    client.setBufferSize(2048);
+    if (!client.connect("bench")) {
+        printf("connect failed\n");
+        return 1;
+    }
+
+    run("loopback", 0,     false, ms);
+    run("20 KB/s",  20000, false, ms);
+    run("qos1",     0,     true,  ms);
+
+    const MqttTransportStats& st = transport.stats();
+    printf("outbox max %u bytes, would-block %u, errors %u, pump worst %u us\n",
+           st.queuedMax, st.wouldBlock, st.errors, st.pumpMaxUs);
+    return st.errors ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+// Parser benchmark: ns and heap allocations per frame
+//
+//   ./bench_parsers            full run
+//   ./bench_parsers --quick    smoke run (ctest)
+//
+// Host numbers - the ESP32 is roughly 20-40x slower - but good enough
+// to compare two parser versions on the same machine.
+#include "host_test.h"
+#include "py_parser_pwr.h"
+#include "py_parser_bat.h"
+#include "py_parser_stat.h"
+
+static PwrBuffer  pwr;
+static BatBuffer  bat;
+static StatBuffer stat;
+
+template <typename Fn>
+static void bench(const char* name, const std::string& frame, int iterations, Fn parse) {
+    FrameView v(frame.data(), frame.size());
+
+    // warm-up (schema / header caches)
+    for (int i = 0; i < 10; i++) parse(v);
+
+    size_t allocs = hostAllocCount();
+    uint64_t t0 = hostNowNs();
+    int ok = 0;
+    for (int i = 0; i < iterations; i++) ok += parse(v) == PARSE_OK;
+    uint64_t t1 = hostNowNs();
+    allocs = hostAllocCount() - allocs;
+
+    double ns = (double)(t1 - t0) / iterations;
+    printf("%-20s %6zu B  %10.0f ns/frame  %8.1f MB/s  %5.2f allocs/frame  %s\n",
+           name, frame.size(), ns, frame.size() / ns * 1000.0,
+           (double)allocs / iterations, ok == iterations ? "ok" : "FAIL");
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    int n = quick ? 200 : 20000;
+
+    std::string p  = corpusFrame("pwr.txt");
+    std::string b  = corpusFrame("bat_1.txt");
+    std::string bp = corpusFrame("bat_2_paged.txt");
+    std::string s  = corpusFrame("stat_1.txt");
+    std::string t  = corpusFrame("pwr_truncated.txt");
+
+    printf("%d iterations per frame\n", n);
+    bench("pwr",            p,  n, [](FrameView v) { return parsePwrFrame(v, pwr); });
+    bench("bat 1",          b,  n, [](FrameView v) { return parseBatFrame(1, v, bat); });
+    bench("bat 2 (paged)",  bp, n, [](FrameView v) { return parseBatFrame(2, v, bat); });
+    bench("stat 1",         s,  n, [](FrameView v) { return parseStatFrame(1, v, stat.stat); });
+    bench("pwr truncated",  t,  n, [](FrameView v) {
+        // expected to fail: reported as ok when rejected
+        return parsePwrFrame(v, pwr) == PARSE_FAIL ? PARSE_OK : PARSE_FAIL;
+    });
+    return 0;
+}
@@ -0,0 +1,75 @@
+// RX path benchmark: PyUart::sendCommand() + processFrame() against the
+// replayed console (host_console.h)
+//
+//   ./bench_uart            full run
+//   ./bench_uart --quick    smoke run (ctest)
+//
+// "unthrottled" measures the firmware side only (callback, tail scan,
+// semaphore handoff, queue, parse). "115200" replays with line timing
+// and shows how close a command gets to the pure transfer time.
+// Pacing gaps cost nothing here (delay() advances the host clock);
+// allocs/cmd includes the console thread (response copy, command line).
+#include "host_test.h"
+#include "host_console.h"
+#include "py_uart.h"
+#include "py_pipeline.h"
+#include "config.h"
+
+static PyUart uart;
+
+static const char* const COMMANDS[] = { "pwr", "bat 1", "stat 1" };
+
+static void run(HostConsole& console, const char* label, int rounds) {
+    size_t allocs = hostAllocCount();
+    uint64_t bytes0 = console.bytesSent;
+    uint64_t t0 = hostNowNs();
+    int ok = 0, n = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        for (const char* cmd : COMMANDS) {
+            n++;
+            if (!uart.sendCommand(cmd)) continue;
+
+            FrameDesc d;
+            if (xQueueReceive(frameQueue, &d, 0) != pdTRUE) continue;
+            ok += processFrame(d) == PARSE_OK;
+            frameStore.release(d.slot);
+        }
+    }
+
+    uint64_t ns = hostNowNs() - t0;
+    uint64_t bytes = console.bytesSent - bytes0;
+    allocs = hostAllocCount() - allocs;
+
+    double lineNs = console.byteNs ? (double)bytes * console.byteNs / n : 0;
+    printf("%-12s %5d cmds  %10.0f ns/cmd  %6.2f allocs/cmd", label, n, (double)ns / n,
+           (double)allocs / n);
+    if (lineNs > 0)
+        printf("  line %8.0f ns/cmd  overhead %5.1f %%", lineNs, ((double)ns / n - lineNs) * 100.0 / lineNs);
+    printf("  %s\n", ok == n ? "ok" : "FAIL");
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+    HostConsole console(Serial2);
+    console.respond("pwr",    corpusFrame("pwr.txt"));
+    console.respond("bat 1",  corpusFrame("bat_1.txt"));
+    console.respond("stat 1", corpusFrame("stat_1.txt"));
+
+    frameQueue = xQueueCreate(FRAME_QUEUE_LEN, sizeof(FrameDesc));
+    uart.begin(16, 17);
+    console.waitIdle();
+    while (Serial2.available()) Serial2.read();
+
+    // parser logging off like a production config
+    config.logInfo = false;
+
+    console.chunk = 64;
+    run(console, "unthrottled", quick ? 20 : 2000);
+
+    console.chunk = 120;            // ESP32 UART FIFO full threshold
+    console.byteNs = 86806;         // 10 bits at 115200 baud
+    run(console, "115200", quick ? 1 : 5);
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include "host_broker.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+
+// small receive window → backpressure shows up after a few KB
+#define BROKER_RCVBUF  4096
+
+HostBroker::HostBroker() {
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+
+    int one = 1, rcv = BROKER_RCVBUF;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listenFd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ::bind(listenFd, (sockaddr*)&addr, sizeof(addr));
+    ::listen(listenFd, 1);
+
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr*)&addr, &len);
+    listenPort = ntohs(addr.sin_port);
+
+    worker = std::thread([this] { run(); });
+}
+
+HostBroker::~HostBroker() {
+    stop = true;
+    worker.join();
+    ::close(listenFd);
+}
+
+bool HostBroker::waitMessages(size_t n, uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(mu);
+    return cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                       [&] { return received.size() >= n; });
+}
+
+std::vector<BrokerMessage> HostBroker::messages() {
+    std::lock_guard<std::mutex> lock(mu);
+    return received;
+}
+
+size_t HostBroker::messageCount() {
+    std::lock_guard<std::mutex> lock(mu);
+    return received.size();
+}
+
+void HostBroker::clear() {
+    std::lock_guard<std::mutex> lock(mu);
+    received.clear();
+}
+
+void HostBroker::ackPending() {
+    std::lock_guard<std::mutex> lock(mu);
+    flushAcks = true;
+}
+
+void HostBroker::dropClient() {
+    std::unique_lock<std::mutex> lock(mu);
+    drop = true;
+    cv.wait_for(lock, std::chrono::milliseconds(1000), [&] { return clientFd < 0; });
+}
+
+bool HostBroker::clientConnected() {
+    std::lock_guard<std::mutex> lock(mu);
+    return clientFd >= 0;
+}
+
+// ---------------------------------------------------------
+// Broker thread
+// ---------------------------------------------------------
+void HostBroker::run() {
+    while (!stop) {
+        pollfd p = { listenFd, POLLIN, 0 };
+        if (poll(&p, 1, 10) <= 0) continue;
+
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            clientFd = fd;
+            drop = false;
+            withheld.clear();
+        }
+
+        serve(fd);
+
+        ::close(fd);
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            clientFd = -1;
+        }
+        cv.notify_all();
+    }
+}
+
+void HostBroker::serve(int fd) {
+    std::vector<uint8_t> in;
+    uint8_t buf[4096];
+    auto tick = std::chrono::steady_clock::now();
+
+    while (!stop) {
+        std::vector<uint16_t> acksNow;
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (drop) return;
+            if (flushAcks) {
+                acksNow.swap(withheld);
+                flushAcks = false;
+            }
+        }
+        for (uint16_t id : acksNow) {
+            uint8_t ack[4] = { 0x40, 0x02, (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+            sendAll(fd, ack, sizeof(ack));
+        }
+
+        if (paused) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        // read budget per 1 ms tick at readRate
+        size_t want = sizeof(buf);
+        uint32_t rate = readRate;
+        if (rate) {
+            auto now = std::chrono::steady_clock::now();
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - tick).count();
+            if (us < 1000) {
+                std::this_thread::sleep_for(std::chrono::microseconds(1000 - us));
+                continue;
+            }
+            tick = now;
+            want = std::min(want, (size_t)std::max<uint64_t>(1, (uint64_t)rate * us / 1000000));
+        }
+
+        pollfd p = { fd, POLLIN, 0 };
+        if (poll(&p, 1, 1) <= 0) continue;
+
+        ssize_t n = ::recv(fd, buf, want, 0);
+        if (n <= 0) return;                      // client closed
+        bytesIn += n;
+        in.insert(in.end(), buf, buf + n);
+
+        // complete packets: type | remaining length (varint) | body
+        size_t pos = 0;
+        for (;;) {
+            size_t p2 = pos + 1;
+            uint32_t len = 0, shift = 0;
+            bool complete = false;
+            while (p2 < in.size()) {
+                uint8_t b = in[p2++];
+                len |= (uint32_t)(b & 0x7F) << shift;
+                shift += 7;
+                if (!(b & 0x80)) { complete = true; break; }
+            }
+            if (!complete || p2 + len > in.size()) break;
+
+            if (!handle(fd, in[pos], in.data() + p2, len)) return;
+            pos = p2 + len;
+        }
+        in.erase(in.begin(), in.begin() + pos);
+    }
+}
+
+bool HostBroker::handle(int fd, uint8_t type, const uint8_t* body, size_t len) {
+    switch (type & 0xF0) {
+        case 0x10: {                                    // CONNECT
+            connects++;
+            static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+            sendAll(fd, connack, sizeof(connack));
+            return true;
+        }
+
+        case 0x80: {                                    // SUBSCRIBE
+            uint8_t suback[] = { 0x90, 0x03, body[0], body[1], 0x00 };
+            sendAll(fd, suback, sizeof(suback));
+            return true;
+        }
+
+        case 0x30: {                                    // PUBLISH
+            BrokerMessage m;
+            m.qos      = (type >> 1) & 0x03;
+            m.dup      = (type & 0x08) != 0;
+            m.retained = (type & 0x01) != 0;
+            m.id       = 0;
+
+            size_t tl = ((size_t)body[0] << 8) | body[1];
+            size_t p = 2 + tl;
+            m.topic.assign((const char*)body + 2, tl);
+            if (m.qos > 0) {
+                m.id = ((uint16_t)body[p] << 8) | body[p + 1];
+                p += 2;
+            }
+            m.payload.assign((const char*)body + p, len - p);
+
+            if (m.qos == 1) {
+                if (acks) {
+                    uint8_t ack[4] = { 0x40, 0x02, (uint8_t)(m.id >> 8), (uint8_t)(m.id & 0xFF) };
+                    sendAll(fd, ack, sizeof(ack));
+                } else {
+                    std::lock_guard<std::mutex> lock(mu);
+                    withheld.push_back(m.id);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                received.push_back(std::move(m));
+            }
+            cv.notify_all();
+            return true;
+        }
+
+        case 0xC0: {                                    // PINGREQ
+            static const uint8_t pong[] = { 0xD0, 0x00 };
+            sendAll(fd, pong, sizeof(pong));
+            return true;
+        }
+
+        case 0xE0:                                      // DISCONNECT
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+void HostBroker::sendAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        data += n;
+        len -= n;
+    }
+}
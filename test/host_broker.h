@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------
+// Loopback stand-in for an MQTT broker (MQTT 3.1.1 subset)
+// ---------------------------------------------------------
+// Listens on 127.0.0.1 (port() = ephemeral port) and serves one
+// client at a time from its own thread: CONNECT → CONNACK,
+// SUBSCRIBE → SUBACK, PINGREQ → PINGRESP, PUBLISH is recorded and
+// QoS 1 acknowledged. The firmware talks to it through the real
+// MqttTransport / PubSubClient / WiFiClient shim (a TCP socket).
+//
+// Knobs for the backpressure paths:
+//   paused        stop reading: the TCP window closes, writes see EAGAIN
+//   readRate      bytes per second the broker reads (0 = unlimited)
+//   acks          false: PUBACKs are withheld (ackPending() sends them)
+//   dropClient()  closes the connection like a broker restart
+//
+//   HostBroker broker;
+//   mqtt.setServer("127.0.0.1", broker.port());
+//   broker.waitMessages(10);
+// ---------------------------------------------------------
+
+struct BrokerMessage {
+    std::string topic;
+    std::string payload;
+    uint8_t     qos;
+    bool        dup;
+    bool        retained;
+    uint16_t    id;
+};
+
+class HostBroker {
+public:
+    HostBroker();
+    ~HostBroker();
+
+    uint16_t port() const { return listenPort; }
+
+    // Blocks until n messages arrived (false after timeoutMs)
+    bool waitMessages(size_t n, uint32_t timeoutMs = 2000);
+    std::vector<BrokerMessage> messages();
+    size_t messageCount();
+    void clear();
+
+    void ackPending();           // send the withheld PUBACKs
+    void dropClient();
+    bool clientConnected();
+
+    std::atomic<bool>     paused{false};
+    std::atomic<uint32_t> readRate{0};
+    std::atomic<bool>     acks{true};
+
+    // Statistics
+    std::atomic<uint32_t> connects{0};
+    std::atomic<uint64_t> bytesIn{0};
+
+private:
+    void run();
+    void serve(int fd);
+    bool handle(int fd, uint8_t type, const uint8_t* body, size_t len);
+    void sendAll(int fd, const uint8_t* data, size_t len);
+
+    int listenFd = -1;
+    uint16_t listenPort = 0;
+
+    std::mutex mu;
+    std::condition_variable cv;
+    std::vector<BrokerMessage> received;
+    std::vector<uint16_t> withheld;
+    int  clientFd = -1;
+    bool drop = false;
+    bool flushAcks = false;
+    std::atomic<bool> stop{false};
+
+    std::thread worker;
+};
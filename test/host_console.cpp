@@ -0,0 +1,123 @@
+#include "host_console.h"
+#include <chrono>
+
+static const char* const PAGE_PROMPT = "Press [Enter] to be continued";
+static const char* const SILENT = "\x01silent";
+
+HostConsole::HostConsole(HardwareSerial& s) : serial(s) {
+    serial.onHostTx = [this](const uint8_t* data, size_t n) { onTx(data, n); };
+    worker = std::thread([this] { run(); });
+}
+
+HostConsole::~HostConsole() {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+    serial.hostReset();
+}
+
+void HostConsole::respond(const std::string& cmd, const std::string& response) {
+    std::lock_guard<std::mutex> lock(mu);
+    responses[cmd] = response;
+}
+
+void HostConsole::silence(const std::string& cmd) {
+    respond(cmd, SILENT);
+}
+
+void HostConsole::waitIdle() {
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [this] { return !haveCmd && !busy; });
+}
+
+// Firmware → console (runs in the writing thread, never blocks)
+void HostConsole::onTx(const uint8_t* data, size_t n) {
+    if (serial.baud() != 115200) return;
+
+    std::lock_guard<std::mutex> lock(mu);
+    for (size_t i = 0; i < n; i++) {
+        char c = (char)data[i];
+
+        if (c == '\r') {
+            if (paused) {
+                paused = false;
+                enters++;
+            }
+            continue;
+        }
+        if (c == '\n') {
+            pendingCmd = line;
+            line.clear();
+            haveCmd = true;
+            continue;
+        }
+        if ((unsigned char)c >= 0x20) line += c;
+    }
+    cv.notify_all();
+}
+
+// Chunks with the line timing; stops at the paging prompt until <Enter>
+void HostConsole::send(const std::string& text) {
+    size_t pos = 0;
+    size_t page = text.find(PAGE_PROMPT);
+    if (page != std::string::npos) page += strlen(PAGE_PROMPT);
+
+    while (pos < text.size()) {
+        size_t end = std::min(text.size(), pos + chunk);
+        if (page != std::string::npos && pos < page && end > page) end = page;
+
+        if (byteNs)
+            std::this_thread::sleep_for(std::chrono::nanoseconds((uint64_t)byteNs * (end - pos)));
+
+        if (end == page) {
+            std::lock_guard<std::mutex> lock(mu);
+            paused = true;
+        }
+
+        serial.hostInject(text.data() + pos, end - pos);
+        bytesSent += end - pos;
+        pos = end;
+
+        if (pos == page) {
+            std::unique_lock<std::mutex> lock(mu);
+            cv.wait(lock, [this] { return !paused || stop; });
+            if (stop) return;
+        }
+    }
+}
+
+void HostConsole::run() {
+    for (;;) {
+        std::string cmd, text;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            cv.wait(lock, [this] { return haveCmd || stop; });
+            if (stop) return;
+
+            cmd = pendingCmd;
+            haveCmd = false;
+            busy = true;
+            commands++;
+            lastCommand = cmd;
+
+            auto it = responses.find(cmd);
+            if (it != responses.end()) text = it->second;
+            else                       text = cmd + "\r\n\r\npylon>";   // echo + prompt
+        }
+
+        if (text != SILENT) {
+            if (firstByteUs)
+                std::this_thread::sleep_for(std::chrono::microseconds(firstByteUs));
+            send(text);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            busy = false;
+        }
+        cv.notify_all();
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <HardwareSerial.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ---------------------------------------------------------
+// Replay stand-in for the Pylontech console on Serial2
+// ---------------------------------------------------------
+// Receives what the firmware writes, and answers every command line
+// ("pwr\n", "bat 1\n", ...) with the recorded response from its own
+// thread, in chunks through Serial2.hostInject() - so the firmware's
+// onReceive() callback runs concurrently with the waiting realtime
+// code, like with the UART event task on the ESP32.
+//
+// Paging: the response stops after "Press [Enter] to be continued"
+// until the firmware sends "\r" (enters counts them).
+// Bytes written at another baud rate than 115200 are ignored (the
+// 1200 baud wake-up string), unknown commands get an empty prompt.
+//
+//   HostConsole console(Serial2);
+//   console.respond("pwr", corpusFrame("pwr.txt"));
+//   console.chunk = 64;  console.byteNs = 86800;   // 115200 baud
+// ---------------------------------------------------------
+
+class HostConsole {
+public:
+    explicit HostConsole(HardwareSerial& serial);
+    ~HostConsole();
+
+    void respond(const std::string& cmd, const std::string& response);
+    void silence(const std::string& cmd);          // no answer at all
+
+    // Blocks until all pending responses are delivered
+    void waitIdle();
+
+    // Timing of the simulated line
+    size_t   chunk = 64;         // bytes per hostInject() (driver FIFO/idle event)
+    uint32_t byteNs = 0;         // line time per byte, 0 = as fast as possible
+    uint32_t firstByteUs = 0;    // echo latency after the command
+
+    // Statistics
+    uint32_t commands = 0;
+    uint32_t enters = 0;
+    uint64_t bytesSent = 0;
+    std::string lastCommand;
+
+private:
+    void onTx(const uint8_t* data, size_t n);
+    void run();
+    void send(const std::string& text);
+
+    HardwareSerial& serial;
+
+    std::mutex mu;
+    std::condition_variable cv;
+    std::map<std::string, std::string> responses;
+    std::string line;            // command being received
+    std::string pendingCmd;
+    bool haveCmd = false;
+    bool paused = false;         // waiting for <Enter>
+    bool busy = false;
+    bool stop = false;
+
+    std::thread worker;
+};
@@ -0,0 +1,149 @@
+#include "host_http.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+
+static uint32_t nowMs() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool HostHttpClient::open(uint16_t port, int recvBuffer) {
+    close();
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (recvBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &recvBuffer, sizeof(recvBuffer));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close();
+        return false;
+    }
+    in.clear();
+    eof = false;
+    return true;
+}
+
+void HostHttpClient::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool HostHttpClient::write(const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = ::send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += n;
+    }
+    return true;
+}
+
+bool HostHttpClient::fill(uint32_t deadlineMs) {
+    if (eof) return false;
+
+    int32_t left = (int32_t)(deadlineMs - nowMs());
+    if (left <= 0) return false;
+
+    pollfd p = { fd, POLLIN, 0 };
+    if (poll(&p, 1, left) <= 0) return false;
+
+    char buf[16384];
+    ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+        eof = true;
+        return false;
+    }
+    in.append(buf, n);
+    return true;
+}
+
+bool HostHttpClient::readLine(std::string& line, uint32_t deadlineMs) {
+    for (;;) {
+        size_t e = in.find("\r\n");
+        if (e != std::string::npos) {
+            line = in.substr(0, e);
+            in.erase(0, e + 2);
+            return true;
+        }
+        if (!fill(deadlineMs)) return false;
+    }
+}
+
+bool HostHttpClient::readBytes(size_t n, std::string& out, uint32_t deadlineMs) {
+    while (in.size() < n)
+        if (!fill(deadlineMs)) return false;
+    out.append(in, 0, n);
+    in.erase(0, n);
+    return true;
+}
+
+bool HostHttpClient::read(HostHttpResponse& r, uint32_t timeoutMs) {
+    uint32_t deadline = nowMs() + timeoutMs;
+    r = HostHttpResponse();
+
+    std::string line;
+    if (!readLine(line, deadline)) return false;
+    if (line.compare(0, 5, "HTTP/") != 0 || line.size() < 12) return false;
+    r.code = atoi(line.c_str() + 9);
+
+    for (;;) {
+        if (!readLine(line, deadline)) return false;
+        if (line.empty()) break;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        for (auto& ch : name) ch = (char)tolower(ch);
+        size_t v = line.find_first_not_of(' ', colon + 1);
+        r.headers[name] = v == std::string::npos ? "" : line.substr(v);
+    }
+
+    if (r.header("transfer-encoding") == "chunked") {
+        for (;;) {
+            if (!readLine(line, deadline)) return false;
+            size_t len = strtoul(line.c_str(), nullptr, 16);
+            if (len == 0) return readLine(line, deadline);      // trailing CRLF
+            if (!readBytes(len, r.body, deadline)) return false;
+            if (!readLine(line, deadline)) return false;
+        }
+    }
+
+    std::string cl = r.header("content-length");
+    if (!cl.empty()) return readBytes(strtoul(cl.c_str(), nullptr, 10), r.body, deadline);
+
+    // neither: body up to the close
+    while (fill(deadline)) {}
+    r.body += in;
+    in.clear();
+    return eof;
+}
+
+bool HostHttpClient::closedByPeer(uint32_t timeoutMs) {
+    uint32_t deadline = nowMs() + timeoutMs;
+    while (fill(deadline)) {}
+    return eof;
+}
+
+std::string hostHttpGet(const std::string& path, bool close) {
+    return "GET " + path + " HTTP/1.1\r\nHost: host-test\r\n" +
+           (close ? "Connection: close\r\n" : "") + "\r\n";
+}
+
+std::string hostHttpPost(const std::string& path, const std::string& type,
+                         const std::string& body, bool close) {
+    return "POST " + path + " HTTP/1.1\r\nHost: host-test\r\n" +
+           "Content-Type: " + type + "\r\n" +
+           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+           (close ? "Connection: close\r\n" : "") + "\r\n" + body;
+}
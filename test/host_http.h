@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <string>
+
+// ---------------------------------------------------------
+// Minimal HTTP/1.1 client for the server tests and the load
+// generator (blocking POSIX socket to 127.0.0.1)
+// ---------------------------------------------------------
+// One connection, requests one after the other (keep-alive) or
+// several written at once (pipelining, read() per response).
+// Bodies with Content-Length, chunked or up to the close.
+//
+//   HostHttpClient c;
+//   c.open(server.port());
+//   HostHttpResponse r;
+//   c.request("GET /api/x HTTP/1.1\r\nHost: t\r\n\r\n", r);
+// ---------------------------------------------------------
+
+struct HostHttpResponse {
+    int code = 0;
+    std::map<std::string, std::string> headers;     // lower-case names
+    std::string body;
+
+    std::string header(const char* name) const {
+        auto it = headers.find(name);
+        return it == headers.end() ? std::string() : it->second;
+    }
+};
+
+class HostHttpClient {
+public:
+    ~HostHttpClient() { close(); }
+
+    bool open(uint16_t port, int recvBuffer = 0);     // recvBuffer: SO_RCVBUF (small window)
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    bool write(const std::string& data);
+    bool read(HostHttpResponse& r, uint32_t timeoutMs = 2000);
+    bool request(const std::string& raw, HostHttpResponse& r, uint32_t timeoutMs = 2000) {
+        return write(raw) && read(r, timeoutMs);
+    }
+
+    // peer closed (recv = 0) within timeoutMs
+    bool closedByPeer(uint32_t timeoutMs = 2000);
+
+    int fd = -1;
+
+private:
+    bool fill(uint32_t deadlineMs);
+    bool readLine(std::string& line, uint32_t deadlineMs);
+    bool readBytes(size_t n, std::string& out, uint32_t deadlineMs);
+
+    std::string in;
+    bool eof = false;
+};
+
+// Raw GET / POST requests (keep-alive unless close)
+std::string hostHttpGet(const std::string& path, bool close = false);
+std::string hostHttpPost(const std::string& path, const std::string& type,
+                         const std::string& body, bool close = false);
@@ -0,0 +1,62 @@
+#include "host_test.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+
+int hostTestFailures = 0;
+
+HostTest* hostTests = nullptr;
+static HostTest* g_testsTail = nullptr;
+
+HostTest::HostTest(const char* n, void (*f)()) : name(n), fn(f), next(nullptr) {
+    // registration order = file order
+    if (g_testsTail) g_testsTail->next = this;
+    else             hostTests = this;
+    g_testsTail = this;
+}
+
+// ---------------------------------------------------------
+// Corpus
+// ---------------------------------------------------------
+std::string corpusFrame(const char* name) {
+    std::string path = std::string(CORPUS_DIR) + "/" + name;
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        fprintf(stderr, "corpus file missing: %s\n", path.c_str());
+        exit(2);
+    }
+
+    std::string out;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\r') continue;            // checkout may have CRLF already
+        if (c == '\n') out += '\r';
+        out += (char)c;
+    }
+    fclose(f);
+    return out;
+}
+
+// ---------------------------------------------------------
+// Allocation counter
+// ---------------------------------------------------------
+static std::atomic<size_t> g_allocs{0};
+
+size_t hostAllocCount() { return g_allocs.load(std::memory_order_relaxed); }
+
+void* operator new(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void  operator delete(void* p) noexcept { free(p); }
+void  operator delete[](void* p) noexcept { free(p); }
+void  operator delete(void* p, size_t) noexcept { free(p); }
+void  operator delete[](void* p, size_t) noexcept { free(p); }
+
+uint64_t hostNowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
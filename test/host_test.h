@@ -0,0 +1,81 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------
+// Minimal test runner (host build, see CMakeLists.txt)
+// ---------------------------------------------------------
+//   TEST(pwr_parses_modules) {
+//       CHECK(r == PARSE_OK);
+//       CHECK_EQ(buf.moduleCount, 3);
+//   }
+//
+// Test executables link test_main.cpp: runs all TESTs,
+// or only those whose name contains argv[1]. Exit code = failures.
+// ---------------------------------------------------------
+
+struct HostTest {
+    const char* name;
+    void (*fn)();
+    HostTest* next;
+
+    HostTest(const char* n, void (*f)());
+};
+
+extern int hostTestFailures;
+extern HostTest* hostTests;     // registration order
+
+#define TEST(name)                                              \
+    static void test_##name();                                  \
+    static HostTest hostTest_##name(#name, test_##name);        \
+    static void test_##name()
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "  %s:%d: CHECK(%s) failed\n",                  \
+                    __FILE__, __LINE__, #cond);                             \
+            hostTestFailures++;                                             \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                      \
+    do {                                                                    \
+        long long va_ = (long long)(a), vb_ = (long long)(b);               \
+        if (va_ != vb_) {                                                   \
+            fprintf(stderr, "  %s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                    __FILE__, __LINE__, #a, #b, va_, vb_);                  \
+            hostTestFailures++;                                             \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_STR(a, b)                                                     \
+    do {                                                                    \
+        const char* sa_ = (a);                                              \
+        const char* sb_ = (b);                                              \
+        if (strcmp(sa_, sb_) != 0) {                                        \
+            fprintf(stderr, "  %s:%d: CHECK_STR(%s, %s) failed: \"%s\" != \"%s\"\n", \
+                    __FILE__, __LINE__, #a, #b, sa_, sb_);                  \
+            hostTestFailures++;                                             \
+        }                                                                   \
+    } while (0)
+
+// ---------------------------------------------------------
+// Recorded console frames (test/corpus)
+// ---------------------------------------------------------
+// Stored with plain \n; returned with the console's \r\n line ends.
+std::string corpusFrame(const char* name);
+
+// ---------------------------------------------------------
+// Heap allocations since start (global operator new replacement in
+// host_test.cpp; String, std containers), for the "no allocation"
+// checks and the per-frame numbers of the benchmarks
+// ---------------------------------------------------------
+size_t hostAllocCount();
+
+// Nanoseconds of a monotonic clock (benchmarks)
+uint64_t hostNowNs();
@@ -0,0 +1,87 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+// ---------------------------------------------------------
+// Host shim: Arduino-ESP32 core
+// ---------------------------------------------------------
+// Just enough of the core to build the firmware modules under test
+// (test/CMakeLists.txt) on Linux. Not a simulator: no WiFi, no flash.
+//
+// Time: millis() runs with the host clock. delay() / vTaskDelay() do
+// not sleep, they advance millis() by the requested time and yield -
+// pacing gaps and wake-up waits cost nothing in a test, timeouts
+// measured with millis() still behave.
+// ---------------------------------------------------------
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+using std::min;
+using std::max;
+
+#define PROGMEM
+#define pgm_read_byte_near(p) (*(const uint8_t*)(p))
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// host only: advance millis() without sleeping
+void hostClockAdvance(uint32_t ms);
+
+// host only: runs once inside the next millis() call (then cleared) -
+// lets a test "preempt" firmware code at a known point
+extern void (*hostMillisHook)();
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char* dst, const char* src, size_t cap) {
+    size_t n = strlen(src);
+    if (cap) {
+        size_t c = n < cap - 1 ? n : cap - 1;
+        memcpy(dst, src, c);
+        dst[c] = '\0';
+    }
+    return n;
+}
+#endif
+
+uint32_t esp_random();
+
+inline bool  psramFound() { return false; }
+inline void* ps_malloc(size_t) { return nullptr; }
+
+class EspClass {
+public:
+    uint64_t getEfuseMac() { return 0x0000a1b2c3d4e5f6ULL; }
+    uint32_t getFreeHeap() { return 200 * 1024; }
+    uint32_t getMinFreeHeap() { return 150 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getMaxAllocHeap() { return 110 * 1024; }
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    const char* getChipModel() { return "host"; }
+    const char* getSdkVersion() { return "host"; }
+    [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
@@ -0,0 +1,67 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <mutex>
+#include "Print.h"
+
+// ---------------------------------------------------------
+// Host shim: HardwareSerial
+// ---------------------------------------------------------
+// Serial  → stdout (LogPump)
+// Serial2 → nothing by default. A test attaches the device side:
+//   onHostTx     gets every byte the firmware writes
+//   hostInject() puts bytes into the RX buffer and runs the
+//                onReceive() callback like the UART event task does
+//                (in the injecting thread)
+// ---------------------------------------------------------
+
+#define SERIAL_8N1 0x800001c
+
+typedef std::function<void(void)> OnReceiveCb;
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(bool console = false) : console(console) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1,
+               int8_t rxPin = -1, int8_t txPin = -1) {
+        (void)config; (void)rxPin; (void)txPin;
+        baudRate = baud;
+    }
+    void end() {}
+    void setRxBufferSize(size_t n) { rxCap = n; }
+    void onReceive(OnReceiveCb cb, bool onlyOnTimeout = false) {
+        (void)onlyOnTimeout;
+        std::lock_guard<std::mutex> lock(mu);
+        callback = cb;
+    }
+    unsigned long baud() const { return baudRate; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buf, size_t n);
+    size_t read(char* buf, size_t n) { return read((uint8_t*)buf, n); }
+
+    using Print::write;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t n) override;
+    void flush() override {}
+
+    // device side (tests)
+    std::function<void(const uint8_t*, size_t)> onHostTx;
+    size_t hostInject(const char* data, size_t n);
+    void   hostReset();
+
+private:
+    bool console;
+    unsigned long baudRate = 0;
+    size_t rxCap = 256;
+
+    std::mutex mu;
+    std::deque<uint8_t> rx;
+    OnReceiveCb callback;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial2;
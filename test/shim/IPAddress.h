@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include "WString.h"
+
+// ---------------------------------------------------------
+// Host shim: IPAddress (IPv4 only)
+// ---------------------------------------------------------
+
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr{a, b, c, d} {}
+
+    uint8_t operator[](int i) const { return addr[i]; }
+    operator uint32_t() const {
+        return addr[0] | (addr[1] << 8) | (addr[2] << 16) | ((uint32_t)addr[3] << 24);
+    }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+        return String(buf);
+    }
+
+private:
+    uint8_t addr[4] = {0, 0, 0, 0};
+};
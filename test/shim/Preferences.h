@@ -0,0 +1,62 @@
+#pragma once
+#include <string.h>
+#include <map>
+#include <string>
+#include "WString.h"
+
+// ---------------------------------------------------------
+// Host shim: Preferences (NVS) in RAM
+// ---------------------------------------------------------
+// One process-wide store, namespaces like on the device. Values are
+// kept as bytes, so put/get of different types under one key behave
+// like a type mismatch on the device only loosely (not checked).
+// ---------------------------------------------------------
+
+class Preferences {
+public:
+    bool begin(const char* ns, bool readOnly = false);
+    void end() { open = false; }
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool v)            { return putRaw(key, &v, sizeof(v)); }
+    size_t putUChar(const char* key, uint8_t v)        { return putRaw(key, &v, sizeof(v)); }
+    size_t putUShort(const char* key, uint16_t v)      { return putRaw(key, &v, sizeof(v)); }
+    size_t putInt(const char* key, int32_t v)          { return putRaw(key, &v, sizeof(v)); }
+    size_t putUInt(const char* key, uint32_t v)        { return putRaw(key, &v, sizeof(v)); }
+    size_t putULong(const char* key, uint32_t v)       { return putRaw(key, &v, sizeof(v)); }
+    size_t putFloat(const char* key, float v)          { return putRaw(key, &v, sizeof(v)); }
+    size_t putString(const char* key, const char* v)   { return putRaw(key, v, strlen(v)); }
+    size_t putString(const char* key, const String& v) { return putRaw(key, v.c_str(), v.length()); }
+    size_t putBytes(const char* key, const void* v, size_t n) { return putRaw(key, v, n); }
+
+    bool     getBool(const char* key, bool def = false)         { return getNum(key, def); }
+    uint8_t  getUChar(const char* key, uint8_t def = 0)         { return getNum(key, def); }
+    uint16_t getUShort(const char* key, uint16_t def = 0)       { return getNum(key, def); }
+    int32_t  getInt(const char* key, int32_t def = 0)           { return getNum(key, def); }
+    uint32_t getUInt(const char* key, uint32_t def = 0)         { return getNum(key, def); }
+    uint32_t getULong(const char* key, uint32_t def = 0)        { return getNum(key, def); }
+    float    getFloat(const char* key, float def = 0)           { return getNum(key, def); }
+    String   getString(const char* key, const String& def = String());
+    size_t   getBytesLength(const char* key);
+    size_t   getBytes(const char* key, void* buf, size_t cap);
+
+private:
+    size_t putRaw(const char* key, const void* v, size_t n);
+    const std::string* find(const char* key);
+
+    template <typename T>
+    T getNum(const char* key, T def) {
+        const std::string* v = find(key);
+        if (!v || v->size() != sizeof(T)) return def;
+        T r;
+        memcpy(&r, v->data(), sizeof(T));
+        return r;
+    }
+
+    std::string space;
+    bool open = false;
+    bool readOnly = false;
+};
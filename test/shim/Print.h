@@ -0,0 +1,72 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "WString.h"
+
+// ---------------------------------------------------------
+// Host shim: Print / Stream
+// ---------------------------------------------------------
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buf, size_t n) {
+        size_t r = 0;
+        for (size_t i = 0; i < n; i++) r += write(buf[i]);
+        return r;
+    }
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+
+    virtual void flush() {}
+
+    size_t print(const char* s)    { return write(s); }
+    size_t print(const String& s)  { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(char c)           { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC)           { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned v, int base = DEC)      { return print(String(v, (unsigned char)base)); }
+    size_t print(long v, int base = DEC)          { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(long long v, int base = DEC)     { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(double v, int decimals = 2)      { return print(String(v, (unsigned)decimals)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template <typename T>
+    size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeout = ms; }
+
+    size_t readBytes(uint8_t* buf, size_t n) {
+        size_t i = 0;
+        for (; i < n; i++) {
+            int c = read();
+            if (c < 0) break;
+            buf[i] = (uint8_t)c;
+        }
+        return i;
+    }
+    size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
+
+protected:
+    unsigned long timeout = 1000;
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+// ---------------------------------------------------------
+// Host shim: Arduino String
+// ---------------------------------------------------------
+// Subset of the Arduino-ESP32 String API the firmware uses, on top of
+// std::string. Semantics follow the Arduino core (substring clamps,
+// indexOf -1, toInt = atol, String(float) with 2 decimals).
+// ---------------------------------------------------------
+
+class String {
+public:
+    String() {}
+    String(const char* s) { if (s) str = s; }
+    String(const char* s, size_t n) : str(s, n) {}
+    String(const String&) = default;
+    String(String&&) = default;
+    explicit String(char c) : str(1, c) {}
+    explicit String(int v, unsigned char base = 10)           { setNum((long long)v, base); }
+    explicit String(unsigned v, unsigned char base = 10)      { setNum((unsigned long long)v, base); }
+    explicit String(long v, unsigned char base = 10)          { setNum((long long)v, base); }
+    explicit String(unsigned long v, unsigned char base = 10) { setNum((unsigned long long)v, base); }
+    explicit String(long long v, unsigned char base = 10)     { setNum(v, base); }
+    explicit String(unsigned long long v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(float v, unsigned int decimals = 2)       { setFloat(v, decimals); }
+    explicit String(double v, unsigned int decimals = 2)      { setFloat(v, decimals); }
+
+    String& operator=(const String&) = default;
+    String& operator=(String&&) = default;
+    String& operator=(const char* s) { if (s) str = s; else str.clear(); return *this; }
+
+    const char* c_str() const { return str.c_str(); }
+    char* begin() { return &str[0]; }
+    char* end() { return &str[0] + str.size(); }
+    const char* begin() const { return str.c_str(); }
+    const char* end() const { return str.c_str() + str.size(); }
+    unsigned int length() const { return (unsigned int)str.size(); }
+    bool isEmpty() const { return str.empty(); }
+    bool reserve(unsigned int n) { str.reserve(n); return true; }
+
+    bool concat(const String& s) { str += s.str; return true; }
+    bool concat(const char* s) { if (!s) return false; str += s; return true; }
+    bool concat(const char* s, unsigned int n) { if (!s) return false; str.append(s, n); return true; }
+    bool concat(char c) { str += c; return true; }
+    bool concat(int v) { return concat(String(v)); }
+    bool concat(unsigned v) { return concat(String(v)); }
+    bool concat(long v) { return concat(String(v)); }
+    bool concat(unsigned long v) { return concat(String(v)); }
+    bool concat(long long v) { return concat(String(v)); }
+    bool concat(unsigned long long v) { return concat(String(v)); }
+    bool concat(float v) { return concat(String(v)); }
+    bool concat(double v) { return concat(String(v)); }
+
+    template <typename T>
+    String& operator+=(const T& v) { concat(v); return *this; }
+
+    char charAt(unsigned int i) const { return i < str.size() ? str[i] : '\0'; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return str[i]; }
+    void setCharAt(unsigned int i, char c) { if (i < str.size()) str[i] = c; }
+
+    int compareTo(const String& s) const { return str.compare(s.str); }
+    bool equals(const String& s) const { return str == s.str; }
+    bool equals(const char* s) const { return str == (s ? s : ""); }
+    bool equalsIgnoreCase(const String& s) const;
+
+    bool operator==(const String& s) const { return equals(s); }
+    bool operator==(const char* s) const { return equals(s); }
+    bool operator!=(const String& s) const { return !equals(s); }
+    bool operator!=(const char* s) const { return !equals(s); }
+    bool operator<(const String& s) const { return str < s.str; }
+    bool operator>(const String& s) const { return str > s.str; }
+
+    bool startsWith(const String& p) const { return str.compare(0, p.str.size(), p.str) == 0; }
+    bool startsWith(const String& p, unsigned int from) const {
+        return from <= str.size() && str.compare(from, p.str.size(), p.str) == 0;
+    }
+    bool endsWith(const String& s) const {
+        return s.str.size() <= str.size() &&
+               str.compare(str.size() - s.str.size(), s.str.size(), s.str) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(str.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return pos(str.find(s.str, from)); }
+    int lastIndexOf(char c) const { return pos(str.rfind(c)); }
+    int lastIndexOf(char c, unsigned int from) const { return pos(str.rfind(c, from)); }
+    int lastIndexOf(const String& s) const { return pos(str.rfind(s.str)); }
+    int lastIndexOf(const String& s, unsigned int from) const { return pos(str.rfind(s.str, from)); }
+
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(char find, char repl);
+    void replace(const String& find, const String& repl);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long   toInt() const { return atol(str.c_str()); }
+    float  toFloat() const { return (float)atof(str.c_str()); }
+    double toDouble() const { return atof(str.c_str()); }
+
+    void getBytes(unsigned char* buf, unsigned int cap, unsigned int index = 0) const;
+    void toCharArray(char* buf, unsigned int cap, unsigned int index = 0) const {
+        getBytes((unsigned char*)buf, cap, index);
+    }
+
+    // host side only
+    const std::string& std() const { return str; }
+
+private:
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    void setNum(long long v, unsigned char base);
+    void setNum(unsigned long long v, unsigned char base);
+    void setFloat(double v, unsigned int decimals);
+
+    std::string str;
+};
+
+// Arduino's StringSumHelper: "a" + String + 1 + ...
+inline String operator+(const String& a, const String& b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, const char* b)   { String r(a); r.concat(b); return r; }
+inline String operator+(const char* a, const String& b)   { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, char b)          { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, int b)           { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, unsigned b)      { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, long b)          { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, unsigned long b) { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, float b)         { String r(a); r.concat(b); return r; }
+inline String operator+(const String& a, double b)        { String r(a); r.concat(b); return r; }
+
+inline bool operator==(const char* a, const String& b) { return b.equals(a); }
+inline bool operator!=(const char* a, const String& b) { return !b.equals(a); }
@@ -0,0 +1,43 @@
+#pragma once
+#include <memory>
+#include "Client.h"
+
+// ---------------------------------------------------------
+// Host shim: WiFiClient on a POSIX TCP socket
+// ---------------------------------------------------------
+// Like the ESP32 class: copies share the socket (closed with the
+// last copy), write() blocks until everything is sent, reads never
+// block. fd() is a real descriptor, so code using lwIP's ::send()
+// with MSG_DONTWAIT runs unchanged (lwip/sockets.h → <sys/socket.h>).
+// The send buffer is about lwIP's size. Only numeric IPv4 hosts and
+// "localhost".
+// ---------------------------------------------------------
+
+class WiFiClient : public Client {
+public:
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) { (void)timeout; return connect(ip, port); }
+    int connect(const char* host, uint16_t port, int32_t timeout) { (void)timeout; return connect(host, port); }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override { sock.reset(); }
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    int fd() const { return sock ? sock->fd : -1; }
+
+private:
+    struct Socket {
+        int fd;
+        explicit Socket(int f) : fd(f) {}
+        ~Socket();
+    };
+    std::shared_ptr<Socket> sock;
+};
@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+// µs since start of the test process (follows millis(), see Arduino.h)
+int64_t esp_timer_get_time();
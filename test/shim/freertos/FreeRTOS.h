@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <mutex>
+
+// ---------------------------------------------------------
+// Host shim: FreeRTOS on std::thread
+// ---------------------------------------------------------
+// One tick = 1 ms. Critical sections are a plain mutex per portMUX
+// (the firmware never nests them). Tasks are detached std::threads.
+// ---------------------------------------------------------
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE   1
+#define pdFALSE  0
+#define pdPASS   1
+#define pdFAIL   0
+
+#define portMAX_DELAY        0xffffffffUL
+#define portTICK_PERIOD_MS   1
+#define configTICK_RATE_HZ   1000
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(ms))
+
+struct portMUX_TYPE {
+    std::mutex m;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED  {}
+
+#define portENTER_CRITICAL(mux)      (mux)->m.lock()
+#define portEXIT_CRITICAL(mux)       (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux)  (mux)->m.lock()
+#define portEXIT_CRITICAL_ISR(mux)   (mux)->m.unlock()
+#define taskENTER_CRITICAL(mux)      (mux)->m.lock()
+#define taskEXIT_CRITICAL(mux)       (mux)->m.unlock()
@@ -0,0 +1,554 @@
+// Host shim implementation (see Arduino.h)
+#include "Arduino.h"
+#include "Preferences.h"
+#include "esp_timer.h"
+
+#include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------
+// Clock
+// ---------------------------------------------------------
+static const auto g_start = std::chrono::steady_clock::now();
+static std::atomic<int64_t> g_warpUs{0};
+
+static int64_t hostMicros() {
+    auto d = std::chrono::steady_clock::now() - g_start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count() + g_warpUs.load();
+}
+
+void (*hostMillisHook)() = nullptr;
+
+unsigned long millis() {
+    if (hostMillisHook) {
+        void (*hook)() = hostMillisHook;
+        hostMillisHook = nullptr;
+        hook();
+    }
+    return (unsigned long)(hostMicros() / 1000);
+}
+unsigned long micros() { return (unsigned long)hostMicros(); }
+int64_t esp_timer_get_time() { return hostMicros(); }
+
+void hostClockAdvance(uint32_t ms) { g_warpUs += (int64_t)ms * 1000; }
+
+void delay(uint32_t ms) {
+    hostClockAdvance(ms);
+    std::this_thread::yield();
+}
+
+void delayMicroseconds(uint32_t us) {
+    g_warpUs += us;
+}
+
+void yield() { std::this_thread::yield(); }
+
+uint32_t esp_random() {
+    static std::mt19937 rng(12345);
+    static std::mutex mu;
+    std::lock_guard<std::mutex> lock(mu);
+    return rng();
+}
+
+EspClass ESP;
+
+void EspClass::restart() {
+    throw std::runtime_error("ESP.restart() called");
+}
+
+// ---------------------------------------------------------
+// String
+// ---------------------------------------------------------
+bool String::equalsIgnoreCase(const String& s) const {
+    if (str.size() != s.str.size()) return false;
+    for (size_t i = 0; i < str.size(); i++)
+        if (tolower((unsigned char)str[i]) != tolower((unsigned char)s.str[i])) return false;
+    return true;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= str.size()) return String();
+    if (to > str.size()) to = str.size();
+    return String(str.data() + from, to - from);
+}
+
+void String::replace(char find, char repl) {
+    for (auto& c : str) if (c == find) c = repl;
+}
+
+void String::replace(const String& find, const String& repl) {
+    if (find.str.empty()) return;
+    size_t p = 0;
+    while ((p = str.find(find.str, p)) != std::string::npos) {
+        str.replace(p, find.str.size(), repl.str);
+        p += repl.str.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < str.size()) str.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < str.size()) str.erase(index, count);
+}
+
+void String::toLowerCase() { for (auto& c : str) c = tolower((unsigned char)c); }
+void String::toUpperCase() { for (auto& c : str) c = toupper((unsigned char)c); }
+
+void String::trim() {
+    size_t a = str.find_first_not_of(" \t\r\n\f\v");
+    if (a == std::string::npos) { str.clear(); return; }
+    size_t b = str.find_last_not_of(" \t\r\n\f\v");
+    str = str.substr(a, b - a + 1);
+}
+
+void String::getBytes(unsigned char* buf, unsigned int cap, unsigned int index) const {
+    if (!cap || !buf) return;
+    size_t n = index < str.size() ? str.size() - index : 0;
+    if (n > cap - 1) n = cap - 1;
+    memcpy(buf, str.data() + (n ? index : 0), n);
+    buf[n] = 0;
+}
+
+void String::setNum(long long v, unsigned char base) {
+    if (v < 0 && base == 10) {
+        setNum((unsigned long long)(-v), base);
+        str.insert(str.begin(), '-');
+    } else {
+        setNum((unsigned long long)v, base);
+    }
+}
+
+void String::setNum(unsigned long long v, unsigned char base) {
+    char buf[72];
+    int i = sizeof(buf) - 1;
+    buf[i] = 0;
+    if (base < 2) base = 10;
+    do {
+        int d = (int)(v % base);
+        buf[--i] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        v /= base;
+    } while (v);
+    str = buf + i;
+}
+
+void String::setFloat(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    str = buf;
+}
+
+// ---------------------------------------------------------
+// Print / Serial
+// ---------------------------------------------------------
+size_t Print::printf(const char* fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? n : sizeof(buf) - 1);
+}
+
+HardwareSerial Serial(true);
+HardwareSerial Serial2;
+
+int HardwareSerial::available() {
+    std::lock_guard<std::mutex> lock(mu);
+    return (int)rx.size();
+}
+
+int HardwareSerial::read() {
+    std::lock_guard<std::mutex> lock(mu);
+    if (rx.empty()) return -1;
+    int c = rx.front();
+    rx.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    std::lock_guard<std::mutex> lock(mu);
+    return rx.empty() ? -1 : rx.front();
+}
+
+size_t HardwareSerial::read(uint8_t* buf, size_t n) {
+    std::lock_guard<std::mutex> lock(mu);
+    size_t i = 0;
+    for (; i < n && !rx.empty(); i++) {
+        buf[i] = rx.front();
+        rx.pop_front();
+    }
+    return i;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+    if (console) {
+        if (getenv("HOST_SERIAL")) fwrite(buf, 1, n, stdout);
+        return n;
+    }
+    if (onHostTx) onHostTx(buf, n);
+    return n;
+}
+
+// Like the driver: bytes beyond the ring are lost, the callback runs
+// after the data is in the buffer
+size_t HardwareSerial::hostInject(const char* data, size_t n) {
+    size_t taken = 0;
+    OnReceiveCb cb;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        for (; taken < n && rx.size() < rxCap; taken++) rx.push_back((uint8_t)data[taken]);
+        cb = callback;
+    }
+    if (cb) cb();
+    return taken;
+}
+
+void HardwareSerial::hostReset() {
+    std::lock_guard<std::mutex> lock(mu);
+    rx.clear();
+    callback = nullptr;
+    onHostTx = nullptr;
+}
+
+// ---------------------------------------------------------
+// FreeRTOS
+// ---------------------------------------------------------
+static std::chrono::steady_clock::time_point deadline(TickType_t wait) {
+    if (wait == portMAX_DELAY) return std::chrono::steady_clock::time_point::max();
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(wait);
+}
+
+template <typename Pred>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                    TickType_t wait, Pred pred) {
+    if (wait == portMAX_DELAY) {
+        cv.wait(lock, pred);
+        return true;
+    }
+    return cv.wait_until(lock, deadline(wait), pred);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t,
+                                   void* arg, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    std::thread t(fn, arg);
+    if (handle) *handle = (TaskHandle_t)(uintptr_t)std::hash<std::thread::id>()(t.get_id());
+    t.detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack,
+                       void* arg, UBaseType_t prio, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t) {}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 4096; }
+
+struct HostQueue {
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue* q = new HostQueue;
+    q->length = length;
+    q->itemSize = itemSize;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q) { delete q; }
+
+static BaseType_t queuePut(QueueHandle_t q, const void* item, TickType_t wait, bool front) {
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!waitFor(q->cv, lock, wait, [&] { return q->items.size() < q->length; }))
+        return pdFALSE;
+    std::vector<uint8_t> v((const uint8_t*)item, (const uint8_t*)item + q->itemSize);
+    if (front) q->items.push_front(std::move(v));
+    else       q->items.push_back(std::move(v));
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t wait) {
+    return queuePut(q, item, wait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t wait) {
+    return queuePut(q, item, wait, true);
+}
+
+static BaseType_t queueGet(QueueHandle_t q, void* item, TickType_t wait, bool remove) {
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!waitFor(q->cv, lock, wait, [&] { return !q->items.empty(); }))
+        return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    if (remove) {
+        q->items.pop_front();
+        q->cv.notify_all();
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t wait) {
+    return queueGet(q, item, wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t wait) {
+    return queueGet(q, item, wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->length - q->items.size();
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->m);
+    q->items.clear();
+    q->cv.notify_all();
+    return pdPASS;
+}
+
+struct HostSemaphore {
+    enum Kind { COUNTING, MUTEX, RECURSIVE } kind;
+    std::mutex m;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t max;
+    std::thread::id owner;
+    UBaseType_t depth = 0;
+};
+
+static SemaphoreHandle_t semCreate(HostSemaphore::Kind kind, UBaseType_t max, UBaseType_t initial) {
+    HostSemaphore* s = new HostSemaphore;
+    s->kind = kind;
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return semCreate(HostSemaphore::COUNTING, 1, 0); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    return semCreate(HostSemaphore::COUNTING, max, initial);
+}
+SemaphoreHandle_t xSemaphoreCreateMutex() { return semCreate(HostSemaphore::MUTEX, 1, 1); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return semCreate(HostSemaphore::RECURSIVE, 1, 1); }
+void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+    std::unique_lock<std::mutex> lock(s->m);
+    if (!waitFor(s->cv, lock, wait, [&] { return s->count > 0; }))
+        return pdFALSE;
+    s->count--;
+    s->owner = std::this_thread::get_id();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    std::lock_guard<std::mutex> lock(s->m);
+    if (s->count >= s->max) return pdFALSE;
+    s->count++;
+    s->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(s);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t wait) {
+    std::unique_lock<std::mutex> lock(s->m);
+    auto self = std::this_thread::get_id();
+    if (s->depth > 0 && s->owner == self) {
+        s->depth++;
+        return pdTRUE;
+    }
+    if (!waitFor(s->cv, lock, wait, [&] { return s->depth == 0; }))
+        return pdFALSE;
+    s->owner = self;
+    s->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s) {
+    std::lock_guard<std::mutex> lock(s->m);
+    if (s->depth == 0 || s->owner != std::this_thread::get_id()) return pdFALSE;
+    if (--s->depth == 0) s->cv.notify_one();
+    return pdTRUE;
+}
+
+// ---------------------------------------------------------
+// Preferences
+// ---------------------------------------------------------
+static std::mutex g_nvsMu;
+static std::map<std::string, std::string> g_nvs;   // "<ns>/<key>" → bytes
+
+bool Preferences::begin(const char* ns, bool ro) {
+    space = ns;
+    readOnly = ro;
+    open = true;
+    return true;
+}
+
+bool Preferences::clear() {
+    if (!open || readOnly) return false;
+    std::lock_guard<std::mutex> lock(g_nvsMu);
+    std::string prefix = space + "/";
+    for (auto it = g_nvs.begin(); it != g_nvs.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) it = g_nvs.erase(it);
+        else ++it;
+    }
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open || readOnly) return false;
+    std::lock_guard<std::mutex> lock(g_nvsMu);
+    return g_nvs.erase(space + "/" + key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return find(key) != nullptr;
+}
+
+size_t Preferences::putRaw(const char* key, const void* v, size_t n) {
+    if (!open || readOnly) return 0;
+    std::lock_guard<std::mutex> lock(g_nvsMu);
+    g_nvs[space + "/" + key] = std::string((const char*)v, n);
+    return n ? n : 1;
+}
+
+// entries are never erased while a caller holds the pointer (tests
+// are single threaded around Preferences)
+const std::string* Preferences::find(const char* key) {
+    if (!open) return nullptr;
+    std::lock_guard<std::mutex> lock(g_nvsMu);
+    auto it = g_nvs.find(space + "/" + key);
+    return it == g_nvs.end() ? nullptr : &it->second;
+}
+
+String Preferences::getString(const char* key, const String& def) {
+    const std::string* v = find(key);
+    return v ? String(v->data(), v->size()) : def;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    const std::string* v = find(key);
+    return v ? v->size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t cap) {
+    const std::string* v = find(key);
+    if (!v || v->size() > cap) return 0;
+    memcpy(buf, v->data(), v->size());
+    return v->size();
+}
+
+// ---------------------------------------------------------
+// WiFiClient (POSIX socket)
+// ---------------------------------------------------------
+#include "WiFiClient.h"
+#include "lwip/sockets.h"
+#include <signal.h>
+
+// lwIP has no SIGPIPE: a send() to a closed peer just fails
+static const bool g_noSigpipe = [] { signal(SIGPIPE, SIG_IGN); return true; }();
+
+WiFiClient::Socket::~Socket() {
+    ::close(fd);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (strcmp(host, "localhost") == 0) host = "127.0.0.1";
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) return 0;
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        return 0;
+    }
+
+    // send buffer about lwIP's TCP_SND_BUF (4 × MSS) instead of the
+    // auto-tuned megabytes of Linux, so a slow peer blocks as early
+    int one = 1, snd = 4 * 1436;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &snd, sizeof(snd));
+    sock = std::make_shared<Socket>(fd);
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+    size_t done = 0;
+    while (sock && done < size) {
+        ssize_t n = ::send(sock->fd, buf + done, size - done, 0);
+        if (n <= 0) break;
+        done += n;
+    }
+    return done;
+}
+
+int WiFiClient::available() {
+    int n = 0;
+    if (!sock || ioctl(sock->fd, FIONREAD, &n) != 0) return 0;
+    return n;
+}
+
+int WiFiClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+    if (!sock) return -1;
+    ssize_t n = ::recv(sock->fd, buf, size, MSG_DONTWAIT);
+    return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+    uint8_t b;
+    if (!sock || ::recv(sock->fd, &b, 1, MSG_PEEK | MSG_DONTWAIT) != 1) return -1;
+    return b;
+}
+
+uint8_t WiFiClient::connected() {
+    if (!sock) return 0;
+    uint8_t b;
+    ssize_t n = ::recv(sock->fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n > 0) return 1;
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
@@ -0,0 +1,72 @@
+// Fixed-point value formatting (py_format)
+#include "host_test.h"
+#include "py_format.h"
+
+static std::string fmt(const char* text, const char* factor, uint8_t decimals,
+                       bool fahrenheit = false) {
+    FixedFormat f;
+    f.decimals   = decimals;
+    f.fahrenheit = fahrenheit;
+    f.exact      = fixedParseFactor(factor, f.mul, f.exp);
+
+    int64_t raw;
+    uint8_t scale;
+    char out[32];
+    if (!fixedParseText(text, raw, scale)) return "<float>";
+    if (fixedFormat(out, sizeof(out), raw, scale, f) == 0) return "<overflow>";
+    return out;
+}
+
+TEST(factor_parsing) {
+    int32_t mul;
+    uint8_t exp;
+    CHECK(fixedParseFactor("0.001", mul, exp) && mul == 1 && exp == 3);
+    CHECK(fixedParseFactor("0.10", mul, exp) && mul == 1 && exp == 1);
+    CHECK(fixedParseFactor("-2.5", mul, exp) && mul == -25 && exp == 1);
+    CHECK(!fixedParseFactor("1e-3", mul, exp));
+    CHECK(!fixedParseFactor("", mul, exp));
+}
+
+TEST(text_parsing) {
+    int64_t raw;
+    uint8_t scale;
+    CHECK(fixedParseText(" -12.50 mV", raw, scale) && raw == -1250 && scale == 2);
+    CHECK(fixedParseText("75%", raw, scale) && raw == 75 && scale == 0);
+    CHECK(!fixedParseText("1e3", raw, scale));
+    CHECK(!fixedParseText("1234567890123456789", raw, scale));
+}
+
+TEST(scaled_values) {
+    CHECK_STR(fmt("50376", "0.001", 3).c_str(), "50.376");
+    CHECK_STR(fmt("3299", "0.001", 3).c_str(), "3.299");   // float: 3.2989999
+    CHECK_STR(fmt("-1150", "0.001", 2).c_str(), "-1.15");
+    CHECK_STR(fmt("37104 mAH", "0.001", 0).c_str(), "37");
+    CHECK_STR(fmt("76%", "1", 1).c_str(), "76.0");
+    CHECK_STR(fmt("5", "10", 0).c_str(), "50");
+}
+
+TEST(rounding_half_away_from_zero) {
+    CHECK_STR(fmt("1005", "0.001", 2).c_str(), "1.01");
+    CHECK_STR(fmt("-1005", "0.001", 2).c_str(), "-1.01");
+    CHECK_STR(fmt("1004", "0.001", 2).c_str(), "1.00");
+    CHECK_STR(fmt("-4", "0.001", 2).c_str(), "0.00");         // no "-0.00"
+}
+
+TEST(fahrenheit_is_exact) {
+    CHECK_STR(fmt("20000", "0.001", 1, true).c_str(), "68.0");
+    CHECK_STR(fmt("-40000", "0.001", 1, true).c_str(), "-40.0");
+    CHECK_STR(fmt("20450", "0.001", 2, true).c_str(), "68.81");
+}
+
+TEST(overflow_falls_back) {
+    CHECK_STR(fmt("999999999999999999", "1000", 0).c_str(), "<overflow>");
+
+    FixedFormat f = {};
+    f.exact = false;
+    char out[8];
+    CHECK_EQ(fixedFormat(out, sizeof(out), 1, 0, f), 0);
+
+    f.exact = true;
+    f.mul = 1;
+    CHECK_EQ(fixedFormat(out, 3, 12345, 0, f), 0);             // buffer too small
+}
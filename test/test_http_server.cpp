@@ -0,0 +1,576 @@
+// HTTP server core (py_http_server.cpp) on Linux sockets: requests,
+// keep-alive, pipelining, chunked / blocking / file responses,
+// deferred answers, uploads and the connection limits
+#include "host_test.h"
+#include "host_http.h"
+#include "py_http_server.h"
+#include "web/json_stream.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <thread>
+
+static HttpServer server(0);
+
+static void sleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+template <typename Cond>
+static bool waitFor(Cond cond, uint32_t timeoutMs = 2000) {
+    auto t0 = std::chrono::steady_clock::now();
+    while (!cond()) {
+        if (std::chrono::steady_clock::now() - t0 > std::chrono::milliseconds(timeoutMs))
+            return false;
+        sleepMs(1);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// streamFile() source: pattern bytes, no SPIFFS
+// ---------------------------------------------------------
+static std::atomic<int> filesClosed{0};
+
+static uint8_t pattern(size_t i) { return (uint8_t)(i * 7 + (i >> 9)); }
+
+struct FakeFile {
+    const char* path;
+    size_t len;
+    size_t pos = 0;
+
+    const char* name() const { return path; }
+    size_t size() const { return len; }
+    size_t read(uint8_t* buf, size_t n) {
+        size_t k = n < len - pos ? n : len - pos;
+        for (size_t i = 0; i < k; i++) buf[i] = pattern(pos + i);
+        pos += k;
+        return k;
+    }
+    void close() { filesClosed++; }
+};
+
+#define FILE_BYTES  (1024 * 1024)
+
+// ---------------------------------------------------------
+// Server thread (the web task) and routes
+// ---------------------------------------------------------
+static std::atomic<HttpTicket> parked{0};
+static std::atomic<bool>       parkedPending{false};
+static std::atomic<bool>       release{false};
+static std::atomic<int>        detachedFd{-1};
+static std::atomic<bool>       stopLoop{false};
+
+static std::string uploadLog;           // written by the server thread
+static std::string uploadData;
+static std::mutex  uploadMu;
+
+static void registerRoutes() {
+    server.on("/echo", HTTP_GET, [] {
+        String body = "a=" + server.arg("a") + ";b=" + server.arg("b") +
+                      ";n=" + String(server.args());
+        server.send(200, "text/plain", body);
+    });
+
+    server.on("/post", HTTP_POST, [] {
+        String body = "plain=" + server.arg("plain") + "|x=" + server.arg("x") +
+                      "|has_y=" + String(server.hasArg("y") ? 1 : 0);
+        server.send(200, "text/plain", body);
+    });
+
+    server.on("/json", HTTP_GET, [] {
+        JsonStream js(server);
+        js.begin();
+        js.beginArray();
+        for (int i = 0; i < 1000; i++) js.value(i);
+        js.endArray();
+        js.end();
+    });
+
+    server.on("/big", HTTP_GET, [] {
+        String body;
+        for (int i = 0; i < 40000; i++) body += (char)('a' + i % 26);
+        server.send(200, "text/plain", body);
+    });
+
+    server.on("/file", HTTP_GET, [] {
+        FakeFile f = { "/blob.bin", FILE_BYTES };
+        server.streamFile(f, "application/octet-stream");
+    });
+
+    server.on("/app.js", HTTP_GET, [] {
+        FakeFile f = { "/app.js.gz", 3000 };
+        server.streamFile(f, "application/javascript");
+    });
+
+    server.on("/defer", HTTP_GET, [] {
+        parked = server.defer();
+    });
+
+    server.on("/etag", HTTP_GET, [] {
+        server.sendHeader("ETag", "\"1\"");
+        server.send(200, "text/plain", server.header("If-None-Match"));
+    });
+
+    server.on("/detach", HTTP_GET, [] {
+        int fd = server.detach();
+        static const char R[] = "HTTP/1.1 200 OK\r\nContent-Length: 8\r\n\r\ndetached";
+        ::send(fd, R, sizeof(R) - 1, 0);
+        detachedFd = fd;
+    });
+
+    server.on("/silent", HTTP_GET, [] {});
+
+    server.on("/upload", HTTP_POST,
+        [] {
+            std::lock_guard<std::mutex> lock(uploadMu);
+            String body = "note=" + server.arg("note") + ";bytes=" + String((unsigned)uploadData.size());
+            server.send(200, "text/plain", body);
+        },
+        [] {
+            HTTPUpload& up = server.upload();
+            std::lock_guard<std::mutex> lock(uploadMu);
+            switch (up.status) {
+                case UPLOAD_FILE_START:
+                    uploadLog += std::string("start:") + up.filename.c_str() + ":" + up.name.c_str() + ";";
+                    uploadData.clear();
+                    break;
+                case UPLOAD_FILE_WRITE:
+                    uploadData.append((const char*)up.buf, up.currentSize);
+                    break;
+                case UPLOAD_FILE_END:
+                    uploadLog += "end:" + std::to_string(up.totalSize) + ";";
+                    break;
+                case UPLOAD_FILE_ABORTED:
+                    uploadLog += "aborted;";
+                    break;
+            }
+        });
+
+    static const char* keys[] = { "If-None-Match" };
+    server.collectHeaders(keys, 1);
+}
+
+static void serverLoop() {
+    while (!stopLoop) {
+        server.handleClient(1);
+
+        // stands in for pollDeferred() in wp_webserver.cpp
+        HttpTicket t = parked;
+        parkedPending = t && server.pending(t);
+        if (t && release) {
+            server.reply(t, 200, "text/plain", "late", 4);
+            parked = 0;
+            release = false;
+        }
+    }
+}
+
+struct ServerThread {
+    std::thread worker;
+    ServerThread() {
+        registerRoutes();
+        server.begin();
+        worker = std::thread(serverLoop);
+    }
+    ~ServerThread() {
+        stopLoop = true;
+        worker.join();
+        server.close();
+    }
+};
+
+// started by the first test (config / log ring are set up by then)
+static uint16_t port() {
+    static ServerThread serverThread;
+    return server.port();
+}
+
+static bool get(HostHttpClient& c, const std::string& path, HostHttpResponse& r) {
+    return c.request(hostHttpGet(path), r);
+}
+
+// ---------------------------------------------------------
+// Requests
+// ---------------------------------------------------------
+TEST(query_args) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+
+    HostHttpResponse r;
+    CHECK(get(c, "/echo?a=1&b=x%20y+z", r));
+    CHECK_EQ(r.code, 200);
+    CHECK_STR(r.body.c_str(), "a=1;b=x y z;n=2");
+    CHECK(r.header("connection") == "keep-alive");
+    CHECK(r.header("content-type") == "text/plain");
+}
+
+TEST(post_body_and_form_args) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+
+    HostHttpResponse r;
+    CHECK(c.request(hostHttpPost("/post", "application/json", "{\"x\":1}"), r));
+    CHECK_EQ(r.code, 200);
+    CHECK_STR(r.body.c_str(), "plain={\"x\":1}|x=|has_y=0");
+
+    CHECK(c.request(hostHttpPost("/post", "application/x-www-form-urlencoded", "x=5&y=%41"), r));
+    CHECK_STR(r.body.c_str(), "plain=x=5&y=%41|x=5|has_y=1");
+
+    // the route is bound to POST
+    CHECK(get(c, "/post", r));
+    CHECK_EQ(r.code, 404);
+}
+
+TEST(keep_alive_and_pipelining) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    uint32_t reused = server.stats().keepAlive;
+
+    // three requests in one segment, answered in order
+    CHECK(c.write(hostHttpGet("/echo?a=1") + hostHttpGet("/json") + hostHttpGet("/echo?a=3")));
+
+    HostHttpResponse r;
+    CHECK(c.read(r));
+    CHECK_STR(r.body.c_str(), "a=1;b=;n=1");
+    CHECK(c.read(r));
+    CHECK_EQ(r.body.size() > 3000, 1);
+    CHECK(c.read(r));
+    CHECK_STR(r.body.c_str(), "a=3;b=;n=1");
+
+    CHECK(server.stats().keepAlive >= reused + 2);
+}
+
+TEST(http10_closes) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+
+    HostHttpResponse r;
+    CHECK(c.request("GET /echo?a=x HTTP/1.0\r\n\r\n", r));
+    CHECK_STR(r.body.c_str(), "a=x;b=;n=1");
+    CHECK(r.header("connection") == "close");
+    CHECK(c.closedByPeer());
+
+    // no chunked encoding for 1.0: the body ends with the connection
+    CHECK(c.open(port()));
+    CHECK(c.request("GET /json HTTP/1.0\r\n\r\n", r));
+    CHECK(r.header("transfer-encoding").empty());
+    CHECK_EQ(r.body.front(), '[');
+    CHECK_EQ(r.body.back(), ']');
+}
+
+// ---------------------------------------------------------
+// Responses
+// ---------------------------------------------------------
+TEST(chunked_json_stream) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+
+    HostHttpResponse r;
+    CHECK(get(c, "/json", r));
+    CHECK_EQ(r.code, 200);
+    CHECK(r.header("transfer-encoding") == "chunked");
+
+    std::string expect = "[";
+    for (int i = 0; i < 1000; i++) expect += (i ? "," : "") + std::to_string(i);
+    expect += "]";
+    CHECK(r.body == expect);
+}
+
+// > HTTP_OUT_MAX: pushed out while the handler runs
+TEST(large_response) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    uint32_t blocked = server.stats().blockedSends;
+
+    HostHttpResponse r;
+    CHECK(get(c, "/big", r));
+    CHECK_EQ(r.body.size(), 40000);
+    CHECK_EQ(r.body[39999], 'a' + 39999 % 26);
+    CHECK_EQ(server.stats().blockedSends, blocked + 1);
+
+    CHECK(get(c, "/echo", r));                           // connection still usable
+    CHECK_EQ(r.code, 200);
+}
+
+// a browser that does not read its file holds up nobody else
+TEST(file_streamed_while_others_served) {
+    int closed = filesClosed;
+
+    HostHttpClient slow;
+    CHECK(slow.open(port(), 4096));
+    CHECK(slow.write(hostHttpGet("/file")));
+    sleepMs(20);
+
+    HostHttpClient fast;
+    CHECK(fast.open(port()));
+    uint64_t worst = 0;
+    for (int i = 0; i < 20; i++) {
+        uint64_t t0 = hostNowNs();
+        HostHttpResponse r;
+        CHECK(get(fast, "/echo?a=" + std::to_string(i), r));
+        CHECK_EQ(r.code, 200);
+        uint64_t dt = hostNowNs() - t0;
+        if (dt > worst) worst = dt;
+    }
+    CHECK(worst < 200000000ull);                         // 200 ms (typ. < 1 ms)
+
+    HostHttpResponse r;
+    CHECK(slow.read(r, 10000));
+    CHECK_EQ(r.body.size(), FILE_BYTES);
+    CHECK(r.header("content-length") == std::to_string(FILE_BYTES));
+    CHECK(r.header("content-encoding").empty());
+
+    bool same = r.body.size() == FILE_BYTES;
+    for (size_t i = 0; same && i < r.body.size(); i++) same = (uint8_t)r.body[i] == pattern(i);
+    CHECK(same);
+    CHECK(waitFor([&] { return filesClosed == closed + 1; }));
+}
+
+TEST(gz_file_gets_content_encoding) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+
+    HostHttpResponse r;
+    CHECK(get(c, "/app.js", r));
+    CHECK(r.header("content-encoding") == "gzip");
+    CHECK(r.header("content-type") == "application/javascript");
+    CHECK_EQ(r.body.size(), 3000);
+}
+
+TEST(not_found_and_collected_header) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+
+    HostHttpResponse r;
+    CHECK(get(c, "/nope", r));
+    CHECK_EQ(r.code, 404);
+
+    CHECK(c.request("GET /etag HTTP/1.1\r\nif-none-match: \"abc\"\r\n\r\n", r));
+    CHECK_STR(r.body.c_str(), "\"abc\"");
+    CHECK(r.header("etag") == "\"1\"");
+}
+
+TEST(handler_without_response_closes) {
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    CHECK(c.write(hostHttpGet("/silent")));
+    CHECK(c.closedByPeer());
+}
+
+// ---------------------------------------------------------
+// Deferred answers / hand-over
+// ---------------------------------------------------------
+TEST(deferred_reply) {
+    uint32_t deferred = server.stats().deferred;
+
+    HostHttpClient waiting;
+    CHECK(waiting.open(port()));
+    CHECK(waiting.write(hostHttpGet("/defer")));
+    CHECK(waitFor([] { return parkedPending.load(); }));
+    CHECK_EQ(server.stats().deferred, deferred + 1);
+
+    // served while the other one waits
+    HostHttpClient other;
+    CHECK(other.open(port()));
+    HostHttpResponse r;
+    CHECK(get(other, "/echo?a=2", r));
+    CHECK_STR(r.body.c_str(), "a=2;b=;n=1");
+
+    release = true;
+    CHECK(waiting.read(r));
+    CHECK_EQ(r.code, 200);
+    CHECK_STR(r.body.c_str(), "late");
+
+    // the connection goes on with the next request
+    CHECK(get(waiting, "/echo?a=3", r));
+    CHECK_STR(r.body.c_str(), "a=3;b=;n=1");
+}
+
+TEST(deferred_client_gone) {
+    HostHttpClient waiting;
+    CHECK(waiting.open(port()));
+    CHECK(waiting.write(hostHttpGet("/defer")));
+    CHECK(waitFor([] { return parkedPending.load(); }));
+
+    waiting.close();
+    CHECK(waitFor([] { return !parkedPending.load(); }));
+    parked = 0;
+}
+
+TEST(detach_hands_over_socket) {
+    uint32_t detached = server.stats().detached;
+
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    HostHttpResponse r;
+    CHECK(get(c, "/detach", r));
+    CHECK_STR(r.body.c_str(), "detached");
+    CHECK_EQ(server.stats().detached, detached + 1);
+
+    // the server does not touch the socket any more
+    CHECK(waitFor([] { return detachedFd >= 0; }));
+    ::send(detachedFd, "x", 1, 0);
+    CHECK(!c.closedByPeer(50));
+    ::close(detachedFd);
+    detachedFd = -1;
+    CHECK(c.closedByPeer());
+}
+
+// ---------------------------------------------------------
+// Upload (multipart/form-data, streamed)
+// ---------------------------------------------------------
+static std::string uploadContent() {
+    // delimiter look-alikes inside the data
+    std::string d;
+    for (int i = 0; i < 5000; i++) {
+        if (i % 700 == 0) d += "\r\n--XyZboundar";
+        d += (char)(i * 13);
+    }
+    return d;
+}
+
+static std::string multipart(const std::string& data) {
+    return "preamble\r\n"
+           "--XyZboundary\r\n"
+           "Content-Disposition: form-data; name=\"note\"\r\n\r\n"
+           "hello\r\n"
+           "--XyZboundary\r\n"
+           "Content-Disposition: form-data; name=\"file\"; filename=\"test.bin\"\r\n"
+           "Content-Type: application/octet-stream\r\n\r\n" +
+           data +
+           "\r\n--XyZboundary--\r\n";
+}
+
+static std::string uploadHead(size_t len) {
+    return "POST /upload HTTP/1.1\r\n"
+           "Content-Type: multipart/form-data; boundary=XyZboundary\r\n"
+           "Content-Length: " + std::to_string(len) + "\r\n\r\n";
+}
+
+TEST(upload_multipart) {
+    std::string data = uploadContent();
+    std::string body = multipart(data);
+    {
+        std::lock_guard<std::mutex> lock(uploadMu);
+        uploadLog.clear();
+    }
+
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    HostHttpResponse r;
+    CHECK(c.request(uploadHead(body.size()) + body, r));
+    CHECK_EQ(r.code, 200);
+    CHECK(r.body == "note=hello;bytes=" + std::to_string(data.size()));
+
+    std::lock_guard<std::mutex> lock(uploadMu);
+    CHECK(uploadLog == "start:test.bin:file;end:" + std::to_string(data.size()) + ";");
+    CHECK(uploadData == data);
+}
+
+// same body in small pieces: the delimiter is split across reads
+TEST(upload_in_pieces) {
+    std::string data = uploadContent();
+    std::string body = multipart(data);
+    {
+        std::lock_guard<std::mutex> lock(uploadMu);
+        uploadLog.clear();
+    }
+
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    CHECK(c.write(uploadHead(body.size())));
+    for (size_t off = 0; off < body.size(); off += 61) {
+        CHECK(c.write(body.substr(off, 61)));
+        if (off % 610 == 0) sleepMs(1);
+    }
+
+    HostHttpResponse r;
+    CHECK(c.read(r));
+    CHECK_EQ(r.code, 200);
+
+    std::lock_guard<std::mutex> lock(uploadMu);
+    CHECK(uploadLog == "start:test.bin:file;end:" + std::to_string(data.size()) + ";");
+    CHECK(uploadData == data);
+}
+
+TEST(upload_aborted_by_close) {
+    std::string body = multipart(uploadContent());
+    {
+        std::lock_guard<std::mutex> lock(uploadMu);
+        uploadLog.clear();
+    }
+
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    CHECK(c.write(uploadHead(body.size()) + body.substr(0, 3000)));
+    sleepMs(20);
+    c.close();
+
+    CHECK(waitFor([] {
+        std::lock_guard<std::mutex> lock(uploadMu);
+        return uploadLog == "start:test.bin:file;aborted;";
+    }));
+}
+
+// ---------------------------------------------------------
+// Limits
+// ---------------------------------------------------------
+TEST(bad_requests) {
+    HostHttpClient c;
+    HostHttpResponse r;
+
+    CHECK(c.open(port()));
+    CHECK(c.request("GET /echo HTTP/1.1\r\nX-Fill: " + std::string(HTTP_HEAD_MAX, 'x') + "\r\n\r\n", r));
+    CHECK_EQ(r.code, 431);
+
+    CHECK(c.open(port()));
+    CHECK(c.request(hostHttpPost("/post", "text/plain", std::string(HTTP_BODY_MAX + 1, 'b')), r));
+    CHECK_EQ(r.code, 413);
+
+    CHECK(c.open(port()));
+    CHECK(c.request("BREW /pot HTTP/1.1\r\n\r\n", r));
+    CHECK_EQ(r.code, 501);
+
+    CHECK(c.open(port()));
+    CHECK(c.request("hello\r\n\r\n", r));
+    CHECK_EQ(r.code, 400);
+    CHECK(c.closedByPeer());
+}
+
+TEST(incomplete_request_times_out) {
+    uint32_t timeouts = server.stats().timeouts;
+
+    HostHttpClient c;
+    CHECK(c.open(port()));
+    CHECK(c.write("GET /echo HTTP/1.1\r\nHost: x\r\n"));
+    sleepMs(20);
+
+    hostClockAdvance(HTTP_REQUEST_TIMEOUT_MS);
+    CHECK(c.closedByPeer());
+    CHECK(server.stats().timeouts > timeouts);
+}
+
+// all slots held by idle keep-alive connections: the oldest makes room
+TEST(idle_connection_evicted) {
+    CHECK(waitFor([] { return server.connections() == 0; }));
+    uint32_t evicted = server.stats().evicted;
+
+    HostHttpClient idle[HTTP_MAX_CONN];
+    HostHttpResponse r;
+    for (int i = 0; i < HTTP_MAX_CONN; i++) {
+        CHECK(idle[i].open(port()));
+        CHECK(get(idle[i], "/echo", r));
+        sleepMs(2);
+    }
+    CHECK_EQ(server.connections(), HTTP_MAX_CONN);
+
+    HostHttpClient fresh;
+    CHECK(fresh.open(port()));
+    CHECK(get(fresh, "/echo?a=new", r));
+    CHECK_STR(r.body.c_str(), "a=new;b=;n=1");
+    CHECK_EQ(server.stats().evicted, evicted + 1);
+    CHECK(idle[0].closedByPeer());                       // the oldest
+}
@@ -0,0 +1,24 @@
+#include "host_test.h"
+
+// ---------------------------------------------------------
+// Runner (test executables; benchmarks have their own main)
+// ---------------------------------------------------------
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0, failed = 0;
+
+    for (HostTest* t = hostTests; t; t = t->next) {
+        if (filter && !strstr(t->name, filter)) continue;
+
+        int before = hostTestFailures;
+        t->fn();
+        run++;
+
+        bool ok = hostTestFailures == before;
+        if (!ok) failed++;
+        printf("%s %s\n", ok ? "[ OK ]" : "[FAIL]", t->name);
+    }
+
+    printf("%d tests, %d failed\n", run, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+// MQTT transport (py_mqtt_transport.cpp) against the loopback broker
+// (host_broker.h): outbox, backpressure, QoS 1 window
+#include "host_test.h"
+#include "host_broker.h"
+#include "py_mqtt_transport.h"
+#include <PubSubClient.h>
+#include <chrono>
+#include <thread>
+
+static HostBroker    broker;
+static MqttTransport transport;
+static PubSubClient  client(transport);
+
+static void sleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static bool connectClient() {
+    broker.paused = false;
+    broker.acks = true;
+    broker.readRate = 0;
+
+    // the broker serves one connection at a time: after the CONNACK
+    // everything of the previous one has arrived
+    bool ok = client.connected();
+    if (!ok) {
+        client.setServer("127.0.0.1", broker.port());
+        client.setBufferSize(2048);                     // like PyMqtt::begin()
+        ok = client.connect("host-test");
+        if (!ok) printf("  connect failed, state %d\n", client.state());
+    }
+    broker.clear();
+    return ok;
+}
+
+// payload with its sequence number, easy to check for cuts / reordering
+static std::string payloadFor(uint32_t seq, size_t len) {
+    char head[16];
+    snprintf(head, sizeof(head), "%08u:", seq);
+    std::string p(head);
+    while (p.size() < len) p += (char)('a' + p.size() % 26);
+    return p.substr(0, len);
+}
+
+// like publishPacket() in py_mqtt.cpp
+static bool publish(uint32_t seq, size_t len) {
+    std::string p = payloadFor(seq, len);
+    if (!transport.fits(MqttTransport::publishSize("t/v", p.size()))) return false;
+    return client.publish("t/v", (const uint8_t*)p.data(), p.size());
+}
+
+static bool publishQos1(uint32_t seq, size_t len) {
+    std::string p = payloadFor(seq, len);
+    if (!transport.inflightFits(MqttTransport::publishSize("t/r", p.size(), 1))) return false;
+    if (!transport.beginQos1("t/r", p.size(), false)) return false;
+    client.write((const uint8_t*)p.data(), p.size());
+    return transport.endQos1();
+}
+
+// MQTT loop until cond or timeout
+template <typename Cond>
+static bool loopUntil(Cond cond, uint32_t timeoutMs = 2000) {
+    auto t0 = std::chrono::steady_clock::now();
+    while (!cond()) {
+        transport.pump();
+        client.loop();
+        if (std::chrono::steady_clock::now() - t0 > std::chrono::milliseconds(timeoutMs))
+            return false;
+        sleepMs(1);
+    }
+    return true;
+}
+
+// the outbox only moves while the MQTT loop runs
+static bool delivered(size_t n) {
+    return loopUntil([n] { return broker.messageCount() >= n; });
+}
+
+TEST(publish_reaches_broker) {
+    CHECK(connectClient());
+
+    for (uint32_t i = 0; i < 50; i++) CHECK(publish(i, 100));
+    CHECK(delivered(50));
+
+    auto msgs = broker.messages();
+    for (uint32_t i = 0; i < 50; i++) {
+        CHECK_STR(msgs[i].topic.c_str(), "t/v");
+        CHECK(msgs[i].payload == payloadFor(i, 100));
+        CHECK_EQ(msgs[i].qos, 0);
+    }
+}
+
+// broker stops reading: the socket takes a few KB, the outbox the
+// next 8 KB, then fits() refuses - nothing is cut, nothing blocks
+TEST(outbox_backpressure) {
+    CHECK(connectClient());
+    broker.paused = true;
+
+    uint32_t deferred0 = transport.stats().deferred;
+    uint32_t sent = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    while (sent < 2000 && publish(sent, 1000)) sent++;
+    auto dt = std::chrono::steady_clock::now() - t0;
+
+    CHECK(sent < 2000);                                  // backpressure came
+    CHECK(transport.stats().deferred > deferred0);
+    CHECK(transport.queued() > 0);
+    CHECK(transport.queued() <= MQTT_OUTBOX_SIZE);
+    CHECK(transport.connected());
+    CHECK(dt < std::chrono::milliseconds(500));         // never blocked
+
+    // a deferred publish leaves no bytes behind
+    size_t q = transport.queued();
+    CHECK(!publish(sent, 1000));
+    CHECK_EQ(transport.queued(), q);
+
+    broker.paused = false;
+    CHECK(delivered(sent));
+    CHECK_EQ(transport.queued(), 0);
+
+    auto msgs = broker.messages();
+    CHECK_EQ(msgs.size(), sent);
+    for (uint32_t i = 0; i < msgs.size(); i++)
+        CHECK(msgs[i].payload == payloadFor(i, 1000));
+    CHECK(publish(sent, 1000));                          // room again
+}
+
+TEST(outbox_overflow_cuts_connection) {
+    CHECK(connectClient());
+    broker.paused = true;
+
+    uint32_t errors = transport.stats().errors;
+    uint32_t n = 0;
+    while (n < 2000 && publish(n, 1000)) n++;
+
+    // a packet written without fits() cannot be queued completely
+    std::string p = payloadFor(n, 1000);
+    client.publish("t/v", (const uint8_t*)p.data(), p.size());
+    CHECK(!transport.connected());
+    CHECK_EQ(transport.stats().errors, errors + 1);
+
+    broker.paused = false;
+    client.disconnect();
+}
+
+TEST(qos1_window_and_puback) {
+    CHECK(connectClient());
+    broker.acks = false;
+
+    uint32_t acked = transport.stats().qos1Acked;
+    uint32_t n = 0;
+    while (n < 50 && publishQos1(n, 200)) n++;
+
+    CHECK_EQ(n, MQTT_INFLIGHT_MAX);                      // window full
+    CHECK_EQ(transport.inflight(), MQTT_INFLIGHT_MAX);
+    CHECK(transport.stats().inflightFull > 0);
+    CHECK(delivered(n));
+
+    auto msgs = broker.messages();
+    for (uint32_t i = 0; i < n; i++) {
+        CHECK_EQ(msgs[i].qos, 1);
+        CHECK(!msgs[i].dup);
+        CHECK(msgs[i].id >= 0x8000);
+        CHECK(msgs[i].payload == payloadFor(i, 200));
+    }
+
+    // PUBACKs arrive through PubSubClient's loop() → window empty
+    broker.ackPending();
+    CHECK(loopUntil([] { return transport.inflight() == 0; }));
+    CHECK_EQ(transport.stats().qos1Acked, acked + n);
+    broker.acks = true;
+    CHECK(publishQos1(n, 200));
+    CHECK(loopUntil([] { return transport.inflight() == 0; }));
+}
+
+// window limited by bytes, not only by count
+TEST(qos1_window_bytes) {
+    CHECK(connectClient());
+    broker.acks = false;
+
+    uint32_t n = 0;
+    while (n < MQTT_INFLIGHT_MAX && publishQos1(n, 1500)) n++;
+    CHECK_EQ(n, MQTT_INFLIGHT_BYTES / 1510);
+
+    broker.ackPending();
+    CHECK(loopUntil([] { return transport.inflight() == 0; }));
+}
+
+// broker restart: unacknowledged packets go out again with DUP set
+TEST(qos1_resend_after_reconnect) {
+    CHECK(connectClient());
+    broker.acks = false;
+
+    for (uint32_t i = 0; i < 3; i++) CHECK(publishQos1(i, 300));
+    CHECK(delivered(3));
+    auto first = broker.messages();
+
+    broker.dropClient();
+    CHECK(loopUntil([] { return !client.connected(); }));
+    CHECK_EQ(transport.inflight(), 3);
+
+    CHECK(connectClient());
+    broker.acks = true;
+    uint32_t resent = transport.stats().qos1Resent;
+    transport.resendInflight();
+    CHECK_EQ(transport.stats().qos1Resent, resent + 3);
+
+    CHECK(delivered(3));
+    CHECK(loopUntil([] { return transport.inflight() == 0; }));
+
+    auto again = broker.messages();
+    for (uint32_t i = 0; i < 3; i++) {
+        CHECK(again[i].dup);
+        CHECK_EQ(again[i].id, first[i].id);
+        CHECK(again[i].payload == first[i].payload);
+    }
+}
+
+// no PUBACK at all → the connection counts as dead
+TEST(qos1_puback_timeout) {
+    CHECK(connectClient());
+    broker.acks = false;
+
+    CHECK(publishQos1(0, 100));
+    CHECK(delivered(1));
+
+    uint32_t errors = transport.stats().errors;
+    hostClockAdvance(MQTT_INFLIGHT_TIMEOUT_MS + 1);
+    transport.pump();
+    CHECK(!transport.connected());
+    CHECK_EQ(transport.stats().errors, errors + 1);
+    CHECK_EQ(transport.inflight(), 1);                   // kept for the resend
+
+    CHECK(connectClient());
+    transport.resendInflight();
+    CHECK(loopUntil([] { return transport.inflight() == 0; }));
+}
+
+TEST(publish_size) {
+    // fixed header 1 + length 1 + topic length 2 + "t/v" 3 + payload
+    CHECK_EQ(MqttTransport::publishSize("t/v", 10), 1 + 1 + 2 + 3 + 10);
+    CHECK_EQ(MqttTransport::publishSize("t/v", 10, 1), 1 + 1 + 2 + 3 + 2 + 10);
+    CHECK_EQ(MqttTransport::publishSize("t/v", 200), 1 + 2 + 2 + 3 + 200);
+}
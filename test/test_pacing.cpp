@@ -0,0 +1,88 @@
+// Adaptive pacing (py_pacing.cpp): percentile gap, AIMD fallback
+#include "host_test.h"
+#include "py_pacing.h"
+
+static void feed(PyPacing& p, PaceType t, int n, uint32_t fb, uint32_t total) {
+    for (int i = 0; i < n; i++) p.onResult(t, PACE_OK, fb, total, 1200);
+}
+
+// warm-up: no window yet → AIMD from PACE_GAP_START
+TEST(warmup_is_aimd) {
+    PyPacing p;
+    p.reset();
+    feed(p, PACE_PWR, 1, 30, 400);
+    CHECK_EQ(p.stats(PACE_PWR).gap, PACE_GAP_START - PACE_GAP_START / 8);
+    CHECK_EQ(p.stats(PACE_PWR).backoff, 0);
+}
+
+// enough samples → gap = p90(first byte) + margin
+TEST(gap_follows_first_byte_p90) {
+    PyPacing p;
+    p.reset();
+    feed(p, PACE_BAT, 14, 40, 900);
+    feed(p, PACE_BAT, 2, 120, 950);        // 2 of 16 slow echoes
+
+    const PaceStats& s = p.stats(PACE_BAT);
+    CHECK_EQ(s.firstByteP90, 120);          // rank ceil(0.9 × 16) = 15
+    CHECK_EQ(s.latencyP90, 950);
+    CHECK_EQ(s.gap, 120 + PACE_GAP_MARGIN);
+    CHECK_EQ(s.firstByteTimeout, PACE_FIRST_BYTE_MIN);   // 2 × 120 + 100 < MIN
+
+    // window slides: the slow echoes drop out
+    feed(p, PACE_BAT, 16, 40, 900);
+    CHECK_EQ(s.firstByteP90, 40);
+    CHECK_EQ(s.gap, 40 + PACE_GAP_MARGIN);
+}
+
+TEST(gap_never_below_min) {
+    PyPacing p;
+    p.reset();
+    feed(p, PACE_STAT, 8, 5, 200);
+    CHECK_EQ(p.stats(PACE_STAT).gap, PACE_GAP_MIN);
+}
+
+// invalid / timeout → backoff doubles on top, good frames decay it
+TEST(backoff_on_top_of_percentile) {
+    PyPacing p;
+    p.reset();
+    feed(p, PACE_PWR, 8, 80, 600);
+    const PaceStats& s = p.stats(PACE_PWR);
+    uint32_t base = 80 + PACE_GAP_MARGIN;
+    CHECK_EQ(s.gap, base);
+
+    p.onResult(PACE_PWR, PACE_INVALID, 0, 600, 0);
+    CHECK_EQ(s.gap, base * 2);
+    p.onResult(PACE_PWR, PACE_TIMEOUT, 0, 1500, 0);
+    CHECK_EQ(s.gap, base * 3);
+    CHECK_EQ(s.firstByteTimeout, PACE_FIRST_BYTE_MAX);
+
+    for (int i = 0; i < 40; i++) p.onResult(PACE_PWR, PACE_OK, 80, 600, 1200);
+    CHECK_EQ(s.backoff, 0);
+    CHECK_EQ(s.gap, base);
+
+    for (int i = 0; i < 20; i++) p.onResult(PACE_PWR, PACE_TIMEOUT, 0, 1500, 0);
+    CHECK_EQ(s.gap, PACE_GAP_MAX);
+}
+
+// a frame far beyond p90(frame end) backs off like an invalid one
+TEST(slow_frame_backs_off) {
+    PyPacing p;
+    p.reset();
+    feed(p, PACE_BAT, 8, 40, 900);
+    p.onResult(PACE_BAT, PACE_OK, 40, 900 + PACE_SLOW_MARGIN + 1, 1200);
+
+    const PaceStats& s = p.stats(PACE_BAT);
+    CHECK_EQ(s.slow, 1);
+    CHECK_EQ(s.ok, 9);
+    CHECK(s.backoff > 0);
+}
+
+TEST(reset_restarts_warmup) {
+    PyPacing p;
+    p.reset();
+    feed(p, PACE_PWR, 8, 40, 600);
+    p.reset();
+    const PaceStats& s = p.stats(PACE_PWR);
+    CHECK_EQ(s.gap, PACE_GAP_START);
+    CHECK_EQ(s.ok, 8);                      // statistics are kept
+}
@@ -0,0 +1,266 @@
+// Parser tests on the recorded console frames (test/corpus)
+#include "host_test.h"
+#include "py_parser_pwr.h"
+#include "py_parser_bat.h"
+#include "py_parser_stat.h"
+
+static FrameView view(const std::string& s) {
+    return FrameView(s.data(), s.size());
+}
+
+static PwrBuffer  pwr;
+static BatBuffer  bat;
+static StatBuffer stat;
+
+// ---------------------------------------------------------
+// Frame views / tokenizer
+// ---------------------------------------------------------
+TEST(view_helpers) {
+    FrameView v("  -1234 mAH \r\n", 14);
+    CHECK_EQ(viewToInt(v), -1234);
+    CHECK(viewEquals(viewTrim(v), "-1234 mAH"));
+    CHECK_EQ(viewFind(v, "mAH"), 8);
+    CHECK_EQ(viewFindLastChar(v, ' '), 11);
+
+    char buf[4];
+    CHECK_EQ(viewCopy(viewTrim(v), buf, sizeof(buf)), 3);
+    CHECK_STR(buf, "-12");
+}
+
+TEST(line_ends_and_columns) {
+    const char* s = "a\rb\r\n\r\n  c  \nBase State   Volt. State  12 mAH";
+    FrameView rest(s, strlen(s)), line;
+
+    CHECK(frameNextLine(rest, line) && viewEquals(line, "a"));
+    CHECK(frameNextLine(rest, line) && viewEquals(line, "b"));
+    CHECK(frameNextLine(rest, line) && viewEquals(line, "c"));
+    CHECK(frameNextLine(rest, line));
+
+    FrameView cols[4];
+    CHECK_EQ(frameSplitColumns(line, cols, 4), 3);
+    CHECK(viewEquals(cols[0], "Base State"));
+    CHECK(viewEquals(cols[2], "12 mAH"));
+    CHECK_EQ(frameSplitWS(line, cols, 4), 4);
+    CHECK(!frameNextLine(rest, line));
+}
+
+// ---------------------------------------------------------
+// PWR
+// ---------------------------------------------------------
+TEST(pwr_frame) {
+    std::string f = corpusFrame("pwr.txt");
+    CHECK_EQ(parsePwrFrame(view(f), pwr), PARSE_OK);
+
+    // parsing stops at the first "Absent" module
+    CHECK_EQ(pwr.moduleCount, 3);
+    CHECK_EQ(pwr.header.count, 22);
+
+    const BatteryModule& m = pwr.modules[1];
+    CHECK(m.present);
+    CHECK_EQ(m.index, 2);
+    CHECK_EQ(m.voltage_mV, 50376);
+    CHECK_EQ(m.current_mA, -1150);
+    CHECK_EQ(m.temperature, 20400);
+    CHECK_EQ(m.soc, 76);
+
+    // date and time tokens are merged into the "Time" column
+    CHECK_STR(m.field(pwr.header.find("Time")), "2023-01-26 19:43:51");
+    CHECK_STR(m.field(pwr.header.find("Base.St")), "Dischg");
+    CHECK_STR(m.field(pwr.header.find("M.T.St")), "Normal");
+
+    CHECK_EQ(pwr.stack.batteryCount, 3);
+    CHECK_EQ(pwr.stack.avgVoltage_mV, (50383 + 50376 + 50391) / 3);
+    CHECK_EQ(pwr.stack.totalCurrent_mA, -1109 - 1150 - 1092);
+    CHECK_EQ(pwr.stack.soc, 72);
+    CHECK_EQ(pwr.stack.temperature, 21000);
+}
+
+TEST(pwr_header_revision_only_changes_with_columns) {
+    std::string f = corpusFrame("pwr.txt");
+    parsePwrFrame(view(f), pwr);
+    uint16_t rev = pwr.header.revision;
+
+    parsePwrFrame(view(f), pwr);
+    CHECK_EQ(pwr.header.revision, rev);
+
+    std::string g = f;
+    g.replace(g.find("MosTempr"), 8, "MosTemp2");
+    CHECK_EQ(parsePwrFrame(view(g), pwr), PARSE_OK);
+    CHECK_EQ(pwr.header.revision, rev + 1);
+}
+
+TEST(pwr_truncated_frame) {
+    std::string f = corpusFrame("pwr_truncated.txt");
+    CHECK_EQ(parsePwrFrame(view(f), pwr), PARSE_FAIL);
+    CHECK_EQ(pwr.moduleCount, 0);
+}
+
+TEST(pwr_implausible_values) {
+    std::string f = corpusFrame("pwr_implausible.txt");
+    CHECK_EQ(parsePwrFrame(view(f), pwr), PARSE_FAIL);
+    CHECK_EQ(pwr.moduleCount, 0);
+}
+
+TEST(pwr_end_before_start) {
+    std::string f = corpusFrame("pwr_swapped.txt");
+    CHECK_EQ(parsePwrFrame(view(f), pwr), PARSE_FAIL);
+}
+
+TEST(garbage_is_rejected_by_all_parsers) {
+    std::string f = corpusFrame("garbage.txt");
+    CHECK_EQ(parsePwrFrame(view(f), pwr), PARSE_FAIL);
+    CHECK_EQ(parseBatFrame(1, view(f), bat), PARSE_FAIL);
+    CHECK_EQ(parseStatFrame(1, view(f), stat.stat), PARSE_FAIL);
+
+    CHECK_EQ(parsePwrFrame(FrameView(), pwr), PARSE_FAIL);
+}
+
+// ---------------------------------------------------------
+// BAT
+// ---------------------------------------------------------
+TEST(bat_frame) {
+    std::string f = corpusFrame("bat_1.txt");
+    CHECK_EQ(parseBatFrame(1, view(f), bat), PARSE_OK);
+
+    CHECK_EQ(bat.cells.moduleIndex, 1);
+    CHECK_EQ(bat.cells.cellCount, 15);
+    CHECK_EQ(bat.schema.colCount, 11);
+
+    int volt    = batFindColumn(bat.schema, "Volt");
+    int state   = batFindColumn(bat.schema, "Base State");
+    int coulomb = batFindColumn(bat.schema, "Coulomb");
+    int soc     = batFindColumn(bat.schema, "SOC");
+    int bal     = batFindColumn(bat.schema, "BAL");
+    CHECK(volt >= 0 && state >= 0 && coulomb >= 0 && soc >= 0 && bal >= 0);
+
+    CHECK(batIsNumeric(bat.schema, volt));
+    CHECK(!batIsNumeric(bat.schema, state));
+    CHECK_EQ(bat.cells.values[volt][0], 3356);
+
+    // raw text is rebuilt exactly (suffix + enum dictionary)
+    char buf[24];
+    batFormatValue(bat, coulomb, 1, buf, sizeof(buf));
+    CHECK_STR(buf, "37104 mAH");
+    batFormatValue(bat, soc, 14, buf, sizeof(buf));
+    CHECK_STR(buf, "74%");
+    batFormatValue(bat, state, 3, buf, sizeof(buf));
+    CHECK_STR(buf, "Dischg");
+    batFormatValue(bat, bal, 4, buf, sizeof(buf));
+    CHECK_STR(buf, "Y");
+    batFormatValue(bat, bal, 5, buf, sizeof(buf));
+    CHECK_STR(buf, "N");
+}
+
+TEST(bat_paged_frame_keeps_all_cells) {
+    // response as received after the RX path answered "Press [Enter]"
+    std::string f = corpusFrame("bat_2_paged.txt");
+    CHECK_EQ(parseBatFrame(2, view(f), bat), PARSE_OK);
+    CHECK_EQ(bat.cells.cellCount, 15);
+
+    int volt = batFindColumn(bat.schema, "Volt");
+    CHECK_EQ(bat.cells.values[volt][10], 3355);
+    CHECK_EQ(bat.cells.values[volt][14], 3356);
+}
+
+TEST(bat_header_only) {
+    std::string f = corpusFrame("bat_header_only.txt");
+    CHECK_EQ(parseBatFrame(3, view(f), bat), PARSE_OK);
+    CHECK_EQ(bat.cells.cellCount, 0);
+}
+
+// numeric columns are typed from all rows: a gap ("-", "N/A") in the
+// first row stays a gap, more decimals in a later row widen the column
+TEST(bat_columns_typed_from_all_rows) {
+    std::string f = corpusFrame("bat_gaps_decimals.txt");
+    CHECK_EQ(parseBatFrame(4, view(f), bat), PARSE_OK);
+    CHECK_EQ(bat.cells.cellCount, 4);
+
+    int volt  = batFindColumn(bat.schema, "Volt");
+    int tempr = batFindColumn(bat.schema, "Tempr");
+    int state = batFindColumn(bat.schema, "Base State");
+    int soc   = batFindColumn(bat.schema, "SOC");
+    CHECK(volt >= 0 && tempr >= 0 && state >= 0 && soc >= 0);
+
+    CHECK(batIsNumeric(bat.schema, volt));
+    CHECK(batIsNumeric(bat.schema, soc));
+    CHECK(!batIsNumeric(bat.schema, state));
+    CHECK_EQ(bat.schema.cols[volt].decimals, 4);
+    CHECK_EQ(bat.schema.cols[tempr].decimals, 2);
+
+    CHECK_EQ(bat.cells.values[volt][0], BAT_VALUE_NONE);
+    CHECK_EQ(bat.cells.values[volt][1], 33510);
+    CHECK_EQ(bat.cells.values[volt][3], 33496);
+    CHECK_EQ(bat.cells.values[tempr][0], 2010);
+    CHECK_EQ(bat.cells.values[tempr][1], 2015);
+    CHECK_EQ(bat.cells.values[soc][1], BAT_VALUE_NONE);
+
+    // only real enum texts end up in the dictionary
+    CHECK_EQ(bat.schema.enumCount, 2);
+
+    char buf[24];
+    batFormatValue(bat, soc, 2, buf, sizeof(buf));
+    CHECK_STR(buf, "75%");
+}
+
+TEST(bat_module_index_out_of_range) {
+    std::string f = corpusFrame("bat_1.txt");
+    CHECK_EQ(parseBatFrame(0, view(f), bat), PARSE_IGNORED);
+    CHECK_EQ(parseBatFrame(MAX_MODULES + 1, view(f), bat), PARSE_IGNORED);
+}
+
+// ---------------------------------------------------------
+// STAT
+// ---------------------------------------------------------
+static const StatField* statField(const StatData& s, const char* name) {
+    for (uint8_t i = 0; i < s.fieldCount; i++)
+        if (strcmp(s.fields[i].name, name) == 0) return &s.fields[i];
+    return nullptr;
+}
+
+TEST(stat_frame) {
+    std::string f = corpusFrame("stat_1.txt");
+    CHECK_EQ(parseStatFrame(1, view(f), stat.stat), PARSE_OK);
+
+    CHECK_EQ(stat.stat.moduleIndex, 1);
+    CHECK_EQ(stat.stat.fieldCount, 20);
+
+    const StatField* cycles = statField(stat.stat, "Cycle Times");
+    const StatField* soh    = statField(stat.stat, "SOH Status");
+    CHECK(cycles && strcmp(cycles->raw, "412") == 0);
+    CHECK(soh && strcmp(soh->raw, "Normal") == 0);
+}
+
+TEST(stat_paged_frame) {
+    std::string f = corpusFrame("stat_1.txt");
+    size_t at = f.find("Bat Cnt.");
+    f.insert(at, "Press [Enter] to be continued\r\n");
+
+    CHECK_EQ(parseStatFrame(1, view(f), stat.stat), PARSE_OK);
+    CHECK_EQ(stat.stat.fieldCount, 20);
+    CHECK(statField(stat.stat, "Press [Enter] to be") == nullptr);
+}
+
+TEST(stat_truncated_frame) {
+    std::string f = corpusFrame("stat_1.txt");
+    f.resize(f.find("Pwr Percent"));
+    CHECK_EQ(parseStatFrame(1, view(f), stat.stat), PARSE_FAIL);
+}
+
+// ---------------------------------------------------------
+// Zero-copy: parsing does not touch the heap
+// ---------------------------------------------------------
+TEST(parsers_do_not_allocate) {
+    std::string p = corpusFrame("pwr.txt");
+    std::string b = corpusFrame("bat_2_paged.txt");
+    std::string s = corpusFrame("stat_1.txt");
+    std::string g = corpusFrame("pwr_truncated.txt");
+
+    size_t before = hostAllocCount();
+    for (int i = 0; i < 10; i++) {
+        parsePwrFrame(view(p), pwr);
+        parseBatFrame(2, view(b), bat);
+        parseStatFrame(1, view(s), stat.stat);
+        parsePwrFrame(view(g), pwr);
+    }
+    CHECK_EQ(hostAllocCount() - before, 0);
+}
@@ -0,0 +1,123 @@
+// Seqlock snapshots (py_snapshot.h): Snapshot<T> and SnapshotRing<T, N>
+#include "host_test.h"
+#include "py_snapshot.h"
+#include <thread>
+
+struct Sample {
+    uint32_t module;
+    uint32_t values[64];     // all = module × 1000 + generation
+};
+
+static void fill(Sample& s, uint32_t module, uint32_t gen) {
+    s.module = module;
+    for (uint32_t& v : s.values) v = module * 1000 + gen;
+}
+
+static bool whole(const Sample& s) {
+    for (uint32_t v : s.values)
+        if (v != s.values[0] || v / 1000 != s.module) return false;
+    return true;
+}
+
+TEST(snapshot_generation) {
+    static Snapshot<Sample> snap;
+    Sample s;
+    CHECK_EQ(snap.generation(), 0);
+
+    fill(s, 1, 1);
+    snap.publish(s);
+    fill(s, 2, 2);
+    snap.publish(s);
+
+    Sample out;
+    CHECK_EQ(snap.read(out), 2);
+    CHECK_EQ(out.module, 2);
+}
+
+// every module result is seen once, in order
+TEST(ring_cursor_walks_every_result) {
+    static SnapshotRing<Sample, 4> ring;
+    Sample s, out;
+    uint32_t cursor = 0;
+
+    CHECK_EQ(ring.readAt(cursor, out), SNAP_NONE);
+    CHECK_EQ(ring.latest(out), 0);
+
+    for (uint32_t m = 1; m <= 3; m++) {
+        fill(s, m, m);
+        ring.publish(s);
+    }
+
+    for (uint32_t m = 1; m <= 3; m++) {
+        CHECK_EQ(ring.readAt(cursor, out), SNAP_OK);
+        CHECK_EQ(out.module, m);
+        cursor++;
+    }
+    CHECK_EQ(ring.readAt(cursor, out), SNAP_NONE);
+
+    CHECK_EQ(ring.latest(out), 3);
+    CHECK_EQ(out.module, 3);
+}
+
+// consumer that did not advance (publish deferred) gets the same entry
+TEST(ring_entry_is_kept_until_the_cursor_moves) {
+    static SnapshotRing<Sample, 4> ring;
+    Sample s, out;
+    uint32_t cursor = 0;
+
+    fill(s, 5, 1);
+    ring.publish(s);
+    CHECK_EQ(ring.readAt(cursor, out), SNAP_OK);
+    CHECK_EQ(ring.readAt(cursor, out), SNAP_OK);
+    CHECK_EQ(out.module, 5);
+    CHECK_EQ(cursor, 0);
+}
+
+TEST(ring_lapped_consumer_skips_to_the_oldest_kept) {
+    static SnapshotRing<Sample, 4> ring;
+    Sample s, out;
+    uint32_t cursor = 0;
+
+    for (uint32_t m = 1; m <= 7; m++) {
+        fill(s, m, m);
+        ring.publish(s);
+    }
+
+    CHECK_EQ(ring.readAt(cursor, out), SNAP_LAPPED);
+    CHECK_EQ(cursor, 3);
+    CHECK_EQ(ring.readAt(cursor, out), SNAP_OK);
+    CHECK_EQ(out.module, 4);
+}
+
+// one writer, concurrent readers: never a torn copy
+TEST(ring_concurrent_reader_never_tears) {
+    static SnapshotRing<Sample, 4> ring;
+    std::atomic<bool> stop{false};
+    int bad = 0, seen = 0;
+
+    std::thread writer([&] {
+        Sample s;
+        for (uint32_t g = 1; !stop; g++) {
+            fill(s, 1 + g % 16, g % 1000);
+            ring.publish(s);
+        }
+    });
+
+    uint32_t cursor = 0;
+    Sample out;
+    uint64_t until = hostNowNs() + 300000000ull;
+    while (hostNowNs() < until) {
+        SnapRead r = ring.readAt(cursor, out);
+        if (r == SNAP_OK) {
+            seen++;
+            if (!whole(out)) bad++;
+            cursor++;
+        }
+        if (ring.latest(out) && !whole(out)) bad++;
+    }
+    stop = true;
+    writer.join();
+
+    CHECK(seen > 0);
+    CHECK_EQ(bad, 0);
+}
@@ -0,0 +1,193 @@
+// Event-driven RX path (py_uart) against the replayed console
+#include "host_test.h"
+#include "host_console.h"
+#include "py_uart.h"
+#include "py_pipeline.h"
+#include "config.h"
+
+static PyUart uart;
+
+// Console + UART once for all tests (begin() runs the wake-up)
+static HostConsole& console() {
+    static HostConsole* c = nullptr;
+    if (!c) {
+        c = new HostConsole(Serial2);
+        c->respond("pwr",   corpusFrame("pwr.txt"));
+        c->respond("bat 1", corpusFrame("bat_1.txt"));
+        c->respond("bat 2", corpusFrame("bat_2_paged.txt"));
+        c->respond("stat 1", corpusFrame("stat_1.txt"));
+        c->respond("pwr_truncated", corpusFrame("pwr_truncated.txt"));
+        c->silence("stat 9");
+
+        frameQueue = xQueueCreate(FRAME_QUEUE_LEN, sizeof(FrameDesc));
+        uart.begin(16, 17);
+        c->waitIdle();
+        while (Serial2.available()) Serial2.read();   // wake-up prompt
+    }
+    return *c;
+}
+
+// Frame handed to the parser stage, as the parser task would take it
+static bool takeFrame(FrameDesc& d) {
+    return xQueueReceive(frameQueue, &d, 0) == pdTRUE;
+}
+
+static bool sameAsCorpus(int slot, const char* file) {
+    FrameView v = frameStore.view(slot);
+    std::string want = corpusFrame(file);
+    return v.len == want.size() && memcmp(v.data, want.data(), v.len) == 0;
+}
+
+TEST(wakeup_and_ready) {
+    console();
+    CHECK(uart.isReady());
+    CHECK(!uart.isBusy());
+}
+
+TEST(pwr_end_to_end) {
+    console().chunk = 64;
+    uint32_t gen = pwrSnapshot.generation();
+
+    CHECK(uart.sendCommand("pwr"));
+    CHECK(uart.isFrameValid());
+
+    FrameDesc d;
+    CHECK(takeFrame(d));
+    CHECK_EQ(d.type, FRAME_PWR);
+    CHECK(sameAsCorpus(d.slot, "pwr.txt"));
+
+    CHECK_EQ(processFrame(d), PARSE_OK);
+    frameStore.release(d.slot);
+    CHECK_EQ(pwrSnapshot.generation(), gen + 1);
+
+    PwrBuffer p;
+    pwrSnapshot.read(p);
+    CHECK_EQ(p.moduleCount, 3);
+    CHECK(p.updatedAt > 1700000000);                // host clock is set
+}
+
+// "$$" / "pylon>" split over driver events in every possible way
+// (up to the 1024 byte driver ring: more per event would overflow it)
+TEST(chunk_boundaries) {
+    static const size_t sizes[] = { 1, 2, 3, 7, 64, 120, 1024 };
+    for (size_t s : sizes) {
+        console().chunk = s;
+        CHECK(uart.sendCommand("bat 1"));
+
+        FrameDesc d;
+        CHECK(takeFrame(d));
+        CHECK_EQ(d.type, FRAME_BAT);
+        CHECK_EQ(d.moduleIndex, 1);
+        CHECK(sameAsCorpus(d.slot, "bat_1.txt"));
+        frameStore.release(d.slot);
+    }
+    console().chunk = 64;
+}
+
+TEST(paging_is_answered_with_enter) {
+    uint32_t enters = console().enters;
+
+    // complete response after one <Enter>; isValidFrame() only accepts
+    // paged output in "Remote command:" mode → not parsed, but the web
+    // console sees the whole frame
+    CHECK(!uart.sendCommand("bat 2", true));
+    CHECK_EQ(console().enters, enters + 1);
+
+    int slot = frameStore.acquireLast();
+    CHECK(slot >= 0);
+    CHECK(sameAsCorpus(slot, "bat_2_paged.txt"));
+    frameStore.release(slot);
+
+    FrameDesc d;
+    CHECK(!takeFrame(d));
+}
+
+TEST(truncated_response_ends_on_idle) {
+    // no "$$ ... pylon>": the RX idle timeout hands the bytes over
+    uint32_t seq = frameStore.lastSequence();
+    CHECK(!uart.sendCommand("pwr_truncated", true));
+    CHECK_EQ(frameStore.lastSequence(), seq + 1);
+    CHECK(!uart.isFrameValid());
+
+    int slot = frameStore.acquireLast();
+    CHECK(sameAsCorpus(slot, "pwr_truncated.txt"));
+    frameStore.release(slot);
+}
+
+// Only console commands replace the console's last frame
+TEST(last_frame_is_the_console_response) {
+    uint32_t seq = frameStore.lastSequence();
+    FrameDesc d;
+
+    CHECK(uart.sendCommand("pwr"));                 // scheduled poll
+    CHECK(takeFrame(d));
+    frameStore.release(d.slot);
+    CHECK_EQ(frameStore.lastSequence(), seq);
+
+    CHECK(uart.sendCommand("stat 1", true));        // console command
+    CHECK(takeFrame(d));
+
+    uint32_t got;
+    int slot = frameStore.acquireLast(&got);
+    CHECK_EQ(got, seq + 1);
+    CHECK_EQ(slot, d.slot);                         // parser and console share it
+    CHECK(sameAsCorpus(slot, "stat_1.txt"));
+    frameStore.release(slot);
+    frameStore.release(d.slot);
+}
+
+TEST(no_response_times_out) {
+    unsigned long t0 = millis();
+    CHECK(!uart.sendCommand("stat 9"));
+    CHECK(millis() - t0 >= PACE_FIRST_BYTE_MIN);
+    CHECK(!uart.isBusy());
+}
+
+TEST(stat_after_errors) {
+    CHECK(uart.sendCommand("stat 1"));
+    FrameDesc d;
+    CHECK(takeFrame(d));
+    CHECK_EQ(d.type, FRAME_STAT);
+    CHECK_EQ(processFrame(d), PARSE_OK);
+    frameStore.release(d.slot);
+
+    StatBuffer s;
+    statSnapshot.latest(s);
+    CHECK_EQ(s.stat.moduleIndex, 1);
+    CHECK_EQ(s.stat.fieldCount, 20);
+}
+
+// Everything holding a slot at once: the RX path still gets one
+TEST(rx_slot_with_full_pipeline) {
+    FrameDesc parsing, queued;
+
+    CHECK(uart.sendCommand("pwr"));
+    CHECK(takeFrame(parsing));                      // parser task busy with it
+
+    CHECK(!uart.sendCommand("pwr_truncated", true)); // last frame = invalid slot
+    int reader = frameStore.acquireLast();          // web console reading it
+
+    CHECK(uart.sendCommand("bat 1"));               // frameQueue full
+    CHECK(uart.sendCommand("stat 1"));
+    CHECK(!uart.sendCommand("pwr_truncated", true)); // new last frame
+
+    int rx = frameStore.acquire();
+    CHECK(rx >= 0);
+
+    frameStore.release(rx);
+    frameStore.release(reader);
+    frameStore.release(parsing.slot);
+    while (takeFrame(queued)) frameStore.release(queued.slot);
+}
+
+TEST(slots_are_returned) {
+    // everything above released its references: only "last frame" holds one
+    int held = 0;
+    int got[FRAME_SLOTS];
+    for (int i = 0; i < FRAME_SLOTS; i++) {
+        got[i] = frameStore.acquire();
+        if (got[i] >= 0) held++;
+    }
+    CHECK_EQ(held, FRAME_SLOTS - 1);
+    for (int i = 0; i < FRAME_SLOTS; i++) frameStore.release(got[i]);
+}
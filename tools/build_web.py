@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Build the web UI for SPIFFS: data/ -> data_build/
+
+  * minify   html / css / js (comments, indentation, empty lines only -
+             no parser, nothing that could change behaviour)
+  * gzip     text files are stored as <name>.gz (level 9, mtime 0 so
+             the output is reproducible); png is stored as is
+  * hash     8 hex digits of the SHA-256 of the final (uncompressed)
+             content
+  * fingerprint
+             assets that are referenced by URL (js, css, png, json) are
+             renamed to /<base>.<hash>.<ext> in every file referencing
+             them. The file itself keeps its plain name on SPIFFS (object
+             names are limited to 31 characters); the web server strips
+             the hash again. Pages (*.html) keep their names.
+  * manifest manifest.json: path -> hash / gz / url. The device uses it
+             for ETag and Cache-Control (see web/static_files.h).
+
+Usage:
+    python3 tools/build_web.py [--src data] [--out data_build]
+
+Then upload the content of data_build/ with the file manager
+(http://<device>/filemanager) instead of data/.
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+import sys
+
+TEXT_TYPES = {".html", ".css", ".js", ".json"}
+SPIFFS_NAME_MAX = 31
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{}:;,])\s*", r"\1", text)
+    return text.replace(";}", "}").strip() + "\n"
+
+
+def minify_js(text):
+    out = []
+    for line in text.split("\n"):
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        out.append(line)
+    return "\n".join(out) + "\n"
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    out = [line.strip() for line in text.split("\n")]
+    return "\n".join(line for line in out if line) + "\n"
+
+
+def minify_json(text):
+    return json.dumps(json.loads(text), separators=(",", ":"), ensure_ascii=False) + "\n"
+
+
+MINIFY = {
+    ".css": minify_css,
+    ".js": minify_js,
+    ".html": minify_html,
+    ".json": minify_json,
+}
+
+
+def short_hash(data):
+    return hashlib.sha256(data).hexdigest()[:8]
+
+
+def fingerprinted(name, digest):
+    base, ext = os.path.splitext(name)
+    return "%s.%s%s" % (base, digest, ext)
+
+
+def reference_pattern(name):
+    # "/name" inside quotes or url(...), optionally followed by ?query / #hash
+    return re.compile(r"""(["'(])/%s(?=["')?#])""" % re.escape(name))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--src", default="data")
+    ap.add_argument("--out", default="data_build")
+    args = ap.parse_args()
+
+    names = sorted(n for n in os.listdir(args.src)
+                   if os.path.isfile(os.path.join(args.src, n)))
+
+    content = {}
+    for name in names:
+        with open(os.path.join(args.src, name), "rb") as f:
+            data = f.read()
+        ext = os.path.splitext(name)[1]
+        if ext in TEXT_TYPES:
+            text = data.decode("utf-8").replace("\r\n", "\n")
+            data = MINIFY[ext](text).encode("utf-8")
+        content[name] = data
+
+    # assets = everything referenced by URL from another file
+    patterns = {n: reference_pattern(n) for n in names if not n.endswith(".html")}
+    refs = {}
+    for name in names:
+        if os.path.splitext(name)[1] not in TEXT_TYPES:
+            refs[name] = set()
+            continue
+        text = content[name].decode("utf-8")
+        refs[name] = {a for a, p in patterns.items() if a != name and p.search(text)}
+    assets = set().union(*refs.values())
+
+    # resolve in dependency order: a file is hashed after the files it references
+    hashes = {}
+    pending = list(names)
+    while pending:
+        ready = [n for n in pending if refs[n] <= set(hashes)]
+        if not ready:
+            sys.exit("reference cycle between: %s" % ", ".join(pending))
+        for name in ready:
+            if refs[name]:
+                text = content[name].decode("utf-8")
+                for a in refs[name]:
+                    text = patterns[a].sub(lambda m: m.group(1) + "/" + fingerprinted(a, hashes[a]), text)
+                content[name] = text.encode("utf-8")
+            hashes[name] = short_hash(content[name])
+            pending.remove(name)
+
+    if os.path.isdir(args.out):
+        shutil.rmtree(args.out)
+    os.makedirs(args.out)
+
+    manifest = {}
+    total_in = total_out = 0
+
+    for name in names:
+        data = content[name]
+        gz = os.path.splitext(name)[1] in TEXT_TYPES
+        stored = name + ".gz" if gz else name
+        if gz:
+            data = gzip.compress(data, 9, mtime=0)
+
+        if len("/" + stored) > SPIFFS_NAME_MAX:
+            sys.exit("name too long for SPIFFS (max %d): /%s" % (SPIFFS_NAME_MAX, stored))
+
+        with open(os.path.join(args.out, stored), "wb") as f:
+            f.write(data)
+
+        entry = {"hash": hashes[name], "gz": gz}
+        if name in assets:
+            entry["url"] = "/" + fingerprinted(name, hashes[name])
+        manifest["/" + name] = entry
+
+        size_in = os.path.getsize(os.path.join(args.src, name))
+        total_in += size_in
+        total_out += len(data)
+        print("%-28s %7d -> %7d  %s" % (stored, size_in, len(data), entry.get("url", "")))
+
+    with open(os.path.join(args.out, "manifest.json"), "w") as f:
+        json.dump({"files": manifest}, f, separators=(",", ":"))
+
+    print("%-28s %7d -> %7d" % ("total", total_in, total_out))
+
+
+if __name__ == "__main__":
+    main()
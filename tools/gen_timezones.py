@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Generate py_timezone_data.h from tools/timezone.json
+
+  timezone.json   {"Europe": [{"city": "Berlin", "tz": "Europe/Berlin",
+                               "posix": "CET-1CEST-2,..."}, ...], ...}
+
+The output is included by py_timezones.cpp only:
+
+  TIMEZONES[]         entries grouped by region, in file order (UI order)
+  TIMEZONE_REGIONS[]  region name + first entry + count
+  TIMEZONE_BY_NAME[]  entry indices sorted by IANA name (strcmp order)
+                      for the binary search in findTimezone()
+
+All tables are constexpr and end up in flash; nothing is parsed at
+run time.
+
+Usage:
+    python3 tools/gen_timezones.py [--src tools/timezone.json] [--out py_timezone_data.h]
+
+Run it after editing timezone.json and commit both files.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def c_string(s):
+    if any(ord(c) < 0x20 or ord(c) > 0x7e for c in s):
+        sys.exit("non-ASCII or control character in %r" % s)
+    return '"%s"' % s.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--src", default=os.path.join(HERE, "timezone.json"))
+    ap.add_argument("--out", default=os.path.join(HERE, "..", "py_timezone_data.h"))
+    args = ap.parse_args()
+
+    with open(args.src, encoding="utf-8") as f:
+        data = json.load(f)
+
+    entries = []
+    regions = []
+    for region, items in data.items():
+        regions.append((region, len(entries), len(items)))
+        for e in items:
+            entries.append((region, e["city"], e["tz"], e["posix"]))
+
+    names = [e[2] for e in entries]
+    dup = {n for n in names if names.count(n) > 1}
+    if dup:
+        sys.exit("duplicate timezone: %s" % ", ".join(sorted(dup)))
+    if len(entries) > 255:
+        sys.exit("more than 255 timezones, widen TIMEZONE_BY_NAME")
+
+    # strcmp order = byte order (ASCII only, checked above)
+    by_name = sorted(range(len(entries)), key=lambda i: entries[i][2].encode())
+
+    out = []
+    out.append("// Generated by tools/gen_timezones.py from tools/timezone.json - do not edit")
+    out.append("#pragma once")
+    out.append('#include "py_timezones.h"')
+    out.append("")
+    out.append("constexpr TimezoneEntry TIMEZONES[] = {")
+    for region, city, tz, posix in entries:
+        out.append("    { %s, %s, %s, %s }," % (c_string(region), c_string(city), c_string(tz), c_string(posix)))
+    out.append("};")
+    out.append("")
+    out.append("constexpr TimezoneRegion TIMEZONE_REGIONS[] = {")
+    for name, first, count in regions:
+        out.append("    { %s, %d, %d }," % (c_string(name), first, count))
+    out.append("};")
+    out.append("")
+    out.append("constexpr uint8_t TIMEZONE_BY_NAME[] = {")
+    for i in range(0, len(by_name), 16):
+        out.append("    " + " ".join("%d," % n for n in by_name[i:i + 16]))
+    out.append("};")
+    out.append("")
+    out.append("constexpr size_t TIMEZONE_COUNT        = %d;" % len(entries))
+    out.append("constexpr size_t TIMEZONE_REGION_COUNT = %d;" % len(regions))
+    out.append("")
+
+    with open(args.out, "w", newline="\n") as f:
+        f.write("\n".join(out))
+
+    print("%s: %d timezones in %d regions" % (os.path.normpath(args.out), len(entries), len(regions)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,55 @@
+#pragma once
+#include "../py_http_server.h"
+#include "../config.h"
+
+extern HttpServer server;
+extern AppConfig config;
+
+// ---------------------------------------------------------
+// Conditional GET for the data APIs
+// ---------------------------------------------------------
+// ETag = "<api>-<boot>-<generation>-<config revision>"
+//
+// The generation counts the parser results behind the snapshot, the
+// config revision every load()/save(), boot is random per start
+// (generations begin at 0 again after a reboot). Same tag → same
+// document, so If-None-Match is answered with 304 before the snapshot
+// is read or anything is encoded:
+//
+//   char etag[API_ETAG_LEN];
+//   if (apiNotModified(etag, 'p', pwrSnapshot.generation())) return;
+//   uint32_t gen = pwrSnapshot.read(webPwr);
+//   apiSendETag(etag, 'p', gen);      // tag of the copy actually sent
+//
+// Cache-Control no-cache: the browser keeps the body, but asks every
+// time - fetch() sends If-None-Match by itself.
+// ---------------------------------------------------------
+
+#define API_ETAG_LEN  48
+
+static void apiETag(char* etag, char api, uint32_t gen) {
+    static uint32_t boot = 0;
+    while (boot == 0) boot = esp_random();
+
+    snprintf(etag, API_ETAG_LEN, "\"%c-%08lx-%lu-%lu\"", api,
+             (unsigned long)boot, (unsigned long)gen,
+             (unsigned long)config.revision);
+}
+
+// true → 304 sent, handler is done
+static bool apiNotModified(char* etag, char api, uint32_t gen) {
+    apiETag(etag, api, gen);
+    if (server.header("If-None-Match") != etag) return false;
+
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Cache-Control", "no-cache");
+    server.send(304);
+    return true;
+}
+
+// Headers for the full response (before JsonStream::begin)
+static void apiSendETag(char* etag, char api, uint32_t gen) {
+    apiETag(etag, api, gen);
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Cache-Control", "no-cache");
+}
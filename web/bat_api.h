@@ -1,151 +1,178 @@
-#pragma once
-#include <ArduinoJson.h>
-#include "../wp_webserver.h"
-#include "../py_parser_bat.h"
-#include "../config.h"
-
-static void handleApiBatCells();
-
-static void registerBatAPI() {
-    server.on("/api/bat/cells", HTTP_GET, handleApiBatCells);
-}
-
-static void handleApiBatCells() {
-    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    server.send(200, "application/json", "");
-
-    server.sendContent("{");
-
-    // CONFIG
-    server.sendContent("\"config\":{");
-    server.sendContent("\"intervalBat\":");
-    server.sendContent(String(config.battery.intervalBat));
-    server.sendContent(",");
-    server.sendContent("\"enableBat\":");
-    server.sendContent(config.battery.enableBat ? "true" : "false");
-    server.sendContent("},");
-
-    // MQTT
-    server.sendContent("\"mqtt\":{");
-    server.sendContent("\"topicBat\":\"");
-    server.sendContent(config.mqtt.topicBat);
-    server.sendContent("\",");
-    server.sendContent("\"cellPrefix\":\"");
-    server.sendContent(config.mqtt.cellPrefix);
-    server.sendContent("\"");
-    server.sendContent("},");
-
-    // HEADERS
-    server.sendContent("\"headers\":[");
-    for (size_t i = 0; i < lastParsedBat.fields.size(); i++) {
-        if (i > 0) server.sendContent(",");
-        server.sendContent("\"");
-        server.sendContent(lastParsedBat.fields[i].name);
-        server.sendContent("\"");
-    }
-    server.sendContent("],");
-
-    // VALUES
-    server.sendContent("\"values\":[");
-    for (size_t i = 0; i < lastParsedBat.fields.size(); i++) {
-        if (i > 0) server.sendContent(",");
-        server.sendContent("\"");
-        server.sendContent(lastParsedBat.fields[i].raw);
-        server.sendContent("\"");
-    }
-    server.sendContent("],");
-
-    // FIELDS (nur NVS-Felder!)
-    server.sendContent("\"fields\":[");
-
-    bool first = true;
-    for (auto &pf : lastParsedBat.fields) {
-
-        // Nur Felder aus NVS zurückgeben
-        if (!config.battery.fieldsBat.count(pf.name)) {
-            continue;
-        }
-
-        const FieldConfig &f = config.battery.fieldsBat.at(pf.name);
-
-        DynamicJsonDocument doc(256);
-        JsonObject o = doc.to<JsonObject>();
-
-        o["name"]        = pf.name;
-        o["display"]     = f.display;
-        o["factor"]      = f.factor;
-        o["unit"]        = f.unit;
-        o["sendMQTT"]    = f.mqtt;
-        o["sendPayload"] = f.send;
-        o["raw"]         = pf.raw;
-        o["value"]       = pf.raw;
-
-        String tmp;
-        serializeJson(o, tmp);
-
-        if (!first) server.sendContent(",");
-        first = false;
-
-        server.sendContent(tmp);
-    }
-
-    server.sendContent("]");
-
-    server.sendContent("}");
-}
-
-static void handleApiBatSet() {
-
-    if (!server.hasArg("plain")) {
-        server.send(400, "text/plain", "Missing body");
-        return;
-    }
-
-    DynamicJsonDocument req(4096);
-    if (deserializeJson(req, server.arg("plain"))) {
-        server.send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-
-    // CONFIG
-    config.battery.intervalBat = req["config"]["intervalBat"] | config.battery.intervalBat;
-    config.battery.enableBat   = req["config"]["enableBat"]   | config.battery.enableBat;
-
-    // MQTT
-    config.mqtt.topicBat   = req["mqtt"]["topicBat"]   | config.mqtt.topicBat;
-    config.mqtt.cellPrefix = req["mqtt"]["cellPrefix"] | config.mqtt.cellPrefix;
-
-    // FIELDS
-    JsonArray arr = req["fields"];
-    for (JsonObject f : arr) {
-
-        String name = f["name"] | "";
-        if (name.length() == 0) continue;
-
-        if (!config.battery.fieldsBat.count(name)) {
-            FieldConfig fc;
-            fc.label   = name;
-            fc.display = name;
-            fc.factor  = "1";
-            fc.unit    = "";
-            fc.mqtt    = false;
-            fc.send    = false;
-            config.battery.fieldsBat[name] = fc;
-        }
-
-        FieldConfig &fc = config.battery.fieldsBat[name];
-
-        fc.display = f["display"]     | fc.display;
-        fc.label   = f["display"]     | fc.label;
-        fc.factor  = f["factor"]      | fc.factor;
-        fc.unit    = f["unit"]        | fc.unit;
-        fc.mqtt    = f["sendMQTT"]    | false;
-        fc.send    = f["sendPayload"] | false;
-    }
-
-	discoveryBatNeeded  = true;
-
-    config.save();
-
-    server.send(200, "text/plain", "BAT settings saved");
-}
+#pragma once
+#include <ArduinoJson.h>
+#include "../wp_webserver.h"
+#include "../py_parser_bat.h"
+#include "../config.h"
+#include "../py_mqtt.h"
+#include "json_stream.h"
+#include "api_etag.h"
+
+extern PyMqtt py_mqtt;
+
+static void handleApiBatCells();
+
+static void registerBatAPI() {
+    server.on("/api/bat/cells", HTTP_GET, handleApiBatCells);
+}
+
+// Local copy of the BAT snapshot (web handlers only)
+static BatBuffer webBat;
+
+static void handleApiBatCells() {
+    char etag[API_ETAG_LEN];
+    if (apiNotModified(etag, 'b', batSnapshot.generation())) return;
+
+    uint32_t gen = batSnapshot.latest(webBat);
+    apiSendETag(etag, 'b', gen);
+
+    const BatSchema& schema = webBat.schema;
+
+    // copy - config belongs to the noncritical task (see ConfigLock)
+    String topicBat, cellPrefix, batMode;
+    std::map<String, FieldConfig> fields;
+    {
+        ConfigLock lock;
+        topicBat   = config.mqtt.topicBat;
+        cellPrefix = config.mqtt.cellPrefix;
+        batMode    = config.mqtt.batMode;
+        fields     = config.battery.fieldsBat;
+    }
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+
+    // CONFIG
+    js.key("config").beginObject();
+    js.member("intervalBat", config.battery.intervalBat);
+    js.member("enableBat",   config.battery.enableBat);
+    js.endObject();
+
+    // MQTT
+    js.key("mqtt").beginObject();
+    js.member("topicBat",   topicBat);
+    js.member("cellPrefix", cellPrefix);
+    js.member("batMode",    batMode);
+    js.endObject();
+
+    // HEADERS (shared column schema)
+    js.key("headers").beginArray();
+    for (uint8_t c = 0; c < schema.colCount; c++) {
+        js.value(schema.cols[c].name);
+    }
+    js.endArray();
+
+    // VALUES (first cell, rebuilt from the typed values)
+    char raw[BAT_ENUM_LEN + BAT_SUFFIX_LEN + 16];
+
+    js.key("values").beginArray();
+    for (uint8_t c = 0; c < schema.colCount; c++) {
+        batFormatValue(webBat, c, 0, raw, sizeof(raw));
+        js.value(raw);
+    }
+    js.endArray();
+
+    // FIELDS (nur NVS-Felder!)
+    js.key("fields").beginArray();
+
+    for (uint8_t c = 0; c < schema.colCount; c++) {
+
+        String name = schema.cols[c].name;
+
+        // Nur Felder aus NVS zurückgeben
+        if (!fields.count(name)) {
+            continue;
+        }
+
+        const FieldConfig &f = fields.at(name);
+        batFormatValue(webBat, c, 0, raw, sizeof(raw));
+
+        char value[32];   // scaled like the MQTT value
+
+        js.beginObject();
+        js.member("name",        name);
+        js.member("display",     f.display);
+        js.member("factor",      f.factor);
+        js.member("unit",        f.unit);
+        js.member("sendMQTT",    f.mqtt);
+        js.member("sendPayload", f.send);
+        js.member("deadband",    f.deadband);
+        js.member("maxSilence",  f.maxSilence);
+        js.member("raw",         raw);
+        js.member("value",       py_mqtt.formatFieldValue(f, raw, value, sizeof(value)));
+        js.endObject();
+    }
+
+    js.endArray();
+
+    js.endObject();
+    js.end();
+}
+
+static void handleApiBatSet() {
+
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing body");
+        return;
+    }
+
+    DynamicJsonDocument req(8192);
+    if (deserializeJson(req, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    // runs in the noncritical task, which owns config (see ConfigChange)
+    WebServerModule_applyConfig([req = std::move(req)]() mutable {
+        {
+            ConfigLock lock;
+
+            // CONFIG
+            config.battery.intervalBat = req["config"]["intervalBat"] | config.battery.intervalBat;
+            config.battery.enableBat   = req["config"]["enableBat"]   | config.battery.enableBat;
+
+            // MQTT
+            config.mqtt.topicBat   = req["mqtt"]["topicBat"]   | config.mqtt.topicBat;
+            config.mqtt.cellPrefix = req["mqtt"]["cellPrefix"] | config.mqtt.cellPrefix;
+
+            String batMode = req["mqtt"]["batMode"] | config.mqtt.batMode;
+            if (batMode == "cells" || batMode == "bulk" || batMode == "both")
+                config.mqtt.batMode = batMode;
+
+            // FIELDS
+            JsonArray arr = req["fields"];
+            for (JsonObject f : arr) {
+
+                String name = f["name"] | "";
+                if (name.length() == 0) continue;
+
+                if (!config.battery.fieldsBat.count(name)) {
+                    FieldConfig fc;
+                    fc.label   = name;
+                    fc.display = name;
+                    fc.factor  = "1";
+                    fc.unit    = "";
+                    fc.mqtt    = false;
+                    fc.send    = false;
+                    config.battery.fieldsBat[name] = fc;
+                }
+
+                FieldConfig &fc = config.battery.fieldsBat[name];
+
+                fc.display = f["display"]     | fc.display;
+                fc.label   = f["display"]     | fc.label;
+                fc.factor  = f["factor"]      | fc.factor;
+                fc.unit    = f["unit"]        | fc.unit;
+                fc.mqtt    = f["sendMQTT"]    | false;
+                fc.send    = f["sendPayload"] | false;
+
+                fc.deadband   = f["deadband"]   | fc.deadband;
+                fc.maxSilence = f["maxSilence"] | fc.maxSilence;
+                if (fc.deadband < 0) fc.deadband = 0;
+            }
+        }
+
+        discoveryBatNeeded = true;
+        config.save();
+    }, "BAT settings saved");
+}
@@ -1,33 +1,94 @@
-#pragma once
-#include <WebServer.h>
-#include "../py_uart.h"
-#include "../py_scheduler.h"
-
-extern WebServer server;
-extern PyUart py_uart;
-extern PyScheduler py_scheduler;
-
-inline void registerConsoleAPI() {
-
-    // /req?code=...
-    server.on("/req", HTTP_GET, []() {
-        String cmd = server.arg("code");
-        py_scheduler.enqueue(cmd);
-        server.send(200, "text/plain", "OK");
-    });
-
-    // /api/lastframe
-    server.on("/api/lastframe", HTTP_GET, []() {
-
-        unsigned long start = millis();
-        while (!py_uart.hasFrame()) {
-            if (millis() - start > 2000) {
-                server.send(200, "text/plain", "TIMEOUT");
-                return;
-            }
-            vTaskDelay(1);
-        }
-
-        server.send(200, "text/plain", py_uart.getFrame());
-    });
-}
+#pragma once
+#include "../py_http_server.h"
+#include "../py_uart.h"
+#include "../py_scheduler.h"
+#include "../py_pacing.h"
+#include "json_stream.h"
+#include "../wp_webserver.h"
+
+extern HttpServer server;
+extern PyUart py_uart;
+extern PyScheduler py_scheduler;
+
+// frameStore.lastSequence() when the last /req was queued: /api/lastframe
+// answers with the first console frame published after that
+static uint32_t consoleSeqAtEnqueue = 0;
+
+// Deferred /api/lastframe: stream straight out of the frame arena
+static bool pollLastFrame(DeferredReply& reply) {
+    uint32_t seq;
+    int slot = frameStore.acquireLast(&seq);
+
+    if (slot < 0 || seq == consoleSeqAtEnqueue) {
+        frameStore.release(slot);
+        if (!reply.timedOut) return false;
+        reply.send(200, "text/plain", "TIMEOUT");
+        return true;
+    }
+
+    FrameView f = frameStore.view(slot);
+    reply.send(200, "text/plain", f.data, f.len);
+
+    frameStore.release(slot);
+    return true;
+}
+
+inline void registerConsoleAPI() {
+
+    // /req?code=...
+    server.on("/req", HTTP_GET, []() {
+        String cmd = server.arg("code");
+        consoleSeqAtEnqueue = frameStore.lastSequence();
+        if (!py_scheduler.enqueue(cmd)) {
+            server.send(503, "text/plain", "QUEUE FULL");
+            return;
+        }
+        server.send(200, "text/plain", "OK");
+    });
+
+    // /api/lastframe – answered when the response to /req arrives (max 2 s)
+    server.on("/api/lastframe", HTTP_GET, []() {
+        if (!WebServerModule_defer(pollLastFrame, 2000)) {
+            server.send(503, "text/plain", "BUSY");
+        }
+    });
+
+    // /api/uart/stats – adaptive pacing / throughput
+    server.on("/api/uart/stats", HTTP_GET, []() {
+        JsonStream js(server);
+        js.begin();
+        js.beginObject();
+
+        js.member("commands", py_pacing.totalCommands);
+        js.member("rxMs",     py_pacing.totalRxMs);
+        js.member("gapMs",    py_pacing.totalGapMs);
+        js.member("queued",   py_scheduler.queuedCount());
+
+        js.key("types").beginObject();
+        for (int t = 0; t < PACE_TYPES; t++) {
+            const PaceStats& s = py_pacing.stats((PaceType)t);
+
+            js.key(PyPacing::typeName((PaceType)t)).beginObject();
+            js.member("count",            s.count);
+            js.member("ok",               s.ok);
+            js.member("invalid",          s.invalid);
+            js.member("timeouts",         s.timeouts);
+            js.member("latencyAvg",       s.latencyAvg);
+            js.member("latencyMin",       s.latencyMin);
+            js.member("latencyMax",       s.latencyMax);
+            js.member("latencyP90",       s.latencyP90);
+            js.member("firstByteAvg",     s.firstByteAvg);
+            js.member("firstByteP90",     s.firstByteP90);
+            js.member("slow",             s.slow);
+            js.member("bytesAvg",         s.bytesAvg);
+            js.member("gap",              s.gap);
+            js.member("backoff",          s.backoff);
+            js.member("firstByteTimeout", s.firstByteTimeout);
+            js.endObject();
+        }
+        js.endObject();
+
+        js.endObject();
+        js.end();
+    });
+}
@@ -1,60 +1,80 @@
-#pragma once
-#include <WebServer.h>
-#include <WiFi.h>
-
-// KORREKTE Pfade aus dem Unterordner:
-#include "../py_mqtt.h"
-#include "../py_parser_pwr.h"
-
-extern AppConfig config;
-extern PyMqtt py_mqtt;
-extern BatteryStack lastParsedStack;
-
-void registerDashboardAPI(WebServer &server) {
-
-    server.on("/api/dashboard", HTTP_GET, [&]() {
-
-        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-        server.send(200, "application/json", "");
-        server.sendContent("{");
-
-        // WiFi
-        server.sendContent("\"wifi\":{");
-        server.sendContent("\"mode\":\"STA\",");
-        server.sendContent("\"ssid\":\"" + WiFi.SSID() + "\",");
-        server.sendContent("\"ip\":\"" + WiFi.localIP().toString() + "\",");
-        server.sendContent("\"rssi\":" + String(WiFi.RSSI()));
-        server.sendContent("},");
-
-        // MQTT
-        server.sendContent("\"mqtt\":{");
-        server.sendContent("\"connected\":" + String(py_mqtt.isConnected() ? "true" : "false") + ",");
-        server.sendContent("\"server\":\"" + config.mqtt.server + "\",");
-        server.sendContent("\"port\":" + String(config.mqtt.port) + ",");
-        server.sendContent("\"last_contact\":\"" + config.lastMqttContact + "\"");
-        server.sendContent("},");
-
-        // Battery
-        server.sendContent("\"battery\":{");
-        server.sendContent("\"modules\":" + String(lastParsedStack.batteryCount) + ",");
-        server.sendContent("\"last_update\":\"" + config.lastPwrUpdate + "\"");
-        server.sendContent("},");
-
-        // System
-        time_t now;
-        time(&now);
-        struct tm t;
-        localtime_r(&now, &t);
-        char buf[32];
-        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &t);
-
-        server.sendContent("\"system\":{");
-        server.sendContent("\"time\":\"" + String(buf) + "\",");
-        server.sendContent("\"uptime\":\"" + config.uptimeString() + "\",");
-        server.sendContent("\"version\":\"" + config.firmwareVersion + "\"");
-        server.sendContent("}");
-
-        server.sendContent("}");
-        server.sendContent("");
-    });
-}
+#pragma once
+#include "../py_http_server.h"
+#include <WiFi.h>
+
+// KORREKTE Pfade aus dem Unterordner:
+#include "../py_mqtt.h"
+#include "../py_parser_pwr.h"
+#include "json_stream.h"
+#include "../config.h"
+
+extern AppConfig config;
+extern PyMqtt py_mqtt;
+
+void registerDashboardAPI(HttpServer &server) {
+
+    server.on("/api/dashboard", HTTP_GET, [&]() {
+
+        // copy - config belongs to the noncritical task (see ConfigLock)
+        String mqttServer, lastContact, lastPwrUpdate;
+        {
+            ConfigLock lock;
+            mqttServer    = config.mqtt.server;
+            lastContact   = config.lastMqttContact;
+            lastPwrUpdate = config.lastPwrUpdate;
+        }
+
+        // no ETag: clock, uptime, RSSI and MQTT state change every
+        // second, a validator would never match (data APIs: api_etag.h)
+        JsonStream js(server);
+        js.begin();
+        js.beginObject();
+
+        // WiFi
+        js.key("wifi").beginObject();
+        js.member("mode", "STA");
+        js.member("ssid", WiFi.SSID());
+        js.member("ip",   WiFi.localIP().toString());
+        js.member("rssi", WiFi.RSSI());
+        js.endObject();
+
+        // MQTT
+        js.key("mqtt").beginObject();
+        js.member("connected",    py_mqtt.isConnected());
+        js.member("server",       mqttServer);
+        js.member("port",         config.mqtt.port);
+        js.member("last_contact", lastContact);
+        js.endObject();
+
+        // Battery (until the first PWR after boot: values saved in NVS)
+        int modules = config.detectedModules;
+        uint32_t updatedAt = 0;
+        pwrSnapshot.peek([&](const PwrBuffer& p) {
+            if (p.moduleCount == 0) return;
+            modules   = p.stack.batteryCount;
+            updatedAt = p.updatedAt;
+        });
+
+        js.key("battery").beginObject();
+        js.member("modules",     modules);
+        js.member("last_update", updatedAt ? AppConfig::formatTime(updatedAt) : lastPwrUpdate);
+        js.endObject();
+
+        // System
+        time_t now;
+        time(&now);
+        struct tm t;
+        localtime_r(&now, &t);
+        char buf[32];
+        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &t);
+
+        js.key("system").beginObject();
+        js.member("time",    buf);
+        js.member("uptime",  config.uptimeString());
+        js.member("version", config.firmwareVersion);
+        js.endObject();
+
+        js.endObject();
+        js.end();
+    });
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "../py_http_server.h"
+#include "../py_history.h"
+#include "../config.h"
+#include "json_stream.h"
+
+extern HttpServer server;
+
+// ---------------------------------------------------------
+// /api/history?series=stack|<module>&res=raw|1m|15m|1h&range=<s>
+// ---------------------------------------------------------
+// Streams the points of one tier newer than now - range (default 24 h):
+//   raw:       [t, volt, curr, temp, soc]
+//   aggregate: [t, volt_min, volt_avg, volt_max, curr_min, ...]
+// t = seconds since boot; uptime + epoch map it to wall time
+// (epoch 0 = no NTP time yet). The open bucket comes last.
+// ---------------------------------------------------------
+
+static const char* const HIST_METRIC_NAME[HIST_METRICS] = { "volt", "curr", "temp", "soc" };
+static const uint8_t     HIST_DECIMALS[HIST_METRICS]    = { 2, 1, 1, 0 };
+
+#define HIST_BATCH  16      // points copied per history lock
+
+static void writeHistPoint(JsonStream& js, const HistPoint& p, bool agg) {
+    const int16_t* cols[3] = { p.min, p.avg, p.max };
+
+    js.beginArray();
+    js.value(p.t);
+    for (uint8_t m = 0; m < HIST_METRICS; m++) {
+        for (uint8_t k = agg ? 0 : 1; k < (agg ? 3 : 2); k++)
+            js.fixed(cols[k][m], HIST_DECIMALS[m]);
+    }
+    js.endArray();
+}
+
+static void handleApiHistory() {
+    String seriesArg = server.hasArg("series") ? server.arg("series") : String("stack");
+    int idx = seriesArg == "stack" ? 0 : seriesArg.toInt();
+
+    int tier = PyHistory::tierByName(server.hasArg("res") ? server.arg("res") : String("15m"));
+    uint32_t range = server.hasArg("range") ? server.arg("range").toInt() : 86400;
+
+    if (tier < 0) {
+        server.send(400, "text/plain", "Unknown resolution");
+        return;
+    }
+    if (!history.hasSeries(idx)) {
+        server.send(404, "text/plain", "No history for this series");
+        return;
+    }
+
+    uint32_t now   = PyHistory::now();
+    uint32_t since = range < now ? now - range : 0;
+    bool agg = tier != HIST_RAW;
+
+    time_t epoch = config.isSystemTimeValid() ? time(nullptr) : 0;
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+
+    js.member("series", seriesArg);
+    js.member("res",    PyHistory::tierName(tier));
+    js.member("step",   PyHistory::step(tier));
+    js.member("uptime", now);
+    js.member("epoch",  (unsigned long)epoch);
+
+    static const char* const SUFFIX[3] = { "_min", "_avg", "_max" };
+    char col[16];
+
+    js.key("columns").beginArray();
+    js.value("t");
+    for (uint8_t m = 0; m < HIST_METRICS; m++) {
+        if (!agg) {
+            js.value(HIST_METRIC_NAME[m]);
+            continue;
+        }
+        for (uint8_t k = 0; k < 3; k++) {
+            snprintf(col, sizeof(col), "%s%s", HIST_METRIC_NAME[m], SUFFIX[k]);
+            js.value(col);
+        }
+    }
+    js.endArray();
+
+    // copied in batches under the history lock, written without it
+    js.key("points").beginArray();
+
+    HistPoint batch[HIST_BATCH];
+    uint32_t cursor = 0;
+    size_t n;
+
+    while ((n = history.read(idx, tier, since, cursor, batch, HIST_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++)
+            writeHistPoint(js, batch[i], agg);
+    }
+
+    HistPoint open;
+    if (agg && history.openBucket(idx, tier, open) && open.t >= since)
+        writeHistPoint(js, open, true);
+
+    js.endArray();
+    js.endObject();
+    js.end();
+}
+
+static void registerHistoryAPI() {
+    server.on("/api/history", HTTP_GET, handleApiHistory);
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include "../py_http_server.h"
+#include <math.h>
+#include "../py_log.h"
+
+// ---------------------------------------------------------
+// JsonStream – streaming JSON writer for the web API
+// ---------------------------------------------------------
+// Writes into a fixed buffer and hands it to server.sendContent() only
+// when it is full, so a response goes out in a few segment-sized
+// chunks instead of one chunk per token. No JsonDocument, no String
+// concatenation; commas are inserted automatically.
+//
+//   JsonStream js(server);
+//   js.begin();
+//   js.beginObject();
+//     js.member("ip", WiFi.localIP().toString());
+//     js.key("modules").beginArray();
+//       js.value(1).value(2);
+//     js.endArray();
+//   js.endObject();
+//   js.end();
+//
+// Strings are escaped (" \ and control characters), UTF-8 is passed
+// through. NaN / Inf become null.
+//
+// JsonStream(Print&) writes to any Print instead (event buffers,
+// sockets); begin() / end() are for HTTP responses only.
+// ---------------------------------------------------------
+
+// One TCP segment (lwIP MSS 1436) minus the chunk framing "5A4\r\n...\r\n"
+#define JSON_STREAM_BUF  1428
+
+class JsonStream {
+public:
+    explicit JsonStream(HttpServer& srv) : server(&srv) {}
+    explicit JsonStream(Print& p) : out(&p) {}
+
+    // Response header (chunked), body follows
+    void begin(int code = 200, const char* type = "application/json") {
+        startUs = micros();
+        server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server->send(code, type, "");
+    }
+
+    // Last chunk + terminating empty chunk
+    void end() {
+        flush();
+        server->sendContent("");
+        LOGD(LOGM_WEB, "JSON %s: %u bytes, %u chunks, %lu us",
+             server->uri(), bytes, chunks, (unsigned long)(micros() - startUs));
+    }
+
+    // ---------------------------------------------------------
+    // Structure
+    // ---------------------------------------------------------
+    JsonStream& beginObject() { sep(); put('{'); comma = false; return *this; }
+    JsonStream& endObject()   { put('}'); comma = true; return *this; }
+    JsonStream& beginArray()  { sep(); put('['); comma = false; return *this; }
+    JsonStream& endArray()    { put(']'); comma = true; return *this; }
+
+    JsonStream& key(const char* k) {
+        sep();
+        string(k);
+        put(':');
+        comma = false;
+        return *this;
+    }
+
+    // ---------------------------------------------------------
+    // Values
+    // ---------------------------------------------------------
+    JsonStream& value(const char* s)    { sep(); if (s) string(s); else put("null", 4); return done(); }
+    JsonStream& value(const String& s)  { return value(s.c_str()); }
+    JsonStream& value(bool b)           { sep(); put(b ? "true" : "false", b ? 4 : 5); return done(); }
+
+    JsonStream& value(int v)                { return number("%d", v); }
+    JsonStream& value(unsigned v)           { return number("%u", v); }
+    JsonStream& value(long v)               { return number("%ld", v); }
+    JsonStream& value(unsigned long v)      { return number("%lu", v); }
+    JsonStream& value(long long v)          { return number("%lld", v); }
+    JsonStream& value(unsigned long long v) { return number("%llu", v); }
+
+    // float: 7 significant digits (0.1f → 0.1), double: 15
+    JsonStream& value(float v)   { return real(v, 7); }
+    JsonStream& value(double v)  { return real(v, 15); }
+
+    // Scaled integer with fixed decimals: fixed(5312, 2) → 53.12
+    JsonStream& fixed(int32_t v, uint8_t decimals) {
+        if (decimals == 0) return value((long)v);
+
+        uint32_t div = 1;
+        for (uint8_t i = 0; i < decimals; i++) div *= 10;
+        uint32_t a = v < 0 ? (uint32_t)(-(int64_t)v) : (uint32_t)v;
+
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), "%s%lu.%0*lu", v < 0 ? "-" : "",
+                         (unsigned long)(a / div), decimals, (unsigned long)(a % div));
+        sep();
+        put(tmp, n);
+        return done();
+    }
+
+    // Pre-serialized JSON (number, object, ...) as one value
+    JsonStream& raw(const char* json, size_t len) { sep(); put(json, len); return done(); }
+
+    // key + value
+    template <typename T>
+    JsonStream& member(const char* k, const T& v) { key(k); return value(v); }
+
+    JsonStream& memberFixed(const char* k, int32_t v, uint8_t decimals) {
+        key(k);
+        return fixed(v, decimals);
+    }
+
+    void flush() {
+        if (len == 0) return;
+        if (server) server->sendContent(buf, len);
+        else        out->write((const uint8_t*)buf, len);
+        bytes += len;
+        chunks++;
+        len = 0;
+    }
+
+private:
+    void sep()           { if (comma) put(','); }
+    JsonStream& done()   { comma = true; return *this; }
+
+    void put(char c) {
+        if (len == sizeof(buf)) flush();
+        buf[len++] = c;
+    }
+
+    void put(const char* s, size_t n) {
+        while (n > 0) {
+            if (len == sizeof(buf)) flush();
+            size_t k = sizeof(buf) - len;
+            if (k > n) k = n;
+            memcpy(buf + len, s, k);
+            len += k;
+            s += k;
+            n -= k;
+        }
+    }
+
+    template <typename T>
+    JsonStream& number(const char* fmt, T v) {
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), fmt, v);
+        sep();
+        put(tmp, n);
+        return done();
+    }
+
+    JsonStream& real(double v, int digits) {
+        sep();
+        if (isnan(v) || isinf(v)) {
+            put("null", 4);
+        } else {
+            char tmp[32];
+            int n = snprintf(tmp, sizeof(tmp), "%.*g", digits, v);
+            put(tmp, n);
+        }
+        return done();
+    }
+
+    // Quoted + escaped; unescaped runs are copied in one piece
+    void string(const char* s) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+
+        put('"');
+        const char* run = s;
+        for (; *s; s++) {
+            uint8_t c = (uint8_t)*s;
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+            put(run, s - run);
+            run = s + 1;
+
+            put('\\');
+            switch (c) {
+                case '"':  put('"');  break;
+                case '\\': put('\\'); break;
+                case '\n': put('n');  break;
+                case '\r': put('r');  break;
+                case '\t': put('t');  break;
+                case '\b': put('b');  break;
+                case '\f': put('f');  break;
+                default: {
+                    char u[5] = { 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 15] };
+                    put(u, 5);
+                }
+            }
+        }
+        put(run, s - run);
+        put('"');
+    }
+
+    HttpServer* server = nullptr;
+    Print*     out = nullptr;
+    char     buf[JSON_STREAM_BUF];
+    size_t   len = 0;
+    bool     comma = false;
+
+    uint32_t bytes = 0;
+    uint16_t chunks = 0;
+    uint32_t startUs = 0;
+};
@@ -1,172 +1,182 @@
-#pragma once
-#include <ArduinoJson.h>
-#include "../wp_webserver.h"
-#include "../py_parser_pwr.h"
-#include "../config.h"
-
-static void handleApiPwrBase();
-
-static void registerPwrAPI() {
-    server.on("/api/pwr/base", HTTP_GET, handleApiPwrBase);
-}
-
-static void handleApiPwrBase() {
-    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    server.send(200, "application/json", "");
-
-    server.sendContent("{");
-
-    // ---------------------------------------------------------
-    // CONFIG BLOCK
-    // ---------------------------------------------------------
-    server.sendContent("\"config\":{");
-
-    server.sendContent("\"intervalPwr\":");
-    server.sendContent(String(config.battery.intervalPwr));
-    server.sendContent(",");
-
-    server.sendContent("\"useFahrenheit\":");
-    server.sendContent(config.battery.useFahrenheit ? "true" : "false");
-
-    server.sendContent("},");
-
-    // ---------------------------------------------------------
-    // MQTT BLOCK
-    // ---------------------------------------------------------
-    server.sendContent("\"mqtt\":{");
-
-    server.sendContent("\"topicStack\":\"");
-    server.sendContent(config.mqtt.topicStack);
-    server.sendContent("\",");
-
-    server.sendContent("\"topicPwr\":\"");
-    server.sendContent(config.mqtt.topicPwr);
-    server.sendContent("\"");
-
-    server.sendContent("},");
-
-    // ---------------------------------------------------------
-    // HEADERS
-    // ---------------------------------------------------------
-    server.sendContent("\"headers\":[");
-    for (size_t i = 0; i < lastParserHeader.size(); i++) {
-        if (i > 0) server.sendContent(",");
-        server.sendContent("\"");
-        server.sendContent(lastParserHeader[i]);
-        server.sendContent("\"");
-    }
-    server.sendContent("],");
-
-    // ---------------------------------------------------------
-    // VALUES
-    // ---------------------------------------------------------
-    server.sendContent("\"values\":[");
-    for (size_t i = 0; i < lastParserValues.size(); i++) {
-        if (i > 0) server.sendContent(",");
-        server.sendContent("\"");
-        server.sendContent(lastParserValues[i]);
-        server.sendContent("\"");
-    }
-    server.sendContent("],");
-
-    // ---------------------------------------------------------
-    // FIELDS (NUR NVS-FELDER!)
-    // ---------------------------------------------------------
-    server.sendContent("\"fields\":[");
-
-    bool firstField = true;
-
-    for (size_t i = 0; i < lastParserHeader.size(); i++) {
-
-        const String &name = lastParserHeader[i];
-
-        // Nur Felder aus dem NVS zurückgeben
-        if (!config.battery.fieldsPwr.count(name)) {
-            continue;   // <--- WICHTIG!
-        }
-
-        const FieldConfig &f = config.battery.fieldsPwr.at(name);
-
-        String raw = "";
-        if (i < lastParserValues.size()) raw = lastParserValues[i];
-
-        DynamicJsonDocument doc(256);
-        JsonObject o = doc.to<JsonObject>();
-
-        o["name"]        = name;
-        o["display"]     = f.display;
-        o["factor"]      = f.factor;
-        o["unit"]        = f.unit;
-        o["sendMQTT"]    = f.mqtt;
-        o["sendPayload"] = f.send;
-        o["raw"]         = raw;
-        o["value"]       = raw;
-
-        String tmp;
-        serializeJson(o, tmp);
-
-        if (!firstField) server.sendContent(",");
-        firstField = false;
-
-        server.sendContent(tmp);
-    }
-
-    server.sendContent("]");
-
-    server.sendContent("}");
-}
-
-static void handleApiPwrSet() {
-
-    if (!server.hasArg("plain")) {
-        server.send(400, "text/plain", "Missing body");
-        return;
-    }
-
-    DynamicJsonDocument req(4096);
-    if (deserializeJson(req, server.arg("plain"))) {
-        server.send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-
-    // CONFIG
-    config.battery.intervalPwr = req["config"]["intervalPwr"] | config.battery.intervalPwr;
-    config.battery.useFahrenheit = req["config"]["useFahrenheit"] | config.battery.useFahrenheit;
-
-    // MQTT
-    config.mqtt.topicStack = req["mqtt"]["topicStack"] | config.mqtt.topicStack;
-    config.mqtt.topicPwr   = req["mqtt"]["topicPwr"]   | config.mqtt.topicPwr;
-
-    // FIELDS
-    JsonArray arr = req["fields"];
-    for (JsonObject f : arr) {
-
-        String name = f["name"] | "";
-        if (name.length() == 0) continue;
-
-        if (!config.battery.fieldsPwr.count(name)) {
-            FieldConfig fc;
-            fc.label   = name;
-            fc.display = name;
-            fc.factor  = "1";
-            fc.unit    = "";
-            fc.mqtt    = false;
-            fc.send    = false;
-            config.battery.fieldsPwr[name] = fc;
-        }
-
-        FieldConfig &fc = config.battery.fieldsPwr[name];
-
-        fc.display = f["display"]     | fc.display;
-        fc.label   = f["display"]     | fc.label;
-        fc.factor  = f["factor"]      | fc.factor;
-        fc.unit    = f["unit"]        | fc.unit;
-        fc.mqtt    = f["sendMQTT"]    | false;
-        fc.send    = f["sendPayload"] | false;
-    }
-
-    discoveryPwrNeeded = true;
-    config.save();
-
-    server.send(200, "text/plain", "PWR settings saved");
-}
+#pragma once
+#include <ArduinoJson.h>
+#include "../wp_webserver.h"
+#include "../py_parser_pwr.h"
+#include "../config.h"
+#include "../py_mqtt.h"
+#include "json_stream.h"
+#include "api_etag.h"
+
+extern PyMqtt py_mqtt;
+
+static void handleApiPwrBase();
+
+static void registerPwrAPI() {
+    server.on("/api/pwr/base", HTTP_GET, handleApiPwrBase);
+}
+
+// Local copy of the PWR snapshot (web handlers only)
+static PwrBuffer webPwr;
+
+static void handleApiPwrBase() {
+    char etag[API_ETAG_LEN];
+    if (apiNotModified(etag, 'p', pwrSnapshot.generation())) return;
+
+    uint32_t gen = pwrSnapshot.read(webPwr);
+    apiSendETag(etag, 'p', gen);
+
+    // first module line = sample values for the field table
+    const PwrHeader& header = webPwr.header;
+    const BatteryModule* first = webPwr.moduleCount > 0 ? &webPwr.modules[0] : nullptr;
+
+    // copy - config belongs to the noncritical task (see ConfigLock)
+    String topicStack, topicPwr;
+    std::map<String, FieldConfig> fields;
+    {
+        ConfigLock lock;
+        topicStack = config.mqtt.topicStack;
+        topicPwr   = config.mqtt.topicPwr;
+        fields     = config.battery.fieldsPwr;
+    }
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+
+    // ---------------------------------------------------------
+    // CONFIG BLOCK
+    // ---------------------------------------------------------
+    js.key("config").beginObject();
+    js.member("intervalPwr",   config.battery.intervalPwr);
+    js.member("useFahrenheit", config.battery.useFahrenheit);
+    js.endObject();
+
+    // ---------------------------------------------------------
+    // MQTT BLOCK
+    // ---------------------------------------------------------
+    js.key("mqtt").beginObject();
+    js.member("topicStack", topicStack);
+    js.member("topicPwr",   topicPwr);
+    js.endObject();
+
+    // ---------------------------------------------------------
+    // HEADERS
+    // ---------------------------------------------------------
+    js.key("headers").beginArray();
+    for (uint8_t i = 0; i < header.count; i++) {
+        js.value(header.names[i]);
+    }
+    js.endArray();
+
+    // ---------------------------------------------------------
+    // VALUES
+    // ---------------------------------------------------------
+    js.key("values").beginArray();
+    for (uint8_t i = 0; first && i < first->fieldCount; i++) {
+        js.value(first->field(i));
+    }
+    js.endArray();
+
+    // ---------------------------------------------------------
+    // FIELDS (NUR NVS-FELDER!)
+    // ---------------------------------------------------------
+    js.key("fields").beginArray();
+
+    for (uint8_t i = 0; i < header.count; i++) {
+
+        String name = header.names[i];
+
+        // Nur Felder aus dem NVS zurückgeben
+        if (!fields.count(name)) {
+            continue;   // <--- WICHTIG!
+        }
+
+        const FieldConfig &f = fields.at(name);
+
+        const char* raw = first ? first->field(i) : "";
+
+        char value[32];   // scaled like the MQTT value
+
+        js.beginObject();
+        js.member("name",        name);
+        js.member("display",     f.display);
+        js.member("factor",      f.factor);
+        js.member("unit",        f.unit);
+        js.member("sendMQTT",    f.mqtt);
+        js.member("sendPayload", f.send);
+        js.member("deadband",    f.deadband);
+        js.member("maxSilence",  f.maxSilence);
+        js.member("raw",         raw);
+        js.member("value",       py_mqtt.formatFieldValue(f, raw, value, sizeof(value)));
+        js.endObject();
+    }
+
+    js.endArray();
+
+    js.endObject();
+    js.end();
+}
+
+static void handleApiPwrSet() {
+
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing body");
+        return;
+    }
+
+    DynamicJsonDocument req(8192);
+    if (deserializeJson(req, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    // runs in the noncritical task, which owns config (see ConfigChange)
+    WebServerModule_applyConfig([req = std::move(req)]() mutable {
+        {
+            ConfigLock lock;
+
+            // CONFIG
+            config.battery.intervalPwr = req["config"]["intervalPwr"] | config.battery.intervalPwr;
+            config.battery.useFahrenheit = req["config"]["useFahrenheit"] | config.battery.useFahrenheit;
+
+            // MQTT
+            config.mqtt.topicStack = req["mqtt"]["topicStack"] | config.mqtt.topicStack;
+            config.mqtt.topicPwr   = req["mqtt"]["topicPwr"]   | config.mqtt.topicPwr;
+
+            // FIELDS
+            JsonArray arr = req["fields"];
+            for (JsonObject f : arr) {
+
+                String name = f["name"] | "";
+                if (name.length() == 0) continue;
+
+                if (!config.battery.fieldsPwr.count(name)) {
+                    FieldConfig fc;
+                    fc.label   = name;
+                    fc.display = name;
+                    fc.factor  = "1";
+                    fc.unit    = "";
+                    fc.mqtt    = false;
+                    fc.send    = false;
+                    config.battery.fieldsPwr[name] = fc;
+                }
+
+                FieldConfig &fc = config.battery.fieldsPwr[name];
+
+                fc.display = f["display"]     | fc.display;
+                fc.label   = f["display"]     | fc.label;
+                fc.factor  = f["factor"]      | fc.factor;
+                fc.unit    = f["unit"]        | fc.unit;
+                fc.mqtt    = f["sendMQTT"]    | false;
+                fc.send    = f["sendPayload"] | false;
+
+                fc.deadband   = f["deadband"]   | fc.deadband;
+                fc.maxSilence = f["maxSilence"] | fc.maxSilence;
+                if (fc.deadband < 0) fc.deadband = 0;
+            }
+        }
+
+        discoveryPwrNeeded = true;
+        config.save();
+    }, "PWR settings saved");
+}
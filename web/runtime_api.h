@@ -1,50 +1,80 @@
-#pragma once
-#include <WebServer.h>
-#include "../py_log.h"
-#include "../config.h"
-
-extern WebServer server;
-
-inline void registerRuntimeAPI() {
-
-    // /api/log
-    server.on("/api/log", HTTP_GET, []() {
-        server.send(200, "text/plain", WebLogGet());
-    });
-
-    // /api/log/level (GET)
-    server.on("/api/log/level", HTTP_GET, []() {
-        DynamicJsonDocument doc(128);
-        doc["info"]  = config.logInfo;
-        doc["warn"]  = config.logWarn;
-        doc["error"] = config.logError;
-        doc["debug"] = config.logDebug;
-
-        String out;
-        serializeJson(doc, out);
-        server.send(200, "application/json", out);
-    });
-
-    // /api/log/level (POST)
-    server.on("/api/log/level", HTTP_POST, []() {
-
-        if (!server.hasArg("plain")) {
-            server.send(400, "text/plain", "Missing body");
-            return;
-        }
-
-        DynamicJsonDocument req(128);
-        if (deserializeJson(req, server.arg("plain"))) {
-            server.send(400, "text/plain", "Invalid JSON");
-            return;
-        }
-
-        config.logInfo  = req["info"]  | true;
-        config.logWarn  = req["warn"]  | true;
-        config.logError = req["error"] | true;
-        config.logDebug = req["debug"] | false;
-
-        config.save();
-        server.send(200, "text/plain", "Log level updated");
-    });
-}
+#pragma once
+#include "../py_http_server.h"
+#include "../py_log.h"
+#include "../config.h"
+#include "../wp_webserver.h"
+#include "json_stream.h"
+
+extern HttpServer server;
+
+inline void registerRuntimeAPI() {
+
+    // /api/web/stats – HTTP server connections / requests
+    server.on("/api/web/stats", HTTP_GET, []() {
+        const HttpServerStats& st = server.stats();
+
+        JsonStream js(server);
+        js.begin();
+        js.beginObject();
+        js.member("connections",  server.connections());
+        js.member("connMax",      st.connMax);
+        js.member("accepted",     st.accepted);
+        js.member("requests",     st.requests);
+        js.member("keepAlive",    st.keepAlive);
+        js.member("deferred",     st.deferred);
+        js.member("detached",     st.detached);
+        js.member("evicted",      st.evicted);
+        js.member("timeouts",     st.timeouts);
+        js.member("badRequests",  st.badRequests);
+        js.member("blockedSends", st.blockedSends);
+        js.member("handlerMaxUs", st.handlerMaxUs);
+        js.endObject();
+        js.end();
+    });
+
+    // /api/log
+    server.on("/api/log", HTTP_GET, []() {
+        server.send(200, "text/plain", WebLogGet());
+    });
+
+    // /api/log/level (GET)
+    server.on("/api/log/level", HTTP_GET, []() {
+        JsonStream js(server);
+        js.begin();
+        js.beginObject();
+        js.member("info",  config.logInfo);
+        js.member("warn",  config.logWarn);
+        js.member("error", config.logError);
+        js.member("debug", config.logDebug);
+        js.endObject();
+        js.end();
+    });
+
+    // /api/log/level (POST)
+    server.on("/api/log/level", HTTP_POST, []() {
+
+        if (!server.hasArg("plain")) {
+            server.send(400, "text/plain", "Missing body");
+            return;
+        }
+
+        DynamicJsonDocument req(128);
+        if (deserializeJson(req, server.arg("plain"))) {
+            server.send(400, "text/plain", "Invalid JSON");
+            return;
+        }
+
+        bool info  = req["info"]  | true;
+        bool warn  = req["warn"]  | true;
+        bool error = req["error"] | true;
+        bool debug = req["debug"] | false;
+
+        WebServerModule_applyConfig([=] {
+            config.logInfo  = info;
+            config.logWarn  = warn;
+            config.logError = error;
+            config.logDebug = debug;
+            config.save();
+        }, "Log level updated");
+    });
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include "../py_http_server.h"
+#include <SPIFFS.h>
+#include <ArduinoJson.h>
+#include "../py_log.h"
+
+extern HttpServer server;
+
+// ---------------------------------------------------------
+// Static files (SPIFFS) with gzip, fingerprints and ETag
+// ---------------------------------------------------------
+// tools/build_web.py turns data/ into data_build/: text files are
+// minified and stored as <name>.gz, assets get fingerprinted URLs
+// (/static_style.4e61d9a3.css) inside the pages, manifest.json holds
+// the content hash of every file:
+//
+//   {"files":{"/static_style.css":{"hash":"4e61d9a3","gz":true,...},...}}
+//
+// Requests:
+//   /static_style.4e61d9a3.css   hash stripped → /static_style.css(.gz),
+//                                Cache-Control immutable (1 year)
+//   /layout.html, pages          no-cache, ETag → 304 when unchanged
+//
+// Without manifest.json (plain data/ upload) files are served as they
+// are, like before. The table is reloaded when the file manager
+// uploads or deletes manifest.json.
+// ---------------------------------------------------------
+
+#define WEB_ASSETS_MAX      32
+#define WEB_ASSET_MANIFEST  "/manifest.json"
+#define WEB_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+
+struct WebAsset {
+    char path[32];      // SPIFFS object name limit
+    char hash[9];
+    bool gz;
+};
+
+static WebAsset webAssets[WEB_ASSETS_MAX];
+static uint8_t  webAssetCount = 0;
+
+static void loadAssetManifest() {
+    webAssetCount = 0;
+
+    File f = SPIFFS.open(WEB_ASSET_MANIFEST, "r");
+    if (!f) {
+        LOGI(LOGM_WEB, "Static files: no manifest, plain files without caching");
+        return;
+    }
+
+    DynamicJsonDocument doc(4096);
+    DeserializationError err = deserializeJson(doc, f);
+    f.close();
+
+    if (err) {
+        LOGW(LOGM_WEB, "Static files: manifest invalid (%s)", err.c_str());
+        return;
+    }
+
+    for (JsonPair kv : doc["files"].as<JsonObject>()) {
+        if (webAssetCount >= WEB_ASSETS_MAX) break;
+
+        WebAsset& a = webAssets[webAssetCount++];
+        strlcpy(a.path, kv.key().c_str(), sizeof(a.path));
+        strlcpy(a.hash, kv.value()["hash"] | "", sizeof(a.hash));
+        a.gz = kv.value()["gz"] | false;
+    }
+
+    LOGI(LOGM_WEB, "Static files: manifest with %u files", webAssetCount);
+}
+
+static const WebAsset* findAsset(const String& path) {
+    for (uint8_t i = 0; i < webAssetCount; i++)
+        if (path == webAssets[i].path) return &webAssets[i];
+    return nullptr;
+}
+
+// "/static_style.4e61d9a3.css" → "/static_style.css" + "4e61d9a3"
+static String stripFingerprint(const String& uri, String& hash) {
+    int ext = uri.lastIndexOf('.');
+    int dot = ext > 0 ? uri.lastIndexOf('.', ext - 1) : -1;
+    if (dot < 0 || ext - dot != 9) return uri;
+
+    for (int i = dot + 1; i < ext; i++)
+        if (!isxdigit((unsigned char)uri[i])) return uri;
+
+    hash = uri.substring(dot + 1, ext);
+    return uri.substring(0, dot) + uri.substring(ext);
+}
+
+static const char* assetContentType(const String& path) {
+    if (path.endsWith(".html")) return "text/html";
+    if (path.endsWith(".css"))  return "text/css";
+    if (path.endsWith(".js"))   return "application/javascript";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".png"))  return "image/png";
+    if (path.endsWith(".ico"))  return "image/x-icon";
+    if (path.endsWith(".svg"))  return "image/svg+xml";
+    return "text/plain";
+}
+
+static void handleStaticFile() {
+    if (server.method() != HTTP_GET) {
+        server.send(404, "text/plain", "Not found");
+        return;
+    }
+
+    String uri = server.uri();
+    if (uri == "/") uri = "/index.html";
+
+    String urlHash;
+    String path = stripFingerprint(uri, urlHash);
+    const WebAsset* a = findAsset(path);
+
+    // fingerprint of an older build → still served, but not pinned
+    bool immutable = a && urlHash.length() > 0 && urlHash == a->hash;
+    if (!a) path = uri;
+
+    String etag = a ? String("\"") + a->hash + "\"" : String();
+    const char* cache = immutable ? WEB_CACHE_IMMUTABLE : "no-cache";
+
+    if (a && server.header("If-None-Match") == etag) {
+        server.sendHeader("ETag", etag);
+        server.sendHeader("Cache-Control", cache);
+        server.send(304);
+        return;
+    }
+
+    // .gz first when the manifest says so, plain file as fallback
+    String file = path;
+    String gzFile = path + ".gz";
+    if ((a && a->gz) || !SPIFFS.exists(file)) {
+        if (SPIFFS.exists(gzFile)) file = gzFile;
+    }
+
+    File f = SPIFFS.open(file, "r");
+    if (!f || f.isDirectory()) {
+        server.send(404, "text/plain", "Not found");
+        return;
+    }
+
+    if (a) server.sendHeader("ETag", etag);
+    server.sendHeader("Cache-Control", cache);
+
+    // streamFile adds Content-Encoding: gzip for *.gz; the server
+    // reads and closes the file while the response goes out
+    server.streamFile(f, assetContentType(path));
+}
+
+static void registerStaticFiles() {
+    loadAssetManifest();
+    server.onNotFound(handleStaticFile);
+}
@@ -0,0 +1,526 @@
+#pragma once
+#include "../py_http_server.h"
+#include <lwip/sockets.h>
+#include "../wp_webserver.h"
+#include "json_stream.h"
+#include "pwr_api.h"
+#include "bat_api.h"
+#include "stat_api.h"
+
+// ---------------------------------------------------------
+// /api/stream – live values as Server-Sent Events
+// ---------------------------------------------------------
+// The connection is taken over from the server and kept open. The
+// web task checks the snapshots every loop; every new module result
+// is encoded once and written to every browser, one event per module:
+//
+//   event: pwr
+//   data: {"gen":12,"module":1,"full":true,"headers":[...],"values":[...],
+//          "modules":3,"updated":"2026-10-17 12:00:05"}
+//
+//   event: pwr
+//   data: {"gen":13,"module":1,"d":{"3":"52310","7":"21"},"modules":3,...}
+//
+// values are the rows of the REST pages (pwr line / first cell / STAT
+// fields) of that module. PWR: every module of a new frame; BAT / STAT
+// walk the snapshot rings with their own cursor, so no module result
+// is skipped. "updated" is the device time of the PWR frame.
+//
+// A browser gets a full event the first time it sees a module (or
+// after a column layout change), afterwards only the changed columns.
+// A new browser gets the modules still kept in the rings at once.
+// Without browsers nothing is read or encoded.
+//
+// Writes never block: what the socket does not take is kept per
+// browser (pending, up to STREAM_PENDING_MAX) and sent from the offset
+// where it stopped, before anything newer. A browser that falls
+// further behind is dropped (EventSource reconnects by itself and
+// starts with full events).
+// ---------------------------------------------------------
+
+#define STREAM_MAX_CLIENTS   4
+#define STREAM_EVENT_BUF     3072
+#define STREAM_KEEPALIVE_MS  15000
+#define STREAM_PENDING_MAX   8192    // unsent bytes per browser
+#define STREAM_STALL_MS      30000   // pending bytes without progress → drop
+
+enum StreamType : uint8_t {
+    STREAM_PWR,
+    STREAM_BAT,
+    STREAM_STAT,
+    STREAM_TYPES
+};
+
+static const char* const STREAM_EVENT_NAME[STREAM_TYPES] = { "pwr", "bat", "stat" };
+static const uint8_t     STREAM_COLS[STREAM_TYPES] = { PWR_MAX_COLS, BAT_MAX_COLS, STAT_MAX_FIELDS };
+
+struct StreamClient {
+    bool       used = false;
+    bool       fresh[STREAM_TYPES];     // joined, gets the ring contents
+    uint16_t   synced[STREAM_TYPES];    // bit per module: has its full state
+    int        fd = -1;
+
+    // bytes the socket did not take yet: pending[pendOff .. pendLen)
+    char*      pending = nullptr;       // STREAM_PENDING_MAX, while in use
+    size_t     pendLen = 0;
+    size_t     pendOff = 0;
+    unsigned long pendSince = 0;        // last progress of the pending bytes
+};
+
+// Last encoded state per type and module: layout + FNV-1a of every value
+struct StreamModuleState {
+    uint32_t  schema = 0;
+    uint8_t   count = 0;
+    uint32_t* hash = nullptr;           // STREAM_COLS[type] entries
+};
+
+// One event ("event: x\ndata: {...}\n\n") in a fixed buffer
+class StreamEvent : public Print {
+public:
+    size_t write(uint8_t b) override {
+        if (len < sizeof(buf)) buf[len++] = (char)b;
+        else overflow = true;
+        return 1;
+    }
+
+    void start(uint8_t type) {
+        len = 0;
+        overflow = false;
+        print("event: ");
+        print(STREAM_EVENT_NAME[type]);
+        print("\ndata: ");
+    }
+
+    bool finish() {
+        print("\n\n");
+        return !overflow;
+    }
+
+    char   buf[STREAM_EVENT_BUF];
+    size_t len = 0;
+    bool   overflow = false;
+};
+
+static StreamClient      streamClients[STREAM_MAX_CLIENTS];
+static StreamModuleState streamState[STREAM_TYPES][MAX_MODULES];
+static uint32_t          streamHashes[MAX_MODULES * (PWR_MAX_COLS + BAT_MAX_COLS + STAT_MAX_FIELDS)];
+static uint32_t          streamGen[STREAM_TYPES];      // PWR: generation, BAT/STAT: ring cursor
+static StreamEvent       streamFull;
+static StreamEvent       streamDelta;
+static unsigned long     streamLastWrite = 0;
+
+static StreamModuleState& streamModule(uint8_t type, uint8_t slot) {
+    StreamModuleState& st = streamState[type][slot];
+    if (!st.hash) {
+        size_t off = 0;
+        for (uint8_t t = 0; t < type; t++) off += (size_t)MAX_MODULES * STREAM_COLS[t];
+        st.hash = streamHashes + off + (size_t)slot * STREAM_COLS[type];
+    }
+    return st;
+}
+
+// ---------------------------------------------------------
+// Column access: PWR module at position pos of webPwr, BAT / STAT
+// the entry in webBat / webStat (copies shared with the REST handlers,
+// same web task)
+// ---------------------------------------------------------
+static int streamModuleIndex(uint8_t type, uint8_t pos) {
+    switch (type) {
+        case STREAM_PWR: return webPwr.modules[pos].index;
+        case STREAM_BAT: return webBat.cells.moduleIndex;
+        default:         return webStat.stat.moduleIndex;
+    }
+}
+
+static uint8_t streamCount(uint8_t type, uint8_t pos) {
+    uint8_t n;
+    switch (type) {
+        case STREAM_PWR: n = webPwr.header.count;      break;
+        case STREAM_BAT: n = webBat.schema.colCount;   break;
+        default:         n = webStat.stat.fieldCount;  break;
+    }
+    return n < STREAM_COLS[type] ? n : STREAM_COLS[type];
+}
+
+static const char* streamName(uint8_t type, uint8_t i) {
+    switch (type) {
+        case STREAM_PWR: return webPwr.header.names[i];
+        case STREAM_BAT: return webBat.schema.cols[i].name;
+        default:         return webStat.stat.fields[i].name;
+    }
+}
+
+static const char* streamValue(uint8_t type, uint8_t pos, uint8_t i, char* tmp, size_t cap) {
+    switch (type) {
+        case STREAM_PWR:
+            return webPwr.modules[pos].field(i);
+        case STREAM_BAT:
+            batFormatValue(webBat, i, 0, tmp, cap);
+            return tmp;
+        default:
+            return webStat.stat.fields[i].raw;
+    }
+}
+
+static uint32_t streamHash(const char* s, uint32_t h = 2166136261u) {
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// ---------------------------------------------------------
+// Socket helpers
+// ---------------------------------------------------------
+static void streamDrop(StreamClient& c, const char* why) {
+    LOGD(LOGM_WEB, "Stream: client dropped (%s)", why);
+    ::close(c.fd);
+    free(c.pending);
+    c.pending = nullptr;
+    c.pendLen = c.pendOff = 0;
+    c.fd = -1;
+    c.used = false;
+}
+
+// Non-blocking send: bytes written (0 = socket full), -1 = error
+static int streamSend(StreamClient& c, const char* data, size_t len) {
+    int n = ::send(c.fd, data, len, MSG_DONTWAIT);
+    if (n >= 0) return n;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+}
+
+// Continues the pending bytes; true when nothing is left
+static bool streamFlush(StreamClient& c) {
+    if (c.pendOff == c.pendLen) return true;
+
+    int n = streamSend(c, c.pending + c.pendOff, c.pendLen - c.pendOff);
+    if (n < 0) {
+        streamDrop(c, "send failed");
+        return false;
+    }
+    c.pendOff += n;
+    if (n > 0) c.pendSince = millis();
+    if (c.pendOff < c.pendLen) return false;
+
+    free(c.pending);                    // drained: no buffer while idle
+    c.pending = nullptr;
+    c.pendLen = c.pendOff = 0;
+    return true;
+}
+
+// Queues one event: sent right away as far as the socket takes it, the
+// rest stays pending. false: browser dropped (error or too far behind).
+static bool streamWrite(StreamClient& c, const char* data, size_t len) {
+    if (streamFlush(c)) {
+        int n = streamSend(c, data, len);
+        if (n < 0) {
+            streamDrop(c, "send failed");
+            return false;
+        }
+        if ((size_t)n == len) return true;
+        data += n;
+        len  -= n;
+    } else if (!c.used) {
+        return false;
+    }
+
+    // keep the rest behind what is already pending
+    if (c.pendOff > 0) {
+        memmove(c.pending, c.pending + c.pendOff, c.pendLen - c.pendOff);
+        c.pendLen -= c.pendOff;
+        c.pendOff = 0;
+    }
+    if (c.pendLen + len > STREAM_PENDING_MAX) {
+        streamDrop(c, "too far behind");
+        return false;
+    }
+    if (!c.pending) {
+        c.pending = (char*)malloc(STREAM_PENDING_MAX);
+        if (!c.pending) {
+            streamDrop(c, "no memory");
+            return false;
+        }
+        c.pendSince = millis();
+    }
+    memcpy(c.pending + c.pendLen, data, len);
+    c.pendLen += len;
+    return true;
+}
+
+// ---------------------------------------------------------
+// Encoding (once per module result)
+// ---------------------------------------------------------
+static void streamExtras(JsonStream& js, uint8_t type, int module) {
+    js.member("module", module);
+    if (type != STREAM_PWR) return;
+
+    js.member("modules", webPwr.stack.batteryCount);
+    if (webPwr.updatedAt) js.member("updated", AppConfig::formatTime(webPwr.updatedAt));
+}
+
+static bool streamEncodeFull(uint8_t type, uint8_t pos, uint32_t gen) {
+    uint8_t n = streamCount(type, pos);
+    char tmp[BAT_ENUM_LEN + BAT_SUFFIX_LEN + 16];
+
+    streamFull.start(type);
+    JsonStream js(streamFull);
+    js.beginObject();
+    js.member("gen", gen);
+    js.member("full", true);
+
+    js.key("headers").beginArray();
+    for (uint8_t i = 0; i < n; i++) js.value(streamName(type, i));
+    js.endArray();
+
+    js.key("values").beginArray();
+    for (uint8_t i = 0; i < n; i++) js.value(streamValue(type, pos, i, tmp, sizeof(tmp)));
+    js.endArray();
+
+    streamExtras(js, type, streamModuleIndex(type, pos));
+    js.endObject();
+    js.flush();
+
+    if (streamFull.finish()) return true;
+    LOGW(LOGM_WEB, "Stream: %s event larger than %d bytes", STREAM_EVENT_NAME[type], STREAM_EVENT_BUF);
+    return false;
+}
+
+// Delta against the last encoded values of the module → changed columns
+// (-1: event too large)
+static int streamEncodeDelta(uint8_t type, uint8_t pos, uint8_t slot, uint32_t gen) {
+    StreamModuleState& st = streamModule(type, slot);
+    uint8_t n = streamCount(type, pos);
+    char tmp[BAT_ENUM_LEN + BAT_SUFFIX_LEN + 16];
+    char idx[4];
+
+    uint32_t schema = 2166136261u;
+    for (uint8_t i = 0; i < n; i++) schema = streamHash(streamName(type, i), schema);
+
+    // column layout changed → everybody starts over with this module
+    if (schema != st.schema || n != st.count) {
+        for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++)
+            streamClients[c].synced[type] &= ~(1u << slot);
+        for (uint8_t i = 0; i < n; i++) st.hash[i] = 0;
+        st.schema = schema;
+        st.count  = n;
+    }
+
+    int changes = 0;
+    streamDelta.start(type);
+    JsonStream js(streamDelta);
+    js.beginObject();
+    js.member("gen", gen);
+
+    js.key("d").beginObject();
+    for (uint8_t i = 0; i < n; i++) {
+        const char* v = streamValue(type, pos, i, tmp, sizeof(tmp));
+        uint32_t h = streamHash(v);
+        if (h == st.hash[i]) continue;
+
+        st.hash[i] = h;
+        snprintf(idx, sizeof(idx), "%u", i);
+        js.member(idx, v);
+        changes++;
+    }
+    js.endObject();
+
+    streamExtras(js, type, streamModuleIndex(type, pos));
+    js.endObject();
+    js.flush();
+
+    if (streamDelta.finish()) return changes;
+    LOGW(LOGM_WEB, "Stream: %s event larger than %d bytes", STREAM_EVENT_NAME[type], STREAM_EVENT_BUF);
+    return -1;
+}
+
+// module number 1..MAX_MODULES → state slot (-1: not streamable)
+static int streamSlot(uint8_t type, uint8_t pos) {
+    int m = streamModuleIndex(type, pos);
+    return (m >= 1 && m <= MAX_MODULES) ? m - 1 : -1;
+}
+
+// New result of one module: full event to browsers without its state,
+// changed columns to the others
+static void streamPublish(uint8_t type, uint8_t pos, uint32_t gen, unsigned long now) {
+    int slot = streamSlot(type, pos);
+    if (slot < 0) return;
+
+    int changes = streamEncodeDelta(type, pos, slot, gen);
+    bool fullOk = false, fullDone = false;
+    uint16_t bit = 1u << slot;
+
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) {
+        StreamClient& sc = streamClients[c];
+        if (!sc.used) continue;
+
+        if (sc.synced[type] & bit) {
+            if (changes == 0) continue;
+            if (changes > 0) {
+                if (streamWrite(sc, streamDelta.buf, streamDelta.len)) streamLastWrite = now;
+                continue;
+            }
+            sc.synced[type] &= ~bit;                // retry with a full event
+        }
+
+        if (!fullDone) {
+            fullOk = streamEncodeFull(type, pos, gen);
+            fullDone = true;
+        }
+        if (fullOk && streamWrite(sc, streamFull.buf, streamFull.len)) {
+            sc.synced[type] |= bit;
+            streamLastWrite = now;
+        }
+    }
+}
+
+// Full event to the fresh browsers only (state they missed)
+static void streamCatchUp(uint8_t type, uint8_t pos, uint32_t gen, unsigned long now) {
+    int slot = streamSlot(type, pos);
+    if (slot < 0 || !streamEncodeFull(type, pos, gen)) return;
+
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) {
+        StreamClient& sc = streamClients[c];
+        if (!sc.used || !sc.fresh[type]) continue;
+
+        if (streamWrite(sc, streamFull.buf, streamFull.len)) {
+            sc.synced[type] |= 1u << slot;
+            streamLastWrite = now;
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// Web task poller
+// ---------------------------------------------------------
+static bool streamAnyFresh(uint8_t type) {
+    bool fresh = false;
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++)
+        fresh |= streamClients[c].used && streamClients[c].fresh[type];
+    return fresh;
+}
+
+static void streamClearFresh(uint8_t type) {
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) streamClients[c].fresh[type] = false;
+}
+
+// PWR: one snapshot holds every module
+static void streamPollPwr(unsigned long now) {
+    uint32_t gen = pwrSnapshot.generation();
+    if (gen == 0) return;                           // nothing parsed yet
+
+    bool fresh = streamAnyFresh(STREAM_PWR);
+    if (gen == streamGen[STREAM_PWR] && !fresh) return;
+
+    gen = pwrSnapshot.read(webPwr);
+    uint8_t count = webPwr.moduleCount < MAX_MODULES ? webPwr.moduleCount : MAX_MODULES;
+
+    if (gen != streamGen[STREAM_PWR]) {
+        streamGen[STREAM_PWR] = gen;
+        for (uint8_t pos = 0; pos < count; pos++) streamPublish(STREAM_PWR, pos, gen, now);
+    } else {
+        for (uint8_t pos = 0; pos < count; pos++) streamCatchUp(STREAM_PWR, pos, gen, now);
+    }
+    streamClearFresh(STREAM_PWR);
+}
+
+// BAT / STAT: one module per ring entry, walked with the stream's cursor
+template <typename T, uint8_t N>
+static void streamPollRing(uint8_t type, const SnapshotRing<T, N>& ring, T& copy, unsigned long now) {
+    uint32_t& cursor = streamGen[type];
+
+    // fresh browsers: the entries already handled that are still kept
+    if (streamAnyFresh(type)) {
+        uint32_t k = cursor > N ? cursor - N : 0;
+        while (k < cursor && ring.readAt(k, copy) == SNAP_OK) {
+            streamCatchUp(type, 0, k + 1, now);
+            k++;
+        }
+        streamClearFresh(type);
+    }
+
+    for (;;) {
+        SnapRead r = ring.readAt(cursor, copy);
+        if (r == SNAP_NONE) break;
+        if (r == SNAP_LAPPED) {
+            LOGD(LOGM_WEB, "Stream: %s ring lapped", STREAM_EVENT_NAME[type]);
+            continue;
+        }
+        cursor++;
+        streamPublish(type, 0, cursor, now);
+    }
+}
+
+static void streamPoll() {
+    bool any = false;
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) any |= streamClients[c].used;
+
+    if (!any) {
+        // nobody listens: skip what arrives meanwhile, the next browser
+        // starts from the rings; values are compared from scratch then
+        streamGen[STREAM_BAT]  = batSnapshot.generation();
+        streamGen[STREAM_STAT] = statSnapshot.generation();
+        for (uint8_t t = 0; t < STREAM_TYPES; t++)
+            for (uint8_t m = 0; m < MAX_MODULES; m++) streamState[t][m].count = 0;
+        return;
+    }
+
+    unsigned long now = millis();
+
+    // what the sockets did not take last time goes out first
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) {
+        StreamClient& sc = streamClients[c];
+        if (!sc.used || streamFlush(sc) || !sc.used) continue;
+        if (now - sc.pendSince >= STREAM_STALL_MS) streamDrop(sc, "stalled");
+    }
+
+    streamPollPwr(now);
+    streamPollRing(STREAM_BAT,  batSnapshot,  webBat,  now);
+    streamPollRing(STREAM_STAT, statSnapshot, webStat, now);
+
+    // comment line keeps proxies open and finds closed browsers
+    if (now - streamLastWrite >= STREAM_KEEPALIVE_MS) {
+        streamLastWrite = now;
+        for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) {
+            StreamClient& sc = streamClients[c];
+            if (sc.used) streamWrite(sc, ":\n\n", 3);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// Handler
+// ---------------------------------------------------------
+static void handleApiStream() {
+    for (uint8_t c = 0; c < STREAM_MAX_CLIENTS; c++) {
+        StreamClient& sc = streamClients[c];
+        if (sc.used) continue;
+
+        sc.fd = WebServerModule_takeSocket();
+        if (sc.fd < 0) break;
+        sc.used = true;
+        for (uint8_t t = 0; t < STREAM_TYPES; t++) {
+            sc.fresh[t]  = true;
+            sc.synced[t] = 0;
+        }
+
+        static const char HEAD[] =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\n\r\n"
+            "retry: 3000\n\n";
+
+        // current state follows with the next poll
+        if (streamWrite(sc, HEAD, sizeof(HEAD) - 1))
+            LOGD(LOGM_WEB, "Stream: client %u connected", c);
+        return;
+    }
+
+    server.send(503, "text/plain", "Too many streams");
+}
+
+static void registerStreamAPI() {
+    server.on("/api/stream", HTTP_GET, handleApiStream);
+    WebServerModule_addPoller(streamPoll);
+}
@@ -1,329 +1,329 @@
-#pragma once
-#include <Arduino.h>
-#include <WebServer.h>
-#include "../config.h"
-#include "../py_log.h"
-#include "wp_ui.h"
-
-extern WebServer server;
-
-/* ---------------------------------------------------------
-   BAT Settings Page
-   - Display name is used as MQTT/JSON key
-   - Allowed characters: A-Z, a-z, 0-9, underscore
-   - All other characters are removed when saving
-   --------------------------------------------------------- */
-void handleBatSettingsPage() {
-
-    String html;
-
-    html += R"BAT(
-<!DOCTYPE html>
-<html lang='de'>
-<head>
-<meta charset='UTF-8'>
-<meta name='viewport' content='width=device-width, initial-scale=1.0'>
-<title>BAT Werte</title>
-<style>
-body { font-family: Arial; margin:0; padding:0; background:#f4f4f4; }
-.content { margin-left:260px; padding:20px; }
-h2 { margin-top:0; }
-.lang-box { position:absolute; top:10px; right:20px; }
-.lang-box select { padding:5px; font-size:14px; }
-.top-grid {
-  display:grid;
-  grid-template-columns: 1fr 1fr 1fr;
-  gap:20px;
-  margin-bottom:20px;
-}
-.box { background:white; padding:15px; border-radius:8px; box-shadow:0 0 5px rgba(0,0,0,0.1); }
-.box h3 { margin-top:0; }
-table { width:100%; border-collapse:collapse; margin-top:20px; }
-th, td { padding:8px; border-bottom:1px solid #ddd; text-align:left; }
-th { background:#eee; }
-.save-btn {
-  margin-top:20px; padding:10px 20px; font-size:16px;
-  background:#0078d7; color:white; border:none; border-radius:5px; cursor:pointer;
-}
-.save-btn:hover { background:#005fa3; }
-.hint {
-  margin-top:10px;
-  font-size:13px;
-  color:#555;
-}
-</style>
-</head>
-<body>
-)BAT";
-
-    html += webSidebar("bat_setting");
-
-    html += R"BAT(
-<div class='content'>
-  <div class='lang-box'>
-    <select id='langSel' onchange='changeLang()'>
-      <option value='de'>Deutsch</option>
-      <option value='en'>English</option>
-    </select>
-  </div>
-
-  <h2 id='title'>BAT Werte</h2>
-  <div class='top-grid'>
-    <div class='box'>
-      <h3>BAT Parser</h3>
-      <label>
-        <input id='enable_bat' type='checkbox'>
-        Parser aktivieren
-      </label>
-    </div>
-
-    <div class='box'>
-      <h3 id='mqttTitle'>MQTT Topic</h3>
-
-      <label id='batLabel'>Cell Subtopic<br>
-        <input id='mqtt_bat' type='text' style='width:100%'>
-      </label>
-
-      <br><br>
-
-      <label id='cellPrefixLabel'>Cell Prefix<br>
-        <input id='mqtt_cellprefix' type='text' style='width:100%'>
-      </label>
-    </div>
-
-    <div class='box'>
-      <h3 id='intervalTitle'>Abfrageintervall</h3>
-      <label id='intervalLabel'>BAT (Sekunden)<br>
-        <input id='interval_bat' type='number' min='1' style='width:100%'>
-      </label>
-    </div>
-  </div>
-
-  <div class='box'>
-    <h3 id='parserTitle'>BAT Parser Fields</h3>
-    <div class='hint' id='nameHint'>
-      Hinweis: Der Anzeigename wird als MQTT/JSON-Schlüssel verwendet.
-      Erlaubt sind nur Buchstaben (A–Z, a–z), Ziffern (0–9) und Unterstrich (_).
-      Andere Zeichen werden beim Speichern entfernt.
-    </div>
-    <table>
-      <thead>
-        <tr>
-          <th id='colField'>Feldname</th>
-          <th id='colDisp'>Anzeigename</th>
-          <th id='colRaw'>Rohdaten</th>
-          <th id='colFactor'>Faktor / Teiler</th>
-          <th id='colUnit'>Einheit</th>
-          <th id='colValue'>Wert</th>
-          <th id='colMqtt'>MQTT</th>
-          <th id='colSend'>Send</th>
-        </tr>
-      </thead>
-      <tbody id='parserTable'></tbody>
-    </table>
-  </div>
-
-  <button class='save-btn' onclick='saveBatSettings()'>Speichern</button>
-
-<script>
-
-/* ---------------------------------------------------------
-   Language switch (DE/EN)
---------------------------------------------------------- */
-function changeLang(){
-  let lang=document.getElementById('langSel').value;
-  if(lang==='en'){
-    document.getElementById('title').innerText='BAT Values';
-    document.getElementById('mqttTitle').innerText='MQTT Topic';
-    document.getElementById('batLabel').innerHTML='Cell Subtopic<br><input id="mqtt_bat" type="text" style="width:100%">';
-    document.getElementById('cellPrefixLabel').innerHTML='Cell Prefix<br><input id="mqtt_cellprefix" type="text" style="width:100%">';
-    document.getElementById('intervalTitle').innerText='Query Interval';
-    document.getElementById('intervalLabel').innerHTML='BAT (seconds)<br><input id="interval_bat" type="number" min="1" style="width:100%">';
-    document.getElementById('parserTitle').innerText='BAT Parser Fields';
-    document.getElementById('colField').innerText='Field';
-    document.getElementById('colDisp').innerText='Display Name';
-    document.getElementById('colRaw').innerText='Raw Data';
-    document.getElementById('colFactor').innerText='Factor';
-    document.getElementById('colUnit').innerText='Unit';
-    document.getElementById('colValue').innerText='Value';
-    document.getElementById('colMqtt').innerText='MQTT';
-    document.getElementById('colSend').innerText='Send';
-    document.getElementById('nameHint').innerText =
-      'Note: Display name is used as MQTT/JSON key. Allowed: A–Z, a–z, 0–9, underscore (_). Other characters are removed on save.';
-  } else {
-    location.reload();
-  }
-}
-
-/* ---------------------------------------------------------
-   Sanitize display name: only A-Z, a-z, 0-9, underscore
---------------------------------------------------------- */
-function sanitizeDisplayName(str){
-  return str.replace(/[^A-Za-z0-9_]/g, '');
-}
-
-/* ---------------------------------------------------------
-   Load BAT parser data
---------------------------------------------------------- */
-function loadData(){
-  fetch('/api/bat/get').then(r=>r.json()).then(j=>{
-
-    document.getElementById('enable_bat').checked = j.enable_bat;
-    document.getElementById('interval_bat').value = j.interval_bat;
-    document.getElementById('mqtt_bat').value     = j.mqtt_bat;
-    document.getElementById('mqtt_cellprefix').value = j.mqtt_cellprefix;
-
-    let table = document.getElementById('parserTable');
-    table.innerHTML = '';
-
-    j.fields.forEach(f=>{
-      let row = document.createElement('tr');
-      let valCell = (f.sendMQTT && f.value) ? f.value : '—';
-
-      let disp = f.display || f.name;
-
-      row.innerHTML = `
-        <td>${f.name}</td>
-        <td><input id='disp_${f.name}' value='${disp}'></td>
-        <td id='raw_${f.name}'>${f.raw || '—'}</td>
-        <td>
-          <select id='fac_${f.name}'>
-            <option value='0.0001'>0.0001</option>
-            <option value='0.001'>0.001</option>
-            <option value='0.01'>0.01</option>
-            <option value='0.1'>0.1</option>
-            <option value='1'>1</option>
-            <option value='10'>10</option>
-            <option value='text'>text</option>
-            <option value='date'>date</option>
-          </select>
-        </td>
-        <td>
-          <select id='unit_${f.name}'>
-            <option value=''></option>
-            <option value='V'>V</option>
-            <option value='A'>A</option>
-            <option value='Ah'>Ah</option>
-            <option value='°C'>°C</option>
-            <option value='%'>%</option>
-            <option value='timestamp'>timestamp</option>
-          </select>
-        </td>
-        <td id='val_${f.name}'>${valCell}</td>
-        <td><input type='checkbox' id='mqtt_${f.name}' ${f.sendMQTT ? 'checked' : ''} onchange='mqttChanged("${f.name}")'></td>
-        <td><input type='checkbox' id='send_${f.name}' ${f.sendPayload ? 'checked' : ''} onchange='sendChanged("${f.name}")'></td>
-      `;
-      table.appendChild(row);
-
-      let factor = f.factor;
-      let unit   = f.unit;
-      let mqtt   = f.sendMQTT;
-      let send   = f.sendPayload;
-
-      let n = f.name.toLowerCase();
-      let raw = (f.raw || '').toLowerCase();
-
-      // Auto-detect only if no config exists yet
-      let autoDetect = (factor === '1' && unit === '' && !mqtt && !send && f.raw !== '');
-
-      if (autoDetect) {
-
-        if (raw.includes('%')) {
-          factor = '1';
-          unit = '%';
-          mqtt = false;
-          send = false;
-        }
-        else if (raw.includes('mah')) {
-          factor = '0.001';
-          unit = 'Ah';
-          mqtt = false;
-          send = false;
-        }
-        else if (isNaN(parseFloat(raw))) {
-          factor = 'text';
-          unit = '';
-          mqtt = false;
-          send = false;
-        }
-        else if (n.includes('volt')) {
-          factor = '0.001';
-          unit = 'V';
-          mqtt = false;
-          send = false;
-        }
-        else if (n.includes('curr')) {
-          factor = '0.001';
-          unit = 'A';
-          mqtt = false;
-          send = false;
-        }
-        else if (n.includes('tempr')) {
-          factor = '0.001';
-          unit = '°C';
-          mqtt = false;
-          send = false;
-        }
-        else {
-          factor = '1';
-          unit = '';
-          mqtt = false;
-          send = false;
-        }
-      }
-
-      document.getElementById('fac_' + f.name).value = factor;
-      document.getElementById('unit_' + f.name).value = unit;
-      document.getElementById('mqtt_' + f.name).checked = mqtt;
-      document.getElementById('send_' + f.name).checked = send;
-    });
-  });
-}
-
-/* ---------------------------------------------------------
-   Save BAT settings
---------------------------------------------------------- */
-function saveBatSettings(){
-  let data={
-    enable_bat: document.getElementById('enable_bat').checked,
-    interval_bat:parseInt(document.getElementById('interval_bat').value),
-    mqtt_bat: document.getElementById('mqtt_bat').value,
-    mqtt_cellprefix: document.getElementById('mqtt_cellprefix').value,
-    fields:[]
-  };
-
-  document.querySelectorAll('#parserTable tr').forEach(row=>{
-    let name=row.cells[0].innerText;
-    let dispInput = document.getElementById('disp_'+name);
-    let dispRaw   = dispInput.value || name;
-
-    // Clean display name for MQTT/JSON
-    let dispClean = sanitizeDisplayName(dispRaw);
-    dispInput.value = dispClean;
-
-    data.fields.push({
-      name:name,
-      display:dispClean,
-      factor:document.getElementById('fac_'+name).value,
-      unit:document.getElementById('unit_'+name).value,
-      sendMQTT:document.getElementById('mqtt_'+name).checked,
-      sendPayload:document.getElementById('send_'+name).checked
-    });
-  });
-
-  fetch('/api/bat/set',{
-    method:'POST',
-    headers:{'Content-Type':'application/json'},
-    body:JSON.stringify(data)
-  }).then(()=>alert('Gespeichert'));
-}
-
-loadData();
-</script>
-</div>
-</body>
-</html>
-)BAT";
-
-    server.send(200, "text/html", html);
+#pragma once
+#include <Arduino.h>
+#include "../py_http_server.h"
+#include "../config.h"
+#include "../py_log.h"
+#include "wp_ui.h"
+
+extern HttpServer server;
+
+/* ---------------------------------------------------------
+   BAT Settings Page
+   - Display name is used as MQTT/JSON key
+   - Allowed characters: A-Z, a-z, 0-9, underscore
+   - All other characters are removed when saving
+   --------------------------------------------------------- */
+void handleBatSettingsPage() {
+
+    String html;
+
+    html += R"BAT(
+<!DOCTYPE html>
+<html lang='de'>
+<head>
+<meta charset='UTF-8'>
+<meta name='viewport' content='width=device-width, initial-scale=1.0'>
+<title>BAT Werte</title>
+<style>
+body { font-family: Arial; margin:0; padding:0; background:#f4f4f4; }
+.content { margin-left:260px; padding:20px; }
+h2 { margin-top:0; }
+.lang-box { position:absolute; top:10px; right:20px; }
+.lang-box select { padding:5px; font-size:14px; }
+.top-grid {
+  display:grid;
+  grid-template-columns: 1fr 1fr 1fr;
+  gap:20px;
+  margin-bottom:20px;
+}
+.box { background:white; padding:15px; border-radius:8px; box-shadow:0 0 5px rgba(0,0,0,0.1); }
+.box h3 { margin-top:0; }
+table { width:100%; border-collapse:collapse; margin-top:20px; }
+th, td { padding:8px; border-bottom:1px solid #ddd; text-align:left; }
+th { background:#eee; }
+.save-btn {
+  margin-top:20px; padding:10px 20px; font-size:16px;
+  background:#0078d7; color:white; border:none; border-radius:5px; cursor:pointer;
+}
+.save-btn:hover { background:#005fa3; }
+.hint {
+  margin-top:10px;
+  font-size:13px;
+  color:#555;
+}
+</style>
+</head>
+<body>
+)BAT";
+
+    html += webSidebar("bat_setting");
+
+    html += R"BAT(
+<div class='content'>
+  <div class='lang-box'>
+    <select id='langSel' onchange='changeLang()'>
+      <option value='de'>Deutsch</option>
+      <option value='en'>English</option>
+    </select>
+  </div>
+
+  <h2 id='title'>BAT Werte</h2>
+  <div class='top-grid'>
+    <div class='box'>
+      <h3>BAT Parser</h3>
+      <label>
+        <input id='enable_bat' type='checkbox'>
+        Parser aktivieren
+      </label>
+    </div>
+
+    <div class='box'>
+      <h3 id='mqttTitle'>MQTT Topic</h3>
+
+      <label id='batLabel'>Cell Subtopic<br>
+        <input id='mqtt_bat' type='text' style='width:100%'>
+      </label>
+
+      <br><br>
+
+      <label id='cellPrefixLabel'>Cell Prefix<br>
+        <input id='mqtt_cellprefix' type='text' style='width:100%'>
+      </label>
+    </div>
+
+    <div class='box'>
+      <h3 id='intervalTitle'>Abfrageintervall</h3>
+      <label id='intervalLabel'>BAT (Sekunden)<br>
+        <input id='interval_bat' type='number' min='1' style='width:100%'>
+      </label>
+    </div>
+  </div>
+
+  <div class='box'>
+    <h3 id='parserTitle'>BAT Parser Fields</h3>
+    <div class='hint' id='nameHint'>
+      Hinweis: Der Anzeigename wird als MQTT/JSON-Schlüssel verwendet.
+      Erlaubt sind nur Buchstaben (A–Z, a–z), Ziffern (0–9) und Unterstrich (_).
+      Andere Zeichen werden beim Speichern entfernt.
+    </div>
+    <table>
+      <thead>
+        <tr>
+          <th id='colField'>Feldname</th>
+          <th id='colDisp'>Anzeigename</th>
+          <th id='colRaw'>Rohdaten</th>
+          <th id='colFactor'>Faktor / Teiler</th>
+          <th id='colUnit'>Einheit</th>
+          <th id='colValue'>Wert</th>
+          <th id='colMqtt'>MQTT</th>
+          <th id='colSend'>Send</th>
+        </tr>
+      </thead>
+      <tbody id='parserTable'></tbody>
+    </table>
+  </div>
+
+  <button class='save-btn' onclick='saveBatSettings()'>Speichern</button>
+
+<script>
+
+/* ---------------------------------------------------------
+   Language switch (DE/EN)
+--------------------------------------------------------- */
+function changeLang(){
+  let lang=document.getElementById('langSel').value;
+  if(lang==='en'){
+    document.getElementById('title').innerText='BAT Values';
+    document.getElementById('mqttTitle').innerText='MQTT Topic';
+    document.getElementById('batLabel').innerHTML='Cell Subtopic<br><input id="mqtt_bat" type="text" style="width:100%">';
+    document.getElementById('cellPrefixLabel').innerHTML='Cell Prefix<br><input id="mqtt_cellprefix" type="text" style="width:100%">';
+    document.getElementById('intervalTitle').innerText='Query Interval';
+    document.getElementById('intervalLabel').innerHTML='BAT (seconds)<br><input id="interval_bat" type="number" min="1" style="width:100%">';
+    document.getElementById('parserTitle').innerText='BAT Parser Fields';
+    document.getElementById('colField').innerText='Field';
+    document.getElementById('colDisp').innerText='Display Name';
+    document.getElementById('colRaw').innerText='Raw Data';
+    document.getElementById('colFactor').innerText='Factor';
+    document.getElementById('colUnit').innerText='Unit';
+    document.getElementById('colValue').innerText='Value';
+    document.getElementById('colMqtt').innerText='MQTT';
+    document.getElementById('colSend').innerText='Send';
+    document.getElementById('nameHint').innerText =
+      'Note: Display name is used as MQTT/JSON key. Allowed: A–Z, a–z, 0–9, underscore (_). Other characters are removed on save.';
+  } else {
+    location.reload();
+  }
+}
+
+/* ---------------------------------------------------------
+   Sanitize display name: only A-Z, a-z, 0-9, underscore
+--------------------------------------------------------- */
+function sanitizeDisplayName(str){
+  return str.replace(/[^A-Za-z0-9_]/g, '');
+}
+
+/* ---------------------------------------------------------
+   Load BAT parser data
+--------------------------------------------------------- */
+function loadData(){
+  fetch('/api/bat/get').then(r=>r.json()).then(j=>{
+
+    document.getElementById('enable_bat').checked = j.enable_bat;
+    document.getElementById('interval_bat').value = j.interval_bat;
+    document.getElementById('mqtt_bat').value     = j.mqtt_bat;
+    document.getElementById('mqtt_cellprefix').value = j.mqtt_cellprefix;
+
+    let table = document.getElementById('parserTable');
+    table.innerHTML = '';
+
+    j.fields.forEach(f=>{
+      let row = document.createElement('tr');
+      let valCell = (f.sendMQTT && f.value) ? f.value : '—';
+
+      let disp = f.display || f.name;
+
+      row.innerHTML = `
+        <td>${f.name}</td>
+        <td><input id='disp_${f.name}' value='${disp}'></td>
+        <td id='raw_${f.name}'>${f.raw || '—'}</td>
+        <td>
+          <select id='fac_${f.name}'>
+            <option value='0.0001'>0.0001</option>
+            <option value='0.001'>0.001</option>
+            <option value='0.01'>0.01</option>
+            <option value='0.1'>0.1</option>
+            <option value='1'>1</option>
+            <option value='10'>10</option>
+            <option value='text'>text</option>
+            <option value='date'>date</option>
+          </select>
+        </td>
+        <td>
+          <select id='unit_${f.name}'>
+            <option value=''></option>
+            <option value='V'>V</option>
+            <option value='A'>A</option>
+            <option value='Ah'>Ah</option>
+            <option value='°C'>°C</option>
+            <option value='%'>%</option>
+            <option value='timestamp'>timestamp</option>
+          </select>
+        </td>
+        <td id='val_${f.name}'>${valCell}</td>
+        <td><input type='checkbox' id='mqtt_${f.name}' ${f.sendMQTT ? 'checked' : ''} onchange='mqttChanged("${f.name}")'></td>
+        <td><input type='checkbox' id='send_${f.name}' ${f.sendPayload ? 'checked' : ''} onchange='sendChanged("${f.name}")'></td>
+      `;
+      table.appendChild(row);
+
+      let factor = f.factor;
+      let unit   = f.unit;
+      let mqtt   = f.sendMQTT;
+      let send   = f.sendPayload;
+
+      let n = f.name.toLowerCase();
+      let raw = (f.raw || '').toLowerCase();
+
+      // Auto-detect only if no config exists yet
+      let autoDetect = (factor === '1' && unit === '' && !mqtt && !send && f.raw !== '');
+
+      if (autoDetect) {
+
+        if (raw.includes('%')) {
+          factor = '1';
+          unit = '%';
+          mqtt = false;
+          send = false;
+        }
+        else if (raw.includes('mah')) {
+          factor = '0.001';
+          unit = 'Ah';
+          mqtt = false;
+          send = false;
+        }
+        else if (isNaN(parseFloat(raw))) {
+          factor = 'text';
+          unit = '';
+          mqtt = false;
+          send = false;
+        }
+        else if (n.includes('volt')) {
+          factor = '0.001';
+          unit = 'V';
+          mqtt = false;
+          send = false;
+        }
+        else if (n.includes('curr')) {
+          factor = '0.001';
+          unit = 'A';
+          mqtt = false;
+          send = false;
+        }
+        else if (n.includes('tempr')) {
+          factor = '0.001';
+          unit = '°C';
+          mqtt = false;
+          send = false;
+        }
+        else {
+          factor = '1';
+          unit = '';
+          mqtt = false;
+          send = false;
+        }
+      }
+
+      document.getElementById('fac_' + f.name).value = factor;
+      document.getElementById('unit_' + f.name).value = unit;
+      document.getElementById('mqtt_' + f.name).checked = mqtt;
+      document.getElementById('send_' + f.name).checked = send;
+    });
+  });
+}
+
+/* ---------------------------------------------------------
+   Save BAT settings
+--------------------------------------------------------- */
+function saveBatSettings(){
+  let data={
+    enable_bat: document.getElementById('enable_bat').checked,
+    interval_bat:parseInt(document.getElementById('interval_bat').value),
+    mqtt_bat: document.getElementById('mqtt_bat').value,
+    mqtt_cellprefix: document.getElementById('mqtt_cellprefix').value,
+    fields:[]
+  };
+
+  document.querySelectorAll('#parserTable tr').forEach(row=>{
+    let name=row.cells[0].innerText;
+    let dispInput = document.getElementById('disp_'+name);
+    let dispRaw   = dispInput.value || name;
+
+    // Clean display name for MQTT/JSON
+    let dispClean = sanitizeDisplayName(dispRaw);
+    dispInput.value = dispClean;
+
+    data.fields.push({
+      name:name,
+      display:dispClean,
+      factor:document.getElementById('fac_'+name).value,
+      unit:document.getElementById('unit_'+name).value,
+      sendMQTT:document.getElementById('mqtt_'+name).checked,
+      sendPayload:document.getElementById('send_'+name).checked
+    });
+  });
+
+  fetch('/api/bat/set',{
+    method:'POST',
+    headers:{'Content-Type':'application/json'},
+    body:JSON.stringify(data)
+  }).then(()=>alert('Gespeichert'));
+}
+
+loadData();
+</script>
+</div>
+</body>
+</html>
+)BAT";
+
+    server.send(200, "text/html", html);
 }
\ No newline at end of file
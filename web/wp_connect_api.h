@@ -1,187 +1,345 @@
-#pragma once
-#include <WebServer.h>
-#include <ArduinoJson.h>
-#include "../py_wifimanager.h"
-#include "../py_mqtt.h"
-#include "../config.h"
-
-extern WebServer server;
-extern PyMqtt py_mqtt;
-
-// ---------------------------------------------------------
-// WiFi API
-// ---------------------------------------------------------
-static void apiWifiGet() {
-    WifiStatus s = WiFiManagerModule::getStatus();
-
-    DynamicJsonDocument doc(256);
-    doc["connected"] = s.connected;
-    doc["ssid"]      = s.ssid;
-    doc["rssi"]      = s.rssi;
-    doc["ip"]        = s.ip;
-    doc["mac"]       = s.mac;
-
-    String out;
-    serializeJson(doc, out);
-    server.send(200, "application/json", out);
-}
-
-static void apiWifiPost() {
-    if (!server.hasArg("plain")) {
-        server.send(400, "text/plain", "Missing body");
-        return;
-    }
-
-    DynamicJsonDocument req(256);
-    if (deserializeJson(req, server.arg("plain"))) {
-        server.send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-
-    String ssid = req["ssid"] | "";
-    String pass = req["pass"] | "";
-
-    if (ssid.length() == 0) {
-        server.send(400, "text/plain", "SSID missing");
-        return;
-    }
-
-    WiFiManagerModule::connect(ssid, pass);
-    server.send(200, "text/plain", "Connecting…");
-}
-
-static void apiWifiScan() {
-    String json = WiFiManagerModule::scanJson();
-    server.send(200, "application/json", json);
-}
-
-// ---------------------------------------------------------
-// MQTT API
-// ---------------------------------------------------------
-static void apiMqttGet() {
-    DynamicJsonDocument doc(256);
-
-    doc["enabled"] = config.mqtt.enabled;
-    doc["server"]  = config.mqtt.server;
-    doc["port"]    = config.mqtt.port;
-    doc["user"]    = config.mqtt.user;
-    doc["topic"]   = config.mqtt.prefix;
-
-    String out;
-    serializeJson(doc, out);
-    server.send(200, "application/json", out);
-}
-
-static void apiMqttPost() {
-    if (!server.hasArg("plain")) {
-        server.send(400, "text/plain", "Missing body");
-        return;
-    }
-
-    DynamicJsonDocument req(256);
-    if (deserializeJson(req, server.arg("plain"))) {
-        server.send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-
-    config.mqtt.enabled = req["enabled"] | false;
-    config.mqtt.server  = req["server"]  | "";
-    config.mqtt.port    = req["port"]    | 1883;
-    config.mqtt.user    = req["user"]    | "";
-    String pass         = req["pass"]    | "";
-    if (pass.length() > 0) config.mqtt.pass = pass;
-    config.mqtt.prefix  = req["topic"]   | "Pylontech";
-
-    config.save();
-    py_mqtt.begin();
-
-    server.send(200, "text/plain", "MQTT saved");
-}
-
-// ---------------------------------------------------------
-// TIME / NTP API
-// ---------------------------------------------------------
-static void apiTimeGet() {
-    DynamicJsonDocument doc(256);
-
-    doc["manual_mode"]     = config.manual_mode;
-    doc["manual_date"]     = config.manual_date;
-    doc["manual_time"]     = config.manual_time;
-    doc["manual_dst"]      = config.manual_dst;
-
-    doc["use_gateway_ntp"] = config.use_gateway_ntp;
-    doc["manual_ntp"]      = config.manual_ntp;
-    doc["server"]          = config.ntpServer;
-
-    doc["timezone"]        = config.timezone;
-
-    String out;
-    serializeJson(doc, out);
-    server.send(200, "application/json", out);
-}
-
-static void apiTimePost() {
-    if (!server.hasArg("plain")) {
-        server.send(400, "text/plain", "Missing body");
-        return;
-    }
-
-    DynamicJsonDocument req(256);
-    if (deserializeJson(req, server.arg("plain"))) {
-        server.send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-
-    config.manual_mode     = req["manual_mode"]     | false;
-    config.manual_date     = req["manual_date"]     | "";
-    config.manual_time     = req["manual_time"]     | "";
-    config.manual_dst      = req["manual_dst"]      | false;
-
-    config.use_gateway_ntp = req["use_gateway_ntp"] | true;
-    config.manual_ntp      = req["manual_ntp"]      | false;
-    config.ntpServer       = req["server"]          | "pool.ntp.org";
-
-    config.timezone        = req["timezone"]        | "Europe/Berlin";
-
-    config.save();
-    server.send(200, "text/plain", "Time saved");
-}
-
-// ---------------------------------------------------------
-// NETWORK API
-// ---------------------------------------------------------
-static void apiNetworkGet() {
-    DynamicJsonDocument doc(256);
-
-    doc["dhcp"] = !config.useStaticIP;
-    doc["ip"]   = config.ipAddr;
-    doc["mask"] = config.subnetMask;
-    doc["gw"]   = config.gateway;
-    doc["dns"]  = config.dns;
-
-    String out;
-    serializeJson(doc, out);
-    server.send(200, "application/json", out);
-}
-
-static void apiNetworkPost() {
-    if (!server.hasArg("plain")) {
-        server.send(400, "text/plain", "Missing body");
-        return;
-    }
-
-    DynamicJsonDocument req(256);
-    if (deserializeJson(req, server.arg("plain"))) {
-        server.send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-
-    config.useStaticIP = !(req["dhcp"] | true);
-    config.ipAddr      = req["ip"]   | "";
-    config.subnetMask  = req["mask"] | "";
-    config.gateway     = req["gw"]   | "";
-    config.dns         = req["dns"]  | "";
-
-    config.save();
-    server.send(200, "text/plain", "Network saved");
-}
+#pragma once
+#include "../py_http_server.h"
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include "../py_wifimanager.h"
+#include "../py_mqtt.h"
+#include "../py_mqtt_offline.h"
+#include "../config.h"
+#include "json_stream.h"
+#include "../wp_webserver.h"
+
+extern HttpServer server;
+extern PyMqtt py_mqtt;
+
+// ---------------------------------------------------------
+// WiFi API
+// ---------------------------------------------------------
+static void apiWifiGet() {
+    WifiStatus s = WiFiManagerModule::getStatus();
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+    js.member("connected", s.connected);
+    js.member("ssid",      s.ssid);
+    js.member("rssi",      s.rssi);
+    js.member("ip",        s.ip);
+    js.member("mac",       s.mac);
+    js.endObject();
+    js.end();
+}
+
+static void apiWifiPost() {
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing body");
+        return;
+    }
+
+    DynamicJsonDocument req(256);
+    if (deserializeJson(req, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    String ssid = req["ssid"] | "";
+    String pass = req["pass"] | "";
+
+    if (ssid.length() == 0) {
+        server.send(400, "text/plain", "SSID missing");
+        return;
+    }
+
+    // WiFi belongs to the noncritical task; answered before the switch
+    if (!ConfigChange_post([ssid, pass] { WiFiManagerModule::connect(ssid, pass); })) {
+        server.send(503, "text/plain", "Busy");
+        return;
+    }
+    server.send(200, "text/plain", "Connecting…");
+}
+
+// Scan runs in the background, the answer is deferred until it is done
+static bool pollWifiScan(DeferredReply& reply) {
+    int n = WiFiManagerModule::scanDone();
+
+    if (n == WIFI_SCAN_RUNNING && !reply.timedOut) return false;
+
+    if (n < 0) {
+        reply.send(504, "text/plain", n == WIFI_SCAN_RUNNING ? "Scan timeout" : "Scan failed");
+        return true;
+    }
+
+    reply.send(200, "application/json", WiFiManagerModule::scanJson());
+    return true;
+}
+
+static void apiWifiScan() {
+    if (!WiFiManagerModule::scanStart()) {
+        server.send(503, "text/plain", "Scan failed");
+        return;
+    }
+    if (!WebServerModule_defer(pollWifiScan, 10000)) {
+        server.send(503, "text/plain", "Busy");
+    }
+}
+
+// ---------------------------------------------------------
+// MQTT API
+// ---------------------------------------------------------
+static void apiMqttGet() {
+    MqttConfig m;
+    {
+        ConfigLock lock;
+        m = config.mqtt;
+    }
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+    js.member("enabled",   m.enabled);
+    js.member("server",    m.server);
+    js.member("port",      m.port);
+    js.member("user",      m.user);
+    js.member("topic",     m.prefix);
+    js.member("discovery", m.discovery);
+    js.endObject();
+    js.end();
+}
+
+static void apiMqttPost() {
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing body");
+        return;
+    }
+
+    DynamicJsonDocument req(256);
+    if (deserializeJson(req, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    bool     enabled   = req["enabled"]   | false;
+    String   host      = req["server"]    | "";
+    uint16_t port      = req["port"]      | 1883;
+    String   user      = req["user"]      | "";
+    String   pass      = req["pass"]      | "";
+    String   prefix    = req["topic"]     | "Pylontech";
+    String   discovery = req["discovery"] | "";
+
+    WebServerModule_applyConfig([=] {
+        {
+            ConfigLock lock;
+            config.mqtt.enabled = enabled;
+            config.mqtt.server  = host;
+            config.mqtt.port    = port;
+            config.mqtt.user    = user;
+            if (pass.length() > 0) config.mqtt.pass = pass;
+            config.mqtt.prefix  = prefix;
+
+            if (discovery == "entity" || discovery == "device")
+                config.mqtt.discovery = discovery;
+        }
+
+        config.save();
+        py_mqtt.begin();
+
+        // only groups whose discovery hash changed are republished
+        discoveryPwrNeeded = true;
+    }, "MQTT saved");
+}
+
+// Outbox / backpressure counters of the MQTT transport
+static void apiMqttStats() {
+    const MqttTransportStats& st = py_mqtt.transportStats();
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+    js.member("connected",  py_mqtt.isConnected());
+    js.member("queued",     py_mqtt.outboxQueued());
+    js.member("queuedMax",  st.queuedMax);
+    js.member("sentBytes",  st.sentBytes);
+    js.member("deferred",   st.deferred);
+    js.member("wouldBlock", st.wouldBlock);
+    js.member("errors",     st.errors);
+    js.member("pumpMaxUs",  st.pumpMaxUs);
+
+    // QoS 1 window (replay)
+    js.key("qos1").beginObject();
+    js.member("inflight",     py_mqtt.inflight());
+    js.member("sent",         st.qos1Sent);
+    js.member("acked",        st.qos1Acked);
+    js.member("resent",       st.qos1Resent);
+    js.member("windowFull",   st.inflightFull);
+    js.endObject();
+
+    // store-and-forward ring (samples captured while offline)
+    const OfflineStats& off = mqttOffline.stats();
+    js.key("offline").beginObject();
+    js.member("pendingBytes", mqttOffline.pendingBytes());
+    js.member("segments",     mqttOffline.segmentsUsed());
+    js.member("stored",       off.stored);
+    js.member("replayed",     off.replayed);
+    js.member("dropped",      off.dropped);
+    js.member("lostSegments", off.lostSegments);
+    js.member("corrupt",      off.corrupt);
+    js.member("noTime",       off.noTime);
+    js.endObject();
+
+    js.endObject();
+    js.end();
+}
+
+// ---------------------------------------------------------
+// TIME / NTP API
+// ---------------------------------------------------------
+static void apiTimeGet() {
+    String date, time, ntpServer, timezone;
+    {
+        ConfigLock lock;
+        date      = config.manual_date;
+        time      = config.manual_time;
+        ntpServer = config.ntpServer;
+        timezone  = config.timezone;
+    }
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+
+    js.member("manual_mode",     config.manual_mode);
+    js.member("manual_date",     date);
+    js.member("manual_time",     time);
+    js.member("manual_dst",      config.manual_dst);
+
+    js.member("use_gateway_ntp", config.use_gateway_ntp);
+    js.member("manual_ntp",      config.manual_ntp);
+    js.member("server",          ntpServer);
+
+    js.member("timezone",        timezone);
+
+    js.endObject();
+    js.end();
+}
+
+static void apiTimePost() {
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing body");
+        return;
+    }
+
+    DynamicJsonDocument req(256);
+    if (deserializeJson(req, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    bool   manualMode    = req["manual_mode"]     | false;
+    String manualDate    = req["manual_date"]     | "";
+    String manualTime    = req["manual_time"]     | "";
+    bool   manualDst     = req["manual_dst"]      | false;
+
+    bool   useGatewayNtp = req["use_gateway_ntp"] | true;
+    bool   manualNtp     = req["manual_ntp"]      | false;
+    String ntpServer     = req["server"]          | "pool.ntp.org";
+
+    String timezone      = req["timezone"]        | "Europe/Berlin";
+
+    WebServerModule_applyConfig([=] {
+        {
+            ConfigLock lock;
+            config.manual_mode     = manualMode;
+            config.manual_date     = manualDate;
+            config.manual_time     = manualTime;
+            config.manual_dst      = manualDst;
+
+            config.use_gateway_ntp = useGatewayNtp;
+            config.manual_ntp      = manualNtp;
+            config.ntpServer       = ntpServer;
+
+            config.timezone        = timezone;
+        }
+        config.save();
+    }, "Time saved");
+}
+
+// Timezone list for the selects, streamed from the flash table:
+// {"Europe":[{"city":"Berlin","tz":"Europe/Berlin"},...],...}
+static void apiTimezonesGet() {
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+
+    for (size_t r = 0; r < TIMEZONE_REGION_COUNT; r++) {
+        const TimezoneRegion& reg = TIMEZONE_REGIONS[r];
+
+        js.key(reg.name).beginArray();
+        for (uint8_t i = 0; i < reg.count; i++) {
+            const TimezoneEntry& e = TIMEZONES[reg.first + i];
+            js.beginObject();
+            js.member("city", e.city);
+            js.member("tz",   e.tzName);
+            js.endObject();
+        }
+        js.endArray();
+    }
+
+    js.endObject();
+    js.end();
+}
+
+// ---------------------------------------------------------
+// NETWORK API
+// ---------------------------------------------------------
+static void apiNetworkGet() {
+    String ip, mask, gw, dns;
+    {
+        ConfigLock lock;
+        ip   = config.ipAddr;
+        mask = config.subnetMask;
+        gw   = config.gateway;
+        dns  = config.dns;
+    }
+
+    JsonStream js(server);
+    js.begin();
+    js.beginObject();
+    js.member("dhcp", !config.useStaticIP);
+    js.member("ip",   ip);
+    js.member("mask", mask);
+    js.member("gw",   gw);
+    js.member("dns",  dns);
+    js.endObject();
+    js.end();
+}
+
+static void apiNetworkPost() {
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing body");
+        return;
+    }
+
+    DynamicJsonDocument req(256);
+    if (deserializeJson(req, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    bool   staticIP = !(req["dhcp"] | true);
+    String ip       = req["ip"]   | "";
+    String mask     = req["mask"] | "";
+    String gw       = req["gw"]   | "";
+    String dns      = req["dns"]  | "";
+
+    WebServerModule_applyConfig([=] {
+        {
+            ConfigLock lock;
+            config.useStaticIP = staticIP;
+            config.ipAddr      = ip;
+            config.subnetMask  = mask;
+            config.gateway     = gw;
+            config.dns         = dns;
+        }
+        config.save();
+    }, "Network saved");
+}
@@ -1,2 +1,2 @@
-#pragma once
+#pragma once
 void registerRoutes();
\ No newline at end of file
@@ -1,33 +1,144 @@
-#include "wp_webserver.h"
-#include "wp_routes.h"
-
-
-WebServer server(80);
-
-#include "py_log.h"
-extern String webLog;
-
-static void handleApiLog() {
-  server.send(200, "text/plain", webLog);
-}
-
-// interne Callback‑Pointer
-CmdCallback g_cmdCb = nullptr;
-StatusCallback g_statusCb = nullptr;
-
-void WebServerModule_begin() {
-    registerRoutes();
-    server.begin();
-}
-
-void WebServerModule_handle() {
-    server.handleClient();
-}
-
-void WebServerModule_setCommandCallback(CmdCallback cb) {
-    g_cmdCb = cb;
-}
-
-void WebServerModule_setStatusCallback(StatusCallback cb) {
-    g_statusCb = cb;
+#include "wp_webserver.h"
+#include "wp_routes.h"
+
+
+HttpServer server(80);
+
+#include "py_log.h"
+#include "config.h"
+extern String webLog;
+
+static void handleApiLog() {
+  server.send(200, "text/plain", webLog);
+}
+
+// interne Callback‑Pointer
+CmdCallback g_cmdCb = nullptr;
+StatusCallback g_statusCb = nullptr;
+
+// ---------------------------------------------------------
+// Deferred responses
+// ---------------------------------------------------------
+struct DeferredSlot {
+    bool          used = false;
+    DeferredPoll  poll = nullptr;
+    unsigned long start = 0;
+    uint32_t      timeoutMs = 0;
+    DeferredReply reply;
+};
+
+static DeferredSlot deferred[WEB_DEFERRED_MAX];
+
+static WebPoller pollers[WEB_POLLERS_MAX];
+static uint8_t   pollerCount = 0;
+
+void DeferredReply::send(int code, const char* type, const char* data, size_t len) {
+    server.reply(ticket, code, type, data, len);
+}
+
+int WebServerModule_takeSocket() {
+    return server.detach();
+}
+
+bool WebServerModule_addPoller(WebPoller fn) {
+    if (pollerCount >= WEB_POLLERS_MAX) return false;
+    pollers[pollerCount++] = fn;
+    return true;
+}
+
+bool WebServerModule_defer(DeferredPoll poll, uint32_t timeoutMs,
+                           uint32_t tag, const char* text) {
+    for (uint8_t i = 0; i < WEB_DEFERRED_MAX; i++) {
+        DeferredSlot& d = deferred[i];
+        if (d.used) continue;
+
+        HttpTicket t = server.defer();
+        if (!t) return false;
+
+        d.used           = true;
+        d.poll           = poll;
+        d.start          = millis();
+        d.timeoutMs      = timeoutMs;
+        d.reply.ticket   = t;
+        d.reply.timedOut = false;
+        d.reply.tag      = tag;
+        d.reply.text     = text;
+        return true;
+    }
+
+    LOGW(LOGM_WEB, "Deferred: all %d slots busy", WEB_DEFERRED_MAX);
+    return false;
+}
+
+static void pollDeferred() {
+    for (uint8_t i = 0; i < WEB_DEFERRED_MAX; i++) {
+        DeferredSlot& d = deferred[i];
+        if (!d.used) continue;
+
+        if (!server.pending(d.reply.ticket)) {
+            LOGD(LOGM_WEB, "Deferred: client gone after %lu ms", millis() - d.start);
+            d.used = false;
+            continue;
+        }
+
+        d.reply.timedOut = millis() - d.start >= d.timeoutMs;
+
+        if (d.poll(d.reply) || d.reply.timedOut) {
+            server.abandon(d.reply.ticket);             // no answer sent: close
+            d.used = false;
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// Config writes (applied by the noncritical task)
+// ---------------------------------------------------------
+static bool pollConfigApplied(DeferredReply& reply) {
+    if (ConfigChange_applied(reply.tag)) {
+        reply.send(200, "text/plain", reply.text);
+        return true;
+    }
+    if (!reply.timedOut) return false;
+
+    // still queued - it is applied later, the browser just hears no OK
+    reply.send(504, "text/plain", "Config change pending");
+    return true;
+}
+
+void WebServerModule_applyConfig(ConfigChange fn, const char* okText) {
+    uint32_t n = ConfigChange_post(std::move(fn));
+    if (!n) {
+        server.send(503, "text/plain", "Busy");
+        return;
+    }
+
+    // no deferred slot free: the change is queued anyway
+    if (!WebServerModule_defer(pollConfigApplied, WEB_CONFIG_TIMEOUT_MS, n, okText))
+        server.send(200, "text/plain", okText);
+}
+
+void WebServerModule_begin() {
+    // conditional GET for static files and API snapshots
+    static const char* headerKeys[] = { "If-None-Match" };
+    server.collectHeaders(headerKeys, 1);
+
+    registerRoutes();
+    server.begin();
+}
+
+// Web task: one server round (all connections). No config lock here:
+// handlers copy config under ConfigLock and post their writes.
+void WebServerModule_handle() {
+    server.handleClient(WEB_ROUND_WAIT_MS);
+    pollDeferred();
+
+    for (uint8_t i = 0; i < pollerCount; i++) pollers[i]();
+}
+
+void WebServerModule_setCommandCallback(CmdCallback cb) {
+    g_cmdCb = cb;
+}
+
+void WebServerModule_setStatusCallback(StatusCallback cb) {
+    g_statusCb = cb;
 }
\ No newline at end of file
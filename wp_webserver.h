@@ -1,12 +1,74 @@
-#pragma once
-#include <WebServer.h>
-
-extern WebServer server;
-
-typedef String (*CmdCallback)(const String &cmd);
-typedef String (*StatusCallback)();
-
-void WebServerModule_begin();
-void WebServerModule_handle();
-void WebServerModule_setCommandCallback(CmdCallback cb);
-void WebServerModule_setStatusCallback(StatusCallback cb);
\ No newline at end of file
+#pragma once
+#include "py_http_server.h"
+#include "config.h"
+
+extern HttpServer server;
+
+typedef String (*CmdCallback)(const String &cmd);
+typedef String (*StatusCallback)();
+
+// One server round sleeps in select() until a socket is ready, at most
+// this long, so deferred replies and pollers still run that often
+#define WEB_ROUND_WAIT_MS  10
+
+void WebServerModule_begin();
+void WebServerModule_handle();
+void WebServerModule_setCommandCallback(CmdCallback cb);
+void WebServerModule_setStatusCallback(StatusCallback cb);
+
+// ---------------------------------------------------------
+// Deferred responses
+// ---------------------------------------------------------
+// A handler that has to wait (UART frame, WiFi scan) calls
+// WebServerModule_defer() and returns at once. The server parks the
+// connection (HttpServer::defer), so other requests are served
+// meanwhile. The web task calls poll() every loop until it returns
+// true (answer sent); after timeoutMs it is called once more with
+// timedOut set and has to answer then. Connections closed by the
+// browser are dropped.
+// ---------------------------------------------------------
+#define WEB_DEFERRED_MAX  4
+
+struct DeferredReply {
+    HttpTicket  ticket = 0;
+    bool        timedOut = false;
+    uint32_t    tag = 0;                // handler context (defer() argument)
+    const char* text = nullptr;
+
+    void send(int code, const char* type, const char* data, size_t len);
+    void send(int code, const char* type, const String& body) {
+        send(code, type, body.c_str(), body.length());
+    }
+};
+
+typedef bool (*DeferredPoll)(DeferredReply& reply);
+
+// false: all slots busy (handler answers itself, e.g. 503)
+bool WebServerModule_defer(DeferredPoll poll, uint32_t timeoutMs,
+                           uint32_t tag = 0, const char* text = nullptr);
+
+// ---------------------------------------------------------
+// Config writes
+// ---------------------------------------------------------
+// Handlers never write config themselves: they parse and validate the
+// request, then hand the assignments over as a ConfigChange (config.h)
+// that runs in the noncritical task. The answer (200 okText, a string
+// literal) is sent once the change is applied; 503 if the queue is full.
+// ---------------------------------------------------------
+#define WEB_CONFIG_TIMEOUT_MS  5000
+
+void WebServerModule_applyConfig(ConfigChange fn, const char* okText);
+
+// ---------------------------------------------------------
+// Long-lived connections (/api/stream)
+// ---------------------------------------------------------
+// takeSocket() removes the current connection from the server and
+// returns its (non-blocking) socket; the caller owns it from then on.
+// Pollers run in the web task after every server round.
+// ---------------------------------------------------------
+#define WEB_POLLERS_MAX  4
+
+typedef void (*WebPoller)();
+
+int  WebServerModule_takeSocket();
+bool WebServerModule_addPoller(WebPoller fn);